@@ -109,6 +109,7 @@ ground_state(Simulation_context& ctx, task_t task, cmd_args const& args, int wri
         }
         density.load();
         potential.load();
+        dft.initialize_subspace();
     } else {
         dft.initial_state();
     }
@@ -151,6 +152,9 @@ ground_state(Simulation_context& ctx, task_t task, cmd_args const& args, int wri
         dict["counters"] = json::object();
         dict["counters"]["local_operator_num_applied"] = ctx.num_loc_op_applied();
         dict["counters"]["band_evp_work_count"] = ctx.evp_work_count();
+        /* MPI statistics up to this point */
+        sddk::mpi_stat::collect(ctx.comm());
+        dict["mpi_stat"] = json::parse(sddk::mpi_stat::json());
 
         if (ctx.comm().rank() == 0) {
             std::string output_file = args.value<std::string>("output", std::string("output_") +
@@ -535,6 +539,8 @@ int main(int argn, char** argv)
                                           rt_graph::Stat::Max});
         std::ofstream ofs("timers.json", std::ofstream::out | std::ofstream::trunc);
         ofs << timing_result.json();
+        std::cout << sddk::mpi_stat::print();
+        std::cout << utils::profiler_counters::print();
     }
     if (std::fetestexcept(FE_DIVBYZERO)) {
         std::cout << "FE_DIVBYZERO exception\n";
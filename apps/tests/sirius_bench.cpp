@@ -0,0 +1,430 @@
+#include <sirius.hpp>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include "band/davidson.hpp"
+#include "symmetry/crystal_symmetry.hpp"
+
+using namespace sirius;
+using json = nlohmann::json;
+
+/* Benchmark of the kernels which dominate the pseudopotential SCF loop.
+
+   A synthetic context is created from the model species (no pseudopotential files are needed):
+     si    : diamond structure, 8 atoms in the cubic cell
+     srvo3 : cubic perovskite, 5 atoms in the cell
+   The cell is repeated N times in each direction. Each kernel is executed --warmup times and then timed --repeat
+   times; the time of a repetition is the maximum over MPI ranks. The results are written to the JSON file
+   (--output) and, if --baseline is given, the median times are compared against the stored results of a
+   previous run. The program returns a non-zero code if any kernel is slower than the baseline by more than
+   --tolerance. Typical use:
+
+     sirius_bench --system=si --N=2 --output=base.json
+     ... (new version) ...
+     sirius_bench --system=si --N=2 --baseline=base.json
+*/
+
+/* model species with beta projectors for l = 0..lmax, atomic wave-functions and, optionally, augmentation charge */
+void add_species(Simulation_context& ctx__, std::string label__, int zn__, double rcut__, int lmax__, bool augment__)
+{
+    auto& atype = ctx__.unit_cell().add_atom_type(label__);
+    atype.zn(zn__);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 0.0, 100.0, 6);
+    int np   = atype.radial_grid().num_points();
+    int icut = atype.radial_grid().index_of(rcut__);
+    double rcut = atype.radial_grid(icut);
+
+    std::vector<std::vector<double>> beta;
+    std::vector<int> beta_l;
+    for (int l = 0; l <= lmax__; l++) {
+        for (int k = 0; k < 2; k++) {
+            std::vector<double> f(icut + 1);
+            for (int i = 0; i <= icut; i++) {
+                f[i] = utils::confined_polynomial(atype.radial_grid(i), rcut, l, l + 1 + k, 0);
+            }
+            atype.add_beta_radial_function(l, f);
+            beta.push_back(f);
+            beta_l.push_back(l);
+        }
+    }
+    if (augment__) {
+        for (int i = 0; i < static_cast<int>(beta.size()); i++) {
+            for (int j = 0; j <= i; j++) {
+                for (int l = std::abs(beta_l[i] - beta_l[j]); l <= beta_l[i] + beta_l[j]; l += 2) {
+                    std::vector<double> q(np, 0);
+                    for (int ir = 0; ir <= icut; ir++) {
+                        q[ir] = 0.1 * beta[i][ir] * beta[j][ir];
+                    }
+                    atype.add_q_radial_function(j, i, l, q);
+                }
+            }
+        }
+    }
+
+    std::vector<double> f(np);
+    for (int l = 0; l <= lmax__; l++) {
+        for (int i = 0; i < np; i++) {
+            double x = atype.radial_grid(i);
+            f[i] = std::exp(-x) * std::pow(x, l + 1);
+        }
+        atype.add_ps_atomic_wf(l + 1, sirius::experimental::angular_momentum(l), f);
+    }
+
+    for (int i = 0; i < np; i++) {
+        double x = atype.radial_grid(i);
+        f[i] = -zn__ / (std::exp(-x * (x + 1)) + x);
+    }
+    atype.local_potential(f);
+
+    int nbf = atype.num_beta_radial_functions();
+    matrix<double> dion(nbf, nbf);
+    dion.zero();
+    for (int i = 0; i < nbf; i++) {
+        dion(i, i) = -1.0;
+    }
+    atype.d_mtrx_ion(dion);
+
+    for (int i = 0; i < np; i++) {
+        double x = atype.radial_grid(i);
+        f[i] = 4 * zn__ * std::exp(-x * x) * x * x / std::sqrt(pi);
+    }
+    atype.ps_total_charge_density(f);
+}
+
+/* create the supercell of the model system */
+void create_system(Simulation_context& ctx__, std::string system__, int N__)
+{
+    std::vector<std::pair<std::string, vector3d<double>>> atoms;
+    double a{0};
+    if (system__ == "si") {
+        a = 10.26;
+        add_species(ctx__, "Si", 4, 1.8, 1, false);
+        for (auto r : {vector3d<double>(0, 0, 0), vector3d<double>(0, 0.5, 0.5), vector3d<double>(0.5, 0, 0.5),
+                       vector3d<double>(0.5, 0.5, 0)}) {
+            atoms.push_back({"Si", r});
+            atoms.push_back({"Si", r + vector3d<double>(0.25, 0.25, 0.25)});
+        }
+    } else if (system__ == "srvo3") {
+        a = 7.26;
+        add_species(ctx__, "Sr", 10, 2.0, 1, false);
+        add_species(ctx__, "V", 13, 1.8, 2, true);
+        add_species(ctx__, "O", 6, 1.3, 1, true);
+        atoms.push_back({"Sr", {0, 0, 0}});
+        atoms.push_back({"V", {0.5, 0.5, 0.5}});
+        atoms.push_back({"O", {0.5, 0.5, 0}});
+        atoms.push_back({"O", {0.5, 0, 0.5}});
+        atoms.push_back({"O", {0, 0.5, 0.5}});
+    } else {
+        RTE_THROW("unknown system: " + system__);
+    }
+    ctx__.unit_cell().set_lattice_vectors({{a * N__, 0, 0}, {0, a * N__, 0}, {0, 0, a * N__}});
+    for (int i = 0; i < N__; i++) {
+        for (int j = 0; j < N__; j++) {
+            for (int k = 0; k < N__; k++) {
+                for (auto& e : atoms) {
+                    ctx__.unit_cell().add_atom(e.first, {(e.second[0] + i) / N__, (e.second[1] + j) / N__,
+                                                         (e.second[2] + k) / N__});
+                }
+            }
+        }
+    }
+}
+
+/* run the kernel and collect the timing; the kernel returns the time of the measured part */
+template <typename F>
+json run_kernel(std::string name__, int warmup__, int repeat__, double work__, std::string unit__, F&& f__)
+{
+    auto& comm = Communicator::world();
+    for (int i = 0; i < warmup__; i++) {
+        f__();
+    }
+    std::vector<double> t(repeat__);
+    for (int i = 0; i < repeat__; i++) {
+        comm.barrier();
+        t[i] = f__();
+    }
+    comm.allreduce<double, mpi_op_t::max>(t.data(), repeat__);
+
+    auto ts = t;
+    std::sort(ts.begin(), ts.end());
+    double median = (repeat__ % 2) ? ts[repeat__ / 2] : 0.5 * (ts[repeat__ / 2 - 1] + ts[repeat__ / 2]);
+    double mean{0};
+    for (auto e : t) {
+        mean += e / repeat__;
+    }
+    double sigma{0};
+    for (auto e : t) {
+        sigma += std::pow(e - mean, 2) / repeat__;
+    }
+
+    json dict;
+    dict["times"]      = t;
+    dict["min"]        = ts.front();
+    dict["max"]        = ts.back();
+    dict["median"]     = median;
+    dict["mean"]       = mean;
+    dict["stddev"]     = std::sqrt(sigma);
+    dict["throughput"] = work__ / median;
+    dict["unit"]       = unit__;
+    if (comm.rank() == 0) {
+        std::printf("%-20s median: %12.6f sec., min: %12.6f sec., stddev: %10.6f sec., %12.4f %s\n",
+                    name__.c_str(), median, ts.front(), std::sqrt(sigma), work__ / median, unit__.c_str());
+    }
+    return dict;
+}
+
+template <typename F>
+double timed(F&& f__)
+{
+    auto t0 = utils::time_now();
+    f__();
+    return utils::time_interval(t0);
+}
+
+/* compare the median times with the baseline; return the number of regressions */
+int compare(json& result__, json const& baseline__, double tolerance__)
+{
+    for (auto key : {"system", "N", "pw_cutoff", "gk_cutoff", "num_bands", "num_ranks", "num_threads", "device"}) {
+        if (!baseline__["setup"].count(key) || baseline__["setup"][key] != result__["setup"][key]) {
+            std::printf("warning: setup parameter '%s' differs from the baseline\n", key);
+        }
+    }
+    std::printf("\n%-20s %14s %14s %8s\n", "kernel", "median (sec.)", "baseline", "ratio");
+    std::printf("%s\n", std::string(62, '-').c_str());
+    int num_regressions{0};
+    json comparison = json::object();
+    for (auto& e : result__["kernels"].items()) {
+        if (!baseline__["kernels"].count(e.key())) {
+            continue;
+        }
+        double t  = e.value()["median"].get<double>();
+        double t0 = baseline__["kernels"][e.key()]["median"].get<double>();
+        double r  = t / t0;
+        std::string status;
+        if (r > 1 + tolerance__) {
+            status = "slower";
+            num_regressions++;
+        } else if (r < 1 - tolerance__) {
+            status = "faster";
+        }
+        comparison[e.key()]["baseline"] = t0;
+        comparison[e.key()]["ratio"]    = r;
+        comparison[e.key()]["status"]   = status.size() ? status : "ok";
+        std::printf("%-20s %14.6f %14.6f %8.3f %s\n", e.key().c_str(), t, t0, r, status.c_str());
+    }
+    result__["comparison"] = comparison;
+    return num_regressions;
+}
+
+int sirius_bench(cmd_args const& args__)
+{
+    auto system    = args__.value<std::string>("system", "si");
+    auto N         = args__.value<int>("N", 1);
+    auto pw_cutoff = args__.value<double>("pw_cutoff", 20);
+    auto gk_cutoff = args__.value<double>("gk_cutoff", 6);
+    auto warmup    = args__.value<int>("warmup", 1);
+    auto repeat    = args__.value<int>("repeat", 5);
+    auto device    = args__.value<std::string>("device", "CPU");
+    auto kernels   = args__.value<std::string>("kernels", "");
+    auto output    = args__.value<std::string>("output", "sirius_bench.json");
+    auto tolerance = args__.value<double>("tolerance", 0.1);
+
+    /* list of kernels to run */
+    std::set<std::string> selected;
+    std::istringstream iss(kernels);
+    for (std::string s; std::getline(iss, s, ',');) {
+        selected.insert(s);
+    }
+    auto run = [&](std::string name__) { return selected.empty() || selected.count(name__); };
+
+    auto& comm = Communicator::world();
+
+    Simulation_context ctx("{\"parameters\" : {\"electronic_structure_method\" : \"pseudopotential\"},"
+                           " \"control\" : {\"verification\" : 0}}");
+    create_system(ctx, system, N);
+    ctx.pw_cutoff(pw_cutoff);
+    ctx.gk_cutoff(gk_cutoff);
+    ctx.processing_unit(device);
+    ctx.mpi_grid_dims(args__.value("mpi_grid", std::vector<int>({1, 1})));
+    ctx.add_xc_functional("XC_GGA_X_PBE");
+    ctx.add_xc_functional("XC_GGA_C_PBE");
+    if (args__.exist("num_bands")) {
+        ctx.num_bands(args__.value<int>("num_bands"));
+    }
+    ctx.initialize();
+
+    Density rho(ctx);
+    rho.initial_density();
+    Potential pot(ctx);
+    pot.generate(rho, ctx.use_symmetry(), true);
+
+    std::array<double, 3> vk({0.1, 0.2, 0.3});
+    K_point<double> kp(ctx, &vk[0], 1.0);
+    kp.initialize();
+
+    int nb = ctx.num_bands();
+    auto& gv = ctx.gvec();
+
+    json dict;
+    dict["sirius_version"] = std::to_string(sirius::major_version()) + "." + std::to_string(sirius::minor_version()) +
+                             "." + std::to_string(sirius::revision());
+    dict["git_hash"]      = sirius::git_hash();
+    dict["setup"]         = {{"system", system},
+                             {"N", N},
+                             {"num_atoms", ctx.unit_cell().num_atoms()},
+                             {"pw_cutoff", pw_cutoff},
+                             {"gk_cutoff", gk_cutoff},
+                             {"num_bands", nb},
+                             {"num_gvec", gv.num_gvec()},
+                             {"num_gkvec", kp.num_gkvec()},
+                             {"num_beta", ctx.unit_cell().mt_lo_basis_size()},
+                             {"fft_grid", {ctx.fft_grid()[0], ctx.fft_grid()[1], ctx.fft_grid()[2]}},
+                             {"num_sym", ctx.unit_cell().symmetry().size()},
+                             {"num_ranks", comm.size()},
+                             {"num_threads", omp_get_max_threads()},
+                             {"device", device},
+                             {"warmup", warmup},
+                             {"repeat", repeat}};
+    dict["kernels"] = json::object();
+    if (comm.rank() == 0) {
+        std::printf("%s\n", dict["setup"].dump(2).c_str());
+    }
+
+    {
+        Hamiltonian0<double> H0(pot, true);
+        auto Hk = H0(kp);
+
+        auto phi  = wave_function_factory(ctx, kp, nb, 1, false);
+        auto hphi = wave_function_factory(ctx, kp, nb, 1, false);
+        auto sphi = wave_function_factory(ctx, kp, nb, 1, false);
+        auto tmp  = wave_function_factory(ctx, kp, nb, 1, false);
+        for (int i = 0; i < nb; i++) {
+            for (int igk = 0; igk < kp.num_gkvec_loc(); igk++) {
+                phi->pw_coeffs(0).prime(igk, i) = utils::random<double_complex>();
+            }
+        }
+        if (is_device_memory(ctx.preferred_memory_t())) {
+            phi->copy_to(spin_range(0), ctx.preferred_memory_t(), 0, nb);
+        }
+        int bs = ctx.cyclic_block_size();
+        dmatrix<double_complex> o(nb, nb, ctx.blacs_grid(), bs, bs);
+
+        auto& bp = kp.beta_projectors();
+
+        if (run("apply_h")) {
+            dict["kernels"]["apply_h"] = run_kernel("apply_h", warmup, repeat, nb, "bands/s", [&]() {
+                return timed([&]() {
+                    Hk.apply_h_s<double_complex>(spin_range(0), 0, nb, *phi, hphi.get(), sphi.get());
+                });
+            });
+        }
+        if (run("orthogonalize")) {
+            Hk.apply_h_s<double_complex>(spin_range(0), 0, nb, *phi, hphi.get(), sphi.get());
+            dict["kernels"]["orthogonalize"] = run_kernel("orthogonalize", warmup, repeat, nb, "bands/s", [&]() {
+                return timed([&]() {
+                    orthogonalize<double_complex>(ctx.spla_context(), ctx.preferred_memory_t(),
+                                                  ctx.blas_linalg_t(), spin_range(0), *phi, *hphi, *sphi, 0, nb, o,
+                                                  *tmp);
+                });
+            });
+        }
+        if (run("beta_generate")) {
+            /* size of the generated beta-projector coefficients in GB */
+            double gb = 16e-9 * ctx.unit_cell().mt_lo_basis_size() * kp.num_gkvec();
+            dict["kernels"]["beta_generate"] = run_kernel("beta_generate", warmup, repeat, gb, "GB/s", [&]() {
+                return timed([&]() {
+                    for (int ichunk = 0; ichunk < bp.num_chunks(); ichunk++) {
+                        bp.generate(ichunk);
+                    }
+                });
+            });
+        }
+        if (run("beta_inner")) {
+            double gflop = 8e-9 * ctx.unit_cell().mt_lo_basis_size() * kp.num_gkvec() * nb;
+            dict["kernels"]["beta_inner"] = run_kernel("beta_inner", warmup, repeat, gflop, "GFLOP/s", [&]() {
+                double t{0};
+                for (int ichunk = 0; ichunk < bp.num_chunks(); ichunk++) {
+                    bp.generate(ichunk);
+                    t += timed([&]() { bp.inner<double_complex>(ichunk, *phi, 0, 0, nb); });
+                }
+                return t;
+            });
+        }
+    }
+
+    if (run("symmetrize")) {
+        dict["kernels"]["symmetrize"] = run_kernel("symmetrize", warmup, repeat, 1e-6 * gv.num_gvec(),
+                                                   "M G-vectors/s", [&]() { return timed([&]() { rho.symmetrize(); }); });
+    }
+    if (run("generate_rho_aug")) {
+        double work = 1e-6 * gv.num_gvec() * ctx.unit_cell().num_atoms();
+        dict["kernels"]["generate_rho_aug"] = run_kernel("generate_rho_aug", warmup, repeat, work,
+                                                         "M (atom x G-vector)/s",
+                                                         [&]() { return timed([&]() { rho.generate_rho_aug(); }); });
+    }
+    if (run("xc")) {
+        /* non-magnetic case: the potential is computed by Potential::xc_rg_nonmagnetic() */
+        dict["kernels"]["xc"] = run_kernel("xc", warmup, repeat, 1e-6 * ctx.fft_grid().num_points(),
+                                           "M points/s", [&]() { return timed([&]() { pot.xc(rho); }); });
+    }
+    if (run("ewald_energy")) {
+        dict["kernels"]["ewald_energy"] = run_kernel("ewald_energy", warmup, repeat, ctx.unit_cell().num_atoms(),
+                                                     "atoms/s", [&]() {
+                                                         return timed([&]() { ewald_energy(ctx, gv, ctx.unit_cell()); });
+                                                     });
+    }
+    if (run("mixer")) {
+        rho.mixer_init(ctx.cfg().mixer());
+        dict["kernels"]["mixer"] = run_kernel("mixer", warmup, repeat, 1e-6 * gv.num_gvec(), "M G-vectors/s",
+                                              [&]() { return timed([&]() { rho.mix(); }); });
+    }
+
+    int num_regressions{0};
+    if (args__.exist("baseline")) {
+        json baseline;
+        std::ifstream(args__.value<std::string>("baseline")) >> baseline;
+        if (comm.rank() == 0) {
+            num_regressions = compare(dict, baseline, tolerance);
+            std::printf("number of regressions: %i\n", num_regressions);
+        }
+        comm.bcast(&num_regressions, 1, 0);
+    }
+    if (comm.rank() == 0) {
+        std::ofstream ofs(output, std::ofstream::out | std::ofstream::trunc);
+        ofs << dict.dump(4);
+    }
+    return num_regressions ? 1 : 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--system=", "{string} model system: si or srvo3");
+    args.register_key("--N=", "{int} number of cell repetitions in each direction");
+    args.register_key("--pw_cutoff=", "{double} plane-wave cutoff for density and potential");
+    args.register_key("--gk_cutoff=", "{double} cutoff for G+k vectors");
+    args.register_key("--num_bands=", "{int} number of bands");
+    args.register_key("--mpi_grid=", "{int int} dimensions of MPI grid");
+    args.register_key("--device=", "{string} CPU or GPU");
+    args.register_key("--kernels=", "{string} comma-separated list of kernels (default: all)");
+    args.register_key("--warmup=", "{int} number of warmup runs");
+    args.register_key("--repeat=", "{int} number of timed runs");
+    args.register_key("--output=", "{string} output JSON file");
+    args.register_key("--baseline=", "{string} JSON file with the baseline results");
+    args.register_key("--tolerance=", "{double} allowed relative slowdown with respect to the baseline");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        printf("kernels: apply_h, orthogonalize, beta_generate, beta_inner, symmetrize, generate_rho_aug, xc,\n"
+               "         ewald_energy, mixer\n");
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(1);
+    int result = sirius_bench(args);
+    sirius::finalize();
+
+    return result;
+}
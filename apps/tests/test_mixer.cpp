@@ -58,6 +58,7 @@ int main(int argn, char** argv)
     args.register_key("--dim=", "{size_t} problem dimension");
     args.register_key("--max_iter=", "{int} maximum number of iterations");
     args.register_key("--tol=", "{double} tolerance");
+    args.register_key("--history_storage=", "{string} storage of the mixer history: fp64, fp32 or lossless");
     args.parse_args(argn, argv);
 
     const auto max_iter = args.value<size_t>("max_iter", 100);
@@ -65,6 +66,7 @@ int main(int argn, char** argv)
     const auto beta = args.value<double>("beta", 0.25);
     const auto n = args.value<size_t>("dim", 100);
     const auto tol = args.value<double>("tol", 1e-8);
+    const auto history_storage = args.value<std::string>("history_storage", "fp64");
 
     Operator A{n};
 
@@ -105,6 +107,9 @@ int main(int argn, char** argv)
             }
         }
     );
+    mixer_function_prop.local_data = [](std::vector<double>& x) -> mixer::local_data_t {
+        return mixer::local_data_t({std::make_pair(x.data(), x.size())});
+    };
 
     nlohmann::json mixer_dict = R"mixer(
     {
@@ -120,6 +125,7 @@ int main(int argn, char** argv)
     config_t::mixer_t input(mixer_dict);
     input.beta(beta);
     input.max_history(max_history);
+    input.history_storage(history_storage);
 
     for (auto const mixer_name : {"anderson", "anderson_stable", "broyden2", "linear"}) {
         input.type(mixer_name);
@@ -127,7 +133,8 @@ int main(int argn, char** argv)
         std::cout << "max history = " << input.max_history()
               << ". beta = " << input.beta()
               << ". dim = " << n
-              << ". mixer = " << input.type() << '\n';
+              << ". mixer = " << input.type()
+              << ". history = " << input.history_storage() << '\n';
 
         auto mixer = mixer::Mixer_factory<std::vector<double>>(input);
 
@@ -0,0 +1,118 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* benchmark remapping of wave-functions between the slab and the FFT-friendly distributions for all possible
+   sizes of the communicator orthogonal to the FFT communicator */
+void test_remap(double cutoff__, int num_bands__, int repeat__)
+{
+    auto& comm = Communicator::world();
+
+    matrix3d<double> M = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    Gvec gvec(M, cutoff__, comm, false);
+    if (comm.rank() == 0) {
+        printf("number of bands          : %i\n", num_bands__);
+        printf("total number of G-vectors: %i\n", gvec.num_gvec());
+    }
+
+    for (int northo = 1; northo <= comm.size(); northo++) {
+        if (comm.size() % northo) {
+            continue;
+        }
+        int nfft = comm.size() / northo;
+        auto comm_fft   = comm.split(comm.rank() / nfft);
+        auto comm_ortho = comm.split(comm.rank() % nfft);
+
+        Gvec_partition gvp(gvec, comm_fft, comm_ortho);
+
+        matrix_storage<double_complex, matrix_storage_t::slab> phi(gvp, num_bands__);
+        for (int i = 0; i < num_bands__; i++) {
+            for (int igloc = 0; igloc < gvec.count(); igloc++) {
+                phi.prime(igloc, i) = double_complex(gvec.offset() + igloc, i);
+            }
+        }
+
+        double t_fwd{0};
+        double t_bwd{0};
+        for (int i = 0; i < repeat__; i++) {
+            comm.barrier();
+            auto t0 = utils::time_now();
+            phi.remap_forward(num_bands__, 0, nullptr);
+            t_fwd += utils::time_interval(t0);
+
+            comm.barrier();
+            t0 = utils::time_now();
+            phi.remap_backward(num_bands__, 0);
+            t_bwd += utils::time_interval(t0);
+        }
+
+        /* the number of remapped columns changes from call to call, as for the unconverged residuals of the
+           iterative solver */
+        double t_var{0};
+        for (int i = 0; i < repeat__; i++) {
+            int n = num_bands__ - (i * 7) % (num_bands__ / 2 + 1);
+            comm.barrier();
+            auto t0 = utils::time_now();
+            phi.remap_forward(n, 0, nullptr);
+            phi.remap_backward(n, 0);
+            t_var += utils::time_interval(t0);
+        }
+
+        /* check the extra storage */
+        phi.remap_forward(num_bands__, 0, nullptr);
+        double diff{0};
+        for (int i = 0; i < phi.spl_num_col().local_size(); i++) {
+            int j = phi.spl_num_col()[i];
+            for (int k = 0; k < comm_ortho.size(); k++) {
+                /* global rank that holds the k-th part of the FFT slab */
+                int r = comm_fft.rank() + k * nfft;
+                for (int ig = 0; ig < gvp.gvec_fft_slab().counts[k]; ig++) {
+                    diff += std::abs(phi.extra()(gvp.gvec_fft_slab().offsets[k] + ig, i) -
+                                     double_complex(gvec.gvec_offset(r) + ig, j));
+                }
+            }
+        }
+        /* check the round trip */
+        if (phi.is_remapped()) {
+            phi.zero(memory_t::host, 0, num_bands__);
+        }
+        phi.remap_backward(num_bands__, 0);
+        for (int i = 0; i < num_bands__; i++) {
+            for (int igloc = 0; igloc < gvec.count(); igloc++) {
+                diff += std::abs(phi.prime(igloc, i) - double_complex(gvec.offset() + igloc, i));
+            }
+        }
+        comm.allreduce(&diff, 1);
+
+        if (comm.rank() == 0) {
+            printf("comm_ortho_fft size: %3i, time (forward / backward / varying number of columns): "
+                   "%.6f / %.6f / %.6f sec., difference: %.4e\n",
+                   northo, t_fwd / repeat__, t_bwd / repeat__, t_var / repeat__, diff);
+        }
+        if (diff > 1e-12) {
+            RTE_THROW("wrong remapped data");
+        }
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--cutoff=", "{double} wave-functions cutoff");
+    args.register_key("--num_bands=", "{int} number of bands");
+    args.register_key("--repeat=", "{int} number of repetitions");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    auto cutoff    = args.value<double>("cutoff", 10.0);
+    auto num_bands = args.value<int>("num_bands", 100);
+    auto repeat    = args.value<int>("repeat", 10);
+
+    sirius::initialize(1);
+    test_remap(cutoff, num_bands, repeat);
+    sirius::finalize();
+}
@@ -0,0 +1,80 @@
+#include <sirius.hpp>
+#include "potential/xc_functional_base.hpp"
+
+using namespace sirius;
+
+/* throughput of the native and Libxc implementations of the functionals */
+void test_xc_perf(std::string name__, int num_spins__, int npt__, int repeat__)
+{
+    std::vector<double> rho_up(npt__);
+    std::vector<double> rho_dn(npt__);
+    std::vector<double> sigma_uu(npt__);
+    std::vector<double> sigma_ud(npt__);
+    std::vector<double> sigma_dd(npt__);
+    for (int i = 0; i < npt__; i++) {
+        rho_up[i]   = std::pow(10.0, -3 + 4 * utils::random<double>());
+        rho_dn[i]   = rho_up[i] * utils::random<double>();
+        sigma_uu[i] = std::pow(rho_up[i], 8.0 / 3) * utils::random<double>();
+        sigma_dd[i] = std::pow(rho_dn[i], 8.0 / 3) * utils::random<double>();
+        sigma_ud[i] = 0.5 * std::sqrt(sigma_uu[i] * sigma_dd[i]);
+    }
+    std::vector<std::vector<double>> r(6, std::vector<double>(npt__));
+
+    for (bool use_native : {false, true}) {
+        XC_functional_base xc(name__, num_spins__, use_native);
+
+        double t = -utils::wtime();
+        for (int k = 0; k < repeat__; k++) {
+            #pragma omp parallel
+            {
+                /* split points between threads as in xc_rg_nonmagnetic() */
+                int nt = omp_get_num_threads();
+                int n  = npt__ / nt + std::min(1, npt__ % nt);
+                int i0 = std::min(npt__, omp_get_thread_num() * n);
+                n      = std::min(n, npt__ - i0);
+                if (xc.is_lda()) {
+                    if (num_spins__ == 1) {
+                        xc.get_lda(n, &rho_up[i0], &r[0][i0], &r[1][i0]);
+                    } else {
+                        xc.get_lda(n, &rho_up[i0], &rho_dn[i0], &r[0][i0], &r[1][i0], &r[2][i0]);
+                    }
+                } else {
+                    if (num_spins__ == 1) {
+                        xc.get_gga(n, &rho_up[i0], &sigma_uu[i0], &r[0][i0], &r[1][i0], &r[2][i0]);
+                    } else {
+                        xc.get_gga(n, &rho_up[i0], &rho_dn[i0], &sigma_uu[i0], &sigma_ud[i0], &sigma_dd[i0],
+                                   &r[0][i0], &r[1][i0], &r[2][i0], &r[3][i0], &r[4][i0], &r[5][i0]);
+                    }
+                }
+            }
+        }
+        t += utils::wtime();
+        printf("%-16s num_spins: %i  %-6s : %12.6f Mpoints / sec.\n", name__.c_str(), num_spins__,
+               use_native ? "native" : "libxc", 1e-6 * npt__ * repeat__ / t);
+    }
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--npt=", "{int} number of points");
+    args.register_key("--repeat=", "{int} number of repetitions");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+    int npt    = args.value<int>("npt", 1 << 20);
+    int repeat = args.value<int>("repeat", 10);
+
+    sirius::initialize(true);
+    printf("number of OMP threads: %i\n", omp_get_max_threads());
+    for (auto name : {"XC_LDA_X", "XC_LDA_C_PZ", "XC_LDA_C_PW", "XC_GGA_X_PBE", "XC_GGA_C_PBE"}) {
+        for (int num_spins : {1, 2}) {
+            test_xc_perf(name, num_spins, npt, repeat);
+        }
+    }
+    sirius::finalize();
+}
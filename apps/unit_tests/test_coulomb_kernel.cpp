@@ -0,0 +1,213 @@
+#include <random>
+#include <sirius.hpp>
+
+/* check the derivatives of the truncated Coulomb kernel with finite differences */
+
+using namespace sirius;
+
+/* central finite difference of a scalar function of G along the direction d */
+template <typename F>
+double fd(F&& f__, vector3d<double> G__, vector3d<double> d__, double h__)
+{
+    return (f__(G__ + d__ * h__) - f__(G__ - d__ * h__)) / 2 / h__;
+}
+
+/* compare the analytic gradient of the kernel factor and of the local potential correction with finite
+   differences at the given G-vector */
+double check_gradient(Coulomb_kernel const& kernel__, vector3d<double> G__)
+{
+    double const h{1e-6};
+    auto f  = [&](vector3d<double> G) { return kernel__.factor(G); };
+    auto c  = [&](vector3d<double> G) { return kernel__.vloc_correction(G); };
+    auto df = kernel__.factor_deriv(G__);
+    auto dc = kernel__.vloc_correction_deriv(G__);
+
+    double diff{0};
+    for (int x : {0, 1, 2}) {
+        vector3d<double> d(0, 0, 0);
+        d[x] = 1;
+        diff = std::max(diff, std::abs(fd(f, G__, d, h) - df[x]) / std::max(1.0, std::abs(df[x])));
+        diff = std::max(diff, std::abs(fd(c, G__, d, h) - dc[x]) / std::max(1.0, std::abs(dc[x])));
+    }
+    return diff;
+}
+
+/* lattice vectors (columns) strained by (1 + eps) */
+matrix3d<double> strain(matrix3d<double> lv__, int mu__, int nu__, double eps__)
+{
+    matrix3d<double> e = {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+    e(mu__, nu__) += 0.5 * eps__;
+    e(nu__, mu__) += 0.5 * eps__;
+    return dot(e, lv__);
+}
+
+/* Hartree energy E = 2pi / Omega sum_G f(G) |S(G)|^2 / G^2 of the charge with fixed structure factors S(G) (the
+   charge per cell is invariant under strain); the kernel is not rebuilt, i.e. the cutoff is kept fixed as in
+   the stress */
+double energy(Coulomb_kernel const& kernel__, matrix3d<double> lv__, std::vector<vector3d<int>> const& mill__,
+              std::vector<double> const& s2__)
+{
+    auto rlv = transpose(inverse(lv__)) * twopi;
+    double e{0};
+    for (size_t i = 0; i < mill__.size(); i++) {
+        auto G = dot(rlv, mill__[i]);
+        e += kernel__.factor(G) * s2__[i] / std::pow(G.length(), 2);
+    }
+    return twopi * e / std::abs(lv__.det());
+}
+
+/* compare the Hartree stress, written in the same way as in Stress::calc_stress_har(), with the finite difference
+   derivative of the energy with respect to the strain */
+double check_stress(Coulomb_kernel const& kernel__, matrix3d<double> lv__, std::vector<std::pair<int, int>> comp__)
+{
+    std::vector<vector3d<int>> mill;
+    std::vector<double> s2;
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> u(0, 1);
+    for (int i0 = -4; i0 <= 4; i0++) {
+        for (int i1 = -4; i1 <= 4; i1++) {
+            for (int i2 = -4; i2 <= 4; i2++) {
+                if (i0 || i1 || i2) {
+                    mill.push_back(vector3d<int>(i0, i1, i2));
+                    s2.push_back(u(rng));
+                }
+            }
+        }
+    }
+
+    double omega = std::abs(lv__.det());
+    auto rlv     = transpose(inverse(lv__)) * twopi;
+    matrix3d<double> stress;
+    for (size_t i = 0; i < mill.size(); i++) {
+        auto G    = dot(rlv, mill[i]);
+        double g2 = std::pow(G.length(), 2);
+        /* |rho(G)|^2 = |S(G)|^2 / Omega^2 */
+        double d0 = twopi * s2[i] / omega / omega / g2;
+        double d  = d0 * kernel__.factor(G);
+        auto df   = kernel__.factor_deriv(G);
+        for (int mu : {0, 1, 2}) {
+            for (int nu : {0, 1, 2}) {
+                stress(mu, nu) += d * 2 * G[mu] * G[nu] / g2 - d0 * 0.5 * (df[mu] * G[nu] + df[nu] * G[mu]);
+            }
+        }
+        for (int mu : {0, 1, 2}) {
+            stress(mu, mu) -= d;
+        }
+    }
+
+    double const h{1e-6};
+    double diff{0};
+    double smax{0};
+    for (auto e : comp__) {
+        int mu = e.first;
+        int nu = e.second;
+        double de = (energy(kernel__, strain(lv__, mu, nu, h), mill, s2) -
+                     energy(kernel__, strain(lv__, mu, nu, -h), mill, s2)) / 2 / h;
+        diff = std::max(diff, std::abs(de / omega - stress(mu, nu)));
+        smax = std::max(smax, std::abs(stress(mu, nu)));
+    }
+    return diff / smax;
+}
+
+int test_kernel(std::string cutoff__, matrix3d<double> lv__)
+{
+    Simulation_context ctx;
+    ctx.unit_cell().set_lattice_vectors(lv__);
+    ctx.cfg().parameters().coulomb_cutoff(cutoff__);
+
+    Coulomb_kernel kernel(ctx);
+
+    /* gradient at general G-vectors */
+    double diff{0};
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> u(-2, 2);
+    for (int i = 0; i < 100; i++) {
+        vector3d<double> G(u(rng), u(rng), u(rng));
+        diff = std::max(diff, check_gradient(kernel, G));
+    }
+    if (diff > 1e-6) {
+        printf("wrong gradient of the kernel; diff: %18.12e\n", diff);
+        return 1;
+    }
+
+    /* strain components with the well defined derivative of the energy */
+    std::vector<std::pair<int, int>> comp;
+    if (kernel.type() == coulomb_cutoff_t::cutoff_2d) {
+        auto a = cross(ctx.unit_cell().lattice_vector(0), ctx.unit_cell().lattice_vector(1));
+        auto n = a * (1.0 / a.length());
+
+        /* G_par = 0 limit at the reciprocal lattice vectors along the normal (G_z z_c = pi * m) */
+        for (int m = 1; m <= 4; m++) {
+            auto G = n * (pi * m / kernel.rc());
+            /* the kernel is continuous in G_par */
+            auto t = cross(n, vector3d<double>(1, 0, 0));
+            t      = t * (1e-8 / t.length());
+            if (std::abs(kernel.factor(G + t) - kernel.factor(G)) > 1e-6) {
+                printf("discontinuous kernel at G_par = 0; m: %i\n", m);
+                return 2;
+            }
+            /* derivative along the normal at G_par = 0 */
+            double const h{1e-6};
+            auto f  = [&](vector3d<double> G) { return kernel.factor(G); };
+            auto c  = [&](vector3d<double> G) { return kernel.vloc_correction(G); };
+            double d1 = std::abs(fd(f, G, n, h) - dot(kernel.factor_deriv(G), n));
+            double d2 = std::abs(fd(c, G, n, h) - dot(kernel.vloc_correction_deriv(G), n));
+            if (std::max(d1, d2) > 1e-6) {
+                printf("wrong derivative of the kernel at G_par = 0; m: %i diff: %18.12e %18.12e\n", m, d1, d2);
+                return 3;
+            }
+        }
+        /* a shear along the normal moves G-vectors off the G_par = 0 line, where the kernel has a cusp at a fixed
+           cutoff distance; only the in-plane and the normal components are checked */
+        comp = {{0, 0}, {1, 1}, {0, 1}, {2, 2}};
+    } else {
+        comp = {{0, 0}, {1, 1}, {2, 2}, {0, 1}, {0, 2}, {1, 2}};
+    }
+
+    double ds = check_stress(kernel, lv__, comp);
+    if (ds > 1e-6) {
+        printf("stress doesn't match the derivative of the energy; relative diff: %18.12e\n", ds);
+        return 4;
+    }
+
+    return 0;
+}
+
+int run_test(cmd_args const& args)
+{
+    /* lattice vectors are the columns */
+    matrix3d<double> lv0 = {{10, 0.5, 0.3}, {0, 9, -0.2}, {0, 0, 11}};
+    matrix3d<double> lv2 = {{6, 1.5, 0.4}, {0, 5.5, 0.3}, {0, 0, 16}};
+
+    if (int r = test_kernel("0d", lv0)) {
+        return r;
+    }
+    if (int r = test_kernel("2d", lv2)) {
+        return 10 + r;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
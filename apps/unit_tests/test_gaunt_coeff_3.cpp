@@ -0,0 +1,106 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+
+using namespace sirius;
+
+/* check the packed storage of the Gaunt coefficients against the direct values */
+int test1()
+{
+    int lmax1{6};
+    int lmax3{8};
+    int lmax2{5};
+
+    Gaunt_coefficients<double_complex> gc(lmax1, lmax3, lmax2, SHT::gaunt_hybrid);
+
+    double d{0};
+    int nnz{0};
+    for (int l1 = 0; l1 <= lmax1; l1++) {
+        for (int m1 = -l1; m1 <= l1; m1++) {
+            int lm1 = utils::lm(l1, m1);
+            for (int l2 = 0; l2 <= lmax2; l2++) {
+                for (int m2 = -l2; m2 <= l2; m2++) {
+                    int lm2 = utils::lm(l2, m2);
+                    std::vector<double_complex> ref(utils::lmmax(lmax3), 0);
+                    for (int l3 = 0; l3 <= lmax3; l3++) {
+                        for (int m3 = -l3; m3 <= l3; m3++) {
+                            ref[utils::lm(l3, m3)] = SHT::gaunt_hybrid(l1, l3, l2, m1, m3, m2);
+                        }
+                    }
+                    auto g = gc.gaunt_row(lm1, lm2);
+                    if (g.size != gc.num_gaunt(lm1, lm2)) {
+                        return 1;
+                    }
+                    for (int k = 0; k < g.size; k++) {
+                        d += std::abs(g.coef[k] - ref[g.lm3[k]]);
+                        d += std::abs(gc.gaunt(lm1, lm2, k).coef - ref[gc.gaunt(lm1, lm2, k).lm3]);
+                        ref[g.lm3[k]] = 0;
+                    }
+                    for (auto e : ref) {
+                        d += std::abs(e);
+                    }
+                    nnz += g.size;
+                }
+            }
+        }
+    }
+    /* second grouping contains the same coefficients */
+    auto full = gc.get_full_set_L3();
+    for (int lm3 = 0; lm3 < utils::lmmax(lmax3); lm3++) {
+        for (int i = 0; i < gc.num_gaunt(lm3); i++) {
+            auto g = gc.gaunt(lm3, i);
+            d += std::abs(g.coef - full(lm3, g.lm1, g.lm2));
+            nnz--;
+        }
+    }
+    if (d < 1e-12 && nnz == 0) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+/* check the contraction with a block of vectors against the single-vector sum */
+int test2()
+{
+    int lmax{6};
+    int lmmax = utils::lmmax(2 * lmax);
+    int n{7};
+
+    Gaunt_coefficients<double_complex> gc(lmax, 2 * lmax, lmax, SHT::gaunt_hybrid);
+
+    mdarray<double, 2> v(lmmax, n);
+    for (int i = 0; i < n; i++) {
+        for (int lm = 0; lm < lmmax; lm++) {
+            v(lm, i) = utils::random<double>();
+        }
+    }
+    std::vector<int> idx({6, 0, 3});
+    std::vector<double_complex> res(n);
+
+    double d{0};
+    for (int lm1 = 0; lm1 < utils::lmmax(lmax); lm1++) {
+        for (int lm2 = 0; lm2 < utils::lmmax(lmax); lm2++) {
+            gc.sum_L3_gaunt(lm1, lm2, &v(0, 0), lmmax, n, nullptr, res.data());
+            for (int i = 0; i < n; i++) {
+                d += std::abs(res[i] - gc.sum_L3_gaunt(lm1, lm2, &v(0, i)));
+            }
+            gc.sum_L3_gaunt(lm1, lm2, &v(0, 0), lmmax, 3, idx.data(), res.data());
+            for (int i = 0; i < 3; i++) {
+                d += std::abs(res[i] - gc.sum_L3_gaunt(lm1, lm2, &v(0, idx[i])));
+            }
+        }
+    }
+    if (d < 1e-12) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+int main(int argn, char** argv)
+{
+    int err{0};
+    err += call_test("packed Gaunt coefficients", test1);
+    err += call_test("sum over L3 for a block", test2);
+    return std::min(err, 1);
+}
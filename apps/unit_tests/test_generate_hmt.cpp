@@ -0,0 +1,129 @@
+#include <random>
+#include <sirius.hpp>
+
+/* compare the muffin-tin Hamiltonian of Atom::generate_hmt() with the element-wise sum over L3 */
+
+using namespace sirius;
+
+int run_test(cmd_args const& args)
+{
+    int lmax = args.value<int>("lmax", 6);
+
+    Simulation_context ctx(
+        "{"
+        "   \"parameters\" : {"
+        "        \"electronic_structure_method\" : \"full_potential_lapwlo\""
+        "    },"
+        "   \"control\" : {"
+        "       \"verification\" : 0"
+        "    }"
+        "}");
+    ctx.lmax_apw(lmax);
+    ctx.lmax_pot(lmax);
+    ctx.lmax_rho(lmax);
+
+    auto& atype = ctx.unit_cell().add_atom_type("A");
+    atype.zn(8);
+    atype.set_radial_grid(radial_grid_t::lin_exp, 1000, 1e-6, 2.0, 6);
+    atype.set_free_atom_radial_grid(Radial_grid_lin_exp<double>(2000, 1e-6, 20.0));
+    std::vector<double> atom_rho(atype.free_atom_radial_grid().num_points());
+    for (int i = 0; i < atype.free_atom_radial_grid().num_points(); i++) {
+        atom_rho[i] = 2 * std::sqrt(atype.zn()) * std::exp(-atype.free_atom_radial_grid(i));
+    }
+    atype.free_atom_density(atom_rho);
+    for (int l = 0; l <= lmax; l++) {
+        atype.add_aw_descriptor(-1, l, 0.15, 0, 0);
+        atype.add_aw_descriptor(-1, l, 0.15, 1, 0);
+    }
+    /* local orbitals make the basis larger than the augmented-wave part */
+    for (int l = 0; l <= 2; l++) {
+        atype.add_lo_descriptor(l, -1, l, 0.15, 0, 0);
+        atype.add_lo_descriptor(l, -1, l, 0.15, 1, 0);
+    }
+    ctx.unit_cell().set_lattice_vectors({{5, 0, 0}, {0, 5, 0}, {0, 0, 5}});
+    ctx.unit_cell().add_atom("A", {0, 0, 0});
+    ctx.pw_cutoff(8);
+    ctx.initialize();
+
+    auto& atom = ctx.unit_cell().atom(0);
+    auto& type = atom.type();
+
+    /* random radial integrals; the spherical part is not symmetric in the radial functions, as in
+       Atom::generate_radial_integrals() */
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> u(-1, 1);
+    int nrf   = type.indexr().size();
+    int lmmax = utils::lmmax(ctx.lmax_pot());
+    for (int i2 = 0; i2 < nrf; i2++) {
+        for (int i1 = 0; i1 <= i2; i1++) {
+            for (int lm = 0; lm < lmmax; lm++) {
+                double v = u(rng);
+                atom.h_radial_integrals(i1, i2)[lm] = v;
+                atom.h_radial_integrals(i2, i1)[lm] = (lm == 0 && i1 != i2) ? u(rng) : v;
+            }
+        }
+    }
+
+    double diff{0};
+    /* Hamiltonian0: Hermitian matrix of the full basis */
+    {
+        int nmt = type.mt_basis_size();
+        sddk::mdarray<double_complex, 2> hmt(nmt, nmt);
+        atom.generate_hmt<spin_block_t::nm>(nmt, hmt, true);
+        for (int j2 = 0; j2 < nmt; j2++) {
+            int lm2    = type.indexb(j2).lm;
+            int idxrf2 = type.indexb(j2).idxrf;
+            for (int j1 = 0; j1 <= j2; j1++) {
+                int lm1    = type.indexb(j1).lm;
+                int idxrf1 = type.indexb(j1).idxrf;
+                auto z = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf1, idxrf2,
+                                                                        type.gaunt_coefs().gaunt_row(lm1, lm2));
+                diff = std::max(diff, std::abs(hmt(j1, j2) - z));
+                diff = std::max(diff, std::abs(hmt(j2, j1) - std::conj(z)));
+            }
+        }
+    }
+    if (diff > 1e-12) {
+        printf("wrong Hermitian muffin-tin Hamiltonian; diff: %18.12e\n", diff);
+        return 1;
+    }
+    /* apply_hmt_to_apw: full matrix of the augmented-wave basis */
+    {
+        int naw = type.mt_aw_basis_size();
+        sddk::mdarray<double_complex, 2> hmt(naw, naw);
+        atom.generate_hmt<spin_block_t::nm>(naw, hmt, false);
+        for (int j2 = 0; j2 < naw; j2++) {
+            int lm2    = type.indexb(j2).lm;
+            int idxrf2 = type.indexb(j2).idxrf;
+            for (int j1 = 0; j1 < naw; j1++) {
+                int lm1    = type.indexb(j1).lm;
+                int idxrf1 = type.indexb(j1).idxrf;
+                auto z = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf1, idxrf2,
+                                                                        type.gaunt_coefs().gaunt_row(lm1, lm2));
+                diff = std::max(diff, std::abs(hmt(j1, j2) - z));
+            }
+        }
+    }
+    if (diff > 1e-12) {
+        printf("wrong full muffin-tin Hamiltonian; diff: %18.12e\n", diff);
+        return 2;
+    }
+    return 0;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"lmax=", "{int} maximum orbital quantum number"}});
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -0,0 +1,224 @@
+#include <random>
+#include <sirius.hpp>
+
+/* check that the lossless storage of the mixer history restores the values bit by bit */
+
+using namespace sirius;
+using namespace sirius::mixer;
+
+/* function with two arrays of local data */
+struct func_t
+{
+    std::vector<double> a;
+    std::vector<double> b;
+    func_t(std::size_t na__, std::size_t nb__)
+        : a(na__)
+        , b(nb__)
+    {
+    }
+};
+
+local_data_t local_data(func_t& f__)
+{
+    return {{f__.a.data(), f__.a.size()}, {f__.b.data(), f__.b.size()}};
+}
+
+bool bit_equal(std::vector<double> const& x__, std::vector<double> const& y__)
+{
+    return x__.size() == y__.size() && std::memcmp(x__.data(), y__.data(), x__.size() * sizeof(double)) == 0;
+}
+
+/* fill the arrays with the test data of a given kind */
+void fill(int kind__, std::vector<double>& x__, std::mt19937_64& rng__)
+{
+    std::uniform_real_distribution<double> u(-1, 1);
+    for (std::size_t i = 0; i < x__.size(); i++) {
+        switch (kind__) {
+            case 0: { /* random bit patterns, including NaN and infinity */
+                uint64_t b = rng__();
+                std::memcpy(&x__[i], &b, sizeof(double));
+                break;
+            }
+            case 1: { /* smooth function */
+                x__[i] = std::exp(-1e-4 * i) * std::cos(1e-3 * i);
+                break;
+            }
+            case 2: { /* zeros with a few non-zero values */
+                x__[i] = (i % 1000 == 999) ? u(rng__) : 0.0;
+                break;
+            }
+            case 3: { /* denormals */
+                x__[i] = std::numeric_limits<double>::denorm_min() * static_cast<double>(rng__() % 1000000) *
+                         ((i % 3) ? 1 : -1);
+                break;
+            }
+            case 4: { /* sign flips and signed zeros */
+                double v = (i % 7 == 0) ? 0.0 : u(rng__);
+                x__[i]   = (i % 2) ? -v : v;
+                break;
+            }
+        }
+    }
+}
+
+int test_packed(std::size_t na__, std::size_t nb__)
+{
+    std::mt19937_64 rng(na__ + nb__);
+    for (int kind = 0; kind < 5; kind++) {
+        func_t f(na__, nb__);
+        fill(kind, f.a, rng);
+        fill(kind, f.b, rng);
+        auto a0 = f.a;
+        auto b0 = f.b;
+
+        Packed_function p;
+        p.pack(history_storage_t::lossless, local_data(f));
+        std::fill(f.a.begin(), f.a.end(), 1.0);
+        std::fill(f.b.begin(), f.b.end(), 1.0);
+        p.unpack(local_data(f));
+        if (!bit_equal(f.a, a0) || !bit_equal(f.b, b0)) {
+            printf("wrong lossless roundtrip; kind: %i, sizes: %zu %zu\n", kind, na__, nb__);
+            return 1;
+        }
+        /* zero-padded data must be compressed */
+        if (kind == 2 && na__ + nb__ > 1000 && p.packed_size() > (na__ + nb__) * sizeof(double) / 4) {
+            printf("zeros are not compressed; packed size: %zu\n", p.packed_size());
+            return 2;
+        }
+    }
+    return 0;
+}
+
+/* cycle the functions through the history with more slots than cache entries */
+int test_history(std::size_t na__, std::size_t nb__)
+{
+    int const num_slots{5};
+    History<func_t> history(num_slots);
+    history.storage(history_storage_t::lossless);
+    history.initialize_function<0>(std::function<local_data_t(func_t&)>(local_data), na__, nb__);
+
+    std::mt19937_64 rng(1);
+    std::vector<std::vector<double>> a0(num_slots);
+    std::vector<std::vector<double>> b0(num_slots);
+    for (int i = 0; i < num_slots; i++) {
+        auto& f = *std::get<0>(history[i].get());
+        fill(i, f.a, rng);
+        fill(i, f.b, rng);
+        a0[i] = f.a;
+        b0[i] = f.b;
+    }
+    for (int iter = 0; iter < 3; iter++) {
+        for (int i = num_slots - 1; i >= 0; i--) {
+            auto& f = *std::get<0>(history[i].get());
+            if (!bit_equal(f.a, a0[i]) || !bit_equal(f.b, b0[i])) {
+                printf("wrong history slot %i; sizes: %zu %zu\n", i, na__, nb__);
+                return 3;
+            }
+        }
+    }
+    return 0;
+}
+
+/* exact slots are restored bit by bit, the other slots are rounded to single precision */
+int test_exact()
+{
+    History<func_t> history(4);
+    history.storage(history_storage_t::fp32);
+    history.initialize_function<0>(std::function<local_data_t(func_t&)>(local_data), 1000, 10);
+
+    history.exact({1, 2});
+
+    std::mt19937_64 rng(2);
+    std::vector<std::vector<double>> a0(4);
+    for (int i = 0; i < 4; i++) {
+        auto& f = *std::get<0>(history[i].get());
+        fill(1, f.a, rng);
+        fill(4, f.b, rng);
+        for (auto& x : f.a) {
+            x += 1e-12 * i;
+        }
+        a0[i] = f.a;
+    }
+    /* cycle the slots through the cache */
+    for (int iter = 0; iter < 2; iter++) {
+        for (int i = 0; i < 4; i++) {
+            auto& f = *std::get<0>(history[i].get());
+            bool exact = (i == 1 || i == 2);
+            for (std::size_t j = 0; j < f.a.size(); j++) {
+                double v = exact ? a0[i][j] : static_cast<double>(static_cast<float>(a0[i][j]));
+                if (f.a[j] != v) {
+                    printf("wrong value in history slot %i\n", i);
+                    return 4;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/* an access to a third slot while two slots are in use must fail instead of invalidating one of them */
+int test_pin()
+{
+    History<func_t> history(3);
+    history.storage(history_storage_t::fp32);
+    history.initialize_function<0>(std::function<local_data_t(func_t&)>(local_data), 10, 10);
+
+    auto s0 = history[0];
+    auto s1 = history[1];
+    std::get<0>(s0.get())->a[0] = 1;
+    std::get<0>(s1.get())->a[0] = 2;
+    try {
+        auto s2 = history[2];
+    } catch (std::runtime_error const&) {
+        if (std::get<0>(s0.get())->a[0] != 1 || std::get<0>(s1.get())->a[0] != 2) {
+            printf("history slot in use was modified\n");
+            return 5;
+        }
+        return 0;
+    }
+    printf("history slot in use was evicted\n");
+    return 6;
+}
+
+int run_test(cmd_args const& args)
+{
+    /* sizes around the block size of the lossless encoding (2^14) and the empty array */
+    std::vector<std::pair<std::size_t, std::size_t>> sizes = {
+        {1, 0}, {2, 3}, {16383, 1}, {16384, 16385}, {3 * 16384 + 7, 1001}, {0, 40000}};
+    for (auto s : sizes) {
+        if (int r = test_packed(s.first, s.second)) {
+            return r;
+        }
+        if (int r = test_history(s.first, s.second)) {
+            return r;
+        }
+    }
+    if (int r = test_exact()) {
+        return r;
+    }
+    return test_pin();
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -0,0 +1,56 @@
+#include <sirius.hpp>
+
+using namespace sirius;
+
+/* compare the batched spherical Bessel functions with the single-argument ones */
+int run_test(cmd_args& args)
+{
+    int lmax = args.value<int>("lmax", 12);
+    int n    = args.value<int>("n", 2000);
+    double xmax = args.value<double>("xmax", 60);
+
+    std::vector<double> x(n);
+    for (int i = 0; i < n; i++) {
+        x[i] = xmax * std::pow(double(i) / (n - 1), 2);
+    }
+    /* zeros of j_0 and j_1 where the ratios j_l / j_{l-1} are singular */
+    for (double x0 : {pi, 2 * pi, 3 * pi, 4.493409457909064, 7.725251836937707, 10.904121659428899}) {
+        x.push_back(x0);
+        x.push_back(x0 * (1 + 1e-12));
+    }
+    n = static_cast<int>(x.size());
+
+    mdarray<double, 2> jl(lmax + 1, n);
+    Spherical_Bessel_functions::sbessel(lmax, n, x.data(), &jl(0, 0), lmax + 1);
+
+    std::vector<double> jl_ref(lmax + 1);
+    double diff{0};
+    for (int i = 0; i < n; i++) {
+        Spherical_Bessel_functions::sbessel(lmax, x[i], jl_ref.data());
+        for (int l = 0; l <= lmax; l++) {
+            diff = std::max(diff, std::abs(jl(l, i) - jl_ref[l]));
+        }
+    }
+    printf("max. difference: %12.6e ", diff);
+
+    return (diff < 1e-10) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"lmax=", "{int} maximum orbital quantum number"},
+                               {"n=", "{int} number of arguments"},
+                               {"xmax=", "{double} maximum argument"}});
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
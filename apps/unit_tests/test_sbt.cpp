@@ -0,0 +1,69 @@
+#include <sirius.hpp>
+#include "radial/spherical_bessel_transform.hpp"
+
+using namespace sirius;
+
+/* compare the fast spherical Bessel transform with the direct integration for a set of l=0..3 functions
+   of the ultrasoft pseudopotential type */
+int run_test(cmd_args& args)
+{
+    int lmax    = 3;
+    double rc   = 2.5;
+    double qmax = args.value<double>("qmax", 30);
+    int nq      = args.value<int>("nq", 600);
+
+    Radial_grid_exp<double> rgrid(1500, 1e-6, rc);
+    Radial_grid_lin<double> qgrid(nq, 0, qmax);
+
+    std::vector<Spline<double>> f;
+    for (int l = 0; l <= lmax; l++) {
+        f.push_back(Spline<double>(rgrid, [l, rc](double r) {
+            return std::pow(r, l + 1) * std::pow(rc - r, 3) * std::exp(-r);
+        }));
+    }
+
+    auto t0 = utils::time_now();
+    Spherical_Bessel_transform sbt(lmax, 1e-6, rc, qmax, 4096);
+    std::vector<Spline<double>> g;
+    for (int l = 0; l <= lmax; l++) {
+        g.push_back(sbt.interpolate(sbt.transform(l, f[l], 1)));
+    }
+    double tsbt = utils::time_interval(t0);
+
+    mdarray<double, 2> ref(nq, lmax + 1);
+    t0 = utils::time_now();
+    for (int iq = 0; iq < nq; iq++) {
+        Spherical_Bessel_functions jl(lmax, rgrid, qgrid[iq]);
+        for (int l = 0; l <= lmax; l++) {
+            ref(iq, l) = sirius::inner(jl[l], f[l], 1);
+        }
+    }
+    double tdirect = utils::time_interval(t0);
+
+    double diff{0};
+    for (int l = 0; l <= lmax; l++) {
+        for (int iq = 1; iq < nq; iq++) {
+            diff = std::max(diff, std::abs(ref(iq, l) - sbt.value(g[l], qgrid[iq])));
+        }
+    }
+    printf("max. difference: %12.6e, time (direct / SBT): %.4f / %.4f sec. ", diff, tdirect, tsbt);
+
+    return (diff < 1e-6) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"qmax=", "{double} maximum q"}, {"nq=", "{int} number of q-points"}});
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
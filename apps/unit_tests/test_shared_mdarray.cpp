@@ -0,0 +1,55 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+
+using namespace sirius;
+
+/* fill the array shared between the ranks of a node on one rank and check it on all ranks */
+int run_test(cmd_args const& args)
+{
+    int n = args.value<int>("n", 1000);
+
+    auto comm = Communicator::world().split_shared();
+
+    int err{0};
+    {
+        mdarray<double, 2> a(n, 3, memory_t::none);
+        a.allocate(comm);
+        if (comm.rank() == 0) {
+            for (int j = 0; j < 3; j++) {
+                for (int i = 0; i < n; i++) {
+                    a(i, j) = i + j * n;
+                }
+            }
+        }
+        a.sync_shared(comm);
+        for (int j = 0; j < 3; j++) {
+            for (int i = 0; i < n; i++) {
+                if (a(i, j) != i + j * n) {
+                    err = 1;
+                }
+            }
+        }
+        if (shared_memory_stat::size() != n * 3 * sizeof(double) ||
+            shared_memory_stat::saved() != n * 3 * sizeof(double) * (comm.size() - 1)) {
+            err = 1;
+        }
+        comm.barrier();
+    }
+    if (shared_memory_stat::size() != 0 || shared_memory_stat::saved() != 0) {
+        err = 1;
+    }
+    Communicator::world().allreduce<int, mpi_op_t::max>(&err, 1);
+
+    return err;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"n=", "{int} array size"}});
+
+    sirius::initialize(true);
+    int result = call_test(argv[0], run_test, args);
+    sirius::finalize();
+
+    return result;
+}
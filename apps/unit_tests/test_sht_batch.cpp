@@ -0,0 +1,95 @@
+#include <sirius.hpp>
+#include "testing.hpp"
+
+using namespace sirius;
+
+/* compare batched transformations with the transformations of individual functions and report the timing of
+   both for lmax = 4..12; input functions are stored contiguously, output functions of the forward transformation
+   are either allocated separately or are views into a single buffer, as in the muffin-tin XC code */
+int run_test(cmd_args const& args)
+{
+    int nr  = args.value<int>("nr", 500);
+    int nat = args.value<int>("nat", 16);
+
+    double diff{0};
+    for (int lmax = 4; lmax <= 12; lmax += 2) {
+        SHT sht(device_t::CPU, lmax);
+        int lmmax = sht.lmmax();
+        int ntp   = sht.num_points();
+        /* leading dimension is larger than lmmax, as in the functions of the density */
+        int ld = lmmax + 3;
+
+        mdarray<double, 2> flm(ld, nr * nat);
+        std::vector<double const*> flm_ptr;
+        std::vector<mdarray<double, 2>> glm;
+        std::vector<double*> glm_ptr;
+        for (int iat = 0; iat < nat; iat++) {
+            glm.emplace_back(ld, nr);
+            for (int ir = 0; ir < nr; ir++) {
+                for (int lm = 0; lm < ld; lm++) {
+                    flm(lm, ir + iat * nr) = utils::random<double>();
+                }
+            }
+            glm.back().zero();
+            flm_ptr.push_back(&flm(0, iat * nr));
+            glm_ptr.push_back(glm.back().at(memory_t::host));
+        }
+
+        mdarray<double, 2> ftp(ntp, nr * nat);
+        mdarray<double, 2> ftp_ref(ntp, nr * nat);
+
+        auto t0 = utils::time_now();
+        for (int iat = 0; iat < nat; iat++) {
+            sht.backward_transform(ld, flm_ptr[iat], nr, lmmax, &ftp_ref(0, iat * nr));
+        }
+        double t1 = utils::time_interval(t0);
+
+        t0 = utils::time_now();
+        sht.backward_transform(ld, flm_ptr, nr, lmmax, ftp.at(memory_t::host));
+        double t2 = utils::time_interval(t0);
+
+        for (int i = 0; i < nr * nat; i++) {
+            for (int itp = 0; itp < ntp; itp++) {
+                diff = std::max(diff, std::abs(ftp(itp, i) - ftp_ref(itp, i)));
+            }
+        }
+
+        t0 = utils::time_now();
+        sht.forward_transform(ftp.at(memory_t::host), nr, lmmax, ld, glm_ptr);
+        double t3 = utils::time_interval(t0);
+
+        mdarray<double, 2> hlm(ld, nr * nat);
+        std::vector<double*> hlm_ptr;
+        for (int iat = 0; iat < nat; iat++) {
+            hlm_ptr.push_back(&hlm(0, iat * nr));
+        }
+        t0 = utils::time_now();
+        sht.forward_transform(ftp.at(memory_t::host), nr, lmmax, ld, hlm_ptr);
+        double t4 = utils::time_interval(t0);
+
+        for (int iat = 0; iat < nat; iat++) {
+            for (int ir = 0; ir < nr; ir++) {
+                for (int lm = 0; lm < lmmax; lm++) {
+                    diff = std::max(diff, std::abs(glm[iat](lm, ir) - flm(lm, ir + iat * nr)));
+                    diff = std::max(diff, std::abs(hlm(lm, ir + iat * nr) - flm(lm, ir + iat * nr)));
+                }
+            }
+        }
+        printf("\nlmax: %2i, backward (individual / batch): %.4f / %.4f sec., forward (separate / single buffer): "
+               "%.4f / %.4f sec.", lmax, t1, t2, t3, t4);
+    }
+    printf("\nmax. difference: %12.6e\n", diff);
+
+    return (diff < 1e-10) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"nr=", "{int} number of radial points"}, {"nat=", "{int} number of atoms"}});
+
+    sirius::initialize(true);
+    int result = call_test(argv[0], run_test, args);
+    sirius::finalize();
+
+    return result;
+}
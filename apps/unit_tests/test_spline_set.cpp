@@ -0,0 +1,74 @@
+#include <sirius.hpp>
+#include "radial/spline_set.hpp"
+
+using namespace sirius;
+
+/* compare the set of splines with individual splines: values of coefficients, products and inner products */
+int run_test(cmd_args& args)
+{
+    int num_points  = args.value<int>("num_points", 1500);
+    int num_splines = args.value<int>("num_splines", 20);
+
+    Radial_grid_exp<double> rgrid(num_points, 1e-6, 2.5);
+
+    Spline_set<double> fs(rgrid, num_splines);
+    std::vector<Spline<double>> f(num_splines);
+    for (int s = 0; s < num_splines; s++) {
+        f[s] = Spline<double>(rgrid, [s](double r) { return std::pow(r, s % 4) * std::exp(-r * (1 + 0.1 * s)); });
+        for (int ir = 0; ir < num_points; ir++) {
+            fs(ir, s) = f[s](ir);
+        }
+    }
+    fs.interpolate();
+
+    double diff{0};
+    for (int s = 0; s < num_splines; s++) {
+        for (int ir = 0; ir < num_points; ir++) {
+            for (int k = 0; k < 4; k++) {
+                diff = std::max(diff, std::abs(fs.coeffs()(ir, k, s) - f[s].coeffs()(ir, k)));
+            }
+        }
+    }
+
+    Spline_set<double> gs(rgrid, num_splines);
+    sddk::mdarray<int, 2> idx(2, num_splines * num_splines);
+    for (int i = 0; i < num_splines; i++) {
+        gs.product(i, fs, i, fs, (i + 1) % num_splines);
+        for (int j = 0; j < num_splines; j++) {
+            idx(0, i + j * num_splines) = i;
+            idx(1, i + j * num_splines) = j;
+        }
+    }
+    for (int m = 0; m <= 2; m++) {
+        std::vector<double> result(idx.size(1));
+        fs.inner(gs, idx, m, result.data());
+        for (int i = 0; i < num_splines; i++) {
+            for (int j = 0; j < num_splines; j++) {
+                auto g  = f[j] * f[(j + 1) % num_splines];
+                auto v  = inner(f[i], g, m);
+                diff    = std::max(diff, std::abs(v - result[i + j * num_splines]) / (1 + std::abs(v)));
+            }
+        }
+    }
+    printf("max. difference: %12.6e ", diff);
+
+    return (diff < 1e-10) ? 0 : 1;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args(argn, argv, {{"num_points=", "{int} number of radial grid points"},
+                               {"num_splines=", "{int} number of splines"}});
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -0,0 +1,163 @@
+#include <fenv.h>
+#include <sirius.hpp>
+#include "potential/xc_functional_base.hpp"
+
+using namespace sirius;
+
+/* relative difference between native and Libxc results for the first n points */
+double diff(std::vector<double> const& a, std::vector<double> const& b, int n)
+{
+    double d{0};
+    for (int i = 0; i < n; i++) {
+        d = std::max(d, std::abs(a[i] - b[i]) / std::max(1.0, std::abs(b[i])));
+    }
+    return d;
+}
+
+int test_functional(std::string name__, int num_spins__, int npt__, double tol__)
+{
+    XC_functional_base xc_native(name__, num_spins__, true);
+    XC_functional_base xc_libxc(name__, num_spins__, false);
+
+    if (!xc_native.is_native() || xc_libxc.is_native()) {
+        return 1;
+    }
+
+    /* random points followed by the special points: zero density, density below the threshold and (nearly)
+       fully polarized density */
+    std::vector<std::array<double, 2>> special = {{0, 0}, {1e-20, 1e-20}, {0.5, 0}, {0, 0.5}, {1e-20, 0.3}};
+    int n = npt__ + static_cast<int>(special.size());
+
+    std::vector<double> rho_up(n);
+    std::vector<double> rho_dn(n);
+    std::vector<double> sigma_uu(n);
+    std::vector<double> sigma_ud(n);
+    std::vector<double> sigma_dd(n);
+    for (int i = 0; i < npt__; i++) {
+        /* density spans four orders of magnitude */
+        rho_up[i] = std::pow(10.0, -3 + 4 * utils::random<double>());
+        rho_dn[i] = rho_up[i] * utils::random<double>();
+        /* reduced gradient s in [0, 3] */
+        double s1   = 3 * utils::random<double>();
+        double s2   = 3 * utils::random<double>();
+        sigma_uu[i] = std::pow(s1 * std::pow(rho_up[i], 4.0 / 3), 2);
+        sigma_dd[i] = std::pow(s2 * std::pow(rho_dn[i], 4.0 / 3), 2);
+        sigma_ud[i] = std::sqrt(sigma_uu[i] * sigma_dd[i]) * (2 * utils::random<double>() - 1);
+    }
+    for (int j = 0; j < static_cast<int>(special.size()); j++) {
+        int i       = npt__ + j;
+        rho_up[i]   = special[j][0];
+        rho_dn[i]   = special[j][1];
+        sigma_uu[i] = std::pow(std::pow(rho_up[i], 4.0 / 3), 2);
+        sigma_dd[i] = std::pow(std::pow(rho_dn[i], 4.0 / 3), 2);
+        sigma_ud[i] = 0;
+    }
+
+    int nout = (num_spins__ == 1) ? 3 : 6;
+    std::vector<std::vector<double>> r1(nout, std::vector<double>(n));
+    std::vector<std::vector<double>> r2(nout, std::vector<double>(n));
+
+    auto eval = [&](XC_functional_base& xc, std::vector<std::vector<double>>& r)
+    {
+        if (xc.is_lda()) {
+            if (num_spins__ == 1) {
+                xc.get_lda(n, rho_up.data(), r[0].data(), r[1].data());
+            } else {
+                xc.get_lda(n, rho_up.data(), rho_dn.data(), r[0].data(), r[1].data(), r[2].data());
+            }
+        } else {
+            if (num_spins__ == 1) {
+                xc.get_gga(n, rho_up.data(), sigma_uu.data(), r[0].data(), r[1].data(), r[2].data());
+            } else {
+                xc.get_gga(n, rho_up.data(), rho_dn.data(), sigma_uu.data(), sigma_ud.data(), sigma_dd.data(),
+                           r[0].data(), r[1].data(), r[2].data(), r[3].data(), r[4].data(), r[5].data());
+            }
+        }
+    };
+    /* the native kernels evaluate all points and mask them afterwards; the masked points must not trap */
+#if defined(_GNU_SOURCE)
+    feenableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+    eval(xc_native, r1);
+#if defined(_GNU_SOURCE)
+    fedisableexcept(FE_DIVBYZERO | FE_INVALID | FE_OVERFLOW);
+#endif
+    eval(xc_libxc, r2);
+
+    for (int k = 0; k < nout; k++) {
+        double d = diff(r1[k], r2[k], npt__);
+        if (d > tol__) {
+            printf("\n%s, num_spins: %i, output: %i, difference: %18.12e\n", name__.c_str(), num_spins__, k, d);
+            return 1;
+        }
+        for (int i = 0; i < n; i++) {
+            if (!std::isfinite(r1[k][i])) {
+                printf("\n%s, num_spins: %i, output: %i, point: %i, not a finite value\n", name__.c_str(),
+                       num_spins__, k, i);
+                return 1;
+            }
+        }
+    }
+    /* points below the threshold give no contribution */
+    for (int i = npt__; i < npt__ + 2; i++) {
+        for (int k = 0; k < nout; k++) {
+            if (r1[k][i] != 0) {
+                printf("\n%s, num_spins: %i, output: %i, point: %i, non-zero value below the density threshold\n",
+                       name__.c_str(), num_spins__, k, i);
+                return 1;
+            }
+        }
+    }
+    /* at the fully polarized points the derivative with respect to the empty channel depends on the way the
+       zeta = +/-1 limit is regularized; compare the energy only */
+    int ie = xc_native.is_lda() ? num_spins__ : ((num_spins__ == 1) ? 2 : 5);
+    for (int i = npt__ + 2; i < n; i++) {
+        double d = std::abs(r1[ie][i] - r2[ie][i]) / std::max(1.0, std::abs(r2[ie][i]));
+        if (d > tol__) {
+            printf("\n%s, num_spins: %i, point: %i, energy difference: %18.12e\n", name__.c_str(), num_spins__, i,
+                   d);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int run_test(cmd_args& args)
+{
+    int npt = args.value<int>("npt", 1000);
+    double tol = args.value<double>("tol", 1e-9);
+
+    int result{0};
+    for (auto name : {"XC_LDA_X", "XC_LDA_C_PZ", "XC_LDA_C_PW", "XC_LDA_C_PW_MOD", "XC_GGA_X_PBE", "XC_GGA_C_PBE"}) {
+        for (int num_spins : {1, 2}) {
+            result += test_functional(name, num_spins, npt, tol);
+        }
+    }
+    return result;
+}
+
+int main(int argn, char** argv)
+{
+    cmd_args args;
+    args.register_key("--npt=", "{int} number of points");
+    args.register_key("--tol=", "{double} tolerance");
+
+    args.parse_args(argn, argv);
+    if (args.exist("help")) {
+        printf("Usage: %s [options]\n", argv[0]);
+        args.print_help();
+        return 0;
+    }
+
+    sirius::initialize(true);
+    printf("running %-30s : ", argv[0]);
+    int result = run_test(args);
+    if (result) {
+        printf("\x1b[31m" "Failed" "\x1b[0m" "\n");
+    } else {
+        printf("\x1b[32m" "OK" "\x1b[0m" "\n");
+    }
+    sirius::finalize();
+
+    return result;
+}
@@ -315,6 +315,27 @@ int run_test(cmd_args& args)
             return 1;
         }
     }
+
+    /* batched generation for all points at once */
+    std::vector<double> theta(num_points);
+    std::vector<double> phi(num_points);
+    for (int k = 0; k < num_points; k++) {
+        theta[k] = tp(0, k);
+        phi[k]   = tp(1, k);
+    }
+    int lmmax = utils::lmmax(lmax);
+    mdarray<double_complex, 2> ylm_batch(lmmax, num_points);
+    sf::spherical_harmonics(lmax, num_points, theta.data(), phi.data(), &ylm_batch(0, 0), lmmax);
+    for (int k = 0; k < num_points; k++) {
+        sf::spherical_harmonics(lmax, theta[k], phi[k], &ylm[0]);
+        double diff{0};
+        for (int lm = 0; lm < lmmax; lm++) {
+            diff += std::abs(ylm[lm] - ylm_batch(lm, k));
+        }
+        if (diff > 1e-12) {
+            return 1;
+        }
+    }
     return 0;
 }
 
@@ -677,6 +677,12 @@ class Gvec
         return gvec_shell_len_local_[idx__];
     }
 
+    /// Radii of all local G-vector shells.
+    inline std::vector<double> const& gvec_shell_len_local() const
+    {
+        return gvec_shell_len_local_;
+    }
+
     inline int gvec_shell_idx_local(int igloc__) const
     {
         return gvec_shell_idx_local_[igloc__];
@@ -22,6 +22,7 @@
  *  \brief Definitions.
  *
  */
+#include <limits>
 #include "matrix_storage.hpp"
 #include "utils/profiler.hpp"
 #include "utils/rte.hpp"
@@ -53,14 +54,13 @@ void matrix_storage<T, matrix_storage_t::slab>::set_num_extra(int n__, int idx0_
         ncol = splindex_base<int>::block_size(n__, comm_col.size());
         /* upper limit for the size of swapped extra matrix */
         size_t sz = gvp_->gvec_count_fft() * ncol;
-        /* reallocate buffers if necessary */
+        /* reallocate buffer if necessary; the send-receive buffer is allocated by the remap itself
+           only if it can't use derived datatypes */
         if (extra_buf_.size() < sz) {
             if (mp__) {
-                send_recv_buf_ = mdarray<T, 1>(sz, *mp__, "matrix_storage.send_recv_buf_");
-                extra_buf_     = mdarray<T, 1>(sz, *mp__, "matrix_storage.extra_buf_");
+                extra_buf_ = mdarray<T, 1>(sz, *mp__, "matrix_storage.extra_buf_");
             } else {
-                send_recv_buf_ = mdarray<T, 1>(sz, memory_t::host, "matrix_storage.send_recv_buf_");
-                extra_buf_     = mdarray<T, 1>(sz, memory_t::host, "matrix_storage.extra_buf_");
+                extra_buf_ = mdarray<T, 1>(sz, memory_t::host, "matrix_storage.extra_buf_");
             }
         }
         ptr = extra_buf_.at(memory_t::host);
@@ -165,7 +165,82 @@ void matrix_storage<T, matrix_storage_t::slab>::remap_from(const dmatrix<T>& mtr
 }
 
 template <typename T>
-void matrix_storage<T, matrix_storage_t::slab>::remap_backward(int n__, int idx0__)
+void matrix_storage<T, matrix_storage_t::slab>::init_remap_plan(int n__)
+{
+    auto& comm_col = gvp_->comm_ortho_fft();
+
+    auto& row_distr = gvp_->gvec_fft_slab();
+
+    int nrank = comm_col.size();
+    int rank  = comm_col.rank();
+
+    /* local number of columns */
+    int n_loc = spl_num_col_.local_size();
+
+    auto& p = remap_plan_;
+
+    /* send and receive dimensions of the forward remap */
+    p.prime = block_data_descriptor(nrank);
+    p.extra = block_data_descriptor(nrank);
+    for (int j = 0; j < nrank; j++) {
+        p.prime.counts[j] = spl_num_col_.local_size(j) * row_distr.counts[rank];
+        p.extra.counts[j] = n_loc * row_distr.counts[j];
+    }
+    p.prime.calc_offsets();
+    p.extra.calc_offsets();
+
+    /* byte displacements must fit into int */
+    p.use_datatypes = static_cast<size_t>(p.prime.size()) * sizeof(T) <=
+                          static_cast<size_t>(std::numeric_limits<int>::max()) &&
+                      static_cast<size_t>(gvp_->gvec_count_fft()) * sizeof(T) <=
+                          static_cast<size_t>(std::numeric_limits<int>::max());
+
+    if (p.use_datatypes) {
+        auto base = mpi_type_wrapper<T>::kind();
+        if (!remap_types_) {
+            PROFILE("sddk::matrix_storage::remap_types");
+            remap_types_ = std::unique_ptr<remap_types>(new remap_types(row_distr, gvp_->gvec_count_fft(), base));
+        }
+        p.prime_types = std::vector<MPI_Datatype>(nrank, base);
+        p.extra_types = remap_types_->rows;
+        for (int j = 0; j < nrank; j++) {
+            p.prime.offsets[j] *= sizeof(T);
+            /* blocks of rows of rank j in all local columns of the extra storage */
+            p.extra.counts[j]  = (row_distr.counts[j]) ? n_loc : 0;
+            p.extra.offsets[j] = row_distr.offsets[j] * sizeof(T);
+        }
+        /* the block of this rank is copied by copy_local_block(); the local copy between the resized and the
+           contiguous datatypes is truncated by some MPI libraries (Open MPI 4.1) */
+        p.prime.counts[rank] = 0;
+        p.extra.counts[rank] = 0;
+    }
+}
+
+template <typename T>
+void matrix_storage<T, matrix_storage_t::slab>::copy_local_block(bool forward__, int idx0__)
+{
+    auto& comm_col = gvp_->comm_ortho_fft();
+
+    int offset = gvp_->gvec_fft_slab().offsets[comm_col.rank()];
+    int count  = gvp_->gvec_fft_slab().counts[comm_col.rank()];
+    if (!count) {
+        return;
+    }
+    /* local columns are stored in the prime storage starting from the global offset of this rank */
+    int i0 = idx0__ + spl_num_col_.global_offset();
+
+    #pragma omp parallel for
+    for (int i = 0; i < spl_num_col_.local_size(); i++) {
+        if (forward__) {
+            std::memcpy(&extra_(offset, i), prime_.at(memory_t::host, 0, i0 + i), count * sizeof(T));
+        } else {
+            std::memcpy(prime_.at(memory_t::host, 0, i0 + i), &extra_(offset, i), count * sizeof(T));
+        }
+    }
+}
+
+template <typename T>
+void matrix_storage<T, matrix_storage_t::slab>::remap_backward_begin(int n__, int idx0__)
 {
     PROFILE("sddk::matrix_storage::remap_backward");
 
@@ -174,55 +249,83 @@ void matrix_storage<T, matrix_storage_t::slab>::remap_backward(int n__, int idx0
         return;
     }
 
+    if (remap_in_progress_) {
+        RTE_THROW("remap is already in progress");
+    }
+
+    assert(n__ == spl_num_col_.global_index_size());
+
     auto& comm_col = gvp_->comm_ortho_fft();
 
-    auto& row_distr = gvp_->gvec_fft_slab();
+    init_remap_plan(n__);
+    auto& plan = remap_plan_;
 
-    assert(n__ == spl_num_col_.global_index_size());
+    T* send_buf = (extra_buf_.size() == 0) ? nullptr : extra_buf_.at(memory_t::host);
+    T* recv_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
 
-    /* local number of columns */
-    int n_loc = spl_num_col_.local_size();
+    if (plan.use_datatypes) {
+        comm_col.ialltoall(send_buf, plan.extra.counts.data(), plan.extra.offsets.data(), plan.extra_types.data(),
+                           recv_buf, plan.prime.counts.data(), plan.prime.offsets.data(), plan.prime_types.data(),
+                           &remap_req_);
+        copy_local_block(false, idx0__);
+    } else {
+        auto& row_distr = gvp_->gvec_fft_slab();
 
-    /* reorder sending blocks */
-    #pragma omp parallel for
-    for (int i = 0; i < n_loc; i++) {
-        for (int j = 0; j < comm_col.size(); j++) {
-            int offset = row_distr.offsets[j];
-            int count  = row_distr.counts[j];
-            if (count) {
-                std::memcpy(&send_recv_buf_[offset * n_loc + count * i], &extra_(offset, i), count * sizeof(T));
+        /* local number of columns */
+        int n_loc = spl_num_col_.local_size();
+
+        if (send_recv_buf_.size() < static_cast<size_t>(plan.extra.size())) {
+            send_recv_buf_ = mdarray<T, 1>(plan.extra.size(), memory_t::host, "matrix_storage.send_recv_buf_");
+        }
+
+        /* reorder sending blocks */
+        #pragma omp parallel for
+        for (int i = 0; i < n_loc; i++) {
+            for (int j = 0; j < comm_col.size(); j++) {
+                int offset = row_distr.offsets[j];
+                int count  = row_distr.counts[j];
+                if (count) {
+                    std::memcpy(&send_recv_buf_[offset * n_loc + count * i], &extra_(offset, i), count * sizeof(T));
+                }
             }
         }
+        comm_col.ialltoall(send_recv_buf_.at(memory_t::host), plan.extra.counts.data(), plan.extra.offsets.data(),
+                           recv_buf, plan.prime.counts.data(), plan.prime.offsets.data(), &remap_req_);
     }
+    remap_in_progress_ = true;
+    remap_n_           = n__;
+    remap_idx0_        = idx0__;
+}
 
-    /* send and receive dimensions */
-    block_data_descriptor sd(comm_col.size()), rd(comm_col.size());
-    for (int j = 0; j < comm_col.size(); j++) {
-        sd.counts[j] = spl_num_col_.local_size(comm_col.rank()) * row_distr.counts[j];
-        rd.counts[j] = spl_num_col_.local_size(j) * row_distr.counts[comm_col.rank()];
+template <typename T>
+void matrix_storage<T, matrix_storage_t::slab>::remap_backward_end()
+{
+    /* nothing to wait for in the trivial case */
+    if (!remap_in_progress_) {
+        return;
     }
-    sd.calc_offsets();
-    rd.calc_offsets();
-
-    T* recv_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
 
     {
         PROFILE("sddk::matrix_storage::remap_backward|mpi");
-        comm_col.alltoall(send_recv_buf_.at(memory_t::host), sd.counts.data(), sd.offsets.data(), recv_buf,
-                          rd.counts.data(), rd.offsets.data());
+        CALL_MPI(MPI_Wait, (&remap_req_, MPI_STATUS_IGNORE));
     }
+    remap_in_progress_ = false;
 
     /* move data back to device */
     if (prime_.on_device()) {
-        prime_.copy_to(memory_t::device, idx0__ * num_rows_loc(), n__ * num_rows_loc());
+        prime_.copy_to(memory_t::device, remap_idx0_ * num_rows_loc(), remap_n_ * num_rows_loc());
     }
 }
 
 template <typename T>
-void matrix_storage<T, matrix_storage_t::slab>::remap_forward(int n__, int idx0__, memory_pool* mp__)
+void matrix_storage<T, matrix_storage_t::slab>::remap_forward_begin(int n__, int idx0__, memory_pool* mp__)
 {
     PROFILE("sddk::matrix_storage::remap_forward");
 
+    if (remap_in_progress_) {
+        RTE_THROW("remap is already in progress");
+    }
+
     set_num_extra(n__, idx0__, mp__);
 
     /* trivial case when extra storage mirrors the prime storage */
@@ -230,29 +333,57 @@ void matrix_storage<T, matrix_storage_t::slab>::remap_forward(int n__, int idx0_
         return;
     }
 
-    auto& row_distr = gvp_->gvec_fft_slab();
-
     auto& comm_col = gvp_->comm_ortho_fft();
 
-    /* local number of columns */
-    int n_loc = spl_num_col_.local_size();
+    init_remap_plan(n__);
+    auto& plan = remap_plan_;
 
-    /* send and receive dimensions */
-    block_data_descriptor sd(comm_col.size()), rd(comm_col.size());
-    for (int j = 0; j < comm_col.size(); j++) {
-        sd.counts[j] = spl_num_col_.local_size(j) * row_distr.counts[comm_col.rank()];
-        rd.counts[j] = spl_num_col_.local_size(comm_col.rank()) * row_distr.counts[j];
+    T* send_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
+
+    if (plan.use_datatypes) {
+        T* recv_buf = (extra_buf_.size() == 0) ? nullptr : extra_buf_.at(memory_t::host);
+        comm_col.ialltoall(send_buf, plan.prime.counts.data(), plan.prime.offsets.data(), plan.prime_types.data(),
+                           recv_buf, plan.extra.counts.data(), plan.extra.offsets.data(), plan.extra_types.data(),
+                           &remap_req_);
+        copy_local_block(true, idx0__);
+    } else {
+        if (send_recv_buf_.size() < static_cast<size_t>(plan.extra.size())) {
+            send_recv_buf_ = mdarray<T, 1>(plan.extra.size(), memory_t::host, "matrix_storage.send_recv_buf_");
+        }
+        comm_col.ialltoall(send_buf, plan.prime.counts.data(), plan.prime.offsets.data(),
+                           send_recv_buf_.at(memory_t::host), plan.extra.counts.data(), plan.extra.offsets.data(),
+                           &remap_req_);
     }
-    sd.calc_offsets();
-    rd.calc_offsets();
+    remap_in_progress_ = true;
+    remap_n_           = n__;
+    remap_idx0_        = idx0__;
+}
 
-    T* send_buf = (num_rows_loc_ == 0) ? nullptr : prime_.at(memory_t::host, 0, idx0__);
+template <typename T>
+void matrix_storage<T, matrix_storage_t::slab>::remap_forward_end()
+{
+    /* nothing to wait for in the trivial case */
+    if (!remap_in_progress_) {
+        return;
+    }
 
     {
         PROFILE("sddk::matrix_storage::remap_forward|mpi");
-        comm_col.alltoall(send_buf, sd.counts.data(), sd.offsets.data(), send_recv_buf_.at(memory_t::host),
-                          rd.counts.data(), rd.offsets.data());
+        CALL_MPI(MPI_Wait, (&remap_req_, MPI_STATUS_IGNORE));
     }
+    auto& plan         = remap_plan_;
+    remap_in_progress_ = false;
+
+    if (plan.use_datatypes) {
+        return;
+    }
+
+    auto& comm_col = gvp_->comm_ortho_fft();
+
+    auto& row_distr = gvp_->gvec_fft_slab();
+
+    /* local number of columns */
+    int n_loc = spl_num_col_.local_size();
 
     /* reorder received blocks */
     #pragma omp parallel for
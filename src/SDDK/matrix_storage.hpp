@@ -25,6 +25,7 @@
 #ifndef __MATRIX_STORAGE_HPP__
 #define __MATRIX_STORAGE_HPP__
 
+#include <memory>
 #include "gvec.hpp"
 #include "dmatrix.hpp"
 
@@ -52,6 +53,74 @@ enum class matrix_storage_t
 template <typename T, matrix_storage_t kind>
 class matrix_storage;
 
+/// Derived datatypes of the extra storage blocks.
+/** The datatype of rank j is the block of rows of rank j in one column of the extra storage, resized to the extent of
+ *  the full column. n consecutive elements of this type are therefore the blocks of n local columns, and the same
+ *  datatypes serve any number of remapped columns. They depend only on the slab distribution of G-vectors and are
+ *  created once per matrix storage. */
+struct remap_types
+{
+    /// Datatypes of the row blocks.
+    std::vector<MPI_Datatype> rows;
+
+    remap_types(block_data_descriptor const& row_distr__, int ld__, MPI_Datatype base__)
+        : rows(row_distr__.counts.size(), MPI_DATATYPE_NULL)
+    {
+        MPI_Aint lb{0};
+        MPI_Aint extent{0};
+        CALL_MPI(MPI_Type_get_extent, (base__, &lb, &extent));
+        for (size_t j = 0; j < rows.size(); j++) {
+            MPI_Datatype t;
+            CALL_MPI(MPI_Type_contiguous, (row_distr__.counts[j], base__, &t));
+            CALL_MPI(MPI_Type_create_resized, (t, 0, extent * ld__, &rows[j]));
+            CALL_MPI(MPI_Type_commit, (&rows[j]));
+            CALL_MPI(MPI_Type_free, (&t));
+        }
+    }
+
+    remap_types(remap_types const& src__) = delete;
+
+    remap_types& operator=(remap_types const& src__) = delete;
+
+    ~remap_types()
+    {
+        int finalized{0};
+        MPI_Finalized(&finalized);
+        if (finalized) {
+            return;
+        }
+        for (auto& t : rows) {
+            if (t != MPI_DATATYPE_NULL) {
+                MPI_Type_free(&t);
+            }
+        }
+    }
+};
+
+/// Description of the data exchange between the prime and the extra storage.
+/** The plan depends only on the number of remapped columns: the starting column shifts the base pointer of the
+ *  prime storage and doesn't change counts and displacements. Setting it up costs O(number of ranks) and no MPI
+ *  calls. Blocks of the extra storage are described by the remap_types, so the data is received (or sent) in place
+ *  and no reordering copy is needed; the block of this rank is copied directly. If the byte displacements don't fit
+ *  into int, the plan falls back to the alltoallv with the reordering copy. */
+struct remap_plan
+{
+    /// True if the exchange is done with the derived datatypes.
+    bool use_datatypes{false};
+
+    /// Counts and displacements of the prime storage blocks (in elements for the fallback, in bytes otherwise).
+    block_data_descriptor prime;
+
+    /// Counts and displacements of the extra storage blocks (in elements for the fallback, in bytes otherwise).
+    block_data_descriptor extra;
+
+    /// Datatypes of the prime storage blocks.
+    std::vector<MPI_Datatype> prime_types;
+
+    /// Datatypes of the extra storage blocks.
+    std::vector<MPI_Datatype> extra_types;
+};
+
 /// Specialization of matrix storage class for slab data distribution.
 /** \tparam T data type */
 template <typename T>
@@ -84,6 +153,28 @@ class matrix_storage<T, matrix_storage_t::slab>
     /// Column distribution in auxiliary matrix.
     splindex<splindex_t::block> spl_num_col_;
 
+    /// Datatypes of the extra storage blocks; created at the first remap with the derived datatypes.
+    std::unique_ptr<remap_types> remap_types_;
+
+    /// Plan of the last remap.
+    remap_plan remap_plan_;
+
+    /// True if the remap is in progress.
+    bool remap_in_progress_{false};
+
+    /// Request of the remap in progress.
+    MPI_Request remap_req_;
+
+    /// Number of columns and starting column of the remap in progress.
+    int remap_n_{0};
+    int remap_idx0_{0};
+
+    /// Set up the plan of the remap of n columns.
+    void init_remap_plan(int n__);
+
+    /// Copy the block of this rank between the prime and the extra storage.
+    void copy_local_block(bool forward__, int idx0__);
+
   public:
     /// Constructor.
     matrix_storage(Gvec_partition const& gvp__, int num_cols__)
@@ -153,7 +244,19 @@ class matrix_storage<T, matrix_storage_t::slab>
      *  \param [in] idx0      Starting column of the matrix.
      *
      *  Prime storage is expected on the CPU (for the MPI a2a communication). */
-    void remap_forward(int n__, int idx0__, memory_pool* mp__);
+    void remap_forward(int n__, int idx0__, memory_pool* mp__)
+    {
+        remap_forward_begin(n__, idx0__, mp__);
+        remap_forward_end();
+    }
+
+    /// Start the non-blocking remap from prime to extra storage.
+    /** Prime storage must not be modified and extra storage must not be accessed until remap_forward_end()
+     *  is called. */
+    void remap_forward_begin(int n__, int idx0__, memory_pool* mp__);
+
+    /// Wait for the completion of the remap from prime to extra storage.
+    void remap_forward_end();
 
     /// Remap data from extra to prime storage.
     /** \param [in] n         Number of matrix columns to collect.
@@ -161,7 +264,17 @@ class matrix_storage<T, matrix_storage_t::slab>
      *
      *  Extra storage is expected on the CPU (for the MPI a2a communication). If the prime storage is allocated on GPU
      *  remapped data will be copied to GPU. */
-    void remap_backward(int n__, int idx0__);
+    void remap_backward(int n__, int idx0__)
+    {
+        remap_backward_begin(n__, idx0__);
+        remap_backward_end();
+    }
+
+    /// Start the non-blocking remap from extra to prime storage.
+    void remap_backward_begin(int n__, int idx0__);
+
+    /// Wait for the completion of the remap from extra to prime storage.
+    void remap_backward_end();
 
     void remap_from(dmatrix<T> const& mtrx__, int irow0__);
 
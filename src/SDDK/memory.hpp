@@ -39,6 +39,9 @@
 
 namespace sddk {
 
+/* forward declaration */
+class Communicator;
+
 /// Check is the type is a complex number; by default it is not.
 template <typename T>
 struct is_complex
@@ -258,6 +261,10 @@ class memory_t_deleter_base
     {
       public:
         virtual void free(void* ptr__) = 0;
+        /// Make the updates of the memory visible to the other ranks; only the shared memory needs it.
+        virtual void sync(Communicator const&)
+        {
+        }
         virtual ~memory_t_deleter_base_impl()
         {
         }
@@ -269,6 +276,10 @@ class memory_t_deleter_base
     {
         impl_->free(ptr__);
     }
+    void sync(Communicator const& comm__)
+    {
+        impl_->sync(comm__);
+    }
 };
 
 /// Deleter for the allocated memory pointer of a given type.
@@ -1278,6 +1289,17 @@ class mdarray
         return *this;
     }
 
+    /// Allocate host memory shared between the ranks of a node.
+    /** The communicator must be created with Communicator::split_shared(). All ranks of the communicator get the
+     *  same storage; it is expected to be filled by one rank and read by all ranks after sync_shared().
+     *  Only the arrays of primitive types can be shared. Defined in memory_shared.hpp. */
+    inline mdarray<T, N>& allocate(Communicator const& comm__);
+
+    /// Synchronize the shared memory after it was modified.
+    /** This is a collective operation over the communicator used in allocate(Communicator const&). Defined in
+     *  memory_shared.hpp. */
+    inline void sync_shared(Communicator const& comm__);
+
     /// Deallocate host or device memory.
     inline void deallocate(memory_t memory__)
     {
@@ -0,0 +1,138 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file memory_shared.hpp
+ *
+ *  \brief Host memory shared between the ranks of a node.
+ */
+
+#ifndef __MEMORY_SHARED_HPP__
+#define __MEMORY_SHARED_HPP__
+
+#include "memory.hpp"
+#include "mpi/communicator.hpp"
+
+namespace sddk {
+
+/// Statistics of the host memory shared between the ranks of a node.
+struct shared_memory_stat
+{
+    /// Total size of the shared arrays in bytes; each array is counted once per node.
+    static size_t& size()
+    {
+        static size_t size_{0};
+        return size_;
+    }
+    /// Size of the memory in bytes which would be additionally allocated by the ranks of the node if the arrays
+    /// were not shared.
+    static size_t& saved()
+    {
+        static size_t saved_{0};
+        return saved_;
+    }
+};
+
+/// Deleter for the memory of the MPI shared window.
+class memory_shared_deleter: public memory_t_deleter_base
+{
+  protected:
+    class memory_shared_deleter_impl: public memory_t_deleter_base_impl
+    {
+      protected:
+        MPI_Win win_;
+        size_t size_{0};
+        int num_ranks_{0};
+      public:
+        memory_shared_deleter_impl(MPI_Win win__, size_t size__, int num_ranks__)
+            : win_(win__)
+            , size_(size__)
+            , num_ranks_(num_ranks__)
+        {
+        }
+        inline void free(void*)
+        {
+            shared_memory_stat::size() -= size_;
+            shared_memory_stat::saved() -= size_ * (num_ranks_ - 1);
+            if (!Communicator::is_finalized()) {
+                MPI_Win_unlock_all(win_);
+                MPI_Win_free(&win_);
+            }
+        }
+        /* the writer flushes its updates to the window, the readers refresh their view after the barrier */
+        inline void sync(Communicator const& comm__)
+        {
+            CALL_MPI(MPI_Win_sync, (win_));
+            comm__.barrier();
+            CALL_MPI(MPI_Win_sync, (win_));
+        }
+    };
+  public:
+    memory_shared_deleter(MPI_Win win__, size_t size__, int num_ranks__)
+    {
+        impl_ = std::unique_ptr<memory_t_deleter_base_impl>(new memory_shared_deleter_impl(win__, size__, num_ranks__));
+    }
+};
+
+/// Allocate n elements in the host memory shared between the ranks of the communicator.
+/** The communicator must be created with Communicator::split_shared(). The memory is owned by the rank 0 of the
+ *  communicator and all ranks get the pointer to the same memory. This is a collective operation. The window
+ *  stays in the passive target epoch (MPI_Win_lock_all) until it is freed, so that MPI_Win_sync can be used to
+ *  synchronize the direct loads and stores. */
+template <typename T>
+inline std::unique_ptr<T, memory_t_deleter_base> get_unique_ptr(size_t n__, Communicator const& comm__)
+{
+    MPI_Aint size = (comm__.rank() == 0) ? n__ * sizeof(T) : 0;
+    T* ptr{nullptr};
+    MPI_Win win;
+    CALL_MPI(MPI_Win_allocate_shared, (size, sizeof(T), MPI_INFO_NULL, comm__.mpi_comm(), &ptr, &win));
+    int disp_unit;
+    CALL_MPI(MPI_Win_shared_query, (win, 0, &size, &disp_unit, &ptr));
+    CALL_MPI(MPI_Win_lock_all, (MPI_MODE_NOCHECK, win));
+
+    shared_memory_stat::size() += n__ * sizeof(T);
+    shared_memory_stat::saved() += n__ * sizeof(T) * (comm__.size() - 1);
+
+    return std::unique_ptr<T, memory_t_deleter_base>(ptr, memory_shared_deleter(win, n__ * sizeof(T), comm__.size()));
+}
+
+template <typename T, int N>
+inline mdarray<T, N>& mdarray<T, N>::allocate(Communicator const& comm__)
+{
+    static_assert(std::is_trivial<T>::value || is_complex<T>::value, "wrong type of shared array");
+
+    /* do nothing for zero-sized array */
+    if (!this->size()) {
+        return *this;
+    }
+    unique_ptr_ = get_unique_ptr<T>(this->size(), comm__);
+    raw_ptr_    = unique_ptr_.get();
+    return *this;
+}
+
+template <typename T, int N>
+inline void mdarray<T, N>::sync_shared(Communicator const& comm__)
+{
+    if (unique_ptr_) {
+        unique_ptr_.get_deleter().sync(comm__);
+    }
+}
+
+} // namespace sddk
+
+#endif // __MEMORY_SHARED_HPP__
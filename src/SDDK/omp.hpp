@@ -55,6 +55,11 @@ inline double omp_get_wtime()
     return 0;
 }
 
+inline int omp_in_parallel()
+{
+    return 0;
+}
+
 #endif
 
 #endif
@@ -482,6 +482,8 @@ sirius_print_timers(bool* flatten__, int* error_code__)
             std::cout << timing_result.print({rt_graph::Stat::Count, rt_graph::Stat::Total, rt_graph::Stat::Percentage,
                                               rt_graph::Stat::SelfPercentage, rt_graph::Stat::Median,
                                               rt_graph::Stat::Min, rt_graph::Stat::Max});
+            std::cout << sddk::mpi_stat::print();
+            std::cout << utils::profiler_counters::print();
         },
         error_code__);
 }
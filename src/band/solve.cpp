@@ -142,6 +142,8 @@ Band::solve(K_point_set& kset__, Hamiltonian0<T>& H0__, double itsol_tol__) cons
     }
 
     int num_dav_iter{0};
+    auto& num_itsol_steps = kset__.num_itsol_steps();
+    num_itsol_steps = std::vector<int>(kset__.num_kpoints(), 0);
     /* solve secular equation and generate wave functions */
     for (int ikloc = 0; ikloc < kset__.spl_num_kpoints().local_size(); ikloc++) {
         int ik  = kset__.spl_num_kpoints(ikloc);
@@ -152,13 +154,19 @@ Band::solve(K_point_set& kset__, Hamiltonian0<T>& H0__, double itsol_tol__) cons
             solve_full_potential<T>(Hk, itsol_tol__);
         } else {
             if (ctx_.gamma_point() && (ctx_.so_correction() == false)) {
-                num_dav_iter += solve_pseudo_potential<T, F>(Hk, itsol_tol__, empy_tol);
+                num_itsol_steps[ik] = solve_pseudo_potential<T, F>(Hk, itsol_tol__, empy_tol);
             } else {
-                num_dav_iter += solve_pseudo_potential<std::complex<T>, std::complex<F>>(Hk, itsol_tol__, empy_tol);
+                num_itsol_steps[ik] = solve_pseudo_potential<std::complex<T>, std::complex<F>>(Hk, itsol_tol__,
+                                                                                                empy_tol);
             }
+            num_dav_iter += num_itsol_steps[ik];
         }
     }
     kset__.comm().allreduce(&num_dav_iter, 1);
+    /* per k-point numbers are only needed by the SCF performance log */
+    if (!ctx_.cfg().control().scf_log().empty()) {
+        kset__.comm().allreduce(num_itsol_steps.data(), kset__.num_kpoints());
+    }
     ctx_.num_itsol_steps(num_dav_iter);
     if (!ctx_.full_potential()) {
         ctx_.message(2, __function_name__, "average number of iterations: %12.6f\n",
@@ -53,6 +53,9 @@ const double ha2ev = 27.21138505;
 
 const char* const storage_file_name = "sirius.h5";
 
+/// Name of the wave-function checkpoint file.
+const char* const wf_storage_file_name = "sirius_wf.h5";
+
 /// Pauli matrices in {I, Z, X, Y} order.
 const std::complex<double> pauli_matrix[4][2][2] = {
     {{1.0, 0.0}, {0.0, 1.0}},
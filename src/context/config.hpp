@@ -103,6 +103,60 @@ class config_t
             }
             dict_["/mixer/use_hartree"_json_pointer] = use_hartree__;
         }
+        /// Preconditioner of the charge density residual
+        /**
+            kerker: q^2/(q^2+q0^2) filter with q0 = kerker_q0; thomas_fermi: the same filter with q0 set to the Thomas-Fermi screening wave vector of the average valence density. Only used in the pseudopotential case.
+        */
+        inline auto preconditioner() const
+        {
+            return dict_.at("/mixer/preconditioner"_json_pointer).get<std::string>();
+        }
+        inline void preconditioner(std::string preconditioner__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/preconditioner"_json_pointer] = preconditioner__;
+        }
+        /// Screening wave vector (in a.u.^-1) of the Kerker preconditioner
+        inline auto kerker_q0() const
+        {
+            return dict_.at("/mixer/kerker_q0"_json_pointer).get<double>();
+        }
+        inline void kerker_q0(double kerker_q0__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/kerker_q0"_json_pointer] = kerker_q0__;
+        }
+        /// Lower bound of the preconditioner weight of the density residual
+        inline auto kerker_min_weight() const
+        {
+            return dict_.at("/mixer/kerker_min_weight"_json_pointer).get<double>();
+        }
+        inline void kerker_min_weight(double kerker_min_weight__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/kerker_min_weight"_json_pointer] = kerker_min_weight__;
+        }
+        /// Storage format of the mixer history
+        /**
+            fp32: history of the densities, density matrix and PAW densities is rounded to single precision; lossless: history is compressed without loss of precision. Mixing coefficients are always computed in double precision.
+        */
+        inline auto history_storage() const
+        {
+            return dict_.at("/mixer/history_storage"_json_pointer).get<std::string>();
+        }
+        inline void history_storage(std::string history_storage__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/mixer/history_storage"_json_pointer] = history_storage__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -167,6 +221,51 @@ class config_t
             }
             dict_["/settings/nprii_rho_core"_json_pointer] = nprii_rho_core__;
         }
+        /// Generate radial integrals of pseudopotentials with the fast spherical Bessel transform
+        /**
+            Radial integrals of beta-projectors, augmentation charges, local potential and pseudo-density are computed for all q-points at once on the logarithmic grid. Derivatives of the radial integrals are always computed by direct integration.
+        */
+        inline auto sbt_radial_integrals() const
+        {
+            return dict_.at("/settings/sbt_radial_integrals"_json_pointer).get<bool>();
+        }
+        inline void sbt_radial_integrals(bool sbt_radial_integrals__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/sbt_radial_integrals"_json_pointer] = sbt_radial_integrals__;
+        }
+        /// Directory of the binary cache of the parsed pseudopotentials and their radial integrals
+        /**
+            Cached data is keyed by a hash of the pseudopotential input and the parameters of the q-grid. Empty string disables the cache.
+        */
+        inline auto cache_dir() const
+        {
+            return dict_.at("/settings/cache_dir"_json_pointer).get<std::string>();
+        }
+        inline void cache_dir(std::string cache_dir__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/cache_dir"_json_pointer] = cache_dir__;
+        }
+        /// Store read-only data, which is identical on all MPI ranks, in the shared memory of a node
+        /**
+            Tables of the radial integrals of the augmentation charges are allocated once per node in the MPI-3 shared window.
+        */
+        inline auto shared_memory() const
+        {
+            return dict_.at("/settings/shared_memory"_json_pointer).get<bool>();
+        }
+        inline void shared_memory(bool shared_memory__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/shared_memory"_json_pointer] = shared_memory__;
+        }
         /// Update wave-functions in the Davdison solver even if they immediately satisfy the convergence criterion
         inline auto always_update_wf() const
         {
@@ -287,6 +386,21 @@ class config_t
             }
             dict_["/settings/fft_grid_size"_json_pointer] = fft_grid_size__;
         }
+        /// Use built-in implementation of LDA and PBE functionals instead of Libxc.
+        /**
+            Applies to XC_LDA_X, XC_LDA_C_PZ, XC_LDA_C_PW, XC_LDA_C_PW_MOD, XC_GGA_X_PBE and XC_GGA_C_PBE. Other functionals are always evaluated by Libxc.
+        */
+        inline auto xc_use_native() const
+        {
+            return dict_.at("/settings/xc_use_native"_json_pointer).get<bool>();
+        }
+        inline void xc_use_native(bool xc_use_native__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/settings/xc_use_native"_json_pointer] = xc_use_native__;
+        }
         /// Default radial grid for LAPW species.
         inline auto radial_grid() const
         {
@@ -787,6 +901,51 @@ class config_t
             }
             dict_["/control/verification"_json_pointer] = verification__;
         }
+        /// Save wave-functions every N SCF iterations.
+        /**
+            If positive, wave-functions and band energies are written to the checkpoint file every N iterations and at the end of the SCF loop.
+        */
+        inline auto wf_checkpoint_every() const
+        {
+            return dict_.at("/control/wf_checkpoint_every"_json_pointer).get<int>();
+        }
+        inline void wf_checkpoint_every(int wf_checkpoint_every__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/wf_checkpoint_every"_json_pointer] = wf_checkpoint_every__;
+        }
+        /// Write the wave-function checkpoint from a background thread.
+        /**
+            Wave-functions are copied to a host buffer and written while the SCF loop continues.
+        */
+        inline auto wf_checkpoint_async() const
+        {
+            return dict_.at("/control/wf_checkpoint_async"_json_pointer).get<bool>();
+        }
+        inline void wf_checkpoint_async(bool wf_checkpoint_async__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/wf_checkpoint_async"_json_pointer] = wf_checkpoint_async__;
+        }
+        /// Name of the JSON Lines file with the performance log of the SCF iterations.
+        /**
+            If not empty, one JSON record per SCF iteration is appended to the file and flushed immediately. The record contains timings of the iteration phases, number of iterative solver steps for each k-point, number of local operator applications, memory usage, RMS and energy change.
+        */
+        inline auto scf_log() const
+        {
+            return dict_.at("/control/scf_log"_json_pointer).get<std::string>();
+        }
+        inline void scf_log(std::string scf_log__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/scf_log"_json_pointer] = scf_log__;
+        }
         /// Number of eigen-values that are printed to the standard output.
         inline auto num_bands_to_print() const
         {
@@ -943,6 +1102,24 @@ class config_t
             }
             dict_["/control/ortho_rf"_json_pointer] = ortho_rf__;
         }
+        /// Number of wave-functions transformed to real space at once during the density generation.
+        /**
+            In case of serial coarse-grid FFT the bands are distributed between OpenMP threads and each thread
+            accumulates its own contribution to the density; the default value 0 means one band per thread.
+            In case of parallel FFT the transformations are pipelined in batches of this size; the default value 0
+            means no batching.
+        */
+        inline auto fft_batch_size() const
+        {
+            return dict_.at("/control/fft_batch_size"_json_pointer).get<int>();
+        }
+        inline void fft_batch_size(int fft_batch_size__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/control/fft_batch_size"_json_pointer] = fft_batch_size__;
+        }
       private:
         nlohmann::json& dict_;
     };
@@ -1245,6 +1422,21 @@ class config_t
             }
             dict_["/parameters/molecule"_json_pointer] = molecule__;
         }
+        /// Truncation of the Coulomb interaction for isolated systems.
+        /**
+            0d: molecule (spherical cutoff); 2d: slab, non-periodic along the third lattice vector. Molecule calculation implies 0d.
+        */
+        inline auto coulomb_cutoff() const
+        {
+            return dict_.at("/parameters/coulomb_cutoff"_json_pointer).get<std::string>();
+        }
+        inline void coulomb_cutoff(std::string coulomb_cutoff__)
+        {
+            if (dict_.contains("locked")) {
+                throw std::runtime_error(locked_msg);
+            }
+            dict_["/parameters/coulomb_cutoff"_json_pointer] = coulomb_cutoff__;
+        }
         /// True if gamma-point (real) version of the PW code is used.
         inline auto gamma_point() const
         {
@@ -29,6 +29,7 @@
 #include "utils/profiler.hpp"
 #include "utils/env.hpp"
 #include "SDDK/omp.hpp"
+#include "SDDK/memory_shared.hpp"
 #include "potential/xc_functional.hpp"
 #include "linalg/linalg_spla.hpp"
 #include "symmetry/crystal_symmetry.hpp"
@@ -156,13 +157,22 @@ Simulation_context::generate_sbessel_mt(int lmax__) const
 {
     PROFILE("sirius::Simulation_context::generate_sbessel_mt");
 
-    mdarray<double, 3> sbessel_mt(lmax__ + 1, gvec().count(), unit_cell().num_atom_types());
+    int ngv = gvec().count();
+    /* number of G-vectors in a batch of the vectorized generation */
+    int const nb{256};
+
+    mdarray<double, 3> sbessel_mt(lmax__ + 1, ngv, unit_cell().num_atom_types());
     for (int iat = 0; iat < unit_cell().num_atom_types(); iat++) {
+        double R = unit_cell().atom_type(iat).mt_radius();
         #pragma omp parallel for schedule(static)
-        for (int igloc = 0; igloc < gvec().count(); igloc++) {
-            auto gv = gvec().gvec_cart<index_domain_t::local>(igloc);
-            gsl_sf_bessel_jl_array(lmax__, gv.length() * unit_cell().atom_type(iat).mt_radius(),
-                                   &sbessel_mt(0, igloc, iat));
+        for (int ib = 0; ib < utils::num_blocks(ngv, nb); ib++) {
+            int ig0 = ib * nb;
+            int n   = std::min(nb, ngv - ig0);
+            std::vector<double> x(n);
+            for (int i = 0; i < n; i++) {
+                x[i] = gvec().gvec_cart<index_domain_t::local>(ig0 + i).length() * R;
+            }
+            Spherical_Bessel_functions::sbessel(lmax__, n, x.data(), &sbessel_mt(0, ig0, iat), lmax__ + 1);
         }
     }
     return sbessel_mt;
@@ -173,11 +183,23 @@ Simulation_context::generate_gvec_ylm(int lmax__)
 {
     PROFILE("sirius::Simulation_context::generate_gvec_ylm");
 
-    matrix<double_complex> gvec_ylm(utils::lmmax(lmax__), gvec().count(), memory_t::host, "gvec_ylm");
+    int ngv = gvec().count();
+    /* number of G-vectors in a batch of the vectorized generation */
+    int const nb{256};
+
+    matrix<double_complex> gvec_ylm(utils::lmmax(lmax__), ngv, memory_t::host, "gvec_ylm");
     #pragma omp parallel for schedule(static)
-    for (int igloc = 0; igloc < gvec().count(); igloc++) {
-        auto rtp = SHT::spherical_coordinates(gvec().gvec_cart<index_domain_t::local>(igloc));
-        sf::spherical_harmonics(lmax__, rtp[1], rtp[2], &gvec_ylm(0, igloc));
+    for (int ib = 0; ib < utils::num_blocks(ngv, nb); ib++) {
+        int ig0 = ib * nb;
+        int n   = std::min(nb, ngv - ig0);
+        std::vector<double> theta(n);
+        std::vector<double> phi(n);
+        for (int i = 0; i < n; i++) {
+            auto rtp = SHT::spherical_coordinates(gvec().gvec_cart<index_domain_t::local>(ig0 + i));
+            theta[i] = rtp[1];
+            phi[i]   = rtp[2];
+        }
+        sf::spherical_harmonics(lmax__, n, theta.data(), phi.data(), &gvec_ylm(0, ig0), utils::lmmax(lmax__));
     }
     return gvec_ylm;
 }
@@ -728,6 +750,11 @@ Simulation_context::print_info() const
     std::printf("page size (Kb)                : %li\n", utils::get_page_size() >> 10);
     std::printf("number of pages               : %li\n", utils::get_num_pages());
     std::printf("available memory (GB)         : %li\n", utils::get_total_memory() >> 30);
+    if (cfg().settings().shared_memory()) {
+        std::printf("ranks sharing node memory     : %i\n", unit_cell().comm_node().size());
+        std::printf("shared memory per node (MB)   : %.2f\n", sddk::shared_memory_stat::size() / double(1 << 20));
+        std::printf("memory saved per node (MB)    : %.2f\n", sddk::shared_memory_stat::saved() / double(1 << 20));
+    }
 
     std::string headers[]       = {"FFT context for density and potential", "FFT context for coarse grid"};
     double cutoffs[]            = {pw_cutoff(), 2 * gk_cutoff()};
@@ -1631,6 +1658,8 @@ Simulation_context::init_comm()
     if (comm_k_.is_null() && comm_band_.is_null()) {
         comm_band_ = comm_.split(comm_.rank() / npb);
         comm_k_    = comm_.split(comm_.rank() % npb);
+        comm_band_.set_name("comm_band");
+        comm_k_.set_name("comm_k");
     }
 
     /* setup MPI grid */
@@ -1645,8 +1674,10 @@ Simulation_context::init_comm()
 
     /* create communicator, orthogonal to comm_fft_coarse */
     comm_ortho_fft_coarse_ = comm().split(comm_fft_coarse().rank());
+    comm_ortho_fft_coarse_.set_name("comm_ortho_fft_coarse");
 
     /* create communicator, orthogonal to comm_fft_coarse within a band communicator */
     comm_band_ortho_fft_coarse_ = comm_band().split(comm_fft_coarse().rank());
+    comm_band_ortho_fft_coarse_.set_name("comm_band_ortho_fft_coarse");
 }
 } // namespace sirius
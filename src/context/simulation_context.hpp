@@ -26,7 +26,9 @@
 #define __SIMULATION_CONTEXT_HPP__
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <spla/spla.hpp>
 
 #include "simulation_parameters.hpp"
@@ -37,6 +39,7 @@
 #include "gpu/acc.hpp"
 #include "symmetry/rotation.hpp"
 #include "SDDK/fft.hpp"
+#include "sht/sht.hpp"
 
 #ifdef SIRIUS_GPU
 extern "C" void generate_phase_factors_gpu(int num_gvec_loc__, int num_atoms__, int const* gvec__,
@@ -252,6 +255,12 @@ class Simulation_context : public Simulation_parameters
 
     std::shared_ptr<std::ostream> output_stream_;
 
+    /// Cache of spherical harmonic transformations, keyed by lmax and the type of the spherical grid.
+    mutable std::map<std::pair<int, int>, std::unique_ptr<SHT>> sht_cache_;
+
+    /// Protects the access to the cache of spherical harmonic transformations.
+    mutable std::mutex sht_cache_mutex_;
+
     mutable double evp_work_count_{0};
     mutable int num_loc_op_applied_{0};
     /// Total number of iterative solver steps.
@@ -625,6 +634,23 @@ class Simulation_context : public Simulation_parameters
     mdarray<double_complex, 2> sum_fg_fl_yg(int lmax__, double_complex const* fpw__, mdarray<double, 3>& fl__,
                                             matrix<double_complex>& gvec_ylm__);
 
+    /// Return the spherical harmonic transformation for a given lmax.
+    /** The transformation is created on the first request and kept by the context. The spherical grid and the
+     *  tables of complex and real spherical harmonics are thus generated once and shared by all users. */
+    inline SHT const& sht(int lmax__) const
+    {
+        std::lock_guard<std::mutex> lock(sht_cache_mutex_);
+        auto key = std::make_pair(lmax__, cfg().settings().sht_coverage());
+        auto& e  = sht_cache_[key];
+        if (!e) {
+            e = std::make_unique<SHT>(processing_unit(), key.first, key.second);
+            if (cfg().control().verification() >= 1) {
+                e->check();
+            }
+        }
+        return *e;
+    }
+
     inline auto const& beta_ri() const
     {
         return *beta_ri_;
@@ -77,9 +77,13 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     switch (atom_type_.parameters().processing_unit()) {
         case device_t::CPU: {
             gvec_rlm = sddk::mdarray<double, 2>(lmmax, gvec_count, mp__);
+            /* number of G-vectors in a batch of the vectorized generation */
+            int const nb{256};
             #pragma omp parallel for schedule(static)
-            for (int igloc = 0; igloc < gvec_count; igloc++) {
-                sf::spherical_harmonics(2 * lmax_beta, tp__(igloc, 0), tp__(igloc, 1), &gvec_rlm(0, igloc));
+            for (int ib = 0; ib < utils::num_blocks(gvec_count, nb); ib++) {
+                int ig0 = ib * nb;
+                sf::spherical_harmonics(2 * lmax_beta, std::min(nb, gvec_count - ig0), &tp__(ig0, 0), &tp__(ig0, 1),
+                                        &gvec_rlm(0, ig0), lmmax);
             }
             break;
         }
@@ -96,13 +100,14 @@ void Augmentation_operator::generate_pw_coeffs(Radial_integrals_aug<false> const
     /* number of beta- radial functions */
     int nbrf = atom_type_.mt_radial_basis_size();
 
+    /* radial integrals for all local G-shells at once */
+    auto& ri = radial_integrals__.values(atom_type_.id(), gvec_.gvec_shell_len_local());
     sddk::mdarray<double, 3> ri_values(nbrf * (nbrf + 1) / 2, 2 * lmax_beta + 1, gvec_.num_gvec_shells_local(), mp__);
     #pragma omp parallel for
     for (int j = 0; j < gvec_.num_gvec_shells_local(); j++) {
-        auto ri = radial_integrals__.values(atom_type_.id(), gvec_.gvec_shell_len_local(j));
         for (int l = 0; l <= 2 * lmax_beta; l++) {
             for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                ri_values(i, l, j) = ri(i, l);
+                ri_values(i, l, j) = ri(i, l, j);
             }
         }
     }
@@ -281,14 +286,14 @@ void Augmentation_operator_gvec_deriv::prepare(Atom_type const& atom_type__,
     ri_values_ = sddk::mdarray<double, 3>(2 * lmax_beta + 1, nbrf * (nbrf + 1) / 2, gvec_.num_gvec_shells_local(), mp);
     ri_dg_values_ = sddk::mdarray<double, 3>(2 * lmax_beta + 1, nbrf * (nbrf + 1) / 2, gvec_.num_gvec_shells_local(),
         mp);
+    auto& ri    = ri__.values(atom_type__.id(), gvec_.gvec_shell_len_local());
+    auto& ri_dg = ri_dq__.values(atom_type__.id(), gvec_.gvec_shell_len_local());
     #pragma omp parallel for
     for (int j = 0; j < gvec_.num_gvec_shells_local(); j++) {
-        auto ri = ri__.values(atom_type__.id(), gvec_.gvec_shell_len_local(j));
-        auto ri_dg = ri_dq__.values(atom_type__.id(), gvec_.gvec_shell_len_local(j));
         for (int l = 0; l <= 2 * lmax_beta; l++) {
             for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                ri_values_(l, i, j) = ri(i, l);
-                ri_dg_values_(l, i, j) = ri_dg(i, l);
+                ri_values_(l, i, j) = ri(i, l, j);
+                ri_dg_values_(l, i, j) = ri_dg(i, l, j);
             }
         }
     }
@@ -543,7 +543,7 @@ Density::generate_paw_atom_density(int idx__)
 
                 /* add nonzero coefficients */
                 for (int inz = 0; inz < num_non_zero_gc; inz++) {
-                    auto& lm3coef = GC.gaunt(lm1, lm2, inz);
+                    auto lm3coef = GC.gaunt(lm1, lm2, inz);
 
                     /* iterate over radial points */
                     for (int irad = 0; irad < grid.num_points(); irad++) {
@@ -579,6 +579,41 @@ Density::generate_paw_loc_density()
     }
 }
 
+/// Add the occupancy-weighted square of a band in real space to the density matrix.
+/** Wave-function is real in case of Gamma-point calculation and complex otherwise. In the non-collinear case both
+ *  spinor components are provided and all four components of the density matrix are updated. The density matrix
+ *  is stored with the leading dimension ld__ and only the points in the range [ir0__, ir1__) are processed. */
+template <typename T>
+static inline void
+add_band_to_density_rg(int ir0__, int ir1__, int ld__, bool gamma__, int ispn__, T w__, T const* psi_up__,
+                       T const* psi_dn__, T* rho__)
+{
+    if (psi_dn__) {
+        auto up = reinterpret_cast<std::complex<T> const*>(psi_up__);
+        auto dn = reinterpret_cast<std::complex<T> const*>(psi_dn__);
+        for (int ir = ir0__; ir < ir1__; ir++) {
+            auto z2 = up[ir] * std::conj(dn[ir]) * w__;
+
+            rho__[ir]            += w__ * std::norm(up[ir]);
+            rho__[ir + ld__]     += w__ * std::norm(dn[ir]);
+            rho__[ir + 2 * ld__] += 2 * std::real(z2);
+            rho__[ir + 3 * ld__] -= 2 * std::imag(z2);
+        }
+    } else {
+        auto rho = rho__ + ispn__ * ld__;
+        if (gamma__) {
+            for (int ir = ir0__; ir < ir1__; ir++) {
+                rho[ir] += w__ * psi_up__[ir] * psi_up__[ir];
+            }
+        } else {
+            auto psi = reinterpret_cast<std::complex<T> const*>(psi_up__);
+            for (int ir = ir0__; ir < ir1__; ir++) {
+                rho[ir] += w__ * std::norm(psi[ir]);
+            }
+        }
+    }
+}
+
 template <typename T>
 void
 Density::add_k_point_contribution_rg(K_point<T>* kp__)
@@ -600,137 +635,202 @@ Density::add_k_point_contribution_rg(K_point<T>* kp__)
         density_rg.allocate(ctx_.mem_pool(memory_t::device)).zero(memory_t::device);
     }
 
-    /* location of the real-space wave-functions psi(r) */
-    auto data_ptr = kp__->spfft_transform().space_domain_data(kp__->spfft_transform().processing_unit());
+    /* in the non-collinear case both spinor components of the band are transformed */
+    int nsc = (ctx_.num_mag_dims() == 3) ? 1 : ctx_.num_spins();
 
-    /* non-magnetic or collinear case */
-    if (ctx_.num_mag_dims() != 3) {
-        /* loop over pure spinor components */
-        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-            /* trivial case */
-            if (!kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col().global_index_size()) {
+    /* list of (spin, local index, weight) of the bands that contribute to the density */
+    std::vector<std::tuple<int, int, T>> bands;
+    for (int ispn = 0; ispn < nsc; ispn++) {
+        auto const& spl = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col();
+        for (int i = 0; i < spl.local_size(); i++) {
+            /* global index of the band */
+            int j    = spl[i];
+            double o = kp__->band_occupancy(j, ispn);
+            /* skip empty bands */
+            if (std::abs(o) < ctx_.min_occupancy() * ctx_.max_occupancy()) {
                 continue;
             }
-            int ncols = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col().local_size();
-            for (int i = 0; i < ncols; i++) {
-                /* global index of the band */
-                int j    = kp__->spinor_wave_functions().pw_coeffs(ispn).spl_num_col()[i];
-                double w = kp__->band_occupancy(j, ispn) * kp__->weight() / omega;
+            bands.emplace_back(ispn, i, static_cast<T>(o * kp__->weight() / omega));
+        }
+    }
+    int nbnd = static_cast<int>(bands.size());
 
-                auto inp_wf = kp__->spinor_wave_functions().pw_coeffs(ispn).extra().at(memory_t::host, 0, i);
+    auto& spfftk = kp__->spfft_transform();
 
-                /* transform to real space */
-                kp__->spfft_transform().backward(reinterpret_cast<const T*>(inp_wf),
-                                                 kp__->spfft_transform().processing_unit());
-
-                switch (kp__->spfft_transform().processing_unit()) {
-                    case SPFFT_PU_HOST: {
-                        if (ctx_.gamma_point()) {
-                            #pragma omp parallel for schedule(static)
-                            for (int ir = 0; ir < nr; ir++) {
-                                density_rg(ir, ispn) += w * std::pow(data_ptr[ir], 2);
-                            }
-                        } else {
-                            auto data = reinterpret_cast<std::complex<T>*>(data_ptr);
-                            #pragma omp parallel for schedule(static)
-                            for (int ir = 0; ir < nr; ir++) {
-                                auto z = data[ir];
-                                density_rg(ir, ispn) += w * (std::pow(z.real(), 2) + std::pow(z.imag(), 2));
-                            }
-                        }
-                        break;
+    /* pointer to the PW coefficients of the wave-function */
+    auto psi_pw = [&](int ib, int ispn) {
+        return reinterpret_cast<T const*>(
+            kp__->spinor_wave_functions().pw_coeffs(ispn).extra().at(memory_t::host, 0, std::get<1>(bands[ib])));
+    };
+
+    if (spfftk.processing_unit() == SPFFT_PU_HOST) {
+        /* leading dimension of the buffer for the up- component of the spinor wave-function */
+        int ld = (ctx_.num_mag_dims() == 3) ? nr : 0;
+
+        int batch_size = ctx_.cfg().control().fft_batch_size();
+
+        if (ctx_.comm_fft_coarse().size() == 1) {
+            /* bands are distributed between threads; each thread has its own FFT driver and its own
+               accumulator of the density */
+            int nt = std::max(1, std::min(batch_size ? batch_size : omp_get_max_threads(), nbnd));
+
+            /* thread 0 uses the FFT driver of the k-point */
+            std::vector<spfft_transform_type<T>> spfft_pool;
+            for (int i = 1; i < nt; i++) {
+                spfft_pool.emplace_back(spfftk.clone());
+            }
+            mdarray<T, 3> density_rg_t(nr, ctx_.num_mag_dims() + 1, nt - 1, ctx_.mem_pool(memory_t::host),
+                                       "density_rg_t");
+            density_rg_t.zero();
+            mdarray<std::complex<T>, 2> psi_r_up(ld, nt, ctx_.mem_pool(memory_t::host), "psi_r_up");
+
+            #pragma omp parallel num_threads(nt)
+            {
+                int tid    = omp_get_thread_num();
+                auto& fftt = (tid == 0) ? spfftk : spfft_pool[tid - 1];
+                T* rho     = (tid == 0) ? density_rg.at(memory_t::host) : density_rg_t.at(memory_t::host, 0, 0, tid - 1);
+                auto ptr   = fftt.space_domain_data(SPFFT_PU_HOST);
+
+                #pragma omp for schedule(dynamic)
+                for (int ib = 0; ib < nbnd; ib++) {
+                    int ispn = std::get<0>(bands[ib]);
+                    fftt.backward(psi_pw(ib, ispn), SPFFT_PU_HOST);
+                    if (ld) {
+                        auto inp = reinterpret_cast<std::complex<T>*>(ptr);
+                        std::copy(inp, inp + nr, &psi_r_up(0, tid));
+                        fftt.backward(psi_pw(ib, 1), SPFFT_PU_HOST);
+                        add_band_to_density_rg(0, nr, nr, false, 0, std::get<2>(bands[ib]),
+                                               reinterpret_cast<T const*>(&psi_r_up(0, tid)), ptr, rho);
+                    } else {
+                        add_band_to_density_rg(0, nr, nr, ctx_.gamma_point(), ispn, std::get<2>(bands[ib]), ptr,
+                                               static_cast<T const*>(nullptr), rho);
                     }
-                    case SPFFT_PU_GPU: {
-#if defined(SIRIUS_GPU)
-                        if (ctx_.gamma_point()) {
-                            update_density_rg_1_real_gpu(nr, data_ptr, w, density_rg.at(memory_t::device, 0, ispn));
-                        } else {
-                            auto data = reinterpret_cast<std::complex<T>*>(data_ptr);
-                            update_density_rg_1_complex_gpu(nr, data, w, density_rg.at(memory_t::device, 0, ispn));
+                }
+            }
+            /* reduce thread contributions */
+            if (nt > 1) {
+                #pragma omp parallel for schedule(static)
+                for (int ir = 0; ir < nr; ir++) {
+                    for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+                        for (int t = 0; t < nt - 1; t++) {
+                            density_rg(ir, j) += density_rg_t(ir, j, t);
                         }
-#endif
-                        break;
                     }
                 }
             }
-        }
-    } else { /* non-collinear case */
-        assert(kp__->spinor_wave_functions().pw_coeffs(0).spl_num_col().local_size() ==
-               kp__->spinor_wave_functions().pw_coeffs(1).spl_num_col().local_size());
-
-        /* allocate on CPU or GPU */
-        mdarray<std::complex<T>, 1> psi_r_up(nr, ctx_.mem_pool(memory_t::host));
-        if (fft.processing_unit() == SPFFT_PU_GPU) {
-            psi_r_up.allocate(ctx_.mem_pool(memory_t::device));
-        }
-        for (int i = 0; i < kp__->spinor_wave_functions().pw_coeffs(0).spl_num_col().local_size(); i++) {
-            int j = kp__->spinor_wave_functions().pw_coeffs(0).spl_num_col()[i];
-            T w   = kp__->band_occupancy(j, 0) * kp__->weight() / omega;
-
-            /* transform up- component of spinor function to real space; in case of GPU wave-function stays in GPU
-             * memory */
-            auto inp_wf_up = kp__->spinor_wave_functions().pw_coeffs(0).extra().at(memory_t::host, 0, i);
-            /* transform to real space */
-            kp__->spfft_transform().backward(reinterpret_cast<const T*>(inp_wf_up),
-                                             kp__->spfft_transform().processing_unit());
-
-            /* this is a non-collinear case, so the wave-functions and FFT buffer are complex and
-               we can copy memory */
-            switch (kp__->spfft_transform().processing_unit()) {
-                case SPFFT_PU_HOST: {
-                    auto inp = reinterpret_cast<std::complex<T>*>(data_ptr);
-                    std::copy(inp, inp + nr, psi_r_up.at(memory_t::host));
-                    break;
-                }
-                case SPFFT_PU_GPU: {
-                    acc::copy(psi_r_up.at(memory_t::device), reinterpret_cast<std::complex<T>*>(data_ptr), nr);
-                    break;
+        } else {
+            /* FFT is distributed; transform batches of bands at once to overlap communication and computation
+               and add a batch to the density in a single pass over the real-space points */
+            int nb = std::max(1, std::min(batch_size, nbnd));
+
+            std::vector<spfft_transform_type<T>> spfft_pool;
+            if (nb > 1) {
+                for (int i = 0; i < nb; i++) {
+                    spfft_pool.emplace_back(spfftk.clone());
                 }
             }
+            std::vector<SpfftProcessingUnitType> out_pu(nb, SPFFT_PU_HOST);
+            std::vector<T const*> inp(nb);
+            std::vector<T*> out(nb);
+            for (int i = 0; i < nb; i++) {
+                out[i] = (nb == 1) ? spfftk.space_domain_data(SPFFT_PU_HOST) : spfft_pool[i].space_domain_data(SPFFT_PU_HOST);
+            }
+            mdarray<std::complex<T>, 2> psi_r_up(ld, nb, ctx_.mem_pool(memory_t::host), "psi_r_up");
 
-            /* transform dn- component of spinor wave function */
-            auto inp_wf_dn = kp__->spinor_wave_functions().pw_coeffs(1).extra().at(memory_t::host, 0, i);
-            kp__->spfft_transform().backward(reinterpret_cast<const T*>(inp_wf_dn),
-                                             kp__->spfft_transform().processing_unit());
-
-            auto psi_r_dn = reinterpret_cast<std::complex<T>*>(data_ptr);
-
-            switch (fft.processing_unit()) {
-                case SPFFT_PU_HOST: {
-                    #pragma omp parallel for schedule(static)
-                    for (int ir = 0; ir < nr; ir++) {
-                        auto r0 = (std::pow(psi_r_up[ir].real(), 2) + std::pow(psi_r_up[ir].imag(), 2)) * w;
-                        auto r1 = (std::pow(psi_r_dn[ir].real(), 2) + std::pow(psi_r_dn[ir].imag(), 2)) * w;
-
-                        auto z2 = psi_r_up[ir] * std::conj(psi_r_dn[ir]) * w;
+            auto backward = [&](int n) {
+                if (nb == 1) {
+                    spfftk.backward(inp[0], SPFFT_PU_HOST);
+                } else {
+                    spfft::multi_transform_backward(n, spfft_pool.data(), inp.data(), out_pu.data());
+                }
+            };
 
-                        density_rg(ir, 0) += r0;
-                        density_rg(ir, 1) += r1;
-                        density_rg(ir, 2) += 2.0 * std::real(z2);
-                        density_rg(ir, 3) -= 2.0 * std::imag(z2);
+            for (int ib0 = 0; ib0 < nbnd; ib0 += nb) {
+                int n = std::min(nb, nbnd - ib0);
+                for (int i = 0; i < n; i++) {
+                    inp[i] = psi_pw(ib0 + i, std::get<0>(bands[ib0 + i]));
+                }
+                backward(n);
+                if (ld) {
+                    for (int i = 0; i < n; i++) {
+                        auto ptr = reinterpret_cast<std::complex<T>*>(out[i]);
+                        std::copy(ptr, ptr + nr, &psi_r_up(0, i));
+                        inp[i] = psi_pw(ib0 + i, 1);
                     }
-                    break;
+                    backward(n);
                 }
-                case SPFFT_PU_GPU: {
-#ifdef SIRIUS_GPU
-                    /* add up-up contribution */
-                    update_density_rg_1_complex_gpu(nr, psi_r_up.at(memory_t::device), w,
-                                                    density_rg.at(memory_t::device, 0, 0));
-                    /* add dn-dn contribution */
-                    update_density_rg_1_complex_gpu(nr, psi_r_dn, w, density_rg.at(memory_t::device, 0, 1));
-                    /* add off-diagonal contribution */
-                    update_density_rg_2_gpu(nr, psi_r_up.at(memory_t::device), psi_r_dn, w,
-                                            density_rg.at(memory_t::device, 0, 2),
-                                            density_rg.at(memory_t::device, 0, 3));
-#endif
-                    break;
+                #pragma omp parallel
+                {
+                    /* each thread works on its own chunk of points */
+                    int nth = omp_get_num_threads();
+                    int tid = omp_get_thread_num();
+                    int ir0 = static_cast<int>(static_cast<int64_t>(nr) * tid / nth);
+                    int ir1 = static_cast<int>(static_cast<int64_t>(nr) * (tid + 1) / nth);
+                    for (int i = 0; i < n; i++) {
+                        auto w = std::get<2>(bands[ib0 + i]);
+                        if (ld) {
+                            add_band_to_density_rg(ir0, ir1, nr, false, 0, w,
+                                                   reinterpret_cast<T const*>(&psi_r_up(0, i)), out[i],
+                                                   density_rg.at(memory_t::host));
+                        } else {
+                            add_band_to_density_rg(ir0, ir1, nr, ctx_.gamma_point(), std::get<0>(bands[ib0 + i]),
+                                                   w, out[i], static_cast<T const*>(nullptr),
+                                                   density_rg.at(memory_t::host));
+                        }
+                    }
                 }
             }
         }
-    }
+    } else {
+#if defined(SIRIUS_GPU)
+        /* location of the real-space wave-functions psi(r) */
+        auto data_ptr = spfftk.space_domain_data(SPFFT_PU_GPU);
 
-    if (fft.processing_unit() == SPFFT_PU_GPU) {
+        /* non-magnetic or collinear case */
+        if (ctx_.num_mag_dims() != 3) {
+            for (int ib = 0; ib < nbnd; ib++) {
+                int ispn = std::get<0>(bands[ib]);
+                T w      = std::get<2>(bands[ib]);
+
+                /* transform to real space */
+                spfftk.backward(psi_pw(ib, ispn), SPFFT_PU_GPU);
+
+                if (ctx_.gamma_point()) {
+                    update_density_rg_1_real_gpu(nr, data_ptr, w, density_rg.at(memory_t::device, 0, ispn));
+                } else {
+                    auto data = reinterpret_cast<std::complex<T>*>(data_ptr);
+                    update_density_rg_1_complex_gpu(nr, data, w, density_rg.at(memory_t::device, 0, ispn));
+                }
+            }
+        } else { /* non-collinear case */
+            assert(kp__->spinor_wave_functions().pw_coeffs(0).spl_num_col().local_size() ==
+                   kp__->spinor_wave_functions().pw_coeffs(1).spl_num_col().local_size());
+
+            mdarray<std::complex<T>, 1> psi_r_up(nr, ctx_.mem_pool(memory_t::device));
+
+            for (int ib = 0; ib < nbnd; ib++) {
+                T w = std::get<2>(bands[ib]);
+
+                /* transform up- component of spinor function to real space; wave-function stays in GPU memory */
+                spfftk.backward(psi_pw(ib, 0), SPFFT_PU_GPU);
+                acc::copy(psi_r_up.at(memory_t::device), reinterpret_cast<std::complex<T>*>(data_ptr), nr);
+
+                /* transform dn- component of spinor wave function */
+                spfftk.backward(psi_pw(ib, 1), SPFFT_PU_GPU);
+                auto psi_r_dn = reinterpret_cast<std::complex<T>*>(data_ptr);
+
+                /* add up-up contribution */
+                update_density_rg_1_complex_gpu(nr, psi_r_up.at(memory_t::device), w,
+                                                density_rg.at(memory_t::device, 0, 0));
+                /* add dn-dn contribution */
+                update_density_rg_1_complex_gpu(nr, psi_r_dn, w, density_rg.at(memory_t::device, 0, 1));
+                /* add off-diagonal contribution */
+                update_density_rg_2_gpu(nr, psi_r_up.at(memory_t::device), psi_r_dn, w,
+                                        density_rg.at(memory_t::device, 0, 2), density_rg.at(memory_t::device, 0, 3));
+            }
+        }
         density_rg.copy_to(memory_t::host);
+#endif
     }
 
     /* switch from real density matrix to density and magnetization */
@@ -1294,7 +1394,10 @@ Density::generate_valence(K_point_set const& ks__)
         for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
             int nbnd = kp->num_occupied_bands(ispn);
             /* swap wave functions for the FFT transformation */
-            kp->spinor_wave_functions().pw_coeffs(ispn).remap_forward(nbnd, 0, &ctx_.mem_pool(memory_t::host));
+            kp->spinor_wave_functions().pw_coeffs(ispn).remap_forward_begin(nbnd, 0, &ctx_.mem_pool(memory_t::host));
+        }
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            kp->spinor_wave_functions().pw_coeffs(ispn).remap_forward_end();
         }
 
         /*
@@ -1937,12 +2040,26 @@ Density::mixer_init(config_t::mixer_t const& mixer_cfg__)
 
     const bool init_mt = ctx_.full_potential();
 
-    /* initialize functions */
-    if (mixer_cfg__.use_hartree()) {
-        this->mixer_->initialize_function<0>(func_prop1, component(0), ctx_, lmmax_, init_mt);
-    } else {
-        this->mixer_->initialize_function<0>(func_prop, component(0), ctx_, lmmax_, init_mt);
+    /* properties of the charge density; only the charge density residual is preconditioned */
+    auto rho_prop = mixer_cfg__.use_hartree() ? func_prop1 : func_prop;
+    if (mixer_cfg__.preconditioner() != "none") {
+        if (ctx_.full_potential()) {
+            WARNING("preconditioning of the density residual is not implemented for the full-potential case");
+        } else {
+            double q0 = mixer_cfg__.kerker_q0();
+            if (mixer_cfg__.preconditioner() == "thomas_fermi") {
+                /* Thomas-Fermi screening wave vector of the homogeneous electron gas with the average density */
+                double kf = std::pow(3 * pi * pi * unit_cell_.num_valence_electrons() / unit_cell_.omega(), 1.0 / 3);
+                q0 = std::sqrt(4 * kf / pi);
+            }
+            ctx_.message(1, __function_name__, "using %s preconditioner for the density residual, q0 = %f\n",
+                         mixer_cfg__.preconditioner().c_str(), q0);
+            rho_prop.precondition = mixer::kerker_preconditioner(q0, mixer_cfg__.kerker_min_weight());
+        }
     }
+
+    /* initialize functions */
+    this->mixer_->initialize_function<0>(rho_prop, component(0), ctx_, lmmax_, init_mt);
     if (ctx_.num_mag_dims() > 0) {
         this->mixer_->initialize_function<1>(func_prop, component(1), ctx_, lmmax_, init_mt);
     }
@@ -287,6 +287,9 @@ class Density : public Field4D
     void add_k_point_contribution_dm_complex(K_point<T>* kp__, sddk::mdarray<double_complex, 4>& density_matrix__);
 
     /// Add k-point contribution to the density and magnetization defined on the regular FFT grid.
+    /** Bands with the occupancy below the min_occupancy threshold are skipped. On the CPU the bands are transformed
+     *  in batches (see control::fft_batch_size); in case of serial FFT each OpenMP thread transforms its own bands
+     *  and accumulates them in a private buffer which is reduced at the end. */
     template <typename T>
     void add_k_point_contribution_rg(K_point<T>* kp__);
 
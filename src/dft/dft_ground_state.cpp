@@ -22,6 +22,7 @@
  *  \brief Contains implementation of sirius::DFT_ground_state class.
  */
 
+#include <fstream>
 #include <iomanip>
 #include "dft_ground_state.hpp"
 #include "utils/profiler.hpp"
@@ -51,6 +52,32 @@ DFT_ground_state::initial_state()
     }
 }
 
+void
+DFT_ground_state::initialize_subspace()
+{
+    PROFILE("sirius::DFT_ground_state::initialize_subspace");
+
+    if (ctx_.full_potential()) {
+        return;
+    }
+    /* wave-functions of the previous run are the starting point for the iterative solver */
+    if (kset_.load(wf_storage_file_name)) {
+        ctx_.message(1, __func__, "wave-functions are loaded from %s\n", wf_storage_file_name);
+        return;
+    }
+    if (ctx_.cfg().parameters().precision_wf() == "fp32") {
+#if defined(USE_FP32)
+        Hamiltonian0<float> H0(potential_);
+        Band(ctx_).initialize_subspace(kset_, H0);
+#else
+        RTE_THROW("not compiled with FP32 support");
+#endif
+    } else {
+        Hamiltonian0<double> H0(potential_, true);
+        Band(ctx_).initialize_subspace(kset_, H0);
+    }
+}
+
 void
 DFT_ground_state::update()
 {
@@ -204,8 +231,29 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
       << "num_dft_iter              : " << num_dft_iter__;
     ctx_.message(1, __func__, s);
 
+    /* performance log of the SCF iterations (one JSON record per line) */
+    bool use_scf_log = !ctx_.cfg().control().scf_log().empty();
+    std::ofstream scf_log;
+    if (use_scf_log && ctx_.comm().rank() == 0) {
+        scf_log.open(ctx_.cfg().control().scf_log(), std::ofstream::out | std::ofstream::app);
+        if (!scf_log.is_open()) {
+            std::stringstream s;
+            s << "failed to open SCF log file " << ctx_.cfg().control().scf_log() << "; records will not be written";
+            WARNING(s);
+        }
+    }
+
+    /* true if the checkpoint holds the current wave-functions */
+    bool checkpoint_is_current{false};
+
     for (int iter = 0; iter < num_dft_iter__; iter++) {
         PROFILE("sirius::DFT_ground_state::scf_loop|iteration");
+        checkpoint_is_current = false;
+        auto t_iter = utils::time_now();
+        int num_loc_op_applied = ctx_.num_loc_op_applied();
+        double itsol_tol_iter = iter_solver_tol__;
+        /* timings of the iteration phases */
+        json phases;
         std::stringstream s;
         s << std::endl;
         s << "+------------------------------+" << std::endl
@@ -215,6 +263,7 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
 
         if (ctx_.cfg().parameters().precision_wf() == "fp32") {
 #if defined(USE_FP32)
+            auto t0 = utils::time_now();
             Hamiltonian0<float> H0(potential_, true);
             /* find new wave-functions */
             if (ctx_.cfg().parameters().precision_hs() == "fp32") {
@@ -222,30 +271,39 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
             } else {
                 Band(ctx_).solve<float, double>(kset_, H0, iter_solver_tol__);
             }
+            phases["band"] = utils::time_interval(t0);
+            t0             = utils::time_now();
             /* find band occupancies */
             kset_.find_band_occupancies<float>();
             /* generate new density from the occupied wave-functions */
             density_.generate<float>(kset_, ctx_.use_symmetry(), true, true);
+            phases["density"] = utils::time_interval(t0);
 #else
             RTE_THROW("not compiled with FP32 support");
 #endif
         } else {
+            auto t0 = utils::time_now();
             Hamiltonian0<double> H0(potential_, true);
             /* find new wave-functions */
             Band(ctx_).solve<double, double>(kset_, H0, iter_solver_tol__);
+            phases["band"] = utils::time_interval(t0);
+            t0             = utils::time_now();
             /* find band occupancies */
             kset_.find_band_occupancies<double>();
             /* generate new density from the occupied wave-functions */
             density_.generate<double>(kset_, ctx_.use_symmetry(), true, true);
+            phases["density"] = utils::time_interval(t0);
         }
 
         double e1 = energy_potential(density_, potential_);
+        auto t0   = utils::time_now();
         copy(density_, rho1);
 
         /* mix density */
         rms = density_.mix();
 
         double eha_res = density_residual_hartree_energy(density_, rho1);
+        phases["mixing"] = utils::time_interval(t0);
 
         /* estimate new tolerance of the iterative solver */
         double tol = rms;
@@ -272,21 +330,8 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
                     ctx_.cfg().parameters().precision_hs("fp64");
                     ctx_.cfg().lock();
 
-                    for (int ikloc = 0; ikloc < kset_.spl_num_kpoints().local_size(); ikloc++) {
-                        int ik = kset_.spl_num_kpoints(ikloc);
-                        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                            kset_.get<double>(ik)->spinor_wave_functions().copy_from(device_t::CPU, ctx_.num_bands(),
-                                                                                     kset_.get<float>(ik)->spinor_wave_functions(), ispn, 0, ispn, 0);
-                        }
-                    }
-                    for (int ik = 0; ik < kset_.num_kpoints(); ik++) {
-                        for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
-                            for (int j = 0; j < ctx_.num_bands(); j++) {
-                                kset_.get<double>(ik)->band_energy(j, ispn, kset_.get<float>(ik)->band_energy(j, ispn));
-                                kset_.get<double>(ik)->band_occupancy(j, ispn, kset_.get<float>(ik)->band_occupancy(j, ispn));
-                            }
-                        }
-                    }
+                    /* build the k-points in double precision and release the single precision ones */
+                    kset_.fp32_to_fp64();
                 }
             }
         }
@@ -297,7 +342,9 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
         }
 
         /* compute new potential */
+        t0 = utils::time_now();
         potential_.generate(density_, ctx_.use_symmetry(), true);
+        phases["potential"] = utils::time_interval(t0);
 
         if (!ctx_.full_potential() && ctx_.cfg().control().verification() >= 2) {
             ctx_.message(1, __function_name__, "%s", "checking functional derivative of Exc\n");
@@ -333,6 +380,36 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
         } else {
             converged = converged && (rms < density_tol__);
         }
+        if (use_scf_log) {
+            num_loc_op_applied = ctx_.num_loc_op_applied() - num_loc_op_applied;
+            kset_.comm().allreduce(&num_loc_op_applied, 1);
+            size_t VmHWM, VmRSS;
+            utils::get_proc_status(&VmHWM, &VmRSS);
+            ctx_.comm().allreduce<size_t, mpi_op_t::max>(&VmHWM, 1);
+
+            json rec;
+            rec["iteration"]          = iter;
+            rec["time"]               = utils::time_interval(t_iter);
+            rec["time_total"]         = utils::time_interval(tstart);
+            rec["phases"]             = phases;
+            rec["num_itsol_steps"]    = kset_.num_itsol_steps();
+            rec["num_loc_op_applied"] = num_loc_op_applied;
+            rec["itsol_tol"]          = itsol_tol_iter;
+            rec["rms"]                = rms;
+            rec["eha_res"]            = eha_res;
+            rec["etot"]               = etot;
+            rec["detot"]              = etot - eold;
+            rec["converged"]          = converged;
+            rec["memory"]["VmHWM"]    = VmHWM;
+            /* memory pools only grow, so their capacity is the high water mark */
+            rec["memory"]["host_pool"] = ctx_.mem_pool(memory_t::host).total_size();
+            if (ctx_.processing_unit() == device_t::GPU) {
+                rec["memory"]["device_pool"] = ctx_.mem_pool(memory_t::device).total_size();
+            }
+            if (scf_log.is_open()) {
+                scf_log << rec.dump() << std::endl;
+            }
+        }
         if (converged) {
             std::stringstream out;
             out << std::endl;
@@ -344,6 +421,18 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
         }
 
         eold = etot;
+
+        int nchk = ctx_.cfg().control().wf_checkpoint_every();
+        if (nchk > 0 && (iter + 1) % nchk == 0) {
+            kset_.save(wf_storage_file_name, ctx_.cfg().control().wf_checkpoint_async());
+            checkpoint_is_current = true;
+        }
+    }
+    /* wait for the background checkpoint and write the final wave-functions, unless the last iteration has
+       already written them */
+    kset_.save_wait();
+    if (ctx_.cfg().control().wf_checkpoint_every() > 0 && !checkpoint_is_current) {
+        kset_.save(wf_storage_file_name);
     }
     std::stringstream out;
     out << std::endl;
@@ -360,7 +449,6 @@ DFT_ground_state::find(double density_tol__, double energy_tol__, double iter_so
         }
         potential_.save();
         density_.save();
-        // kset_.save(storage_file_name);
     }
 
     auto tstop = std::chrono::high_resolution_clock::now();
@@ -147,6 +147,10 @@ class DFT_ground_state
     /// Generate initial density, potential and a subspace of wave-functions.
     void initial_state();
 
+    /// Generate a subspace of wave-functions for the current potential.
+    /** If the wave-functions are found in the checkpoint file, they are loaded instead. */
+    void initialize_subspace();
+
     /// Update the parameters after the change of lattice vectors or atomic positions.
     void update();
 
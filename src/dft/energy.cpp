@@ -32,9 +32,13 @@ ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& u
     double alpha{ctx.ewald_lambda()};
     double ewald_g{0};
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx);
+
     #pragma omp parallel for reduction(+ : ewald_g)
     for (int igloc = gvec.skip_g0(); igloc < gvec.count(); igloc++) {
-        double g2 = std::pow(gvec.gvec_len<index_domain_t::local>(igloc), 2);
+        auto G    = gvec.gvec_cart<index_domain_t::local>(igloc);
+        double g2 = std::pow(G.length(), 2);
 
         double_complex rho(0, 0);
 
@@ -43,15 +47,17 @@ ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& u
                 static_cast<double>(unit_cell.atom(ia).zn());
         }
 
-        ewald_g += std::pow(std::abs(rho), 2) * std::exp(-g2 / 4 / alpha) / g2;
+        ewald_g += std::pow(std::abs(rho), 2) * std::exp(-g2 / 4 / alpha) * kernel.factor(G) / g2;
     }
 
     ctx.comm().allreduce(&ewald_g, 1);
     if (gvec.reduced()) {
         ewald_g *= 2;
     }
-    /* remaining G=0 contribution */
-    ewald_g -= std::pow(unit_cell.num_electrons(), 2) / alpha / 4;
+    /* remaining G=0 contribution; it vanishes for the truncated interaction */
+    if (kernel.periodic()) {
+        ewald_g -= std::pow(unit_cell.num_electrons(), 2) / alpha / 4;
+    }
     ewald_g *= (twopi / unit_cell.omega());
 
     /* remove self-interaction */
@@ -65,6 +71,9 @@ ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& u
         for (int i = 1; i < unit_cell.num_nearest_neighbours(ia); i++) {
             int ja   = unit_cell.nearest_neighbour(i, ia).atom_id;
             double d = unit_cell.nearest_neighbour(i, ia).distance;
+            if (!kernel.within_cutoff(unit_cell.nearest_neighbour(i, ia).rc)) {
+                continue;
+            }
             ewald_r += 0.5 * unit_cell.atom(ia).zn() * unit_cell.atom(ja).zn() * std::erfc(std::sqrt(alpha) * d) / d;
         }
     }
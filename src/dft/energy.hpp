@@ -109,6 +109,9 @@ namespace sirius {
  *      \Big|^2 - \sum_{\alpha} Z_{\alpha}^2 \sqrt{\frac{\lambda}{\pi}} - \frac{2\pi}{\Omega}
  *      \frac{N_{el}^2}{4 \lambda}
  *  \f]
+ *  For isolated systems the reciprocal-space term is multiplied by the factor \f$ f({\bf G}) \f$ of the
+ *  truncated Coulomb interaction (see sirius::Coulomb_kernel), the \f$ G=0 \f$ term vanishes and the real-space
+ *  sum is restricted to the pairs within the cutoff.
  */
 double ewald_energy(const Simulation_context& ctx, const Gvec& gvec, const Unit_cell& unit_cell);
 
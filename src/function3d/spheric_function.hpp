@@ -595,8 +595,6 @@ inline Spheric_vector_function<function_domain_t::spectral, double_complex> grad
 /// Gradient of the function in real spherical harmonics.
 inline Spheric_vector_function<function_domain_t::spectral, double> gradient(Spheric_function<function_domain_t::spectral, double> const& f__)
 {
-    int lmax = utils::lmax(f__.angular_domain_size());
-    SHT sht(device_t::CPU, lmax);
     auto zf = convert(f__);
     auto zg = gradient(zf);
     Spheric_vector_function<function_domain_t::spectral, double> g(f__.angular_domain_size(), f__.radial_grid());
@@ -385,6 +385,9 @@ Force::calc_forces_ewald()
 
     int ig0 = ctx_.gvec().skip_g0();
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+
     sddk::mdarray<double_complex, 1> rho_tmp(ctx_.gvec().count());
     rho_tmp.zero();
     #pragma omp parallel for schedule(static)
@@ -405,13 +408,14 @@ Force::calc_forces_ewald()
         for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
             int ig = ctx_.gvec().offset() + igloc;
 
-            double g2 = std::pow(ctx_.gvec().gvec_len<index_domain_t::local>(igloc), 2);
-
             /* cartesian form for getting cartesian force components */
             auto gvec_cart = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
 
+            double g2 = std::pow(gvec_cart.length(), 2);
+
             double scalar_part = prefac * (rho_tmp[igloc] * ctx_.gvec_phase_factor(ig, ja)).imag() *
-                                 static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) / g2;
+                                 static_cast<double>(unit_cell.atom(ja).zn()) * std::exp(-g2 / (4 * alpha)) *
+                                 kernel.factor(gvec_cart) / g2;
 
             for (int x : {0, 1, 2}) {
                 forces_ewald_(x, ja) += scalar_part * gvec_cart[x];
@@ -428,6 +432,10 @@ Force::calc_forces_ewald()
         for (int i = 1; i < unit_cell.num_nearest_neighbours(ia); i++) {
             int ja = unit_cell.nearest_neighbour(i, ia).atom_id;
 
+            if (!kernel.within_cutoff(unit_cell.nearest_neighbour(i, ia).rc)) {
+                continue;
+            }
+
             double d  = unit_cell.nearest_neighbour(i, ia).distance;
             double d2 = d * d;
 
@@ -745,6 +753,9 @@ Force::calc_forces_vloc()
 
     double fact = valence_rho.gvec().reduced() ? 2.0 : 1.0;
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+
     /* here the calculations are in lattice vectors space */
     #pragma omp parallel for
     for (int ia = 0; ia < unit_cell.num_atoms(); ia++) {
@@ -759,8 +770,13 @@ Force::calc_forces_vloc()
             /* cartesian form for getting cartesian force components */
             auto gvec_cart = gvecs.gvec_cart<index_domain_t::local>(igloc);
 
+            double v = ff(igsh, iat);
+            if (!kernel.periodic() && ig != 0 && !atom.type().local_potential().empty()) {
+                v += atom.zn() * kernel.vloc_correction(gvec_cart);
+            }
+
             /* scalar part of a force without multiplying by G-vector */
-            double_complex z = fact * fourpi * ff(igsh, iat) * std::conj(valence_rho.f_pw_local(igloc)) *
+            double_complex z = fact * fourpi * v * std::conj(valence_rho.f_pw_local(igloc)) *
                                std::conj(ctx_.gvec_phase_factor(ig, ia));
 
             /* get force components multiplying by cartesian G-vector  */
@@ -513,6 +513,9 @@ Stress::calc_stress_ewald()
 
     auto& uc = ctx_.unit_cell();
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+
     int ig0 = ctx_.gvec().skip_g0();
     for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
         int ig = ctx_.gvec().offset() + igloc;
@@ -527,11 +530,14 @@ Stress::calc_stress_ewald()
             rho += ctx_.gvec_phase_factor(ig, ia) * static_cast<double>(uc.atom(ia).zn());
         }
 
-        double a1 = twopi * std::pow(std::abs(rho) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
+        double a0 = twopi * std::pow(std::abs(rho) / uc.omega(), 2) * std::exp(-g2lambda) / g2;
+        double a1 = a0 * kernel.factor(G);
+        auto df   = kernel.factor_deriv(G);
 
         for (int mu : {0, 1, 2}) {
             for (int nu : {0, 1, 2}) {
-                stress_ewald_(mu, nu) += a1 * G[mu] * G[nu] * 2 * (g2lambda + 1) / g2;
+                stress_ewald_(mu, nu) += a1 * G[mu] * G[nu] * 2 * (g2lambda + 1) / g2 -
+                                         a0 * 0.5 * (df[mu] * G[nu] + df[nu] * G[mu]);
             }
         }
 
@@ -546,8 +552,11 @@ Stress::calc_stress_ewald()
 
     ctx_.comm().allreduce(&stress_ewald_(0, 0), 9);
 
-    for (int mu : {0, 1, 2}) {
-        stress_ewald_(mu, mu) += twopi * std::pow(uc.num_electrons() / uc.omega(), 2) / 4 / lambda;
+    /* G=0 contribution vanishes for the truncated interaction */
+    if (kernel.periodic()) {
+        for (int mu : {0, 1, 2}) {
+            stress_ewald_(mu, mu) += twopi * std::pow(uc.num_electrons() / uc.omega(), 2) / 4 / lambda;
+        }
     }
 
     for (int ia = 0; ia < uc.num_atoms(); ia++) {
@@ -556,6 +565,10 @@ Stress::calc_stress_ewald()
             auto d  = uc.nearest_neighbour(i, ia).distance;
             auto rc = uc.nearest_neighbour(i, ia).rc;
 
+            if (!kernel.within_cutoff(rc)) {
+                continue;
+            }
+
             double a1 = (0.5 * uc.atom(ia).zn() * uc.atom(ja).zn() / uc.omega() / std::pow(d, 3)) *
                         (-2 * std::exp(-lambda * std::pow(d, 2)) * std::sqrt(lambda / pi) * d -
                          std::erfc(std::sqrt(lambda) * d));
@@ -643,16 +656,21 @@ Stress::calc_stress_har()
 
     stress_har_.zero();
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+
     int ig0 = ctx_.gvec().skip_g0();
     for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
         auto G    = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
         double g2 = std::pow(G.length(), 2);
         auto z    = density_.rho().f_pw_local(igloc);
-        double d  = twopi * (std::pow(z.real(), 2) + std::pow(z.imag(), 2)) / g2;
+        double d0 = twopi * (std::pow(z.real(), 2) + std::pow(z.imag(), 2)) / g2;
+        double d  = d0 * kernel.factor(G);
+        auto df   = kernel.factor_deriv(G);
 
         for (int mu : {0, 1, 2}) {
             for (int nu : {0, 1, 2}) {
-                stress_har_(mu, nu) += d * 2 * G[mu] * G[nu] / g2;
+                stress_har_(mu, nu) += d * 2 * G[mu] * G[nu] / g2 - d0 * 0.5 * (df[mu] * G[nu] + df[nu] * G[mu]);
             }
         }
         for (int mu : {0, 1, 2}) {
@@ -768,6 +786,10 @@ Stress::calc_stress_vloc()
 
     double sdiag{0};
 
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+    auto& uc = ctx_.unit_cell();
+
     int ig0 = ctx_.gvec().skip_g0();
     for (int igloc = ig0; igloc < ctx_.gvec().count(); igloc++) {
 
@@ -781,6 +803,25 @@ Stress::calc_stress_vloc()
         }
 
         sdiag += std::real(std::conj(density_.rho().f_pw_local(igloc)) * v[igloc]);
+
+        /* correction from the truncation of the long-range part of the local potential */
+        if (!kernel.periodic()) {
+            int ig = ctx_.gvec().offset() + igloc;
+            double_complex s(0, 0);
+            for (int ia = 0; ia < uc.num_atoms(); ia++) {
+                if (!uc.atom(ia).type().local_potential().empty()) {
+                    s += std::conj(ctx_.gvec_phase_factor(ig, ia)) * static_cast<double>(uc.atom(ia).zn());
+                }
+            }
+            double z = std::real(std::conj(density_.rho().f_pw_local(igloc)) * s) * fourpi / uc.omega();
+            auto dc  = kernel.vloc_correction_deriv(G);
+            for (int mu : {0, 1, 2}) {
+                for (int nu : {0, 1, 2}) {
+                    stress_vloc_(mu, nu) -= z * 0.5 * (dc[mu] * G[nu] + dc[nu] * G[mu]);
+                }
+            }
+            sdiag += z * kernel.vloc_correction(G);
+        }
     }
 
     if (ctx_.gvec().reduced()) {
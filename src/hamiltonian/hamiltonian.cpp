@@ -67,18 +67,8 @@ Hamiltonian0<T>::Hamiltonian0(Potential& potential__, bool precompute_lapw__)
 
                 hmt_[ia] = sddk::mdarray<std::complex<T>, 2>(nmt, nmt, memory_t::host, "hmt");
 
-                /* compute muffin-tin Hamiltonian */
-                for (int j2 = 0; j2 < nmt; j2++) {
-                    int lm2    = type.indexb(j2).lm;
-                    int idxrf2 = type.indexb(j2).idxrf;
-                    for (int j1 = 0; j1 <= j2; j1++) {
-                        int lm1    = type.indexb(j1).lm;
-                        int idxrf1 = type.indexb(j1).idxrf;
-                        hmt_[ia](j1, j2) = atom.radial_integrals_sum_L3<spin_block_t::nm>(idxrf1, idxrf2,
-                                                                                type.gaunt_coefs().gaunt_vector(lm1, lm2));
-                        hmt_[ia](j2, j1) = std::conj(hmt_[ia](j1, j2));
-                    }
-                }
+                /* compute Hermitian muffin-tin Hamiltonian */
+                atom.generate_hmt<spin_block_t::nm>(nmt, hmt_[ia], true);
                 if (pu == device_t::GPU) {
                     hmt_[ia].allocate(memory_t::device).copy_to(memory_t::device, stream_id(tid));
                 }
@@ -107,16 +97,7 @@ Hamiltonian0<T>::apply_hmt_to_apw(Atom const& atom__, int ngv__, sddk::mdarray<s
     // TODO: for spin-collinear case hmt is Hermitian; compute upper triangular part and use zhemm
     sddk::mdarray<std::complex<T>, 2> hmt(type.mt_aw_basis_size(), type.mt_aw_basis_size());
     /* compute the muffin-tin Hamiltonian */
-    for (int j2 = 0; j2 < type.mt_aw_basis_size(); j2++) {
-        int lm2    = type.indexb(j2).lm;
-        int idxrf2 = type.indexb(j2).idxrf;
-        for (int j1 = 0; j1 < type.mt_aw_basis_size(); j1++) {
-            int lm1    = type.indexb(j1).lm;
-            int idxrf1 = type.indexb(j1).idxrf;
-            hmt(j1, j2) = atom__.radial_integrals_sum_L3<sblock>(idxrf1, idxrf2,
-                                                                 type.gaunt_coefs().gaunt_vector(lm1, lm2));
-        }
-    }
+    atom__.generate_hmt<sblock>(type.mt_aw_basis_size(), hmt, false);
     linalg(linalg_t::blas)
         .gemm('N', 'T', ngv__, type.mt_aw_basis_size(), type.mt_aw_basis_size(), &linalg_const<std::complex<T>>::one(),
               alm__.at(memory_t::host), alm__.ld(), hmt.at(memory_t::host), hmt.ld(),
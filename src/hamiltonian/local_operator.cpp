@@ -371,7 +371,7 @@ void Local_operator<T>::apply_h(spfft_transform_type<T>& spfftk__, Gvec_partitio
     memory_t mem_phi{memory_t::none};
     memory_t mem_hphi{memory_t::none};
 
-    /* remap wave-functions to FFT friendly distribution */
+    /* remap wave-functions to FFT friendly distribution; remapping of all spin components is started at once */
     for (int ispn : spins__) {
         /* if we store wave-functions in the device memory and if the wave functions are remapped
            we need to copy the wave functions to host memory */
@@ -379,7 +379,10 @@ void Local_operator<T>::apply_h(spfft_transform_type<T>& spfftk__, Gvec_partitio
             phi__.pw_coeffs(ispn).copy_to(memory_t::host, idx0__, n__);
         }
         /* set FFT friendly distribution */
-        phi__.pw_coeffs(ispn).remap_forward(n__, idx0__, &mp);
+        phi__.pw_coeffs(ispn).remap_forward_begin(n__, idx0__, &mp);
+    }
+    for (int ispn : spins__) {
+        phi__.pw_coeffs(ispn).remap_forward_end();
         /* memory location of phi in extra storage */
         mem_phi = (phi__.pw_coeffs(ispn).is_remapped()) ? memory_t::host : phi__.preferred_memory_t();
         /* set FFT friednly distribution */
@@ -657,7 +660,10 @@ void Local_operator<T>::apply_h(spfft_transform_type<T>& spfftk__, Gvec_partitio
 
     /* remap hphi backward */
     for (int ispn : spins__) {
-        hphi__.pw_coeffs(ispn).remap_backward(n__, idx0__);
+        hphi__.pw_coeffs(ispn).remap_backward_begin(n__, idx0__);
+    }
+    for (int ispn : spins__) {
+        hphi__.pw_coeffs(ispn).remap_backward_end();
         if (is_device_memory(hphi__.preferred_memory_t()) && hphi__.pw_coeffs(ispn).is_remapped()) {
             hphi__.pw_coeffs(ispn).copy_to(memory_t::device, idx0__, n__);
         }
@@ -794,11 +800,16 @@ void Local_operator<T>::apply_h_o(spfft_transform_type<T>& spfftk__, Gvec_partit
         }
     }
 
-    if (hphi__ != nullptr) {
-        hphi__->pw_coeffs(0).remap_backward(n__, N__);
+    /* remap both functions at once */
+    for (auto e : {hphi__, ophi__}) {
+        if (e != nullptr) {
+            e->pw_coeffs(0).remap_backward_begin(n__, N__);
+        }
     }
-    if (ophi__ != nullptr) {
-        ophi__->pw_coeffs(0).remap_backward(n__, N__);
+    for (auto e : {hphi__, ophi__}) {
+        if (e != nullptr) {
+            e->pw_coeffs(0).remap_backward_end();
+        }
     }
 
     if (ctx_.processing_unit() == device_t::GPU) {
@@ -891,7 +902,10 @@ void Local_operator<T>::apply_b(spfft_transform_type<T>& spfftk__, int N__, int
     }
 
     for (int i : iv) {
-        bphi__[i].pw_coeffs(0).remap_backward(n__, N__);
+        bphi__[i].pw_coeffs(0).remap_backward_begin(n__, N__);
+    }
+    for (int i : iv) {
+        bphi__[i].pw_coeffs(0).remap_backward_end();
     }
 }
 
@@ -849,94 +849,195 @@ K_point<T>::test_spinor_wave_functions(int use_fft)
     //==     std :: cout << "maximum error = " << maxerr << std::endl;
 }
 
-/** The following HDF5 data structure is created:
-  \verbatim
-  /K_point_set/ik/vk
-  /K_point_set/ik/band_energies
-  /K_point_set/ik/band_occupancies
-  /K_point_set/ik/gkvec
-  /K_point_set/ik/gvec
-  /K_point_set/ik/bands/ibnd/spinor_wave_function/ispn/pw
-  /K_point_set/ik/bands/ibnd/spinor_wave_function/ispn/mt
-  \endverbatim
-*/
+/// Return dimensions of the HDF5 dataset or an empty vector if the dataset doesn't exist.
+static std::vector<hsize_t>
+h5_dataset_dims(hid_t file__, std::string const& path__)
+{
+    std::vector<hsize_t> dims;
+    if (H5Lexists(file__, path__.c_str(), H5P_DEFAULT) <= 0) {
+        return dims;
+    }
+    hid_t id    = H5Dopen(file__, path__.c_str(), H5P_DEFAULT);
+    hid_t space = H5Dget_space(id);
+    dims.resize(H5Sget_simple_extent_ndims(space));
+    H5Sget_simple_extent_dims(space, dims.data(), nullptr);
+    H5Sclose(space);
+    H5Dclose(id);
+    return dims;
+}
+
+/// Read a block of the HDF5 dataset; the whole dataset is read if size__ is empty.
+static void
+h5_read(hid_t file__, std::string const& path__, hid_t type__, void* buf__, std::vector<hsize_t> const& offs__ = {},
+        std::vector<hsize_t> const& size__ = {})
+{
+    hid_t id     = H5Dopen(file__, path__.c_str(), H5P_DEFAULT);
+    hid_t fspace = H5Dget_space(id);
+    hid_t mspace = H5S_ALL;
+    if (!size__.empty()) {
+        H5Sselect_hyperslab(fspace, H5S_SELECT_SET, offs__.data(), nullptr, size__.data(), nullptr);
+        mspace = H5Screate_simple(static_cast<int>(size__.size()), size__.data(), nullptr);
+    }
+    if (H5Dread(id, type__, mspace, fspace, H5P_DEFAULT, buf__) < 0) {
+        RTE_THROW("error in H5Dread(): " + path__);
+    }
+    if (mspace != H5S_ALL) {
+        H5Sclose(mspace);
+    }
+    H5Sclose(fspace);
+    H5Dclose(id);
+}
+
+/** The data is read from the file written by K_point_set::save(). The saved PW coefficients are stored in the
+ *  order of the saved list of G-vectors. The search of the saved G-vectors is split between the ranks: each rank
+ *  reads a slice of the saved G-vectors, finds the matching G+k vectors and sends their indices to the owners.
+ *  Each rank then reads only the rows of the saved coefficients of its local G+k vectors (nearby rows are merged
+ *  into one block of the HDF5 selection). Coefficients of the G+k vectors, which are not in the file (e.g. after
+ *  the cutoff was increased), are set to zero.
+ *
+ *  Returns false if the number of bands or spins doesn't match the current setup. */
 template <typename T>
-void
-K_point<T>::save(std::string const& name__, int id__) const
+bool
+K_point<T>::load(std::string const& name__, int id__)
 {
-    /* rank 0 creates placeholders in the HDF5 file */
-    if (comm().rank() == 0) {
-        /* open file with write access */
-        HDF5_tree fout(name__, hdf5_access_t::read_write);
-        /* create /K_point_set/ik */
-        fout["K_point_set"].create_node(id__);
-        fout["K_point_set"][id__].write("vk", &vk_[0], 3);
-        fout["K_point_set"][id__].write("band_energies", band_energies_);
-        fout["K_point_set"][id__].write("band_occupancies", band_occupancies_);
-
-        /* save the entire G+k object */
-        //TODO: only the list of z-columns is probably needed to recreate the G+k vectors
-        //serializer s;
-        //gkvec().pack(s);
-        //fout["K_point_set"][id__].write("gkvec", s.stream());
-
-        /* save the order of G-vectors */
-        mdarray<int, 2> gv(3, num_gkvec());
-        for (int i = 0; i < num_gkvec(); i++) {
-            auto v = gkvec().template gvec<index_domain_t::global>(i);
-            for (int x : {0, 1, 2}) {
-                gv(x, i) = v[x];
-            }
+    PROFILE("sirius::K_point::load");
+
+    std::string path = "/K_point_set/" + std::to_string(id__);
+
+    hid_t file = H5Fopen(name__.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0) {
+        RTE_THROW("error in H5Fopen(): " + name__);
+    }
+    /* check the number of bands and spins */
+    bool ok = h5_dataset_dims(file, path + "/band_energies") ==
+              std::vector<hsize_t>({static_cast<hsize_t>(ctx_.num_spinors()), static_cast<hsize_t>(ctx_.num_bands())});
+    for (int ispn = 0; ispn < 2; ispn++) {
+        auto dims = h5_dataset_dims(file, path + "/spinor_wave_functions/" + std::to_string(ispn));
+        if (ispn < ctx_.num_spins()) {
+            ok = ok && dims.size() == 3 && dims[0] == static_cast<hsize_t>(ctx_.num_bands());
+        } else {
+            ok = ok && dims.size() == 0;
         }
-        fout["K_point_set"][id__].write("gvec", gv);
-        fout["K_point_set"][id__].create_node("bands");
-        for (int i = 0; i < ctx_.num_bands(); i++) {
-            fout["K_point_set"][id__]["bands"].create_node(i);
-            fout["K_point_set"][id__]["bands"][i].create_node("spinor_wave_function");
-            for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-                fout["K_point_set"][id__]["bands"][i]["spinor_wave_function"].create_node(ispn);
-            }
+    }
+    if (!ok) {
+        H5Fclose(file);
+        return false;
+    }
+    int ngk = static_cast<int>(h5_dataset_dims(file, path + "/gvec")[0]);
+
+    h5_read(file, path + "/band_energies", H5T_NATIVE_DOUBLE, band_energies_.at(memory_t::host));
+    h5_read(file, path + "/band_occupancies", H5T_NATIVE_DOUBLE, band_occupancies_.at(memory_t::host));
+
+    auto& comm = gkvec().comm();
+
+    /* slice of the saved G-vectors */
+    splindex<splindex_t::block> spl_j(ngk, comm.size(), comm.rank());
+    int j0 = spl_j.global_offset();
+    mdarray<int, 2> gv(3, spl_j.local_size());
+    if (spl_j.local_size()) {
+        h5_read(file, path + "/gvec", H5T_NATIVE_INT, gv.at(memory_t::host),
+                {static_cast<hsize_t>(j0), 0}, {static_cast<hsize_t>(spl_j.local_size()), 3});
+    }
+
+    /* pairs of local index of G+k vector and index in the file for each owner of G+k vectors */
+    std::vector<int> gkvec_offs(comm.size());
+    for (int r = 0; r < comm.size(); r++) {
+        gkvec_offs[r] = gkvec().gvec_offset(r);
+    }
+    std::vector<std::vector<int>> sbuf(comm.size());
+    for (int j = 0; j < spl_j.local_size(); j++) {
+        vector3d<int> G(&gv(0, j));
+        int ig = gkvec().index_by_gvec(G);
+        if (ig >= 0 && gkvec().template gvec<index_domain_t::global>(ig) == G) {
+            int r = static_cast<int>(std::upper_bound(gkvec_offs.begin(), gkvec_offs.end(), ig) -
+                                     gkvec_offs.begin()) - 1;
+            sbuf[r].push_back(ig - gkvec_offs[r]);
+            sbuf[r].push_back(j0 + j);
         }
     }
-    /* wait for rank 0 */
-    comm().barrier();
-    int gkvec_count  = gkvec().count();
-    int gkvec_offset = gkvec().offset();
-    std::vector<std::complex<T>> wf_tmp(num_gkvec());
-
-    std::unique_ptr<HDF5_tree> fout;
-    /* rank 0 opens a file */
-    if (comm().rank() == 0) {
-        fout = std::make_unique<HDF5_tree>(name__, hdf5_access_t::read_write);
+    std::vector<int> scount(comm.size());
+    std::vector<int> sdispl(comm.size(), 0);
+    std::vector<int> rcount(comm.size());
+    std::vector<int> rdispl(comm.size(), 0);
+    std::vector<int> sdata;
+    for (int r = 0; r < comm.size(); r++) {
+        scount[r] = static_cast<int>(sbuf[r].size());
+        sdispl[r] = static_cast<int>(sdata.size());
+        sdata.insert(sdata.end(), sbuf[r].begin(), sbuf[r].end());
     }
+    comm.alltoall(scount.data(), 1, rcount.data(), 1);
+    for (int r = 1; r < comm.size(); r++) {
+        rdispl[r] = rdispl[r - 1] + rcount[r - 1];
+    }
+    std::vector<int> rdata(rdispl.back() + rcount.back());
+    comm.alltoall(sdata.data(), scount.data(), sdispl.data(), rdata.data(), rcount.data(), rdispl.data());
 
-    /* store wave-functions */
-    for (int i = 0; i < ctx_.num_bands(); i++) {
-        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
-            /* gather full column of PW coefficients on rank 0 */
-            comm().gather(&spinor_wave_functions_->pw_coeffs(ispn).prime(0, i), wf_tmp.data(), gkvec_offset,
-                          gkvec_count, 0);
-            if (comm().rank() == 0) {
-                (*fout)["K_point_set"][id__]["bands"][i]["spinor_wave_function"][ispn].write("pw", wf_tmp);
-            }
+    /* pairs of index in the file and local index of G+k vector, sorted by the index in the file */
+    std::vector<std::pair<int, int>> idx;
+    for (size_t i = 0; i < rdata.size(); i += 2) {
+        idx.push_back(std::make_pair(rdata[i + 1], rdata[i]));
+    }
+    std::sort(idx.begin(), idx.end());
+    if (static_cast<int>(idx.size()) != gkvec().count()) {
+        this->message(2, __func__, "%i G+k vectors are not found in the saved wave-functions\n",
+                      gkvec().count() - static_cast<int>(idx.size()));
+    }
+
+    /* blocks of rows in the file; rows separated by a small gap are read as one block */
+    int const max_gap{32};
+    std::vector<std::pair<int, int>> blocks;
+    /* position of each local G+k vector in the selection */
+    std::vector<int> pos(idx.size());
+    int nsel{0};
+    for (size_t i = 0; i < idx.size(); i++) {
+        int j = idx[i].first;
+        if (blocks.empty() || j - (blocks.back().first + blocks.back().second) > max_gap) {
+            nsel += blocks.empty() ? 0 : blocks.back().second;
+            blocks.push_back(std::make_pair(j, 1));
+        } else {
+            blocks.back().second = j - blocks.back().first + 1;
         }
-        comm().barrier();
+        pos[i] = nsel + j - blocks.back().first;
     }
-}
+    nsel += blocks.empty() ? 0 : blocks.back().second;
+
+    std::vector<std::complex<T>> buf(static_cast<size_t>(nsel) * ctx_.num_bands());
+    for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+        auto& psi = spinor_wave_functions_->pw_coeffs(ispn).prime();
+        std::fill(psi.at(memory_t::host), psi.at(memory_t::host) + psi.size(), 0);
+        if (!nsel) {
+            continue;
+        }
+        /* the selected rows are stored in the memory in the order of the file */
+        std::string name = path + "/spinor_wave_functions/" + std::to_string(ispn);
+        hid_t id     = H5Dopen(file, name.c_str(), H5P_DEFAULT);
+        hid_t fspace = H5Dget_space(id);
+        for (size_t b = 0; b < blocks.size(); b++) {
+            std::array<hsize_t, 3> offs = {0, static_cast<hsize_t>(blocks[b].first), 0};
+            std::array<hsize_t, 3> size = {static_cast<hsize_t>(ctx_.num_bands()),
+                                           static_cast<hsize_t>(blocks[b].second), 2};
+            H5Sselect_hyperslab(fspace, b ? H5S_SELECT_OR : H5S_SELECT_SET, offs.data(), nullptr, size.data(),
+                                nullptr);
+        }
+        std::array<hsize_t, 3> size = {static_cast<hsize_t>(ctx_.num_bands()), static_cast<hsize_t>(nsel), 2};
+        hid_t mspace = H5Screate_simple(3, size.data(), nullptr);
+        if (H5Dread(id, hdf5_type_wrapper<T>::type_id(), mspace, fspace, H5P_DEFAULT, buf.data()) < 0) {
+            RTE_THROW("error in H5Dread(): " + name);
+        }
+        H5Sclose(mspace);
+        H5Sclose(fspace);
+        H5Dclose(id);
 
-template <typename T>
-void
-K_point<T>::load(HDF5_tree h5in, int id)
-{
-    STOP();
-    //== band_energies_.resize(ctx_.num_bands());
-    //== h5in[id].read("band_energies", band_energies_);
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < ctx_.num_bands(); i++) {
+            for (size_t k = 0; k < idx.size(); k++) {
+                psi(idx[k].second, i) = buf[static_cast<size_t>(i) * nsel + pos[k]];
+            }
+        }
+    }
+    H5Fclose(file);
 
-    //== band_occupancies_.resize(ctx_.num_bands());
-    //== h5in[id].read("band_occupancies", band_occupancies_);
-    //==
-    //== h5in[id].read_mdarray("fv_eigen_vectors", fv_eigen_vectors_panel_);
-    //== h5in[id].read_mdarray("sv_eigen_vectors", sv_eigen_vectors_);
+    return true;
 }
 
 //== void K_point::save_wave_functions(int id)
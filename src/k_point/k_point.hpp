@@ -350,10 +350,8 @@ class K_point
 
     void generate_hubbard_orbitals();
 
-    /// Save data to HDF5 file.
-    void save(std::string const& name__, int id__) const;
-
-    void load(HDF5_tree h5in, int id);
+    /// Load band energies, occupancies and wave-functions from the HDF5 file.
+    bool load(std::string const& name__, int id__);
 
     //== void save_wave_functions(int id);
 
@@ -401,6 +399,12 @@ class K_point
         return *gkvec_;
     }
 
+    /// Return shared pointer to the list of G+k vectors.
+    inline std::shared_ptr<Gvec> gkvec_shared() const
+    {
+        return gkvec_;
+    }
+
     /// Total number of G+k vectors within the cutoff distance
     inline int num_gkvec() const
     {
@@ -18,6 +18,7 @@
 // OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <limits>
+#include <cstdio>
 #include "dft/smearing.hpp"
 #include "k_point/k_point.hpp"
 #include "k_point/k_point_set.hpp"
@@ -145,11 +146,15 @@ void K_point_set::initialize(std::vector<int> const& counts)
         spl_num_kpoints_ = splindex<splindex_t::chunk>(num_kpoints(), comm().size(), comm().rank(), counts);
     }
 
+    /* only the k-points of the current precision are initialized; the other set is created on demand */
     for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
-        kpoints_[spl_num_kpoints_[ikloc]]->initialize();
 #if defined(USE_FP32)
-        kpoints_float_[spl_num_kpoints_[ikloc]]->initialize();
+        if (use_fp32()) {
+            kpoints_float_[spl_num_kpoints_[ikloc]]->initialize();
+            continue;
+        }
 #endif
+        kpoints_[spl_num_kpoints_[ikloc]]->initialize();
     }
 
     if (ctx_.verbosity() > 0) {
@@ -160,6 +165,41 @@ void K_point_set::initialize(std::vector<int> const& counts)
 }
 
 
+void K_point_set::fp32_to_fp64()
+{
+#if defined(USE_FP32)
+    PROFILE("sirius::K_point_set::fp32_to_fp64");
+
+    ctx_.print_memory_usage(__FILE__, __LINE__);
+
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                kpoints_[ik]->band_energy(j, ispn, kpoints_float_[ik]->band_energy(j, ispn));
+                kpoints_[ik]->band_occupancy(j, ispn, kpoints_float_[ik]->band_occupancy(j, ispn));
+            }
+        }
+    }
+
+    /* k-points are converted one by one, so the peak memory grows only by the size of a single k-point */
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik = spl_num_kpoints_[ikloc];
+        kpoints_[ik]->initialize();
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            kpoints_[ik]->spinor_wave_functions().copy_from(device_t::CPU, ctx_.num_bands(),
+                                                            kpoints_float_[ik]->spinor_wave_functions(), ispn, 0,
+                                                            ispn, 0);
+        }
+        /* release the wave-functions and projectors in single precision */
+        kpoints_float_[ik] = std::unique_ptr<K_point<float>>(
+            new K_point<float>(ctx_, kpoints_[ik]->gkvec_shared(), kpoints_[ik]->weight()));
+    }
+    ctx_.print_memory_usage(__FILE__, __LINE__);
+#else
+    RTE_THROW("not compiled with FP32 support");
+#endif
+}
+
 template<class F>
 double bisection_search(F&& f, double a, double b, double tol, int maxstep=1000)
 {
@@ -548,86 +588,358 @@ void K_point_set::print_info()
     }
 }
 
-void K_point_set::save(std::string const& name__) const
+namespace {
+
+/// Wave-functions and band data of the k-point set, prepared for writing.
+template <typename T>
+struct wf_checkpoint
 {
-    if (ctx_.comm().rank() == 0) {
-        if (!utils::file_exists(name__)) {
-            HDF5_tree(name__, hdf5_access_t::truncate);
+    int num_bands{0};
+    int num_spins{0};
+    int num_spinors{0};
+    /* the following is stored for each k-point */
+    std::vector<vector3d<double>> vk;
+    std::vector<int> num_gkvec;
+    std::vector<mdarray<double, 2>> band_energies;
+    std::vector<mdarray<double, 2>> band_occupancies;
+    /// List of G+k vectors (only on rank 0).
+    std::vector<mdarray<int, 2>> gvec;
+    /// Offset of the local slab of G+k vectors.
+    std::vector<int> gkvec_offset;
+    /// Size of the local slab of G+k vectors; zero if the k-point is not stored on this rank.
+    std::vector<int> gkvec_count;
+    /// Local PW coefficients of all bands for each k-point and spin.
+    /** Point either to the wave-functions or, if the checkpoint is written in the background, to the staged copy. */
+    std::vector<std::complex<T> const*> wf;
+    /// Host copy of the local PW coefficients, which are written in the background.
+    std::vector<std::vector<std::complex<T>>> wf_staged;
+};
+
+/// Create a dataset; if the chunk size is given, the dataset is chunked.
+hid_t h5_create_dataset(hid_t loc__, std::string const& name__, hid_t type__, std::vector<hsize_t> const& dims__,
+                        std::vector<hsize_t> const& chunk__ = {})
+{
+    hid_t space = H5Screate_simple(static_cast<int>(dims__.size()), dims__.data(), nullptr);
+    hid_t dcpl  = H5Pcreate(H5P_DATASET_CREATE);
+    if (chunk__.size()) {
+        H5Pset_chunk(dcpl, static_cast<int>(chunk__.size()), chunk__.data());
+    }
+    hid_t id = H5Dcreate(loc__, name__.c_str(), type__, space, H5P_DEFAULT, dcpl, H5P_DEFAULT);
+    H5Pclose(dcpl);
+    H5Sclose(space);
+    if (id < 0) {
+        RTE_THROW("error in H5Dcreate(): " + name__);
+    }
+    return id;
+}
+
+/// Create a dataset and write it from a single rank; other ranks take part in the collective calls only.
+void h5_write_dataset(hid_t loc__, std::string const& name__, hid_t type__, std::vector<hsize_t> const& dims__,
+                      void const* data__, bool writer__, hid_t xfer__)
+{
+    hid_t id     = h5_create_dataset(loc__, name__, type__, dims__);
+    hid_t fspace = H5Dget_space(id);
+    hid_t mspace = H5Screate_simple(static_cast<int>(dims__.size()), dims__.data(), nullptr);
+    if (!writer__) {
+        H5Sselect_none(fspace);
+        H5Sselect_none(mspace);
+    }
+    double dummy{0};
+    if (H5Dwrite(id, type__, mspace, fspace, xfer__, writer__ ? data__ : &dummy) < 0) {
+        RTE_THROW("error in H5Dwrite(): " + name__);
+    }
+    H5Sclose(mspace);
+    H5Sclose(fspace);
+    H5Dclose(id);
+}
+
+/// Create the groups and datasets of the checkpoint and write band energies, occupancies and G+k vectors.
+template <typename T>
+void h5_create_layout(hid_t file__, wf_checkpoint<T> const& data__, bool writer__, hid_t xfer__)
+{
+    int nk = static_cast<int>(data__.vk.size());
+    hid_t gks = H5Gcreate(file__, "K_point_set", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+    h5_write_dataset(gks, "num_kpoints", H5T_NATIVE_INT, {1}, &nk, writer__, xfer__);
+    for (int ik = 0; ik < nk; ik++) {
+        hid_t gk = H5Gcreate(gks, std::to_string(ik).c_str(), H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        hsize_t nb  = data__.num_bands;
+        hsize_t ngk = data__.num_gkvec[ik];
+        h5_write_dataset(gk, "vk", H5T_NATIVE_DOUBLE, {3}, &data__.vk[ik][0], writer__, xfer__);
+        h5_write_dataset(gk, "band_energies", H5T_NATIVE_DOUBLE, {static_cast<hsize_t>(data__.num_spinors), nb},
+                         data__.band_energies[ik].at(memory_t::host), writer__, xfer__);
+        h5_write_dataset(gk, "band_occupancies", H5T_NATIVE_DOUBLE, {static_cast<hsize_t>(data__.num_spinors), nb},
+                         data__.band_occupancies[ik].at(memory_t::host), writer__, xfer__);
+        h5_write_dataset(gk, "gvec", H5T_NATIVE_INT, {ngk, 3},
+                         writer__ ? data__.gvec[ik].at(memory_t::host) : nullptr, writer__, xfer__);
+        /* one dataset of all bands per spin, chunked by blocks of bands of about 4M elements */
+        hid_t gwf = H5Gcreate(gk, "spinor_wave_functions", H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
+        hsize_t nbc = std::max(hsize_t(1), std::min(nb, hsize_t(1 << 22) / (2 * ngk)));
+        for (int ispn = 0; ispn < data__.num_spins; ispn++) {
+            H5Dclose(h5_create_dataset(gwf, std::to_string(ispn), hdf5_type_wrapper<T>::type_id(), {nb, ngk, 2},
+                                       {nbc, ngk, 2}));
         }
-        HDF5_tree fout(name__, hdf5_access_t::read_write);
-        fout.create_node("K_point_set");
-        fout["K_point_set"].write("num_kpoints", num_kpoints());
+        H5Gclose(gwf);
+        H5Gclose(gk);
     }
-    ctx_.comm().barrier();
+    H5Gclose(gks);
+}
+
+/// Write the local slabs of the wave-functions.
+/** If all_kpoints__ is true, all ranks call H5Dwrite() for every k-point (as required by the collective transfer);
+ *  ranks which do not store the k-point select nothing. */
+template <typename T>
+void h5_write_wave_functions(hid_t file__, wf_checkpoint<T> const& data__, bool all_kpoints__, hid_t xfer__)
+{
+    for (int ik = 0; ik < static_cast<int>(data__.vk.size()); ik++) {
+        int count = data__.gkvec_count[ik];
+        if (!count && !all_kpoints__) {
+            continue;
+        }
+        for (int ispn = 0; ispn < data__.num_spins; ispn++) {
+            std::string path = "/K_point_set/" + std::to_string(ik) + "/spinor_wave_functions/" +
+                               std::to_string(ispn);
+            hid_t id = H5Dopen(file__, path.c_str(), H5P_DEFAULT);
+            if (id < 0) {
+                RTE_THROW("error in H5Dopen(): " + path);
+            }
+            hid_t fspace = H5Dget_space(id);
+            std::array<hsize_t, 3> offs = {0, static_cast<hsize_t>(data__.gkvec_offset[ik]), 0};
+            std::array<hsize_t, 3> size = {static_cast<hsize_t>(data__.num_bands), static_cast<hsize_t>(count), 2};
+            hid_t mspace = H5Screate_simple(3, size.data(), nullptr);
+            if (count) {
+                H5Sselect_hyperslab(fspace, H5S_SELECT_SET, offs.data(), nullptr, size.data(), nullptr);
+            } else {
+                H5Sselect_none(fspace);
+                H5Sselect_none(mspace);
+            }
+            std::complex<T> dummy{0};
+            auto ptr = count ? data__.wf[ik * data__.num_spins + ispn] : &dummy;
+            if (H5Dwrite(id, hdf5_type_wrapper<T>::type_id(), mspace, fspace, xfer__, ptr) < 0) {
+                RTE_THROW("error in H5Dwrite(): " + path);
+            }
+            H5Sclose(mspace);
+            H5Sclose(fspace);
+            H5Dclose(id);
+        }
+    }
+}
+
+/// Write the checkpoint to a temporary file, which is renamed once the writing is completed.
+template <typename T>
+void write_wf_checkpoint(Communicator const& comm__, std::string const& name__, wf_checkpoint<T> const& data__)
+{
+    std::string tmp_name = name__ + ".tmp";
+#if defined(H5_HAVE_PARALLEL)
+    /* all ranks open the file and create the layout; PW coefficients are written with collective transfers */
+    hid_t fapl = H5Pcreate(H5P_FILE_ACCESS);
+    H5Pset_fapl_mpio(fapl, comm__.mpi_comm(), MPI_INFO_NULL);
+    hid_t file = H5Fcreate(tmp_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, fapl);
+    H5Pclose(fapl);
+    if (file < 0) {
+        RTE_THROW("error in H5Fcreate(): " + tmp_name);
+    }
+    hid_t xfer = H5Pcreate(H5P_DATASET_XFER);
+    H5Pset_dxpl_mpio(xfer, H5FD_MPIO_COLLECTIVE);
+    h5_create_layout(file, data__, comm__.rank() == 0, xfer);
+    h5_write_wave_functions(file, data__, true, xfer);
+    H5Pclose(xfer);
+    H5Fclose(file);
+#else
+    /* serial HDF5 library: rank 0 creates the layout, then ranks write their own slabs one after another */
+    if (comm__.rank() == 0) {
+        hid_t file = H5Fcreate(tmp_name.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+        if (file < 0) {
+            RTE_THROW("error in H5Fcreate(): " + tmp_name);
+        }
+        h5_create_layout(file, data__, true, H5P_DEFAULT);
+        H5Fclose(file);
+    }
+    for (int r = 0; r < comm__.size(); r++) {
+        comm__.barrier();
+        if (comm__.rank() == r) {
+            hid_t file = H5Fopen(tmp_name.c_str(), H5F_ACC_RDWR, H5P_DEFAULT);
+            if (file < 0) {
+                RTE_THROW("error in H5Fopen(): " + tmp_name);
+            }
+            h5_write_wave_functions(file, data__, false, H5P_DEFAULT);
+            H5Fclose(file);
+        }
+    }
+#endif
+    comm__.barrier();
+    if (comm__.rank() == 0) {
+        if (std::rename(tmp_name.c_str(), name__.c_str())) {
+            RTE_THROW("failed to rename " + tmp_name + " to " + name__);
+        }
+    }
+}
+
+} // namespace
+
+template <typename T>
+void K_point_set::save_impl(std::string const& name__, bool async__)
+{
+    auto data = std::make_shared<wf_checkpoint<T>>();
+
+    data->num_bands   = ctx_.num_bands();
+    data->num_spins   = ctx_.num_spins();
+    data->num_spinors = ctx_.num_spinors();
+
     for (int ik = 0; ik < num_kpoints(); ik++) {
-        /* check if this ranks stores the k-point */
-        if (ctx_.comm_k().rank() == spl_num_kpoints_.local_rank(ik)) {
-            this->get<double>(ik)->save(name__, ik);
+        auto kp = this->get<T>(ik);
+        data->vk.push_back(kp->vk());
+        data->num_gkvec.push_back(kp->num_gkvec());
+        mdarray<double, 2> e(ctx_.num_bands(), ctx_.num_spinors());
+        mdarray<double, 2> o(ctx_.num_bands(), ctx_.num_spinors());
+        for (int ispn = 0; ispn < ctx_.num_spinors(); ispn++) {
+            for (int j = 0; j < ctx_.num_bands(); j++) {
+                e(j, ispn) = kp->band_energy(j, ispn);
+                o(j, ispn) = kp->band_occupancy(j, ispn);
+            }
         }
-        /* wait for all */
-        ctx_.comm().barrier();
+        data->band_energies.push_back(std::move(e));
+        data->band_occupancies.push_back(std::move(o));
+        mdarray<int, 2> gv;
+        if (ctx_.comm().rank() == 0) {
+            gv = mdarray<int, 2>(3, kp->num_gkvec());
+            for (int i = 0; i < kp->num_gkvec(); i++) {
+                auto v = kp->gkvec().template gvec<index_domain_t::global>(i);
+                for (int x : {0, 1, 2}) {
+                    gv(x, i) = v[x];
+                }
+            }
+        }
+        data->gvec.push_back(std::move(gv));
+
+        bool local = ctx_.comm_k().rank() == spl_num_kpoints_.local_rank(ik);
+        int count  = local ? kp->gkvec().count() : 0;
+        data->gkvec_offset.push_back(local ? kp->gkvec().offset() : 0);
+        data->gkvec_count.push_back(count);
+        for (int ispn = 0; ispn < ctx_.num_spins(); ispn++) {
+            auto& pw = kp->spinor_wave_functions().pw_coeffs(ispn).prime();
+            /* the synchronous write goes directly from the wave-functions; the background thread needs a copy,
+               because the wave-functions change while the checkpoint is written */
+            if (!count || (!async__ && static_cast<int>(pw.size(0)) == count)) {
+                data->wf.push_back(count ? pw.at(memory_t::host) : nullptr);
+                continue;
+            }
+            std::vector<std::complex<T>> wf(static_cast<size_t>(count) * ctx_.num_bands());
+            for (int i = 0; i < ctx_.num_bands(); i++) {
+                auto ptr = pw.at(memory_t::host, 0, i);
+                std::copy(ptr, ptr + count, wf.begin() + static_cast<size_t>(i) * count);
+            }
+            data->wf.push_back(wf.data());
+            data->wf_staged.push_back(std::move(wf));
+        }
+    }
+
+    if (async__) {
+        /* the background thread uses its own communicator */
+        auto comm = ctx_.comm().duplicate();
+        /* exceptions can't leave the thread; they are stored and rethrown by save_wait() */
+        save_thread_ = std::thread([this, comm, name__, data]() {
+            try {
+                write_wf_checkpoint(comm, name__, *data);
+            } catch (...) {
+                save_error_ = std::current_exception();
+            }
+        });
+    } else {
+        write_wf_checkpoint(ctx_.comm(), name__, *data);
+    }
+}
+
+/** The following HDF5 data structure is created:
+  \verbatim
+  /K_point_set/num_kpoints
+  /K_point_set/ik/vk
+  /K_point_set/ik/band_energies                 [num_spinors][num_bands]
+  /K_point_set/ik/band_occupancies              [num_spinors][num_bands]
+  /K_point_set/ik/gvec                          [num_gkvec][3]
+  /K_point_set/ik/spinor_wave_functions/ispn    [num_bands][num_gkvec][2]
+  \endverbatim
+  Each rank writes its own slab of G+k vectors for all bands; with a parallel HDF5 library the slabs are written
+  with collective MPI-IO transfers, otherwise the ranks write one after another. The file is first written under
+  a temporary name, so that an interrupted write does not destroy the previous checkpoint.
+*/
+void K_point_set::save(std::string const& name__, bool async__)
+{
+    PROFILE("sirius::K_point_set::save");
+
+    /* only one checkpoint is written at a time */
+    save_wait();
+
+    if (use_fp32()) {
+#if defined(USE_FP32)
+        save_impl<float>(name__, async__);
+#endif
+    } else {
+        save_impl<double>(name__, async__);
     }
 }
 
 /// \todo check parameters of saved data in a separate function
-void K_point_set::load()
+template <typename T>
+bool K_point_set::load_impl(std::string const& name__)
 {
-    STOP();
-
-    //== HDF5_tree fin(storage_file_name, false);
-
-    //== int num_kpoints_in;
-    //== fin["K_point_set"].read("num_kpoints", &num_kpoints_in);
-
-    //== std::vector<int> ikidx(num_kpoints(), -1);
-    //== // read available k-points
-    //== double vk_in[3];
-    //== for (int jk = 0; jk < num_kpoints_in; jk++)
-    //== {
-    //==     fin["K_point_set"][jk].read("coordinates", vk_in, 3);
-    //==     for (int ik = 0; ik < num_kpoints(); ik++)
-    //==     {
-    //==         vector3d<double> dvk;
-    //==         for (int x = 0; x < 3; x++) dvk[x] = vk_in[x] - kpoints_[ik]->vk(x);
-    //==         if (dvk.length() < 1e-12)
-    //==         {
-    //==             ikidx[ik] = jk;
-    //==             break;
-    //==         }
-    //==     }
-    //== }
-
-    //== for (int ik = 0; ik < num_kpoints(); ik++)
-    //== {
-    //==     int rank = spl_num_kpoints_.local_rank(ik);
-    //==
-    //==     if (comm_.rank() == rank) kpoints_[ik]->load(fin["K_point_set"], ikidx[ik]);
-    //== }
+    HDF5_tree fin(name__, hdf5_access_t::read_only);
+
+    int num_kpoints_in;
+    fin["K_point_set"].read("num_kpoints", &num_kpoints_in, 1);
+
+    /* index of the current k-points in the file, which may contain a different set of k-points */
+    std::vector<int> ikidx(num_kpoints(), -1);
+    for (int jk = 0; jk < num_kpoints_in; jk++) {
+        vector3d<double> vk;
+        fin["K_point_set"][jk].read("vk", &vk[0], 3);
+        for (int ik = 0; ik < num_kpoints(); ik++) {
+            if ((vk - kpoints_[ik]->vk()).length() < 1e-10) {
+                ikidx[ik] = jk;
+                break;
+            }
+        }
+    }
+    for (int ik = 0; ik < num_kpoints(); ik++) {
+        if (ikidx[ik] == -1) {
+            ctx_.message(1, __func__, "k-point %i is not found in %s\n", ik, name__.c_str());
+            return false;
+        }
+    }
+
+    int ok{1};
+    for (int ikloc = 0; ikloc < spl_num_kpoints_.local_size(); ikloc++) {
+        int ik = spl_num_kpoints_[ikloc];
+        if (!this->get<T>(ik)->load(name__, ikidx[ik])) {
+            ok = 0;
+        }
+    }
+    comm().allreduce<int, mpi_op_t::min>(&ok, 1);
+    if (!ok) {
+        ctx_.message(1, __func__, "number of bands or spins in %s doesn't match\n", name__.c_str());
+        return false;
+    }
+    sync_band<T, sync_band_t::energy>();
+    sync_band<T, sync_band_t::occupancy>();
+
+    return true;
+}
+
+bool K_point_set::load(std::string const& name__)
+{
+    PROFILE("sirius::K_point_set::load");
+
+    if (!utils::file_exists(name__)) {
+        return false;
+    }
+
+    if (use_fp32()) {
+#if defined(USE_FP32)
+        return load_impl<float>(name__);
+#endif
+    }
+    return load_impl<double>(name__);
 }
 
-//== void K_point_set::save_wave_functions()
-//== {
-//==     if (Platform::mpi_rank() == 0)
-//==     {
-//==         HDF5_tree fout(storage_file_name, false);
-//==         fout["parameters"].write("num_kpoints", num_kpoints());
-//==         fout["parameters"].write("num_bands", ctx_.num_bands());
-//==         fout["parameters"].write("num_spins", ctx_.num_spins());
-//==     }
-//==
-//==     if (ctx_.mpi_grid().side(1 << _dim_k_ | 1 << _dim_col_))
-//==     {
-//==         for (int ik = 0; ik < num_kpoints(); ik++)
-//==         {
-//==             int rank = spl_num_kpoints_.location(_splindex_rank_, ik);
-//==
-//==             if (ctx_.mpi_grid().coordinate(_dim_k_) == rank) kpoints_[ik]->save_wave_functions(ik);
-//==
-//==             ctx_.mpi_grid().barrier(1 << _dim_k_ | 1 << _dim_col_);
-//==         }
-//==     }
-//== }
-//==
 //== void K_point_set::load_wave_functions()
 //== {
 //==     HDF5_tree fin(storage_file_name, false);
@@ -25,6 +25,9 @@
 #ifndef __K_POINT_SET_HPP__
 #define __K_POINT_SET_HPP__
 
+#include <exception>
+#include <iostream>
+#include <thread>
 #include "k_point.hpp"
 #include "dft/smearing.hpp"
 
@@ -48,18 +51,30 @@ class K_point_set
 
 #if defined(USE_FP32)
     /// List of k-points in fp32 type, most calculation and assertion in this class only rely on fp64 type kpoints_
+    /** The k-points in both precisions share the list of G+k vectors, but only the k-points of the precision in use
+     *  (see use_fp32()) are initialized and hold the wave-functions. */
     std::vector<std::unique_ptr<K_point<float>>> kpoints_float_;
 #endif
 
     /// Split index of k-points.
     splindex<splindex_t::chunk> spl_num_kpoints_;
 
+    /// Background thread, which writes the wave-functions in the asynchronous mode of save().
+    std::thread save_thread_;
+
+    /// Exception thrown by the background thread; rethrown by save_wait().
+    std::exception_ptr save_error_;
+
     /// Fermi energy which is searched in find_band_occupancies().
     double energy_fermi_{0};
 
     /// Band gap found by find_band_occupancies().
     double band_gap_{0};
 
+    /// Number of iterative solver steps for each k-point in the last call to Band::solve().
+    /** The values are summed over the k-point communicator only if the SCF performance log is enabled. */
+    std::vector<int> num_itsol_steps_;
+
     /// Copy constuctor is not allowed.
     K_point_set(K_point_set& src) = delete;
 
@@ -75,6 +90,15 @@ class K_point_set
     /// Return entropy contribution from smearing store in Kpoint<T>.
     template <typename T>
     double entropy_sum() const;
+
+    /// Stage the wave-functions of a given precision and write them to the HDF5 file.
+    template <typename T>
+    void save_impl(std::string const& name__, bool async__);
+
+    /// Load the wave-functions and band data of a given precision.
+    template <typename T>
+    bool load_impl(std::string const& name__);
+
   public:
     /// Create empty k-point set.
     K_point_set(Simulation_context& ctx__)
@@ -105,6 +129,16 @@ class K_point_set
     {
     }
 
+    ~K_point_set()
+    {
+        /* destructor must not throw */
+        try {
+            save_wait();
+        } catch (std::exception const& e) {
+            std::cerr << "asynchronous save of the k-point set failed: " << e.what() << std::endl;
+        }
+    }
+
     /// Initialize the k-point set
     void initialize(std::vector<int> const& counts = {});
 
@@ -120,9 +154,28 @@ class K_point_set
     void print_info();
 
     /// Save k-point set to HDF5 file.
-    void save(std::string const& name__) const;
+    /** In the synchronous mode the wave-functions are written directly. In the asynchronous mode they are copied to
+     *  a host buffer and written by a background thread, while the calculation continues. */
+    void save(std::string const& name__, bool async__ = false);
+
+    /// Wait until the asynchronous save is completed.
+    /** The exception thrown by the background thread is rethrown here. */
+    void save_wait()
+    {
+        if (save_thread_.joinable()) {
+            save_thread_.join();
+        }
+        if (save_error_) {
+            auto e      = save_error_;
+            save_error_ = nullptr;
+            std::rethrow_exception(e);
+        }
+    }
 
-    void load();
+    /// Load band energies, occupancies and wave-functions saved by save().
+    /** K-points are matched by their coordinates and the PW coefficients are remapped to the current distribution
+     *  of the G+k vectors. Returns false if the file doesn't exist or doesn't match the current k-point set. */
+    bool load(std::string const& name__);
 
     /// Return sum of valence eigen-values.
     double valence_eval_sum() const;
@@ -130,16 +183,32 @@ class K_point_set
     /// Return entropy contribution from smearing.
     double entropy_sum() const;
 
+    /// True if the wave-functions are stored in single precision.
+    bool use_fp32() const
+    {
+#if defined(USE_FP32)
+        return ctx_.cfg().parameters().precision_wf() == "fp32";
+#else
+        return false;
+#endif
+    }
+
+    /// Switch the k-points from single to double precision.
+    void fp32_to_fp64();
+
     /// Update k-points after moving atoms or changing the lattice vectors.
     void update()
     {
         /* update k-points */
         for (int ikloc = 0; ikloc < spl_num_kpoints().local_size(); ikloc++) {
             int ik = spl_num_kpoints(ikloc);
-            kpoints_[ik]->update();
 #if defined(USE_FP32)
-            kpoints_float_[ik]->update();
+            if (use_fp32()) {
+                kpoints_float_[ik]->update();
+                continue;
+            }
 #endif
+            kpoints_[ik]->update();
         }
     }
 
@@ -164,7 +233,8 @@ class K_point_set
     {
         kpoints_.push_back(std::unique_ptr<K_point<double>>(new K_point<double>(ctx_, vk__, weight__)));
 #ifdef USE_FP32
-        kpoints_float_.push_back(std::unique_ptr<K_point<float>>(new K_point<float>(ctx_, vk__, weight__)));
+        kpoints_float_.push_back(std::unique_ptr<K_point<float>>(
+            new K_point<float>(ctx_, kpoints_.back()->gkvec_shared(), weight__)));
 #endif
     }
 
@@ -211,6 +281,16 @@ class K_point_set
         return band_gap_;
     }
 
+    inline std::vector<int> const& num_itsol_steps() const
+    {
+        return num_itsol_steps_;
+    }
+
+    inline std::vector<int>& num_itsol_steps()
+    {
+        return num_itsol_steps_;
+    }
+
     /// Find index of k-point.
     inline int find_kpoint(vector3d<double> vk__)
     {
@@ -102,13 +102,13 @@ class Anderson : public Mixer<FUNCS...>
             }
         }
 
-        // Set up the next x_{n+1} = x_n.
+        // Set up the residual part of the update f_n - (delta F) * h.
         // Can't use this->output_history_[idx_step + 1] directly here,
         // as it's still used when history is full.
-        this->copy(this->output_history_[idx_step], this->input_);
+        this->copy(this->residual_history_[idx_step], this->input_);
 
-        // + beta * f_n
-        this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+        bool invertible{false};
+        sddk::mdarray<double, 1> h;
 
         if (history_size > 0) {
             // Compute the difference residual[step] - residual[step - 1]
@@ -135,7 +135,7 @@ class Anderson : public Mixer<FUNCS...>
                 for (int j = 0; j < history_size; ++j)
                     this->S_factorized_(j, i) = this->S_(j, i);
 
-            sddk::mdarray<double, 1> h(history_size);
+            h = sddk::mdarray<double, 1>(history_size);
             for (int i = 1; i <= history_size; ++i) {
                 auto j = this->idx_hist(this->step_ - i);
                 h(history_size - i) = this->template inner_product<normalize>(
@@ -144,25 +144,32 @@ class Anderson : public Mixer<FUNCS...>
                 );
             }
 
-            bool invertible = sddk::linalg(sddk::linalg_t::lapack).sysolve(history_size, this->S_factorized_, h);
+            invertible = sddk::linalg(sddk::linalg_t::lapack).sysolve(history_size, this->S_factorized_, h);
 
             if (invertible) {
-                // - beta * (delta F) * h
+                // - (delta F) * h
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-this->beta_ * h(history_size - i), this->residual_history_[j], this->input_);
-                }
-
-                // - (delta X) * h
-                for (int i = 1; i <= history_size; ++i) {
-                    auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-h(history_size - i), this->output_history_[j], this->input_);
+                    this->axpy(-h(history_size - i), this->residual_history_[j], this->input_);
                 }
             } else {
                 this->history_size_ = 0;
             }
         }
 
+        // x_{n+1} = x_n + beta * P (f_n - (delta F) * h)
+        this->precondition(this->input_);
+        this->scale(this->beta_, this->input_);
+        this->axpy(1.0, this->output_history_[idx_step], this->input_);
+
+        if (invertible) {
+            // - (delta X) * h
+            for (int i = 1; i <= history_size; ++i) {
+                auto j = this->idx_hist(this->step_ - i);
+                this->axpy(-h(history_size - i), this->output_history_[j], this->input_);
+            }
+        }
+
         // In case history is full, set S_[1:end-1,1:end-1] .= S_[2:end,2:end]
         if (this->history_size_ == this->max_history_ - 1) {
             for (int col = 0; col <= history_size - 2; ++col) {
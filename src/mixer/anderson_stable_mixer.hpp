@@ -91,13 +91,12 @@ class Anderson_stable : public Mixer<FUNCS...>
 
         // TODO: beta scaling?
 
-        // Set up the next x_{n+1} = x_n.
+        // Set up the residual part of the update f_n - Q * h.
         // Can't use this->output_history_[idx_step + 1] directly here,
         // as it's still used when history is full.
-        this->copy(this->output_history_[idx_step], this->input_);
+        this->copy(this->residual_history_[idx_step], this->input_);
 
-        // + beta * f_n
-        this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+        sddk::mdarray<double, 1> k;
 
         if (history_size > 0) {
             // Compute the difference residual[step] - residual[step - 1]
@@ -153,7 +152,7 @@ class Anderson_stable : public Mixer<FUNCS...>
                 }
 
                 // next compute k = R⁻¹ * h... just do that by hand for now, can dispatch to blas later.
-                sddk::mdarray<double, 1> k(history_size);
+                k = sddk::mdarray<double, 1>(history_size);
                 for (int i = 0; i < history_size; ++i) {
                     k[i] = h[i];
                 }
@@ -165,16 +164,10 @@ class Anderson_stable : public Mixer<FUNCS...>
                     }
                 }
 
-                // - beta * Q * h
+                // - Q * h
                 for (int i = 1; i <= history_size; ++i) {
                     auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-this->beta_ * h(history_size - i), this->residual_history_[j], this->input_);
-                }
-
-                // - (delta X) k
-                for (int i = 1; i <= history_size; ++i) {
-                    auto j = this->idx_hist(this->step_ - i);
-                    this->axpy(-k(history_size - i), this->output_history_[j], this->input_);
+                    this->axpy(-h(history_size - i), this->residual_history_[j], this->input_);
                 }
             } else {
                 // In the unlikely event of a breakdown when exactly
@@ -184,6 +177,18 @@ class Anderson_stable : public Mixer<FUNCS...>
             }
         }
 
+        // x_{n+1} = x_n + beta * P (f_n - Q * h)
+        this->precondition(this->input_);
+        this->scale(this->beta_, this->input_);
+        this->axpy(1.0, this->output_history_[idx_step], this->input_);
+
+        // - (delta X) k
+        int nk = static_cast<int>(k.size());
+        for (int i = 1; i <= nk; ++i) {
+            auto j = this->idx_hist(this->step_ - i);
+            this->axpy(-k(nk - i), this->output_history_[j], this->input_);
+        }
+
         // When the history is full, drop the first column.
         // Basically we have delta F = [q1 Q2] * [r11 R12; O R22]
         // and we apply a couple rotations to make [R12; R22] upper triangular again
@@ -222,7 +227,7 @@ class Anderson_stable : public Mixer<FUNCS...>
             for (int i = 1; i <= history_size - 1; ++i) {
                 int i1 = this->idx_hist(this->step_ - i - 1);
                 int i2 = this->idx_hist(this->step_ - i);
-                std::swap(this->residual_history_[i2], this->residual_history_[i1]);
+                std::swap(this->residual_history_[i2].get(), this->residual_history_[i1].get());
             }
 
             // Delete last row and first column of R.
@@ -87,6 +87,8 @@ namespace mixer {
  * \f[
  *     x_{n+1} = x_n + \beta f_n - \sum_{i=1}^{n-1}\alpha_i \beta \Delta f_i - \sum_{i=1}^{n-1}\alpha_i\Delta x_i.
  * \f]
+ * With a preconditioner \f$ P \f$ the initial guess is \f$ G_1 = -\beta P \f$, i.e. \f$ P \f$ is applied to the
+ * residual part of the update.
  * Finally, we store the vectors \f$ f_1, \cdots, f_n \f$ and \f$ x_1, \dots, x_n \f$ and update the Gram-matrix
  * \f$ S_{ij} = f_i^*f_j \f$ in every iteration. The \f$ \alpha_i \f$ coefficients can be easily computed from
  * \f$ S \f$.
@@ -145,32 +147,43 @@ class Broyden2 : public Mixer<FUNCS...>
             this->gamma_(n - i) /= this->S_(n - i + 1, n - i + 1) - this->S_(n - i + 1, n - i) - this->S_(n - i, n - i + 1) + this->S_(n - i, n - i);
         }
 
-        this->copy(this->output_history_[idx_step], this->input_);
+        // Residual part of the update; it is multiplied by beta * P.
+        this->copy(this->residual_history_[idx_step], this->input_);
 
         if (n > 0) {
+            // last vec is special
+            this->scale(this->gamma_(n - 1) + 1, this->input_);
+
             // first vec is special
             {
                 int j = this->idx_hist(this->step_ - n);
-                this->axpy(-this->beta_ * this->gamma_(0), this->residual_history_[j], this->input_);
-                this->axpy(-this->gamma_(0), this->output_history_[j], this->input_);
+                this->axpy(-this->gamma_(0), this->residual_history_[j], this->input_);
             }
 
             for (int i = 1; i < n; ++i) {
                 auto coeff = this->gamma_(n - i - 1) - this->gamma_(n - i);
                 int j = this->idx_hist(this->step_ - i);
-                this->axpy(this->beta_ * coeff, this->residual_history_[j], this->input_);
-                this->axpy(coeff, this->output_history_[j], this->input_);
+                this->axpy(coeff, this->residual_history_[j], this->input_);
             }
+        }
 
-            // last vec is special.
+        this->precondition(this->input_);
+        this->scale(this->beta_, this->input_);
+        this->axpy(1.0, this->output_history_[idx_step], this->input_);
+
+        if (n > 0) {
             {
-                int j = this->idx_hist(this->step_);
-                this->axpy(this->beta_ * (this->gamma_(n - 1) + 1), this->residual_history_[j], this->input_);
-                this->axpy(this->gamma_(n - 1), this->output_history_[j], this->input_);
+                int j = this->idx_hist(this->step_ - n);
+                this->axpy(-this->gamma_(0), this->output_history_[j], this->input_);
             }
-        } else {
-            // Linear mixing step.
-            this->axpy(this->beta_, this->residual_history_[idx_step], this->input_);
+
+            for (int i = 1; i < n; ++i) {
+                auto coeff = this->gamma_(n - i - 1) - this->gamma_(n - i);
+                int j = this->idx_hist(this->step_ - i);
+                this->axpy(coeff, this->output_history_[j], this->input_);
+            }
+
+            this->axpy(this->gamma_(n - 1), this->output_history_[idx_step], this->input_);
         }
 
         this->copy(this->input_, this->output_history_[idx_next_step]);
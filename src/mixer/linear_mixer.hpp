@@ -53,9 +53,11 @@ class Linear : public Mixer<FUNCS...>
     {
         const auto idx = this->idx_hist(this->step_ + 1);
 
-        this->copy(this->input_, this->output_history_[idx]);
+        /* x_{n+1} = x_n + beta * P f_n */
+        this->copy(this->residual_history_[this->idx_hist(this->step_)], this->output_history_[idx]);
+        this->precondition(this->output_history_[idx]);
         this->scale(beta_, this->output_history_[idx]);
-        this->axpy(1.0 - beta_, this->output_history_[this->idx_hist(this->step_)], this->output_history_[idx]);
+        this->axpy(1.0, this->output_history_[this->idx_hist(this->step_)], this->output_history_[idx]);
     }
 
   private:
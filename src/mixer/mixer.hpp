@@ -34,6 +34,7 @@
 #include <stdexcept>
 #include <cmath>
 #include <numeric>
+#include "mixer/mixer_history.hpp"
 
 namespace sirius {
 namespace mixer {
@@ -41,7 +42,10 @@ namespace mixer {
 /// Describes operations on a function type used for mixing.
 /** The properties contain functions, which determine the behaviour of a given type during mixing. The inner product
  * function result is used for calculating mixing parameters. If a function should not contribute to generation of
- * mixing parameters, the inner product function should always return 0.
+ * mixing parameters, the inner product function should always return 0. The optional preconditioner is applied
+ * to the residual part of the update (the one multiplied by the mixing parameter beta); by default it is the
+ * identity. The optional local data function exposes the raw values of the object, which allows the mixer to keep
+ * the history of this function in a reduced-precision or compressed form.
  */
 template <typename FUNC>
 struct FunctionProperties
@@ -55,19 +59,23 @@ struct FunctionProperties
      *  \param [in]  scal_         Function, which scales the input (x = alpha * x).
      *  \param [in]  copy_         Function, which copies from one object to the other (y = x).
      *  \param [in]  axpy_         Function, which scales and adds one object to the other (y = alpha * x + y).
+     *  \param [in]  rotate_       Function, which applies a Givens rotation to two objects.
+     *  \param [in]  precondition_ Function, which applies a preconditioner to the residual (x = P x).
      */
     FunctionProperties(std::function<double(const FUNC&)> size_,
                        std::function<double(const FUNC&, const FUNC&)> inner_,
                        std::function<void(double, FUNC&)> scal_,
                        std::function<void(const FUNC&, FUNC&)> copy_,
                        std::function<void(double, const FUNC&, FUNC&)> axpy_,
-                       std::function<void(double, double, FUNC&, FUNC&)> rotate_)
+                       std::function<void(double, double, FUNC&, FUNC&)> rotate_,
+                       std::function<void(FUNC&)> precondition_ = [](FUNC&) -> void {})
         : size(size_)
         , inner(inner_)
         , scal(scal_)
         , copy(copy_)
         , axpy(axpy_)
         , rotate(rotate_)
+        , precondition(precondition_)
     {
     }
 
@@ -78,6 +86,7 @@ struct FunctionProperties
         , copy([](const FUNC&, FUNC&) -> void {})
         , axpy([](double, const FUNC&, FUNC&) -> void {})
         , rotate([](double, double, FUNC&, FUNC&) -> void {})
+        , precondition([](FUNC&) -> void {})
     {
     }
 
@@ -98,6 +107,12 @@ struct FunctionProperties
 
     // rotate function [x y] * [c -s; s c]
     std::function<void(double, double, FUNC&, FUNC&)> rotate;
+
+    // preconditioner of the residual. x = P x
+    std::function<void(FUNC&)> precondition;
+
+    // local data of the object as a list of contiguous arrays; not set if the history can't be packed.
+    std::function<local_data_t(FUNC&)> local_data;
 };
 
 // Implementation of templated recursive calls through tuples
@@ -266,6 +281,31 @@ struct Rotate<0, FUNCS...>
     }
 };
 
+template <std::size_t FUNC_REVERSE_INDEX, typename... FUNCS>
+struct Precondition
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        if (std::get<FUNC_REVERSE_INDEX>(x)) {
+            std::get<FUNC_REVERSE_INDEX>(function_prop).precondition(*std::get<FUNC_REVERSE_INDEX>(x));
+        }
+        Precondition<FUNC_REVERSE_INDEX - 1, FUNCS...>::apply(function_prop, x);
+    }
+};
+
+template <typename... FUNCS>
+struct Precondition<0, FUNCS...>
+{
+    static void apply(const std::tuple<FunctionProperties<FUNCS>...>& function_prop,
+                      std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        if (std::get<0>(x)) {
+            std::get<0>(function_prop).precondition(*std::get<0>(x));
+        }
+    }
+};
+
 } // namespace mixer_impl
 
 /// Abstract mixer for variadic number of Function objects, which are described by FunctionProperties.
@@ -288,8 +328,9 @@ class Mixer
         : step_(0)
         , max_history_(max_history)
         , rmse_history_(max_history)
-        , output_history_(max_history)
-        , residual_history_(max_history)
+        , history_(2 * max_history)
+        , output_history_(history_, 0)
+        , residual_history_(history_, max_history)
     {
     }
 
@@ -319,18 +360,28 @@ class Mixer
         std::get<FUNC_INDEX>(input_).reset(
             new typename std::tuple_element<FUNC_INDEX, std::tuple<FUNCS...>>::type(args...));
 
-        for (std::size_t i = 0; i < max_history_; ++i) {
-            std::get<FUNC_INDEX>(output_history_[i])
-                .reset(new typename std::tuple_element<FUNC_INDEX, std::tuple<FUNCS...>>::type(args...));
-            std::get<FUNC_INDEX>(residual_history_[i])
-                .reset(new typename std::tuple_element<FUNC_INDEX, std::tuple<FUNCS...>>::type(args...));
-        }
+        history_.template initialize_function<FUNC_INDEX,
+                                              typename std::tuple_element<FUNC_INDEX, std::tuple<FUNCS...>>::type>(
+            function_prop.local_data, args...);
 
         // initialize output and input with given initial value
-        std::get<FUNC_INDEX>(functions_).copy(init_value, *std::get<FUNC_INDEX>(output_history_[0]));
+        std::get<FUNC_INDEX>(functions_).copy(init_value, *std::get<FUNC_INDEX>(output_history_[0].get()));
         std::get<FUNC_INDEX>(functions_).copy(init_value, *std::get<FUNC_INDEX>(input_));
     }
 
+    /// Set the storage format of the history. Must be called before the functions are initialized.
+    /** The mixing coefficients are always computed in double precision from the expanded functions. */
+    void history_storage(history_storage_t storage__)
+    {
+        history_.storage(storage__);
+    }
+
+    /// Size of the packed history in bytes.
+    std::size_t history_packed_size() const
+    {
+        return history_.packed_size();
+    }
+
     /// Set input for next mixing step
     /** \param [in]  input   Input functions, for which a copy operation is invoked.
      */
@@ -351,10 +402,11 @@ class Mixer
     void get_output(typename std::tuple_element<FUNC_INDEX, std::tuple<FUNCS...>>::type& output)
     {
         const auto idx = idx_hist(step_);
-        if (!std::get<FUNC_INDEX>(output_history_[idx])) {
+        auto out = output_history_[idx];
+        if (!std::get<FUNC_INDEX>(out.get())) {
             throw std::runtime_error("Mixer function not initialized!");
         }
-        std::get<FUNC_INDEX>(functions_).copy(*std::get<FUNC_INDEX>(output_history_[idx]), output);
+        std::get<FUNC_INDEX>(functions_).copy(*std::get<FUNC_INDEX>(out.get()), output);
     }
 
     /// Mix input and stored history. Returns the root mean square error computed by inner products of residuals.
@@ -363,6 +415,11 @@ class Mixer
      */
     double mix(double rms_min__)
     {
+        /* current output and residual and the next output are not rounded in the packed history; the previous
+           output and residual were stored exactly in the previous step and are rounded only after the mixer
+           has used them */
+        history_.exact({idx_hist(step_), max_history_ + idx_hist(step_), idx_hist(step_ + 1)});
+
         this->update_residual();
         this->update_rms();
         double rmse = rmse_history_[idx_hist(step_)];
@@ -432,6 +489,11 @@ class Mixer
         mixer_impl::Rotate<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, c, s, x, y);
     }
 
+    void precondition(std::tuple<std::unique_ptr<FUNCS>...>& x)
+    {
+        mixer_impl::Precondition<sizeof...(FUNCS) - 1, FUNCS...>::apply(functions_, x);
+    }
+
     // Strictly increasing counter, indicating the number of mixing steps
     std::size_t step_;
 
@@ -447,11 +509,14 @@ class Mixer
     // Input storage for next mixing step
     std::tuple<std::unique_ptr<FUNCS>...> input_;
 
+    // Storage of the output and residual histories
+    History<FUNCS...> history_;
+
     // The history of generated mixer outputs. The last generated output is at step_.
-    std::vector<std::tuple<std::unique_ptr<FUNCS>...>> output_history_;
+    History_view<FUNCS...> output_history_;
 
     // The residual history between input and output
-    std::vector<std::tuple<std::unique_ptr<FUNCS>...>> residual_history_;
+    History_view<FUNCS...> residual_history_;
 };
 } // namespace mixer
 } // namespace sirius
@@ -59,6 +59,7 @@ inline std::unique_ptr<Mixer<FUNCS...>> Mixer_factory(config_t::mixer_t const& m
     } else {
         TERMINATE("wrong type of mixer");
     }
+    mixer->history_storage(get_history_storage_t(mix_cfg.history_storage()));
     return mixer;
 }
 
@@ -128,8 +128,22 @@ FunctionProperties<Periodic_function<double>> periodic_function_property()
         }
     };
 
-    return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function, rotate_function);
+    auto local_data_func = [](Periodic_function<double>& x) -> local_data_t
+    {
+        local_data_t result;
+        result.push_back(std::make_pair(x.f_rg().at(memory_t::host), x.f_rg().size()));
+        if (x.ctx().full_potential()) {
+            for (int ialoc = 0; ialoc < x.ctx().unit_cell().spl_num_atoms().local_size(); ialoc++) {
+                result.push_back(std::make_pair(x.f_mt(ialoc).at(memory_t::host), x.f_mt(ialoc).size()));
+            }
+        }
+        return result;
+    };
+
+    FunctionProperties<Periodic_function<double>> result(global_size_func, inner_prod_func, scal_function,
+                                                         copy_function, axpy_function, rotate_function);
+    result.local_data = local_data_func;
+    return result;
 }
 
 FunctionProperties<Periodic_function<double>> periodic_function_property_modified(bool use_coarse_gvec__)
@@ -262,8 +276,24 @@ FunctionProperties<Periodic_function<double>> periodic_function_property_modifie
         }
     };
 
-    return FunctionProperties<Periodic_function<double>>(global_size_func, inner_prod_func, scal_function, copy_function,
-                                                         axpy_function, rotate_function);
+    auto local_data_func = [](Periodic_function<double>& x) -> local_data_t
+    {
+        local_data_t result;
+        result.push_back(std::make_pair(x.f_rg().at(memory_t::host), x.f_rg().size()));
+        result.push_back(std::make_pair(reinterpret_cast<double*>(x.f_pw_local().at(memory_t::host)),
+                                        2 * x.f_pw_local().size()));
+        if (x.ctx().full_potential()) {
+            for (int ialoc = 0; ialoc < x.ctx().unit_cell().spl_num_atoms().local_size(); ialoc++) {
+                result.push_back(std::make_pair(x.f_mt(ialoc).at(memory_t::host), x.f_mt(ialoc).size()));
+            }
+        }
+        return result;
+    };
+
+    FunctionProperties<Periodic_function<double>> result(global_size_func, inner_prod_func, scal_function,
+                                                         copy_function, axpy_function, rotate_function);
+    result.local_data = local_data_func;
+    return result;
 }
 
 FunctionProperties<sddk::mdarray<double_complex, 4>> density_function_property()
@@ -309,8 +339,15 @@ FunctionProperties<sddk::mdarray<double_complex, 4>> density_function_property()
         }
     };
 
-    return FunctionProperties<sddk::mdarray<double_complex, 4>>(global_size_func, inner_prod_func, scal_function,
+    auto local_data_func = [](mdarray<double_complex, 4>& x) -> local_data_t
+    {
+        return local_data_t({std::make_pair(reinterpret_cast<double*>(x.at(memory_t::host)), 2 * x.size())});
+    };
+
+    FunctionProperties<sddk::mdarray<double_complex, 4>> result(global_size_func, inner_prod_func, scal_function,
                                                                 copy_function, axpy_function, rotate_function);
+    result.local_data = local_data_func;
+    return result;
 }
 
 FunctionProperties<paw_density> paw_density_function_property()
@@ -369,8 +406,22 @@ FunctionProperties<paw_density> paw_density_function_property()
         }
     };
 
-    return FunctionProperties<paw_density>(global_size_func, inner_prod_func, scale_func, copy_function,
+    auto local_data_func = [](paw_density& x) -> local_data_t
+    {
+        local_data_t result;
+        for (int i = 0; i < x.ctx().unit_cell().spl_num_paw_atoms().local_size(); i++) {
+            for (int j = 0; j < x.ctx().num_mag_dims() + 1; j++) {
+                result.push_back(std::make_pair(x.ae_density(j, i).at(memory_t::host), x.ae_density(j, i).size()));
+                result.push_back(std::make_pair(x.ps_density(j, i).at(memory_t::host), x.ps_density(j, i).size()));
+            }
+        }
+        return result;
+    };
+
+    FunctionProperties<paw_density> result(global_size_func, inner_prod_func, scale_func, copy_function,
                                            axpy_function, rotate_function);
+    result.local_data = local_data_func;
+    return result;
 }
 
 FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property()
@@ -450,6 +501,23 @@ FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property()
     return FunctionProperties<Hubbard_matrix>(global_size_func, inner_prod_func, scale_func, copy_func, axpy_func,
                                               rotate_func);
 }
+
+std::function<void(Periodic_function<double>&)> kerker_preconditioner(double q0__, double min_weight__)
+{
+    return [q0__, min_weight__](Periodic_function<double>& x) -> void
+    {
+        auto& gv = x.ctx().gvec();
+        double q02 = q0__ * q0__;
+        /* transform residual to plane-wave domain */
+        x.fft_transform(-1);
+        #pragma omp parallel for schedule(static)
+        for (int igloc = gv.skip_g0(); igloc < gv.count(); igloc++) {
+            double q2 = std::pow(gv.gvec_len<index_domain_t::local>(igloc), 2);
+            x.f_pw_local(igloc) *= std::max(min_weight__, q2 / (q2 + q02));
+        }
+        x.fft_transform(1);
+    };
+}
 } // namespace mixer
 
 } // namespace sirius
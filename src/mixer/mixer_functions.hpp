@@ -45,6 +45,11 @@ FunctionProperties<paw_density> paw_density_function_property();
 
 FunctionProperties<Hubbard_matrix> hubbard_matrix_function_property();
 
+/// Kerker preconditioner for the residual of the charge density.
+/** Plane-wave components of the residual are multiplied by \f$ \max(w_{min}, q^2 / (q^2 + q_0^2)) \f$; the
+ *  \f$ {\bf G} = 0 \f$ component is not changed. This damps the long-wavelength charge sloshing in metals. */
+std::function<void(Periodic_function<double>&)> kerker_preconditioner(double q0__, double min_weight__);
+
 } // namespace mixer
 
 } // namespace sirius
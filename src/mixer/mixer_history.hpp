@@ -0,0 +1,550 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file mixer_history.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::mixer::History class.
+ */
+
+#ifndef __MIXER_HISTORY_HPP__
+#define __MIXER_HISTORY_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace sirius {
+namespace mixer {
+
+/// Storage format of the mixer history.
+enum class history_storage_t
+{
+    /// Full copies of the functions.
+    fp64,
+    /// Values are rounded to single precision.
+    fp32,
+    /// Values are compressed without loss of precision.
+    lossless
+};
+
+inline history_storage_t get_history_storage_t(std::string name__)
+{
+    if (name__ == "fp64") {
+        return history_storage_t::fp64;
+    } else if (name__ == "fp32") {
+        return history_storage_t::fp32;
+    } else if (name__ == "lossless") {
+        return history_storage_t::lossless;
+    }
+    throw std::runtime_error("[sirius::mixer::get_history_storage_t] wrong type of history storage: " + name__);
+}
+
+/// List of contiguous arrays, which hold the local data of a function.
+using local_data_t = std::vector<std::pair<double*, std::size_t>>;
+
+/// Packed copy of the local data of one function.
+/** In the lossless mode each value is XOR-ed with the previous one and only the significant low-order bytes of
+ *  the difference are stored, preceded by a 4-bit byte count. Smooth functions share the sign, exponent and
+ *  leading mantissa bits of the neighbouring values, and zero-padded arrays collapse to half a byte per value.
+ *  The data is split into independent blocks, which are encoded in parallel. */
+class Packed_function
+{
+  private:
+    /// Number of values in one block of the lossless encoding.
+    static const std::size_t block_size = 1 << 14;
+
+    /// Format of the stored data.
+    history_storage_t storage_{history_storage_t::fp64};
+
+    /// Total number of packed values; zero if nothing was stored yet.
+    std::size_t size_{0};
+
+    /// Values in double precision.
+    std::vector<double> values64_;
+
+    /// Values in single precision.
+    std::vector<float> values32_;
+
+    /// Encoded blocks of the lossless mode.
+    std::vector<std::vector<uint8_t>> blocks_;
+
+    /// Split the local data into the blocks of the lossless encoding: (array, offset, length).
+    static std::vector<std::tuple<int, std::size_t, std::size_t>> split(local_data_t const& data__)
+    {
+        std::vector<std::tuple<int, std::size_t, std::size_t>> result;
+        for (int i = 0; i < static_cast<int>(data__.size()); i++) {
+            for (std::size_t ofs = 0; ofs < data__[i].second; ofs += block_size) {
+                result.push_back(std::make_tuple(i, ofs, (data__[i].second - ofs < block_size) ? data__[i].second - ofs : block_size));
+            }
+        }
+        return result;
+    }
+
+    static void encode(double const* x__, std::size_t n__, std::vector<uint8_t>& out__)
+    {
+        out__.clear();
+        out__.reserve(n__ * 4);
+        uint64_t prev{0};
+        std::size_t pos{0};
+        for (std::size_t i = 0; i < n__; i++) {
+            uint64_t b;
+            std::memcpy(&b, &x__[i], sizeof(double));
+            uint64_t d = b ^ prev;
+            prev = b;
+            int nb{0};
+            while (nb < 8 && (d >> (8 * nb))) {
+                nb++;
+            }
+            /* two byte counts share one header byte */
+            if (i % 2 == 0) {
+                pos = out__.size();
+                out__.push_back(static_cast<uint8_t>(nb));
+            } else {
+                out__[pos] |= static_cast<uint8_t>(nb << 4);
+            }
+            for (int k = 0; k < nb; k++) {
+                out__.push_back(static_cast<uint8_t>(d >> (8 * k)));
+            }
+        }
+        out__.shrink_to_fit();
+    }
+
+    static void decode(std::vector<uint8_t> const& in__, double* x__, std::size_t n__)
+    {
+        uint64_t prev{0};
+        std::size_t pos{0};
+        int hdr{0};
+        for (std::size_t i = 0; i < n__; i++) {
+            if (i % 2 == 0) {
+                hdr = in__[pos++];
+            }
+            int nb = (i % 2 == 0) ? (hdr & 0xF) : (hdr >> 4);
+            uint64_t d{0};
+            for (int k = 0; k < nb; k++) {
+                d |= static_cast<uint64_t>(in__[pos++]) << (8 * k);
+            }
+            prev ^= d;
+            std::memcpy(&x__[i], &prev, sizeof(double));
+        }
+    }
+
+  public:
+    /// Store the local data in a given format.
+    void pack(history_storage_t storage__, local_data_t const& data__)
+    {
+        storage_ = storage__;
+        size_    = 0;
+        for (auto& e : data__) {
+            size_ += e.second;
+        }
+        /* release the storage of the previous format */
+        if (storage_ != history_storage_t::fp64) {
+            std::vector<double>().swap(values64_);
+        }
+        if (storage_ != history_storage_t::fp32) {
+            std::vector<float>().swap(values32_);
+        }
+        if (storage_ != history_storage_t::lossless) {
+            std::vector<std::vector<uint8_t>>().swap(blocks_);
+        }
+        switch (storage_) {
+            case history_storage_t::fp64: {
+                values64_.resize(size_);
+                std::size_t ofs{0};
+                for (auto& e : data__) {
+                    std::copy(e.first, e.first + e.second, values64_.begin() + ofs);
+                    ofs += e.second;
+                }
+                break;
+            }
+            case history_storage_t::fp32: {
+                values32_.resize(size_);
+                std::size_t ofs{0};
+                for (auto& e : data__) {
+                    #pragma omp parallel for schedule(static)
+                    for (std::size_t i = 0; i < e.second; i++) {
+                        values32_[ofs + i] = static_cast<float>(e.first[i]);
+                    }
+                    ofs += e.second;
+                }
+                break;
+            }
+            case history_storage_t::lossless: {
+                auto blk = split(data__);
+                blocks_.resize(blk.size());
+                #pragma omp parallel for schedule(dynamic)
+                for (int ib = 0; ib < static_cast<int>(blk.size()); ib++) {
+                    encode(data__[std::get<0>(blk[ib])].first + std::get<1>(blk[ib]), std::get<2>(blk[ib]),
+                           blocks_[ib]);
+                }
+                break;
+            }
+        }
+    }
+
+    /// Restore the local data. Functions which were never stored are set to zero.
+    void unpack(local_data_t const& data__) const
+    {
+        std::size_t size{0};
+        for (auto& e : data__) {
+            size += e.second;
+        }
+        if (size_ == 0) {
+            for (auto& e : data__) {
+                std::fill(e.first, e.first + e.second, 0.0);
+            }
+            return;
+        }
+        if (size != size_) {
+            throw std::runtime_error("[sirius::mixer::Packed_function::unpack] wrong size of the function");
+        }
+        switch (storage_) {
+            case history_storage_t::fp64: {
+                std::size_t ofs{0};
+                for (auto& e : data__) {
+                    std::copy(values64_.begin() + ofs, values64_.begin() + ofs + e.second, e.first);
+                    ofs += e.second;
+                }
+                break;
+            }
+            case history_storage_t::fp32: {
+                std::size_t ofs{0};
+                for (auto& e : data__) {
+                    #pragma omp parallel for schedule(static)
+                    for (std::size_t i = 0; i < e.second; i++) {
+                        e.first[i] = values32_[ofs + i];
+                    }
+                    ofs += e.second;
+                }
+                break;
+            }
+            case history_storage_t::lossless: {
+                auto blk = split(data__);
+                #pragma omp parallel for schedule(dynamic)
+                for (int ib = 0; ib < static_cast<int>(blk.size()); ib++) {
+                    decode(blocks_[ib], data__[std::get<0>(blk[ib])].first + std::get<1>(blk[ib]),
+                           std::get<2>(blk[ib]));
+                }
+                break;
+            }
+        }
+    }
+
+    /// Release the packed data.
+    void clear()
+    {
+        size_ = 0;
+        std::vector<double>().swap(values64_);
+        std::vector<float>().swap(values32_);
+        std::vector<std::vector<uint8_t>>().swap(blocks_);
+    }
+
+    /// Size of the packed data in bytes.
+    std::size_t packed_size() const
+    {
+        std::size_t result = values64_.size() * sizeof(double) + values32_.size() * sizeof(float);
+        for (auto& b : blocks_) {
+            result += b.size();
+        }
+        return result;
+    }
+};
+
+/// History of the mixed functions.
+/** In the fp64 mode each history slot holds full copies of the functions. Otherwise only the functions, for
+ *  which the local data is exposed by FunctionProperties::local_data, are kept packed in the slots, while a
+ *  small cache of full function objects is used to access them: the slot is expanded into the least recently
+ *  used cache entry on access (the packed copy is released) and packed back when the entry is reused. The
+ *  remaining functions are moved between the slot and the cache entry without copy. The mixing algorithms
+ *  therefore see ordinary function objects. The access returns a History::Slot, which pins the cache entry while
+ *  it is alive; the operations of the mixers involve at most two history slots at a time and an access to a third
+ *  slot while two entries are pinned is an error.
+ */
+template <typename... FUNCS>
+class History
+{
+  public:
+    using value_type = std::tuple<std::unique_ptr<FUNCS>...>;
+
+    /// Functions of a history slot.
+    /** The cache entry holding the slot is not reused while the object is alive. The object converts to the
+     *  reference to the functions and can be passed directly to the operations of the mixer; a temporary object
+     *  pins the entry until the end of the full expression. */
+    class Slot
+    {
+      private:
+        /// Pin counter of the cache entry or nullptr if the slot is not cached.
+        int* pin_{nullptr};
+
+        value_type* value_{nullptr};
+
+      public:
+        Slot(value_type& value__, int* pin__)
+            : pin_(pin__)
+            , value_(&value__)
+        {
+            if (pin_) {
+                (*pin_)++;
+            }
+        }
+
+        Slot(Slot&& src__)
+            : pin_(src__.pin_)
+            , value_(src__.value_)
+        {
+            src__.pin_ = nullptr;
+        }
+
+        Slot(Slot const&) = delete;
+
+        Slot& operator=(Slot const&) = delete;
+
+        ~Slot()
+        {
+            if (pin_) {
+                (*pin_)--;
+            }
+        }
+
+        operator value_type&() const
+        {
+            return *value_;
+        }
+
+        value_type& get() const
+        {
+            return *value_;
+        }
+    };
+
+  private:
+    using packed_type = std::array<Packed_function, sizeof...(FUNCS)>;
+
+    using move_func_type = std::function<void(value_type&, packed_type&, value_type&, history_storage_t)>;
+
+    /// Number of cache entries.
+    static const int cache_size = 2;
+
+    history_storage_t storage_{history_storage_t::fp64};
+
+    /// Full functions of each slot.
+    std::vector<value_type> slots_;
+
+    /// Packed functions of each slot.
+    std::vector<packed_type> packed_;
+
+    /// Cache of the expanded slots.
+    std::array<value_type, cache_size> cache_;
+
+    /// Slot stored in the cache entry or -1.
+    std::array<int, cache_size> cache_slot_;
+
+    /// True if the slot has to be stored without loss of precision.
+    std::vector<bool> exact_;
+
+    /// Time of the last access to the cache entry.
+    std::array<std::size_t, cache_size> cache_time_;
+
+    /// Number of History::Slot objects, which use the cache entry.
+    std::array<int, cache_size> pin_;
+
+    std::size_t time_{0};
+
+    /// Move the function from the slot to the cache entry (expand) or back (store).
+    std::array<move_func_type, sizeof...(FUNCS)> expand_;
+    std::array<move_func_type, sizeof...(FUNCS)> store_;
+
+    bool initialized_{false};
+
+    void evict(int k__)
+    {
+        if (cache_slot_[k__] >= 0) {
+            int slot = cache_slot_[k__];
+            /* exact slots are kept in double precision, unless the compression is lossless anyway */
+            auto storage = (exact_[slot] && storage_ == history_storage_t::fp32) ? history_storage_t::fp64 : storage_;
+            for (std::size_t i = 0; i < sizeof...(FUNCS); i++) {
+                if (store_[i]) {
+                    store_[i](slots_[slot], packed_[slot], cache_[k__], storage);
+                }
+            }
+            cache_slot_[k__] = -1;
+        }
+    }
+
+  public:
+    History(std::size_t size__)
+        : slots_(size__)
+        , packed_(size__)
+        , exact_(size__, false)
+    {
+        cache_slot_.fill(-1);
+        cache_time_.fill(0);
+        pin_.fill(0);
+    }
+
+    /// Set the storage format. Must be called before the functions are initialized.
+    void storage(history_storage_t storage__)
+    {
+        if (initialized_) {
+            throw std::runtime_error("[sirius::mixer::History::storage] functions are already initialized");
+        }
+        storage_ = storage__;
+    }
+
+    history_storage_t storage() const
+    {
+        return storage_;
+    }
+
+    /// Set the list of slots, which are stored without loss of precision.
+    /** The slots holding the current iterate and residual must be exact, otherwise the rounding error of the
+     *  stored values and not of their differences limits the attainable accuracy. The cached slots are stored
+     *  with the previous list; the new list is applied the next time a slot is stored. A slot, which is removed
+     *  from the list, therefore keeps its exact values until it is accessed again. */
+    void exact(std::vector<std::size_t> const& slots__)
+    {
+        for (int k = 0; k < cache_size; k++) {
+            if (pin_[k]) {
+                throw std::runtime_error("[sirius::mixer::History::exact] history slot is in use");
+            }
+            evict(k);
+        }
+        std::fill(exact_.begin(), exact_.end(), false);
+        for (auto i : slots__) {
+            exact_[i] = true;
+        }
+    }
+
+    /// Create function objects of a given index with "args" passed to the constructor.
+    template <std::size_t FUNC_INDEX, typename FUNC, typename... ARGS>
+    void initialize_function(std::function<local_data_t(FUNC&)> local_data__, ARGS&&... args)
+    {
+        initialized_ = true;
+        for (int k = 0; k < cache_size; k++) {
+            evict(k);
+        }
+        if (storage_ != history_storage_t::fp64 && local_data__) {
+            for (int k = 0; k < cache_size; k++) {
+                std::get<FUNC_INDEX>(cache_[k]).reset(new FUNC(args...));
+            }
+            expand_[FUNC_INDEX] = [local_data__](value_type&, packed_type& p__, value_type& c__, history_storage_t) {
+                p__[FUNC_INDEX].unpack(local_data__(*std::get<FUNC_INDEX>(c__)));
+                /* the slot is packed again when the cache entry is reused */
+                p__[FUNC_INDEX].clear();
+            };
+            store_[FUNC_INDEX] = [local_data__](value_type&, packed_type& p__, value_type& c__,
+                                                history_storage_t storage__) {
+                p__[FUNC_INDEX].pack(storage__, local_data__(*std::get<FUNC_INDEX>(c__)));
+            };
+        } else {
+            for (auto& s : slots_) {
+                std::get<FUNC_INDEX>(s).reset(new FUNC(args...));
+            }
+            if (storage_ != history_storage_t::fp64) {
+                expand_[FUNC_INDEX] = [](value_type& s__, packed_type&, value_type& c__, history_storage_t) {
+                    std::swap(std::get<FUNC_INDEX>(s__), std::get<FUNC_INDEX>(c__));
+                };
+                store_[FUNC_INDEX] = expand_[FUNC_INDEX];
+            }
+        }
+    }
+
+    /// Access functions of a given slot.
+    Slot operator[](std::size_t slot__)
+    {
+        if (storage_ == history_storage_t::fp64) {
+            return Slot(slots_[slot__], nullptr);
+        }
+        int slot = static_cast<int>(slot__);
+        int k{-1};
+        for (int i = 0; i < cache_size; i++) {
+            if (cache_slot_[i] == slot) {
+                k = i;
+            }
+        }
+        if (k < 0) {
+            /* take the least recently used entry, which is not in use */
+            for (int i = 0; i < cache_size; i++) {
+                if (!pin_[i] && (k < 0 || cache_time_[i] < cache_time_[k])) {
+                    k = i;
+                }
+            }
+            if (k < 0) {
+                throw std::runtime_error("[sirius::mixer::History] more than " + std::to_string(cache_size) +
+                                         " history slots are in use");
+            }
+            evict(k);
+            for (std::size_t i = 0; i < sizeof...(FUNCS); i++) {
+                if (expand_[i]) {
+                    expand_[i](slots_[slot], packed_[slot], cache_[k], storage_);
+                }
+            }
+            cache_slot_[k] = slot;
+        }
+        cache_time_[k] = ++time_;
+        return Slot(cache_[k], &pin_[k]);
+    }
+
+    /// Size of the packed data in bytes.
+    std::size_t packed_size() const
+    {
+        std::size_t result{0};
+        for (auto& p : packed_) {
+            for (auto& e : p) {
+                result += e.packed_size();
+            }
+        }
+        return result;
+    }
+};
+
+/// Contiguous range of the history slots.
+template <typename... FUNCS>
+class History_view
+{
+  private:
+    History<FUNCS...>& history_;
+
+    std::size_t offset_;
+
+  public:
+    History_view(History<FUNCS...>& history__, std::size_t offset__)
+        : history_(history__)
+        , offset_(offset__)
+    {
+    }
+
+    typename History<FUNCS...>::Slot operator[](std::size_t i__)
+    {
+        return history_[offset_ + i__];
+    }
+};
+
+} // namespace mixer
+} // namespace sirius
+
+#endif // __MIXER_HISTORY_HPP__
@@ -23,7 +23,9 @@
  *
  */
 
+#include <sstream>
 #include "communicator.hpp"
+#include "utils/profiler.hpp"
 
 namespace sddk {
 
@@ -93,6 +95,131 @@ int get_device_id(int num_devices__)
     return id;
 }
 
+void mpi_stat::add(char const* op__, MPI_Comm comm__, double bytes__, double time__, double wait__)
+{
+    std::array<std::string, 3> key = {op__, Communicator::name(comm__), ::utils::profiler_regions::current()};
+
+    std::lock_guard<std::mutex> lock(mutex());
+    auto& e = data()[key];
+    e.count++;
+    e.bytes += bytes__;
+    e.time += time__;
+    e.wait += wait__;
+}
+
+void mpi_stat::collect(Communicator const& comm__)
+{
+    if (level() == 0) {
+        return;
+    }
+    /* serialize local statistics; fields are separated by tabulation */
+    std::stringstream s;
+    {
+        std::lock_guard<std::mutex> lock(mutex());
+        s.precision(17);
+        for (auto& e : data()) {
+            s << e.first[0] << "\t" << e.first[1] << "\t" << e.first[2] << "\t" << e.second.count << "\t"
+              << e.second.bytes << "\t" << e.second.time << "\t" << e.second.wait << "\n";
+        }
+    }
+    auto str = s.str();
+
+    /* raw MPI calls are used here to keep the collection out of the statistics */
+    int len = static_cast<int>(str.size());
+    std::vector<int> counts(comm__.size());
+    std::vector<int> offsets(comm__.size(), 0);
+    CALL_MPI(MPI_Gather, (&len, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, comm__.mpi_comm()));
+    for (int i = 1; i < comm__.size(); i++) {
+        offsets[i] = offsets[i - 1] + counts[i - 1];
+    }
+    std::vector<char> buf(offsets.back() + counts.back() + 1);
+    CALL_MPI(MPI_Gatherv, (str.data(), len, MPI_CHAR, buf.data(), counts.data(), offsets.data(), MPI_CHAR, 0,
+                           comm__.mpi_comm()));
+
+    summaries_().clear();
+    if (comm__.rank() != 0) {
+        return;
+    }
+
+    std::map<std::array<std::string, 3>, summary> result;
+    std::stringstream in(std::string(buf.data(), buf.size() - 1));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::array<std::string, 7> f;
+        std::stringstream ls(line);
+        for (auto& e : f) {
+            std::getline(ls, e, '\t');
+        }
+        auto& r    = result[{f[0], f[1], f[2]}];
+        r.op       = f[0];
+        r.comm     = f[1];
+        r.region   = f[2];
+        double t   = std::stod(f[5]);
+        double w   = std::stod(f[6]);
+        r.num_ranks++;
+        r.count += std::stoll(f[3]);
+        r.bytes += std::stod(f[4]);
+        r.time_avg += t;
+        r.time_max = std::max(r.time_max, t);
+        r.wait_avg += w;
+        r.wait_max = std::max(r.wait_max, w);
+    }
+    for (auto& e : result) {
+        e.second.time_avg /= e.second.num_ranks;
+        e.second.wait_avg /= e.second.num_ranks;
+        summaries_().push_back(e.second);
+    }
+    std::sort(summaries_().begin(), summaries_().end(),
+              [](summary const& a, summary const& b) { return a.time_max > b.time_max; });
+}
+
+std::string mpi_stat::print()
+{
+    std::stringstream s;
+    if (summaries().empty()) {
+        return s.str();
+    }
+    char str[1024];
+    s << "MPI statistics (time and wait are avg / max over ranks, wait is spent before the slowest rank arrives)\n";
+    std::snprintf(str, sizeof(str), "%-16s %-20s %8s %12s %10s %10s %10s %10s  %s\n", "operation", "communicator",
+                  "ranks", "calls", "MB", "time avg", "time max", "wait max", "region");
+    s << str;
+    for (auto& e : summaries()) {
+        std::snprintf(str, sizeof(str), "%-16s %-20s %8i %12lli %10.2f %10.4f %10.4f %10.4f  %s\n", e.op.c_str(),
+                      e.comm.c_str(), e.num_ranks, e.count, e.bytes / (1 << 20), e.time_avg, e.time_max, e.wait_max,
+                      e.region.c_str());
+        s << str;
+    }
+    return s.str();
+}
+
+std::string mpi_stat::json()
+{
+    auto quote = [](std::string const& str__) {
+        std::string r("\"");
+        for (char c : str__) {
+            if (c == '"' || c == '\\') {
+                r += '\\';
+            }
+            r += c;
+        }
+        return r + "\"";
+    };
+
+    std::stringstream s;
+    s.precision(12);
+    s << "[";
+    for (size_t i = 0; i < summaries().size(); i++) {
+        auto& e = summaries()[i];
+        s << (i ? "," : "") << "{\"op\":" << quote(e.op) << ",\"comm\":" << quote(e.comm)
+          << ",\"region\":" << quote(e.region) << ",\"num_ranks\":" << e.num_ranks << ",\"count\":" << e.count
+          << ",\"bytes\":" << e.bytes << ",\"time_avg\":" << e.time_avg << ",\"time_max\":" << e.time_max
+          << ",\"wait_avg\":" << e.wait_avg << ",\"wait_max\":" << e.wait_max << "}";
+    }
+    s << "]";
+    return s.str();
+}
+
 void sddk::pstdout::printf(const char* fmt, ...)
 {
     std::vector<char> str(1024); // assume that one printf will not output more than this
@@ -36,6 +36,10 @@
 #include <cstring>
 #include <cstdio>
 #include <map>
+#include <array>
+#include <string>
+#include <mutex>
+#include "utils/env.hpp"
 
 namespace sddk {
 
@@ -235,6 +239,137 @@ struct block_data_descriptor
     }
 };
 
+class Communicator;
+
+/// Statistics of MPI calls.
+/** The instrumentation is switched on by the environment variable SIRIUS_MPI_STAT. At the level 1 the number of
+ *  calls, the number of bytes and the time spent in the call are accumulated for each operation, communicator and
+ *  the innermost PROFILE region. At the level 2 each collective operation is additionally preceded by a barrier;
+ *  the time spent in the barrier is the time the rank waits for the slowest rank to arrive (load imbalance).
+ *  The number of bytes is the size of the send buffer of the rank (receive buffer for the receive operations). */
+class mpi_stat
+{
+  public:
+    /// Accumulated statistics of one rank.
+    struct entry
+    {
+        long long count{0};
+        double bytes{0};
+        double time{0};
+        double wait{0};
+    };
+
+    /// Statistics aggregated over ranks.
+    struct summary
+    {
+        std::string op;
+        std::string comm;
+        std::string region;
+        int num_ranks{0};
+        long long count{0};
+        double bytes{0};
+        double time_avg{0};
+        double time_max{0};
+        double wait_avg{0};
+        double wait_max{0};
+    };
+
+  private:
+    static std::map<std::array<std::string, 3>, entry>& data()
+    {
+        static std::map<std::array<std::string, 3>, entry> data_;
+        return data_;
+    }
+
+    static std::vector<summary>& summaries_()
+    {
+        static std::vector<summary> s;
+        return s;
+    }
+
+    static std::mutex& mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+
+  public:
+    /// Instrumentation level taken from the environment variable SIRIUS_MPI_STAT.
+    static int level()
+    {
+        static int level_ = []() {
+            auto val = utils::get_env<int>("SIRIUS_MPI_STAT");
+            return val ? *val : 0;
+        }();
+        return level_;
+    }
+
+    /// Add the measurement of a single call.
+    static void add(char const* op__, MPI_Comm comm__, double bytes__, double time__, double wait__);
+
+    /// Aggregate statistics of all ranks of the communicator on its rank 0.
+    /** This is a collective operation. The result is kept and can be accessed after MPI is finalized. */
+    static void collect(Communicator const& comm__);
+
+    /// Statistics aggregated by the last call to collect().
+    static std::vector<summary> const& summaries()
+    {
+        return summaries_();
+    }
+
+    /// Table of the aggregated statistics.
+    static std::string print();
+
+    /// JSON representation of the aggregated statistics.
+    static std::string json();
+};
+
+/// Measure a single MPI call for the lifetime of the object.
+/** Nested calls (communicator methods implemented through other methods) are accounted only once. */
+class mpi_call_stat
+{
+  private:
+    char const* op_{nullptr};
+    MPI_Comm comm_{MPI_COMM_NULL};
+    double bytes_{0};
+    double wait_{0};
+    double t0_{0};
+
+    static int& depth()
+    {
+        static thread_local int depth_{0};
+        return depth_;
+    }
+
+  public:
+    mpi_call_stat(char const* op__, MPI_Comm comm__, double bytes__, bool collective__)
+    {
+        if (mpi_stat::level() == 0 || depth()++) {
+            return;
+        }
+        op_    = op__;
+        comm_  = comm__;
+        bytes_ = bytes__;
+        if (collective__ && mpi_stat::level() > 1) {
+            double t = MPI_Wtime();
+            MPI_Barrier(comm__);
+            wait_ = MPI_Wtime() - t;
+        }
+        t0_ = MPI_Wtime();
+    }
+
+    ~mpi_call_stat()
+    {
+        if (mpi_stat::level() == 0) {
+            return;
+        }
+        depth()--;
+        if (op_) {
+            mpi_stat::add(op_, comm_, bytes_, MPI_Wtime() - t0_, wait_);
+        }
+    }
+};
+
 class Request
 {
   private:
@@ -277,6 +412,32 @@ class Communicator
     /// Smart pointer to allocated MPI communicator.
     std::shared_ptr<MPI_Comm> mpi_comm_;
 
+    /// Total number of elements sent to all ranks (only computed when MPI statistics is collected).
+    double stat_count(int const* counts__) const
+    {
+        double n{0};
+        if (mpi_stat::level()) {
+            for (int i = 0; i < size(); i++) {
+                n += counts__[i];
+            }
+        }
+        return n;
+    }
+
+    /// Total number of bytes sent to all ranks (only computed when MPI statistics is collected).
+    double stat_bytes(int const* counts__, MPI_Datatype const* types__) const
+    {
+        double n{0};
+        if (mpi_stat::level()) {
+            for (int i = 0; i < size(); i++) {
+                int sz;
+                MPI_Type_size(types__[i], &sz);
+                n += static_cast<double>(counts__[i]) * sz;
+            }
+        }
+        return n;
+    }
+
   public:
     /// Default constructor.
     Communicator()
@@ -365,6 +526,17 @@ class Communicator
         return new_comm;
     }
 
+    /// Split communicator into the groups of ranks which can access the shared memory of a node.
+    inline Communicator split_shared() const
+    {
+        Communicator new_comm;
+        new_comm.mpi_comm_ = std::shared_ptr<MPI_Comm>(new MPI_Comm, mpi_comm_deleter());
+        CALL_MPI(MPI_Comm_split_type,
+                 (mpi_comm(), MPI_COMM_TYPE_SHARED, rank(), MPI_INFO_NULL, new_comm.mpi_comm_.get()));
+        new_comm.mpi_comm_raw_ = *new_comm.mpi_comm_;
+        return new_comm;
+    }
+
     inline Communicator duplicate() const
     {
         Communicator new_comm;
@@ -445,18 +617,46 @@ class Communicator
         return (mpi_comm_raw_ == MPI_COMM_NULL);
     }
 
+    /// Set the name of the communicator; the name is used to label the MPI statistics.
+    inline void set_name(std::string const& name__) const
+    {
+        CALL_MPI(MPI_Comm_set_name, (mpi_comm(), name__.c_str()));
+    }
+
+    /// Name of the communicator.
+    inline std::string name() const
+    {
+        return name(mpi_comm());
+    }
+
+    /// Name of the raw MPI communicator or its size if the name is not set.
+    static std::string name(MPI_Comm comm__)
+    {
+        char str[MPI_MAX_OBJECT_NAME];
+        int len{0};
+        MPI_Comm_get_name(comm__, str, &len);
+        if (len) {
+            return std::string(str, len);
+        }
+        int sz;
+        MPI_Comm_size(comm__, &sz);
+        return "comm(size=" + std::to_string(sz) + ")";
+    }
+
     inline void barrier() const
     {
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Barrier");
 #endif
         assert(mpi_comm() != MPI_COMM_NULL);
+        mpi_call_stat stat("MPI_Barrier", mpi_comm(), 0, false);
         CALL_MPI(MPI_Barrier, (mpi_comm()));
     }
 
     template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
     inline void reduce(T* buffer__, int count__, int root__) const
     {
+        mpi_call_stat stat("MPI_Reduce", mpi_comm(), sizeof(T) * double(count__), true);
         if (root__ == rank()) {
             CALL_MPI(MPI_Reduce, (MPI_IN_PLACE, buffer__, count__, mpi_type_wrapper<T>::kind(),
                                   mpi_op_wrapper<mpi_op__>::kind(), root__, mpi_comm()));
@@ -469,6 +669,7 @@ class Communicator
     template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
     inline void reduce(T* buffer__, int count__, int root__, MPI_Request* req__) const
     {
+        mpi_call_stat stat("MPI_Ireduce", mpi_comm(), sizeof(T) * double(count__), false);
         if (root__ == rank()) {
             CALL_MPI(MPI_Ireduce, (MPI_IN_PLACE, buffer__, count__, mpi_type_wrapper<T>::kind(),
                                    mpi_op_wrapper<mpi_op__>::kind(), root__, mpi_comm(), req__));
@@ -481,6 +682,7 @@ class Communicator
     template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
     void reduce(T const* sendbuf__, T* recvbuf__, int count__, int root__) const
     {
+        mpi_call_stat stat("MPI_Reduce", mpi_comm(), sizeof(T) * double(count__), true);
         CALL_MPI(MPI_Reduce, (sendbuf__, recvbuf__, count__, mpi_type_wrapper<T>::kind(),
                               mpi_op_wrapper<mpi_op__>::kind(), root__, mpi_comm()));
     }
@@ -488,6 +690,7 @@ class Communicator
     template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
     void reduce(T const* sendbuf__, T* recvbuf__, int count__, int root__, MPI_Request* req__) const
     {
+        mpi_call_stat stat("MPI_Ireduce", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Ireduce, (sendbuf__, recvbuf__, count__, mpi_type_wrapper<T>::kind(),
                                mpi_op_wrapper<mpi_op__>::kind(), root__, mpi_comm(), req__));
     }
@@ -496,6 +699,7 @@ class Communicator
     template <typename T, mpi_op_t mpi_op__ = mpi_op_t::sum>
     inline void allreduce(T* buffer__, int count__) const
     {
+        mpi_call_stat stat("MPI_Allreduce", mpi_comm(), sizeof(T) * double(count__), true);
         CALL_MPI(MPI_Allreduce, (MPI_IN_PLACE, buffer__, count__, mpi_type_wrapper<T>::kind(),
                                  mpi_op_wrapper<mpi_op__>::kind(), mpi_comm()));
     }
@@ -513,6 +717,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Iallreduce");
 #endif
+        mpi_call_stat stat("MPI_Iallreduce", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Iallreduce, (MPI_IN_PLACE, buffer__, count__, mpi_type_wrapper<T>::kind(),
                                   mpi_op_wrapper<mpi_op__>::kind(), mpi_comm(), req__));
     }
@@ -524,6 +729,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Bcast");
 #endif
+        mpi_call_stat stat("MPI_Bcast", mpi_comm(), sizeof(T) * double(count__), true);
         CALL_MPI(MPI_Bcast, (buffer__, count__, mpi_type_wrapper<T>::kind(), root__, mpi_comm()));
     }
 
@@ -551,6 +757,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Allgatherv");
 #endif
+        mpi_call_stat stat("MPI_Allgatherv", mpi_comm(), sizeof(T) * double(recvcounts__[rank()]), true);
         CALL_MPI(MPI_Allgatherv, (MPI_IN_PLACE, 0, MPI_DATATYPE_NULL, buffer__, recvcounts__, displs__,
                                   mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
@@ -563,6 +770,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Allgatherv");
 #endif
+        mpi_call_stat stat("MPI_Allgatherv", mpi_comm(), sizeof(T) * double(sendcount__), true);
         CALL_MPI(MPI_Allgatherv, (sendbuf__, sendcount__, mpi_type_wrapper<T>::kind(), recvbuf__, recvcounts__,
                                   displs__, mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
@@ -571,6 +779,7 @@ class Communicator
     void
     allgather(T const* sendbuf__, T* recvbuf__, int count__, int displs__) const
     {
+        mpi_call_stat stat("MPI_Allgatherv", mpi_comm(), sizeof(T) * double(count__), true);
         std::vector<int> v(size() * 2);
         v[2 * rank()]     = count__;
         v[2 * rank() + 1] = displs__;
@@ -595,6 +804,7 @@ class Communicator
     void
     allgather(T* buffer__, int count__, int displs__) const
     {
+        mpi_call_stat stat("MPI_Allgatherv", mpi_comm(), sizeof(T) * double(count__), true);
         std::vector<int> v(size() * 2);
         v[2 * rank()]     = count__;
         v[2 * rank() + 1] = displs__;
@@ -618,6 +828,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Send");
 #endif
+        mpi_call_stat stat("MPI_Send", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Send, (buffer__, count__, mpi_type_wrapper<T>::kind(), dest__, tag__, mpi_comm()));
     }
 
@@ -628,6 +839,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Isend");
 #endif
+        mpi_call_stat stat("MPI_Isend", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Isend, (buffer__, count__, mpi_type_wrapper<T>::kind(), dest__, tag__, mpi_comm(), &req.handler()));
         return req;
     }
@@ -638,6 +850,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Recv");
 #endif
+        mpi_call_stat stat("MPI_Recv", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Recv,
                  (buffer__, count__, mpi_type_wrapper<T>::kind(), source__, tag__, mpi_comm(), MPI_STATUS_IGNORE));
     }
@@ -649,6 +862,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Irecv");
 #endif
+        mpi_call_stat stat("MPI_Irecv", mpi_comm(), sizeof(T) * double(count__), false);
         CALL_MPI(MPI_Irecv, (buffer__, count__, mpi_type_wrapper<T>::kind(), source__, tag__, mpi_comm(), &req.handler()));
         return req;
     }
@@ -661,6 +875,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Gatherv");
 #endif
+        mpi_call_stat stat("MPI_Gatherv", mpi_comm(), sizeof(T) * double(sendcount), true);
         CALL_MPI(MPI_Gatherv, (sendbuf__, sendcount, mpi_type_wrapper<T>::kind(), recvbuf__, recvcounts__, displs__,
                                mpi_type_wrapper<T>::kind(), root__, mpi_comm()));
     }
@@ -673,6 +888,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Gatherv");
 #endif
+        mpi_call_stat stat("MPI_Gatherv", mpi_comm(), sizeof(T) * double(count__), true);
         std::vector<int> v(size() * 2);
         v[2 * rank()]     = count__;
         v[2 * rank() + 1] = offset__;
@@ -698,6 +914,7 @@ class Communicator
         PROFILE("MPI_Scatterv");
 #endif
         int recvcount = sendcounts__[rank()];
+        mpi_call_stat stat("MPI_Scatterv", mpi_comm(), sizeof(T) * double(recvcount), true);
         CALL_MPI(MPI_Scatterv, (sendbuf__, sendcounts__, displs__, mpi_type_wrapper<T>::kind(), recvbuf__, recvcount,
                                 mpi_type_wrapper<T>::kind(), root__, mpi_comm()));
     }
@@ -708,6 +925,7 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Alltoall");
 #endif
+        mpi_call_stat stat("MPI_Alltoall", mpi_comm(), sizeof(T) * double(sendcounts__) * size(), true);
         CALL_MPI(MPI_Alltoall, (sendbuf__, sendcounts__, mpi_type_wrapper<T>::kind(), recvbuf__, recvcounts__,
                                 mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
@@ -719,9 +937,43 @@ class Communicator
 #if defined(__PROFILE_MPI)
         PROFILE("MPI_Alltoallv");
 #endif
+        mpi_call_stat stat("MPI_Alltoallv", mpi_comm(), sizeof(T) * stat_count(sendcounts__), true);
         CALL_MPI(MPI_Alltoallv, (sendbuf__, sendcounts__, sdispls__, mpi_type_wrapper<T>::kind(), recvbuf__,
                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm()));
     }
+
+    /// Non-blocking version of alltoallv.
+    template <typename T>
+    void ialltoall(T const* sendbuf__, int const* sendcounts__, int const* sdispls__, T* recvbuf__,
+                   int const* recvcounts__, int const* rdispls__, MPI_Request* req__) const
+    {
+        mpi_call_stat stat("MPI_Ialltoallv", mpi_comm(), sizeof(T) * stat_count(sendcounts__), false);
+        CALL_MPI(MPI_Ialltoallv, (sendbuf__, sendcounts__, sdispls__, mpi_type_wrapper<T>::kind(), recvbuf__,
+                                  recvcounts__, rdispls__, mpi_type_wrapper<T>::kind(), mpi_comm(), req__));
+    }
+
+    /// Alltoall with individual datatypes for each rank; displacements are in bytes.
+    void alltoall(void const* sendbuf__, int const* sendcounts__, int const* sdispls__, MPI_Datatype const* sendtypes__,
+                  void* recvbuf__, int const* recvcounts__, int const* rdispls__,
+                  MPI_Datatype const* recvtypes__) const
+    {
+#if defined(__PROFILE_MPI)
+        PROFILE("MPI_Alltoallw");
+#endif
+        mpi_call_stat stat("MPI_Alltoallw", mpi_comm(), stat_bytes(sendcounts__, sendtypes__), true);
+        CALL_MPI(MPI_Alltoallw, (sendbuf__, sendcounts__, sdispls__, sendtypes__, recvbuf__, recvcounts__, rdispls__,
+                                 recvtypes__, mpi_comm()));
+    }
+
+    /// Non-blocking version of alltoallw.
+    void ialltoall(void const* sendbuf__, int const* sendcounts__, int const* sdispls__,
+                   MPI_Datatype const* sendtypes__, void* recvbuf__, int const* recvcounts__, int const* rdispls__,
+                   MPI_Datatype const* recvtypes__, MPI_Request* req__) const
+    {
+        mpi_call_stat stat("MPI_Ialltoallw", mpi_comm(), stat_bytes(sendcounts__, sendtypes__), false);
+        CALL_MPI(MPI_Ialltoallw, (sendbuf__, sendcounts__, sdispls__, sendtypes__, recvbuf__, recvcounts__, rdispls__,
+                                  recvtypes__, mpi_comm(), req__));
+    }
 };
 
 /// Get number of ranks per node.
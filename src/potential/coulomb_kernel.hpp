@@ -0,0 +1,213 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file coulomb_kernel.hpp
+ *
+ *  \brief Contains declaration and implementation of sirius::Coulomb_kernel class.
+ */
+
+#ifndef __COULOMB_KERNEL_HPP__
+#define __COULOMB_KERNEL_HPP__
+
+#include <cmath>
+#include <string>
+#include "context/simulation_context.hpp"
+
+namespace sirius {
+
+/// Type of the boundary conditions for the Coulomb interaction.
+enum class coulomb_cutoff_t
+{
+    /// Periodic in all three directions.
+    none,
+    /// Isolated system (molecule).
+    cutoff_0d,
+    /// Slab, periodic along the first two lattice vectors.
+    cutoff_2d
+};
+
+/// Truncated Coulomb interaction for isolated systems.
+/** The Coulomb kernel is written as
+ *  \f[
+ *    v({\bf G}) = \frac{4\pi}{G^2} f({\bf G})
+ *  \f]
+ *  where \f$ f({\bf G}) = 1 \f$ for the periodic case. For the isolated (0D) system the interaction is cut at
+ *  the sphere of radius \f$ R_c \f$ (M. R. Jarvis et al., Phys. Rev. B 56, 14972 (1997)):
+ *  \f[
+ *    f({\bf G}) = 1 - \cos(G R_c)
+ *  \f]
+ *  and for the slab (2D) system the interaction is cut along the normal to the plane of the first two lattice
+ *  vectors at the distance \f$ z_c \f$ equal to half of the cell height (S. Ismail-Beigi, Phys. Rev. B 73,
+ *  233103 (2006)):
+ *  \f[
+ *    f({\bf G}) = 1 + e^{-G_{\parallel} z_c} \Big( \frac{G_z}{G_{\parallel}} \sin(G_z z_c) - \cos(G_z z_c) \Big)
+ *  \f]
+ *  The same kernel is applied to the Hartree potential, to the long-range part of the local potential and to
+ *  the reciprocal-space part of the Ewald sum, so the \f$ {\bf G} = 0 \f$ terms cancel for the neutral system
+ *  and are dropped. With the truncated interaction the vacuum only has to separate the electronic densities of
+ *  the periodic images, instead of damping their electrostatic interaction.
+ */
+class Coulomb_kernel
+{
+  private:
+    coulomb_cutoff_t type_{coulomb_cutoff_t::none};
+
+    /// Cutoff distance.
+    double rc_{0};
+
+    /// Unit normal to the plane of the slab.
+    vector3d<double> n_;
+
+    /// Split G-vector into components perpendicular and parallel to the slab.
+    inline std::pair<double, double> split(vector3d<double> G__) const
+    {
+        double gz = dot(G__, n_);
+        double gp = (G__ - n_ * gz).length();
+        return std::make_pair(gz, gp);
+    }
+
+  public:
+    Coulomb_kernel(Simulation_context const& ctx__)
+    {
+        auto& uc = ctx__.unit_cell();
+        std::string s = ctx__.cfg().parameters().coulomb_cutoff();
+        if (s == "0d" || (s == "none" && ctx__.molecule())) {
+            type_ = coulomb_cutoff_t::cutoff_0d;
+            rc_   = 0.5 * std::pow(uc.omega(), 1.0 / 3);
+        } else if (s == "2d") {
+            type_ = coulomb_cutoff_t::cutoff_2d;
+            /* normal to the plane of the first two lattice vectors */
+            auto a = cross(uc.lattice_vector(0), uc.lattice_vector(1));
+            n_     = a * (1.0 / a.length());
+            rc_    = 0.5 * uc.omega() / a.length();
+        } else if (s != "none") {
+            std::stringstream ss;
+            ss << "wrong type of Coulomb cutoff: " << s;
+            TERMINATE(ss);
+        }
+    }
+
+    inline coulomb_cutoff_t type() const
+    {
+        return type_;
+    }
+
+    /// True if the Coulomb interaction is not truncated.
+    inline bool periodic() const
+    {
+        return type_ == coulomb_cutoff_t::none;
+    }
+
+    /// Cutoff distance.
+    inline double rc() const
+    {
+        return rc_;
+    }
+
+    /// Return true if the interaction between two point charges separated by the vector r is within the cutoff.
+    inline bool within_cutoff(vector3d<double> r__) const
+    {
+        switch (type_) {
+            case coulomb_cutoff_t::cutoff_0d: {
+                return r__.length() < rc_;
+            }
+            case coulomb_cutoff_t::cutoff_2d: {
+                return std::abs(dot(r__, n_)) < rc_;
+            }
+            default: {
+                return true;
+            }
+        }
+    }
+
+    /// Kernel factor \f$ f({\bf G}) \f$ for \f$ {\bf G} \ne 0 \f$.
+    inline double factor(vector3d<double> G__) const
+    {
+        switch (type_) {
+            case coulomb_cutoff_t::cutoff_0d: {
+                return 1 - std::cos(G__.length() * rc_);
+            }
+            case coulomb_cutoff_t::cutoff_2d: {
+                auto g = split(G__);
+                double c = std::cos(g.first * rc_);
+                double s = std::sin(g.first * rc_);
+                if (g.second < 1e-12) {
+                    return 1 - c - g.first * rc_ * s;
+                }
+                return 1 + std::exp(-g.second * rc_) * (g.first * s / g.second - c);
+            }
+            default: {
+                return 1;
+            }
+        }
+    }
+
+    /// Gradient of the kernel factor with respect to the Cartesian components of \f$ {\bf G} \f$.
+    /** The cutoff distance is kept fixed. */
+    inline vector3d<double> factor_deriv(vector3d<double> G__) const
+    {
+        switch (type_) {
+            case coulomb_cutoff_t::cutoff_0d: {
+                double g = G__.length();
+                return G__ * (rc_ * std::sin(g * rc_) / g);
+            }
+            case coulomb_cutoff_t::cutoff_2d: {
+                auto g = split(G__);
+                double c = std::cos(g.first * rc_);
+                double s = std::sin(g.first * rc_);
+                if (g.second < 1e-12) {
+                    /* derivative along the normal; the kernel has a cusp in G_par at G_par = 0 and the
+                       symmetric (zero) in-plane derivative is used */
+                    return n_ * (-rc_ * rc_ * g.first * c);
+                }
+                double e = std::exp(-g.second * rc_);
+                /* derivatives with respect to the perpendicular and parallel components */
+                double dz = e * (s / g.second + g.first * rc_ * c / g.second + rc_ * s);
+                double dp = -rc_ * e * (g.first * s / g.second - c) - e * g.first * s / std::pow(g.second, 2);
+                auto gp   = G__ - n_ * g.first;
+                return n_ * dz + gp * (dp / g.second);
+            }
+            default: {
+                return vector3d<double>(0, 0, 0);
+            }
+        }
+    }
+
+    /// Correction to the local potential form factor from the truncation of its long-range part.
+    /** The long-range part \f$ -Z e^{-G^2/4} / G^2 \f$ of the local potential form factor (see
+     *  sirius::Radial_integrals_vloc) is replaced by the truncated one; the returned value has to be multiplied
+     *  by the ionic charge and added to the form factor. */
+    inline double vloc_correction(vector3d<double> G__) const
+    {
+        double g2 = std::pow(G__.length(), 2);
+        return std::exp(-g2 / 4) * (1 - factor(G__)) / g2;
+    }
+
+    /// Gradient of the local potential correction with respect to the Cartesian components of \f$ {\bf G} \f$.
+    inline vector3d<double> vloc_correction_deriv(vector3d<double> G__) const
+    {
+        double g2 = std::pow(G__.length(), 2);
+        double e  = std::exp(-g2 / 4);
+        return G__ * (-e * (1 - factor(G__)) * (g2 + 4) / 2 / g2 / g2) - factor_deriv(G__) * (e / g2);
+    }
+};
+
+} // namespace sirius
+
+#endif // __COULOMB_KERNEL_HPP__
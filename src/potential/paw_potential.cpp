@@ -138,42 +138,57 @@ void Potential::generate_PAW_effective_potential(Density const& density)
     paw_total_core_energy_    = energies[3];
 }
 
-double xc_mt_paw(std::vector<XC_functional> const& xc_func__, int lmax__, int num_mag_dims__, SHT const& sht__,
-    Radial_grid<double> const& rgrid__, std::vector<Flm const*> rho__, std::vector<double> const& rho_core__,
-    std::vector<Flm>& vxc__)
+/// Generate XC potential of the all-electron and pseudo densities of a PAW sphere.
+/** Both densities are defined on the same radial grid and are transformed and evaluated as a single batch.
+ *  Densities, core densities and potentials are indexed by the density set; return the XC energy of each set. */
+std::vector<double> xc_mt_paw(std::vector<XC_functional> const& xc_func__, int lmax__, int num_mag_dims__,
+    SHT const& sht__, Radial_grid<double> const& rgrid__, std::vector<std::vector<Flm const*>> const& rho__,
+    std::vector<std::vector<double> const*> const& rho_core__, std::vector<std::vector<Flm>>& vxc__)
 {
     int lmmax = utils::lmmax(lmax__);
-
-    /* new array to store core and valence densities */
-    Flm rho0(lmmax, rgrid__);
-
-    assert(rho0.size(0) == rho__[0]->size(0));
-
-    rho0.zero();
-    rho0 += (*rho__[0]);
+    int nset  = static_cast<int>(rho__.size());
 
     double invY00 = 1.0 / y00;
 
-    /* add core density */
-    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-        rho0(0, ir) += invY00 * rho_core__[ir];
+    /* new arrays to store core and valence densities */
+    std::vector<Flm> rho0;
+    std::vector<Flm> exclm;
+    for (int i = 0; i < nset; i++) {
+        rho0.emplace_back(lmmax, rgrid__);
+        exclm.emplace_back(lmmax, rgrid__);
     }
 
-    std::vector<Flm const*> rho;
-    rho.push_back(&rho0);
-    for (int j = 0; j < num_mag_dims__; j++) {
-        rho.push_back(rho__[j + 1]);
-    }
+    std::vector<std::vector<Flm const*>> rho(num_mag_dims__ + 1);
+    std::vector<std::vector<Flm*>> vxc(num_mag_dims__ + 1);
+    std::vector<Flm*> exc;
+    for (int i = 0; i < nset; i++) {
+        assert(rho0[i].size(0) == rho__[i][0]->size(0));
+
+        rho0[i].zero();
+        rho0[i] += (*rho__[i][0]);
+
+        /* add core density */
+        for (int ir = 0; ir < rgrid__.num_points(); ir++) {
+            rho0[i](0, ir) += invY00 * (*rho_core__[i])[ir];
+        }
 
-    std::vector<Flm*> vxc;
-    for (int j = 0; j < num_mag_dims__ + 1; j++) {
-        vxc.push_back(&vxc__[j]);
+        rho[0].push_back(&rho0[i]);
+        for (int j = 0; j < num_mag_dims__; j++) {
+            rho[j + 1].push_back(rho__[i][j + 1]);
+        }
+        for (int j = 0; j < num_mag_dims__ + 1; j++) {
+            vxc[j].push_back(&vxc__[i][j]);
+        }
+        exc.push_back(&exclm[i]);
     }
 
-    Flm exclm(lmmax, rgrid__);
+    sirius::xc_mt(rgrid__, sht__, xc_func__, num_mag_dims__, rho, vxc, exc);
 
-    sirius::xc_mt(rgrid__, sht__, xc_func__, num_mag_dims__, rho, vxc, &exclm);
-    return inner(exclm, rho0);
+    std::vector<double> energy(nset);
+    for (int i = 0; i < nset; i++) {
+        energy[i] = inner(exclm[i], rho0[i]);
+    }
+    return energy;
 }
 
 double Potential::calc_PAW_hartree_potential(Atom& atom, sf const& full_density, sf& full_potential)
@@ -237,26 +252,24 @@ void Potential::calc_PAW_local_potential(paw_potential_data_t& ppd,
     auto& rgrid = ppd.atom_->type().radial_grid();
     int l_max = 2 * ppd.atom_->type().indexr().lmax_lo();
 
-    std::vector<Flm> vxc;
-    for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
-        vxc.emplace_back(utils::lmmax(l_max), rgrid);
-    }
-
-    auto ae_xc_energy = sirius::xc_mt_paw(xc_func_, l_max, ctx_.num_mag_dims(), *sht_, rgrid, ae_density,
-                                          ae_core, vxc);
-    for (int i = 0; i < ctx_.num_mag_dims() + 1; i++) {
-        ppd.ae_potential_[i] += vxc[i];
+    /* all-electron and pseudo densities are treated as a batch of two functions */
+    std::vector<std::vector<Flm>> vxc(2);
+    for (int i = 0; i < 2; i++) {
+        for (int j = 0; j < ctx_.num_mag_dims() + 1; j++) {
+            vxc[i].emplace_back(utils::lmmax(l_max), rgrid);
+        }
     }
 
-    auto ps_xc_energy = sirius::xc_mt_paw(xc_func_, l_max, ctx_.num_mag_dims(), *sht_, rgrid, ps_density,
-                                          ps_core, vxc);
+    auto xc_energy = sirius::xc_mt_paw(xc_func_, l_max, ctx_.num_mag_dims(), *sht_, rgrid, {ae_density, ps_density},
+                                       {&ae_core, &ps_core}, vxc);
 
     for (int i = 0; i < ctx_.num_mag_dims() + 1; i++) {
-        ppd.ps_potential_[i] += vxc[i];
+        ppd.ae_potential_[i] += vxc[0][i];
+        ppd.ps_potential_[i] += vxc[1][i];
     }
 
     /* save xc energy in pdd structure */
-    ppd.xc_energy_ = ae_xc_energy - ps_xc_energy;
+    ppd.xc_energy_ = xc_energy[0] - xc_energy[1];
 }
 
 void Potential::calc_PAW_local_Dij(paw_potential_data_t& pdd, mdarray<double, 4>& paw_dij)
@@ -335,7 +348,7 @@ void Potential::calc_PAW_local_Dij(paw_potential_data_t& pdd, mdarray<double, 4>
             for (int imagn = 0; imagn < ctx_.num_mag_dims() + 1; imagn++) {
                 /* add nonzero coefficients */
                 for (int inz = 0; inz < num_non_zero_gk; inz++) {
-                    auto& lm3coef = GC.gaunt(lm1, lm2, inz);
+                    auto lm3coef = GC.gaunt(lm1, lm2, inz);
 
                     /* add to atom Dij an integral of dij array */
                     paw_dij(ib1, ib2, imagn, paw_ind) += lm3coef.coef * integrals(lm3coef.lm3, iqij, imagn);
@@ -31,11 +31,12 @@ double density_residual_hartree_energy(Density const& rho1__, Density const& rho
 {
     double eh{0};
     auto const& gv = rho1__.ctx().gvec();
+    Coulomb_kernel kernel(rho1__.ctx());
     #pragma omp parallel for reduction(+:eh)
     for (int igloc = gv.skip_g0(); igloc < gv.count(); igloc++) {
         auto z = rho1__.component(0).f_pw_local(igloc) - rho2__.component(0).f_pw_local(igloc);
-        double g = gv.gvec_len<index_domain_t::local>(igloc);
-        eh += (std::pow(z.real(), 2) + std::pow(z.imag(), 2)) / std::pow(g, 2);
+        auto G = gv.gvec_cart<index_domain_t::local>(igloc);
+        eh += (std::pow(z.real(), 2) + std::pow(z.imag(), 2)) * kernel.factor(G) / std::pow(G.length(), 2);
     }
     gv.comm().allreduce(&eh, 1);
     eh *= twopi * rho1__.ctx().unit_cell().omega();
@@ -199,27 +200,13 @@ void Potential::poisson(Periodic_function<double> const& rho)
     if (ctx_.gvec().comm().rank() == 0) {
         hartree_potential_->f_pw_local(0) = 0.0;
     }
-    if (!ctx_.molecule()) {
-        #pragma omp parallel for
-        for (int igloc = ctx_.gvec().skip_g0(); igloc < ctx_.gvec().count(); igloc++) {
-            hartree_potential_->f_pw_local(igloc) = fourpi * rho.f_pw_local(igloc) /
-                std::pow(ctx_.gvec().gvec_len<index_domain_t::local>(igloc), 2);
-        }
-    } else {
-        /* reference paper:
-
-           Supercell technique for total-energy calculations of finite charged and polar systems
-           M. R. Jarvis, I. D. White, R. W. Godby, and M. C. Payne
-           Phys. Rev. B 56, 14972 – Published 15 December 1997
-           DOI:https://doi.org/10.1103/PhysRevB.56.14972
-        */
-        double R_cut = 0.5 * std::pow(unit_cell_.omega(), 1.0 / 3);
-        #pragma omp parallel for
-        for (int igloc = ctx_.gvec().skip_g0(); igloc < ctx_.gvec().count(); igloc++) {
-            auto glen = ctx_.gvec().gvec_len<index_domain_t::local>(igloc);
-            hartree_potential_->f_pw_local(igloc) = (fourpi * rho.f_pw_local(igloc) / std::pow(glen, 2)) *
-                                                    (1.0 - std::cos(glen * R_cut));
-        }
+    /* truncated Coulomb interaction for isolated systems */
+    Coulomb_kernel kernel(ctx_);
+    #pragma omp parallel for
+    for (int igloc = ctx_.gvec().skip_g0(); igloc < ctx_.gvec().count(); igloc++) {
+        auto G = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+        hartree_potential_->f_pw_local(igloc) = fourpi * rho.f_pw_local(igloc) * kernel.factor(G) /
+            std::pow(G.length(), 2);
     }
 
     //if (ctx_.control().print_checksum_) {
@@ -42,10 +42,7 @@ Potential::Potential(Simulation_context& ctx__)
     lmax_ = std::max(ctx_.lmax_rho(), ctx_.lmax_pot());
 
     if (lmax_ >= 0) {
-        sht_  = std::unique_ptr<SHT>(new SHT(ctx_.processing_unit(), lmax_, ctx_.cfg().settings().sht_coverage()));
-        if (ctx_.cfg().control().verification() >= 1)  {
-            sht_->check();
-        }
+        sht_ = &ctx_.sht(lmax_);
         l_by_lm_ = utils::l_by_lm(lmax_);
 
         /* precompute i^l */
@@ -64,7 +61,8 @@ Potential::Potential(Simulation_context& ctx__)
 
     /* create list of XC functionals */
     for (auto& xc_label : ctx_.xc_functionals()) {
-        xc_func_.emplace_back(XC_functional(ctx_.spfft<double>(), ctx_.unit_cell().lattice_vectors(), xc_label, ctx_.num_spins()));
+        xc_func_.emplace_back(XC_functional(ctx_.spfft<double>(), ctx_.unit_cell().lattice_vectors(), xc_label,
+                                            ctx_.num_spins(), ctx_.cfg().settings().xc_use_native()));
         if (ctx_.cfg().parameters().xc_dens_tre() > 0) {
             xc_func_.back().set_dens_threshold(ctx_.cfg().parameters().xc_dens_tre());
         }
@@ -28,6 +28,7 @@
 #include "density/density.hpp"
 #include "hubbard/hubbard.hpp"
 #include "xc_functional.hpp"
+#include "coulomb_kernel.hpp"
 
 namespace sirius {
 
@@ -36,8 +37,18 @@ using Ftp = Spheric_function<function_domain_t::spatial, double>;
 
 void check_xc_potential(Density const& rho__);
 
-void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__);
+/// Generate XC potential and energy density inside a muffin-tin sphere.
+/** Return the number of (theta, phi, r) points excluded from the evaluation of XC functionals. */
+int xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+          int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__);
+
+/// Generate XC potential and energy density for a batch of muffin-tin spheres with the same radial grid.
+/** Density, magnetization and output functions are indexed as [j][iat], where j is the component and iat is
+ *  the atom of the batch. The spherical harmonic transformations of the batch are done with a single GEMM and
+ *  XC functionals are evaluated on the concatenated set of (theta, phi, r) points of all atoms. */
+int xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+          int num_mag_dims__, std::vector<std::vector<Flm const*>> const& rho__,
+          std::vector<std::vector<Flm*>> const& vxc__, std::vector<Flm*> const& exc__);
 
 double density_residual_hartree_energy(Density const& rho1__, Density const& rho2__);
 
@@ -88,7 +99,8 @@ class Potential : public Field4D
 
     int lmax_;
 
-    std::unique_ptr<SHT> sht_;
+    /// Spherical harmonic transformation owned by the context.
+    SHT const* sht_{nullptr};
 
     int pseudo_density_order_{9};
 
@@ -265,6 +277,8 @@ class Potential : public Field4D
      *   4\pi \int \Big(V_{\alpha}(r) r + Z_{\alpha}^p {\rm erf}(r) \Big) \frac{\sin(Gr)}{G} dr - 
      *   Z_{\alpha}^p \frac{e^{-\frac{G^2}{4}}}{G^2}
      * \f]
+     * For isolated systems the analytical long-range term is multiplied by the factor of the truncated Coulomb
+     * interaction (see sirius::Coulomb_kernel).
      */
     void generate_local_potential()
     {
@@ -277,6 +291,24 @@ class Potential : public Field4D
         /* make Vloc(G) */
         auto v = ctx_.make_periodic_function<index_domain_t::local>(ff);
 
+        /* truncate the long-range part of the local potential for isolated systems */
+        Coulomb_kernel kernel(ctx_);
+        if (!kernel.periodic()) {
+            double fourpi_omega = fourpi / unit_cell_.omega();
+            #pragma omp parallel for schedule(static)
+            for (int igloc = ctx_.gvec().skip_g0(); igloc < ctx_.gvec().count(); igloc++) {
+                int ig = ctx_.gvec().offset() + igloc;
+                double_complex z(0, 0);
+                for (int ia = 0; ia < unit_cell_.num_atoms(); ia++) {
+                    if (!unit_cell_.atom(ia).type().local_potential().empty()) {
+                        z += std::conj(ctx_.gvec_phase_factor(ig, ia)) * static_cast<double>(unit_cell_.atom(ia).zn());
+                    }
+                }
+                auto G = ctx_.gvec().gvec_cart<index_domain_t::local>(igloc);
+                v[igloc] += fourpi_omega * z * kernel.vloc_correction(G);
+            }
+        }
+
         std::copy(v.begin(), v.end(), &local_potential_->f_pw_local(0));
 
         local_potential_->fft_transform(1);
@@ -302,6 +334,10 @@ class Potential : public Field4D
     template <bool add_pseudo_core__>
     void xc_rg_magnetic(Density const& density__);
 
+    /// Print the fraction of points excluded from the evaluation of XC functionals.
+    void report_xc_compaction(char const* label__, int num_points__, int num_skipped__,
+                              Communicator const& comm__) const;
+
   public:
     /// Constructor
     Potential(Simulation_context& ctx__);
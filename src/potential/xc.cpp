@@ -29,6 +29,7 @@
 #include "utils/profiler.hpp"
 #include "SDDK/omp.hpp"
 #include "xc_functional.hpp"
+#include "xc_compaction.hpp"
 
 namespace sirius {
 
@@ -135,6 +136,27 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
     sddk::mdarray<double, 1> exc(num_points, memory_t::host, "exc_tmp");
     sddk::mdarray<double, 1> vxc(num_points, memory_t::host, "vxc_tmp");
 
+    /* points with the density below the threshold are not passed to the XC functionals */
+    XC_compaction xc_points(num_points, rho.f_rg().at(memory_t::host), xc_dens_threshold(xc_func_));
+    report_xc_compaction("xc_rg_nonmagnetic", xc_points.num_points(), xc_points.num_skipped(),
+                         Communicator(ctx_.spfft<double>().communicator()));
+
+    int num_active = xc_points.num_active();
+
+    /* compact arrays */
+    sddk::mdarray<double, 1> rho_c(num_active, memory_t::host, "rho_c");
+    sddk::mdarray<double, 1> sigma_c;
+    sddk::mdarray<double, 1> exc_c(num_active, memory_t::host, "exc_c");
+    sddk::mdarray<double, 1> vxc_c(num_active, memory_t::host, "vxc_c");
+    sddk::mdarray<double, 1> vsigma_c;
+
+    xc_points.gather(rho.f_rg().at(memory_t::host), rho_c.at(memory_t::host));
+    if (is_gga) {
+        sigma_c  = sddk::mdarray<double, 1>(num_active, memory_t::host, "sigma_c");
+        vsigma_c = sddk::mdarray<double, 1>(num_active, memory_t::host, "vsigma_c");
+        xc_points.gather(grad_rho_grad_rho.f_rg().at(memory_t::host), sigma_c.at(memory_t::host));
+    }
+
     /* loop over XC functionals */
     for (auto& ixc: xc_func_) {
         PROFILE_START("sirius::Potential::xc_rg_nonmagnetic|libxc");
@@ -152,43 +174,33 @@ void Potential::xc_rg_nonmagnetic(Density const& density__)
             TERMINATE("You should not be there since SIRIUS is not compiled with libVDWXC support\n");
 #endif
         } else {
-            if (num_points) {
+            if (num_active) {
             #pragma omp parallel
             {
-                /* split local size between threads */
-                splindex<splindex_t::block> spl_t(num_points, omp_get_num_threads(), omp_get_thread_num());
+                /* split compact set of points between threads */
+                splindex<splindex_t::block> spl_t(num_active, omp_get_num_threads(), omp_get_thread_num());
                 /* if this is an LDA functional */
                 if (ixc.is_lda()) {
-                    ixc.get_lda(spl_t.local_size(), &rho.f_rg(spl_t.global_offset()),
-                                vxc.at(memory_t::host, spl_t.global_offset()),
-                                exc.at(memory_t::host, spl_t.global_offset()));
+                    ixc.get_lda(spl_t.local_size(), rho_c.at(memory_t::host, spl_t.global_offset()),
+                                vxc_c.at(memory_t::host, spl_t.global_offset()),
+                                exc_c.at(memory_t::host, spl_t.global_offset()));
                 }
                 /* if this is a GGA functional */
                 if (ixc.is_gga()) {
-                    ixc.get_gga(spl_t.local_size(), &rho.f_rg(spl_t.global_offset()),
-                                &grad_rho_grad_rho.f_rg(spl_t.global_offset()),
-                                vxc.at(memory_t::host, spl_t.global_offset()),
-                                &vsigma.f_rg(spl_t.global_offset()),
-                                exc.at(memory_t::host, spl_t.global_offset()));
+                    ixc.get_gga(spl_t.local_size(), rho_c.at(memory_t::host, spl_t.global_offset()),
+                                sigma_c.at(memory_t::host, spl_t.global_offset()),
+                                vxc_c.at(memory_t::host, spl_t.global_offset()),
+                                vsigma_c.at(memory_t::host, spl_t.global_offset()),
+                                exc_c.at(memory_t::host, spl_t.global_offset()));
                 }
             } // omp parallel region
-                        ///* this is the same expression between gga and vdw corrections.
-                        // * The functionals are different that's all */
-                        //for (int i = 0; i < spl_np_t.local_size(); i++) {
-                        //    /* add Exc contribution */
-                        //    exc_tmp(spl_np_t[i]) += exc_t[i];
-
-                        //    /* directly add to Vxc available contributions */
-                        //    //if (use_2nd_deriv) {
-                        //    //    vxc_tmp(spl_np_t[i]) += (vrho_t[i] - 2 * vsigma_t[i] * lapl_rho.f_rg(spl_np_t[i]));
-                        //    //} else {
-                        //    //    vxc_tmp(spl_np_t[i]) += vrho_t[i];
-                        //    //}
-                        //    vxc_tmp(spl_np_t[i]) += vrho_t[i];
-
-                        //    /* save the sigma derivative */
-                        //    vsigma_tmp(spl_np_t[i]) += vsigma_t[i];
-            } // num_points != 0
+            } // num_active != 0
+            /* scatter results back to the full set of points */
+            xc_points.scatter(vxc_c.at(memory_t::host), vxc.at(memory_t::host));
+            xc_points.scatter(exc_c.at(memory_t::host), exc.at(memory_t::host));
+            if (ixc.is_gga()) {
+                xc_points.scatter(vsigma_c.at(memory_t::host), vsigma.f_rg().at(memory_t::host));
+            }
         }
         PROFILE_STOP("sirius::Potential::xc_rg_nonmagnetic|libxc");
         if (ixc.is_gga()) { /* generic for gga and vdw */
@@ -334,6 +346,36 @@ void Potential::xc_rg_magnetic(Density const& density__)
     sddk::mdarray<double, 1> vxc_up(num_points, memory_t::host, "vxc_up_tmp");
     sddk::mdarray<double, 1> vxc_dn(num_points, memory_t::host, "vxc_dn_dmp");
 
+    /* points with the total density below the threshold are not passed to the XC functionals */
+    XC_compaction xc_points(num_points, rho_up.f_rg().at(memory_t::host), rho_dn.f_rg().at(memory_t::host),
+                            xc_dens_threshold(xc_func_));
+    report_xc_compaction("xc_rg_magnetic", xc_points.num_points(), xc_points.num_skipped(),
+                         Communicator(ctx_.spfft<double>().communicator()));
+
+    int num_active = xc_points.num_active();
+
+    /* compact arrays */
+    sddk::mdarray<double, 1> rho_up_c(num_active, memory_t::host, "rho_up_c");
+    sddk::mdarray<double, 1> rho_dn_c(num_active, memory_t::host, "rho_dn_c");
+    sddk::mdarray<double, 1> exc_c(num_active, memory_t::host, "exc_c");
+    sddk::mdarray<double, 1> vxc_up_c(num_active, memory_t::host, "vxc_up_c");
+    sddk::mdarray<double, 1> vxc_dn_c(num_active, memory_t::host, "vxc_dn_c");
+    /* sigma_uu, sigma_ud, sigma_dd and vsigma_uu, vsigma_ud, vsigma_dd */
+    std::array<sddk::mdarray<double, 1>, 3> sigma_c;
+    std::array<sddk::mdarray<double, 1>, 3> vsigma_c;
+
+    xc_points.gather(rho_up.f_rg().at(memory_t::host), rho_up_c.at(memory_t::host));
+    xc_points.gather(rho_dn.f_rg().at(memory_t::host), rho_dn_c.at(memory_t::host));
+    if (is_gga) {
+        for (int i = 0; i < 3; i++) {
+            sigma_c[i]  = sddk::mdarray<double, 1>(num_active, memory_t::host, "sigma_c");
+            vsigma_c[i] = sddk::mdarray<double, 1>(num_active, memory_t::host, "vsigma_c");
+        }
+        xc_points.gather(grad_rho_up_grad_rho_up.f_rg().at(memory_t::host), sigma_c[0].at(memory_t::host));
+        xc_points.gather(grad_rho_up_grad_rho_dn.f_rg().at(memory_t::host), sigma_c[1].at(memory_t::host));
+        xc_points.gather(grad_rho_dn_grad_rho_dn.f_rg().at(memory_t::host), sigma_c[2].at(memory_t::host));
+    }
+
     /* loop over XC functionals */
     for (auto& ixc: xc_func_) {
         PROFILE_START("sirius::Potential::xc_rg_magnetic|libxc");
@@ -351,35 +393,38 @@ void Potential::xc_rg_magnetic(Density const& density__)
             TERMINATE("You should not be there since sirius is not compiled with libVDWXC\n");
 #endif
         } else {
-            if (num_points) {
+            if (num_active) {
             #pragma omp parallel
             {
-                /* split local size between threads */
-                splindex<splindex_t::block> spl_t(num_points, omp_get_num_threads(), omp_get_thread_num());
+                /* split compact set of points between threads */
+                splindex<splindex_t::block> spl_t(num_active, omp_get_num_threads(), omp_get_thread_num());
+                int i0 = spl_t.global_offset();
                 /* if this is an LDA functional */
                 if (ixc.is_lda()) {
-                    ixc.get_lda(spl_t.local_size(), &rho_up.f_rg(spl_t.global_offset()),
-                                &rho_dn.f_rg(spl_t.global_offset()),
-                                vxc_up.at(memory_t::host, spl_t.global_offset()),
-                                vxc_dn.at(memory_t::host, spl_t.global_offset()),
-                                exc.at(memory_t::host, spl_t.global_offset()));
+                    ixc.get_lda(spl_t.local_size(), rho_up_c.at(memory_t::host, i0), rho_dn_c.at(memory_t::host, i0),
+                                vxc_up_c.at(memory_t::host, i0), vxc_dn_c.at(memory_t::host, i0),
+                                exc_c.at(memory_t::host, i0));
                 }
                 /* if this is a GGA functional */
                 if (ixc.is_gga()) {
-                    ixc.get_gga(spl_t.local_size(), &rho_up.f_rg(spl_t.global_offset()),
-                                &rho_dn.f_rg(spl_t.global_offset()),
-                                &grad_rho_up_grad_rho_up.f_rg(spl_t.global_offset()),
-                                &grad_rho_up_grad_rho_dn.f_rg(spl_t.global_offset()),
-                                &grad_rho_dn_grad_rho_dn.f_rg(spl_t.global_offset()),
-                                vxc_up.at(memory_t::host, spl_t.global_offset()),
-                                vxc_dn.at(memory_t::host, spl_t.global_offset()),
-                                &vsigma_uu.f_rg(spl_t.global_offset()),
-                                &vsigma_ud.f_rg(spl_t.global_offset()),
-                                &vsigma_dd.f_rg(spl_t.global_offset()),
-                                exc.at(memory_t::host, spl_t.global_offset()));
+                    ixc.get_gga(spl_t.local_size(), rho_up_c.at(memory_t::host, i0), rho_dn_c.at(memory_t::host, i0),
+                                sigma_c[0].at(memory_t::host, i0), sigma_c[1].at(memory_t::host, i0),
+                                sigma_c[2].at(memory_t::host, i0), vxc_up_c.at(memory_t::host, i0),
+                                vxc_dn_c.at(memory_t::host, i0), vsigma_c[0].at(memory_t::host, i0),
+                                vsigma_c[1].at(memory_t::host, i0), vsigma_c[2].at(memory_t::host, i0),
+                                exc_c.at(memory_t::host, i0));
                 }
             } // omp parallel region
-            } // num_points != 0
+            } // num_active != 0
+            /* scatter results back to the full set of points */
+            xc_points.scatter(vxc_up_c.at(memory_t::host), vxc_up.at(memory_t::host));
+            xc_points.scatter(vxc_dn_c.at(memory_t::host), vxc_dn.at(memory_t::host));
+            xc_points.scatter(exc_c.at(memory_t::host), exc.at(memory_t::host));
+            if (ixc.is_gga()) {
+                xc_points.scatter(vsigma_c[0].at(memory_t::host), vsigma_uu.f_rg().at(memory_t::host));
+                xc_points.scatter(vsigma_c[1].at(memory_t::host), vsigma_ud.f_rg().at(memory_t::host));
+                xc_points.scatter(vsigma_c[2].at(memory_t::host), vsigma_dd.f_rg().at(memory_t::host));
+            }
         }
         PROFILE_STOP("sirius::Potential::xc_rg_magnetic|libxc");
         if (ixc.is_gga()) {
@@ -443,6 +488,20 @@ void Potential::xc_rg_magnetic(Density const& density__)
     } // for loop over XC functionals
 }
 
+void Potential::report_xc_compaction(char const* label__, int num_points__, int num_skipped__,
+                                     Communicator const& comm__) const
+{
+    if (ctx_.verbosity() < 2) {
+        return;
+    }
+    double n[] = {static_cast<double>(num_points__), static_cast<double>(num_skipped__)};
+    comm__.allreduce(n, 2);
+    if (n[0] > 0) {
+        ctx_.message(2, label__, "skipped %.0f out of %.0f points below XC density threshold (%.2f%%)\n", n[1], n[0],
+                     100.0 * n[1] / n[0]);
+    }
+}
+
 template <bool add_pseudo_core__>
 void Potential::xc(Density const& density__)
 {
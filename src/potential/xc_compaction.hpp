@@ -0,0 +1,135 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file xc_compaction.hpp
+ *
+ *  \brief Contains declaration and implementation of sirius::XC_compaction class.
+ */
+
+#ifndef __XC_COMPACTION_HPP__
+#define __XC_COMPACTION_HPP__
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "xc_functional.hpp"
+
+namespace sirius {
+
+/// Smallest density threshold of the list of XC functionals.
+/** Below this threshold all functionals return zero energy and potential, so such points can be excluded
+ *  from the evaluation. */
+inline double
+xc_dens_threshold(std::vector<XC_functional> const& xc_func__)
+{
+    double thr = std::numeric_limits<double>::max();
+    for (auto& ixc : xc_func__) {
+        thr = std::min(thr, ixc.dens_threshold());
+    }
+    return xc_func__.size() ? thr : 0;
+}
+
+/// Index of the points where the density is above the XC threshold.
+/** In systems with vacuum (slabs, molecules) most of the real-space points have a negligible density. Instead
+ *  of passing all points to the XC functionals, the points above the threshold are gathered into contiguous
+ *  buffers, the functionals are evaluated on the compact set and the results are scattered back. Output values
+ *  at the skipped points are set to zero. */
+class XC_compaction
+{
+  private:
+    /// Total number of points.
+    int num_points_{0};
+
+    /// Indices of the active points.
+    std::vector<int> idx_;
+
+  public:
+    XC_compaction()
+    {
+    }
+
+    /// Constructor for the total density.
+    XC_compaction(int num_points__, double const* rho__, double thr__)
+        : num_points_(num_points__)
+    {
+        idx_.reserve(num_points__);
+        for (int i = 0; i < num_points__; i++) {
+            if (rho__[i] >= thr__) {
+                idx_.push_back(i);
+            }
+        }
+    }
+
+    /// Constructor for the spin-up and spin-down densities.
+    /** The point is kept if the total density is above the threshold. */
+    XC_compaction(int num_points__, double const* rho_up__, double const* rho_dn__, double thr__)
+        : num_points_(num_points__)
+    {
+        idx_.reserve(num_points__);
+        for (int i = 0; i < num_points__; i++) {
+            if (rho_up__[i] + rho_dn__[i] >= thr__) {
+                idx_.push_back(i);
+            }
+        }
+    }
+
+    /// Total number of points.
+    inline int num_points() const
+    {
+        return num_points_;
+    }
+
+    /// Number of points above the threshold.
+    inline int num_active() const
+    {
+        return static_cast<int>(idx_.size());
+    }
+
+    /// Number of skipped points.
+    inline int num_skipped() const
+    {
+        return num_points_ - num_active();
+    }
+
+    /// Gather values of the active points into a contiguous array of size num_active().
+    inline void gather(double const* in__, double* out__) const
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_active(); i++) {
+            out__[i] = in__[idx_[i]];
+        }
+    }
+
+    /// Scatter compact array back to the full set of points; skipped points are set to zero.
+    inline void scatter(double const* in__, double* out__) const
+    {
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_points_; i++) {
+            out__[i] = 0;
+        }
+        #pragma omp parallel for schedule(static)
+        for (int i = 0; i < num_active(); i++) {
+            out__[idx_[i]] = in__[i];
+        }
+    }
+};
+
+} // namespace sirius
+
+#endif // __XC_COMPACTION_HPP__
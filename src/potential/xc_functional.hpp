@@ -59,8 +59,8 @@ class XC_functional : public XC_functional_base
 
       /* we need the context because libvdwxc asks for lattice vectors and fft parameters */
       XC_functional(spfft::Transform const& fft__, geometry3d::matrix3d<double> const& lattice_vectors__,
-                    const std::string libxc_name__, int num_spins__)
-          : XC_functional_base(libxc_name__, num_spins__)
+                    const std::string libxc_name__, int num_spins__, bool use_native__ = true)
+          : XC_functional_base(libxc_name__, num_spins__, use_native__)
     {
 
 #if defined(SIRIUS_USE_VDWXC)
@@ -32,6 +32,7 @@
 #include <stdexcept>
 #include <iostream>
 #include "utils/utils.hpp"
+#include "xc_native.hpp"
 
 namespace sirius {
 
@@ -1394,6 +1395,12 @@ class XC_functional_base
 
     bool libxc_initialized_{false};
 
+    /// Native implementation of the functional, if available.
+    xc_native::functional_t native_{xc_native::functional_t::none};
+
+    /// Density threshold of the native implementation.
+    double dens_threshold_{1e-15};
+
   private:
     /* forbid copy constructor */
     XC_functional_base(const XC_functional_base& src) = delete;
@@ -1402,7 +1409,10 @@ class XC_functional_base
         XC_functional_base& operator=(const XC_functional_base& src) = delete;
 
   public:
-    XC_functional_base(const std::string libxc_name__, int num_spins__)
+    /// Constructor.
+    /** If use_native__ is true and the functional is implemented in xc_native, the built-in kernels are used
+     *  for evaluation; Libxc handler is created in any case and serves as a fallback. */
+    XC_functional_base(const std::string libxc_name__, int num_spins__, bool use_native__ = true)
         : libxc_name_(libxc_name__)
         , num_spins_(num_spins__)
     {
@@ -1426,6 +1436,10 @@ class XC_functional_base
             }
         }
 
+        if (use_native__) {
+            native_ = xc_native::get_functional(libxc_name_);
+        }
+
         libxc_initialized_ = true;
     }
 
@@ -1435,6 +1449,8 @@ class XC_functional_base
         this->num_spins_         = src__.num_spins_;
         this->handler_           = std::move(src__.handler_);
         this->libxc_initialized_ = src__.libxc_initialized_;
+        this->native_            = src__.native_;
+        this->dens_threshold_    = src__.dens_threshold_;
         src__.libxc_initialized_ = false;
     }
 
@@ -1527,6 +1543,12 @@ class XC_functional_base
         return kind() == XC_EXCHANGE_CORRELATION;
     }
 
+    /// Return true if the built-in implementation of the functional is used.
+    bool is_native() const
+    {
+        return native_ != xc_native::functional_t::none;
+    }
+
     /// Get LDA contribution.
     void get_lda(const int size, const double* rho, double* v, double* e) const
     {
@@ -1543,7 +1565,9 @@ class XC_functional_base
             }
         }
 
-        if (handler_) {
+        if (is_native()) {
+            xc_native::get_lda(native_, size, rho, v, e, dens_threshold_);
+        } else if (handler_) {
             xc_lda_exc_vxc(handler_.get(), size, rho, e, v);
         } else {
             for (int i = 0; i < size; i++) {
@@ -1562,8 +1586,7 @@ class XC_functional_base
             TERMINATE("wrong XC");
         }
 
-        std::vector<double> rho_ud(size * 2);
-        /* check and rearrange density */
+        /* check density */
         for (int i = 0; i < size; i++) {
             if (rho_up[i] < 0 || rho_dn[i] < 0) {
                 std::stringstream s;
@@ -1571,12 +1594,18 @@ class XC_functional_base
                   << utils::double_to_string(rho_dn[i]);
                 TERMINATE(s);
             }
-
-            rho_ud[2 * i]     = rho_up[i];
-            rho_ud[2 * i + 1] = rho_dn[i];
         }
 
-        if (handler_) {
+        if (is_native()) {
+            xc_native::get_lda(native_, size, rho_up, rho_dn, v_up, v_dn, e, dens_threshold_);
+        } else if (handler_) {
+            /* rearrange density */
+            std::vector<double> rho_ud(size * 2);
+            for (int i = 0; i < size; i++) {
+                rho_ud[2 * i]     = rho_up[i];
+                rho_ud[2 * i + 1] = rho_dn[i];
+            }
+
             std::vector<double> v_ud(size * 2);
 
             xc_lda_exc_vxc(handler_.get(), size, &rho_ud[0], &e[0], &v_ud[0]);
@@ -1610,7 +1639,9 @@ class XC_functional_base
             }
         }
 
-        if (handler_) {
+        if (is_native()) {
+            xc_native::get_gga(native_, size, rho, sigma, vrho, vsigma, e, dens_threshold_);
+        } else if (handler_) {
             xc_gga_exc_vxc(handler_.get(), size, rho, sigma, e, vrho, vsigma);
         } else {
             for (int i = 0; i < size; i++) {
@@ -1630,10 +1661,7 @@ class XC_functional_base
             TERMINATE("wrong XC");
         }
 
-        std::vector<double> rho(2 * size);
-        std::vector<double> sigma(3 * size);
-        /* check and rearrange density */
-        /* rearrange sigma as well */
+        /* check density */
         for (int i = 0; i < size; i++) {
             if (rho_up[i] < 0 || rho_dn[i] < 0) {
                 std::stringstream s;
@@ -1641,7 +1669,18 @@ class XC_functional_base
                   << utils::double_to_string(rho_dn[i]);
                 TERMINATE(s);
             }
+        }
+
+        if (is_native()) {
+            xc_native::get_gga(native_, size, rho_up, rho_dn, sigma_uu, sigma_ud, sigma_dd, vrho_up, vrho_dn,
+                               vsigma_uu, vsigma_ud, vsigma_dd, e, dens_threshold_);
+            return;
+        }
 
+        std::vector<double> rho(2 * size);
+        std::vector<double> sigma(3 * size);
+        /* rearrange density and sigma */
+        for (int i = 0; i < size; i++) {
             rho[2 * i]     = rho_up[i];
             rho[2 * i + 1] = rho_dn[i];
 
@@ -1694,9 +1733,16 @@ class XC_functional_base
     }
 
 
+    /// Density threshold below which the output of the functional is set to zero.
+    double dens_threshold() const
+    {
+        return dens_threshold_;
+    }
+
     /// set density threshold of libxc, if density is below tre, all xc output will be set to 0.
     void set_dens_threshold(double tre)
     {
+        dens_threshold_ = tre;
 #if XC_MAJOR_VERSION >= 4
         xc_func_set_dens_threshold(this->handler(), tre);
 #else
@@ -23,17 +23,166 @@
  */
 
 #include <vector>
+#include <map>
 
 #include "potential.hpp"
 #include "typedefs.hpp"
 #include "utils/profiler.hpp"
 #include "SDDK/omp.hpp"
 #include "xc_functional.hpp"
+#include "xc_compaction.hpp"
 
 namespace sirius {
 
-void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-                       Flm const& rho_lm__, Ftp& rho_tp__, Flm& vxc_lm__, Flm& exc_lm__)
+/// Function of a batch of muffin-tin spheres in spatial or spectral domain.
+/** Functions of all atoms in the batch share the same radial grid and are stored as a single matrix with
+ *  the leading dimension equal to the angular domain size and the columns running over (ir, iat). The forward
+ *  transformation of a batch is a single GEMM. The backward transformation is a single GEMM only if the spectral
+ *  functions of the atoms follow each other in memory (see mt_batch_flm_t); the density of the atoms and the
+ *  results of gradient(), laplacian() and divergence() are allocated per atom and are transformed with one GEMM
+ *  per atom. */
+using mt_batch_t = sddk::mdarray<double, 2>;
+
+/// Spectral functions of the individual atoms of a batch.
+/** The functions are views into a single (lmmax, nr * nat) buffer, such that the batch is transformed with
+ *  a single GEMM in both directions. */
+struct mt_batch_flm_t
+{
+    /// Storage of the functions of all atoms.
+    mt_batch_t buf;
+    /// Functions of the individual atoms; valid as long as the buffer is alive.
+    std::vector<Flm> flm;
+};
+
+/// Maximum number of (theta, phi, r) points in a batch of atoms.
+/** A batch keeps about a dozen arrays of this size in the spatial domain (density, its gradients, potential
+ *  and energy density), 32 MB each in double precision. */
+static int const max_mt_batch_points{1 << 22};
+
+/// Backward transformation of a batch of spectral functions to (theta, phi, r) points.
+static mt_batch_t
+sht_backward_batch(SHT const& sht__, std::vector<Flm const*> const& flm__)
+{
+    int nat   = static_cast<int>(flm__.size());
+    int nr    = flm__[0]->radial_grid().num_points();
+    int ld    = flm__[0]->angular_domain_size();
+    int lmmax = std::min(sht__.lmmax(), ld);
+
+    std::vector<double const*> ptr;
+    for (auto f : flm__) {
+        ptr.push_back(&(*f)(0, 0));
+    }
+    mt_batch_t ftp(sht__.num_points(), nr * nat);
+    sht__.backward_transform(ld, ptr, nr, lmmax, ftp.at(memory_t::host));
+    return ftp;
+}
+
+/// Backward transformation of a batch of spectral functions held by value.
+static mt_batch_t
+sht_backward_batch(SHT const& sht__, std::vector<Flm> const& flm__)
+{
+    std::vector<Flm const*> ptr;
+    for (auto& f : flm__) {
+        ptr.push_back(&f);
+    }
+    return sht_backward_batch(sht__, ptr);
+}
+
+/// Forward transformation of a batch of functions from (theta, phi, r) points to real spherical harmonics.
+static mt_batch_t
+sht_forward_batch(SHT const& sht__, mt_batch_t const& ftp__)
+{
+    int ncol = static_cast<int>(ftp__.size(1));
+    mt_batch_t flm(sht__.lmmax(), ncol);
+    sht__.forward_transform(ftp__.at(memory_t::host), ncol, sht__.lmmax(), sht__.lmmax(), flm.at(memory_t::host));
+    return flm;
+}
+
+/// Forward transformation of a batch of functions to the spectral functions of individual atoms.
+static mt_batch_flm_t
+sht_forward_batch(SHT const& sht__, mt_batch_t const& ftp__, Radial_grid<double> const& rgrid__)
+{
+    int nr  = rgrid__.num_points();
+    int nat = static_cast<int>(ftp__.size(1)) / nr;
+
+    mt_batch_flm_t result;
+    result.buf = sht_forward_batch(sht__, ftp__);
+    for (int iat = 0; iat < nat; iat++) {
+        result.flm.emplace_back(&result.buf(0, iat * nr), sht__.lmmax(), rgrid__);
+    }
+    return result;
+}
+
+/// Add spectral functions of the batch to the functions of individual atoms.
+static void
+add_batch(mt_batch_t const& flm__, std::vector<Flm*> const& f__)
+{
+    int nr = f__[0]->radial_grid().num_points();
+    #pragma omp parallel for
+    for (int iat = 0; iat < static_cast<int>(f__.size()); iat++) {
+        int lmmax = std::min(static_cast<int>(flm__.size(0)), f__[iat]->angular_domain_size());
+        for (int ir = 0; ir < nr; ir++) {
+            for (int lm = 0; lm < lmmax; lm++) {
+                (*f__[iat])(lm, ir) += flm__(lm, ir + iat * nr);
+            }
+        }
+    }
+}
+
+/// Gradient of each spectral function of the batch.
+static std::vector<Spheric_vector_function<function_domain_t::spectral, double>>
+gradient_batch(std::vector<Flm const*> const& f__)
+{
+    std::vector<Spheric_vector_function<function_domain_t::spectral, double>> result(f__.size());
+    #pragma omp parallel for
+    for (int iat = 0; iat < static_cast<int>(f__.size()); iat++) {
+        result[iat] = gradient(*f__[iat]);
+    }
+    return result;
+}
+
+/// Gradient of each spectral function of the batch held by value.
+static std::vector<Spheric_vector_function<function_domain_t::spectral, double>>
+gradient_batch(std::vector<Flm> const& f__)
+{
+    std::vector<Flm const*> ptr;
+    for (auto& f : f__) {
+        ptr.push_back(&f);
+    }
+    return gradient_batch(ptr);
+}
+
+/// Backward transformation of the x-component of the batch of vector functions.
+static mt_batch_t
+sht_backward_batch(SHT const& sht__, std::vector<Spheric_vector_function<function_domain_t::spectral, double>> const& f__,
+                   int x__)
+{
+    std::vector<Flm const*> ptr;
+    for (auto& f : f__) {
+        ptr.push_back(&f[x__]);
+    }
+    return sht_backward_batch(sht__, ptr);
+}
+
+/// Evaluate XC functionals on the compact set of points.
+/** Points are split between OpenMP threads; each thread calls the functional on a contiguous chunk. */
+template <typename F>
+static void
+xc_eval(int num_points__, F&& f__)
+{
+    #pragma omp parallel
+    {
+        splindex<splindex_t::block> spl_t(num_points__, omp_get_num_threads(), omp_get_thread_num());
+        if (spl_t.local_size()) {
+            f__(spl_t.local_size(), static_cast<int>(spl_t.global_offset()));
+        }
+    }
+}
+
+static int
+xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+                  std::vector<Flm const*> const& rho_lm__, mt_batch_t const& rho_tp__, std::vector<Flm*> const& vxc_lm__,
+                  std::vector<Flm*> const& exc_lm__)
 {
     bool is_gga{false};
     for (auto& ixc : xc_func__) {
@@ -42,90 +191,119 @@ void xc_mt_nonmagnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, std
         }
     }
 
-    Ftp exc_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_tp(sht__.num_points(), rgrid__);
-
-    assert(rho_tp__.size() == vxc_tp.size());
-    assert(rho_tp__.size() == exc_tp.size());
+    int num_points = static_cast<int>(rho_tp__.size());
 
-    Ftp grad_rho_grad_rho_tp;
-    Ftp vsigma_tp;
-    Ftp lapl_rho_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_tp;
+    mt_batch_t exc_tp(rho_tp__.size(0), rho_tp__.size(1));
+    mt_batch_t vxc_tp(rho_tp__.size(0), rho_tp__.size(1));
+    exc_tp.zero();
+    vxc_tp.zero();
 
-    /* use Laplacian (true) or divergence of gradient (false) */
-    bool use_lapl{false};
+    std::array<mt_batch_t, 3> grad_rho_tp;
+    mt_batch_t grad_rho_grad_rho_tp;
 
     if (is_gga) {
         /* compute gradient in Rlm spherical harmonics */
-        auto grad_rho_lm = gradient(rho_lm__);
-        grad_rho_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
+        auto grad_rho_lm = gradient_batch(rho_lm__);
         /* backward transform gradient from Rlm to (theta, phi) */
-        for (int x = 0; x < 3; x++) {
-            transform(sht__, grad_rho_lm[x], grad_rho_tp[x]);
+        for (int x: {0, 1, 2}) {
+            grad_rho_tp[x] = sht_backward_batch(sht__, grad_rho_lm, x);
         }
         /* compute density gradient product */
-        grad_rho_grad_rho_tp = grad_rho_tp * grad_rho_tp;
-        assert(rho_tp__.size() == grad_rho_grad_rho_tp.size());
-
-        vsigma_tp = Ftp(sht__.num_points(), rgrid__);
-        assert(rho_tp__.size() == vsigma_tp.size());
-        if (use_lapl) {
-            /* backward transform Laplacian from Rlm to (theta, phi) */
-            lapl_rho_tp = transform(sht__, laplacian(rho_lm__));
-            assert(lapl_rho_tp.size() == rho_tp__.size());
+        grad_rho_grad_rho_tp = mt_batch_t(rho_tp__.size(0), rho_tp__.size(1));
+        #pragma omp parallel for
+        for (int i = 0; i < num_points; i++) {
+            grad_rho_grad_rho_tp[i] = grad_rho_tp[0][i] * grad_rho_tp[0][i] + grad_rho_tp[1][i] * grad_rho_tp[1][i] +
+                                      grad_rho_tp[2][i] * grad_rho_tp[2][i];
         }
     }
 
+    /* points with the density below the threshold are not passed to the XC functionals */
+    XC_compaction xc_points(num_points, rho_tp__.at(memory_t::host), xc_dens_threshold(xc_func__));
+    int num_active = xc_points.num_active();
+
+    std::vector<double> rho_c(num_active);
+    std::vector<double> exc_c(num_active);
+    std::vector<double> vxc_c(num_active);
+    std::vector<double> sigma_c;
+    std::vector<double> vsigma_c;
+    xc_points.gather(rho_tp__.at(memory_t::host), rho_c.data());
+    if (is_gga) {
+        sigma_c.resize(num_active);
+        vsigma_c.resize(num_active);
+        xc_points.gather(grad_rho_grad_rho_tp.at(memory_t::host), sigma_c.data());
+    }
+
+    mt_batch_t tmp_tp(rho_tp__.size(0), rho_tp__.size(1));
+
     for (auto& ixc: xc_func__) {
         /* if this is an LDA functional */
         if (ixc.is_lda()) {
-            ixc.get_lda(sht__.num_points() * rgrid__.num_points(), rho_tp__.at(memory_t::host),
-                vxc_tp.at(memory_t::host), exc_tp.at(memory_t::host));
+            xc_eval(num_active, [&](int n, int i0) {
+                ixc.get_lda(n, &rho_c[i0], &vxc_c[i0], &exc_c[i0]);
+            });
         }
         /* if this is a GGA functional */
         if (ixc.is_gga()) {
-
             /* compute vrho and vsigma */
-            ixc.get_gga(sht__.num_points() * rgrid__.num_points(), rho_tp__.at(memory_t::host),
-                grad_rho_grad_rho_tp.at(memory_t::host), vxc_tp.at(memory_t::host), vsigma_tp.at(memory_t::host),
-                exc_tp.at(memory_t::host));
-
-            if (use_lapl) {
-                vxc_tp -= 2.0 * vsigma_tp * lapl_rho_tp;
-
-                /* compute gradient of vsgima in spherical harmonics */
-                auto grad_vsigma_lm = gradient(transform(sht__, vsigma_tp));
+            xc_eval(num_active, [&](int n, int i0) {
+                ixc.get_gga(n, &rho_c[i0], &sigma_c[i0], &vxc_c[i0], &vsigma_c[i0], &exc_c[i0]);
+            });
+        }
+        xc_points.scatter(exc_c.data(), tmp_tp.at(memory_t::host));
+        #pragma omp parallel for
+        for (int i = 0; i < num_points; i++) {
+            exc_tp[i] += tmp_tp[i];
+        }
+        xc_points.scatter(vxc_c.data(), tmp_tp.at(memory_t::host));
+        #pragma omp parallel for
+        for (int i = 0; i < num_points; i++) {
+            vxc_tp[i] += tmp_tp[i];
+        }
 
-                /* backward transform gradient from Rlm to (theta, phi) */
-                Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_tp(sht__.num_points(), rgrid__);
-                for (int x = 0; x < 3; x++) {
-                    transform(sht__, grad_vsigma_lm[x], grad_vsigma_tp[x]);
+        if (ixc.is_gga()) {
+            mt_batch_t vsigma_tp(rho_tp__.size(0), rho_tp__.size(1));
+            xc_points.scatter(vsigma_c.data(), vsigma_tp.at(memory_t::host));
+
+            /* forward transform vsigma * grad_rho to Rlm */
+            std::array<mt_batch_flm_t, 3> vsigma_grad_rho_lm;
+            for (int x: {0, 1, 2}) {
+                #pragma omp parallel for
+                for (int i = 0; i < num_points; i++) {
+                    tmp_tp[i] = vsigma_tp[i] * grad_rho_tp[x][i];
                 }
-
-                /* compute scalar product of two gradients */
-                auto grad_vsigma_grad_rho_tp = grad_vsigma_tp * grad_rho_tp;
-                /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * grad_vsigma_grad_rho_tp;
-            } else {
-                Spheric_vector_function<function_domain_t::spectral, double> vsigma_grad_rho_lm(sht__.lmmax(), rgrid__);
+                vsigma_grad_rho_lm[x] = sht_forward_batch(sht__, tmp_tp, rgrid__);
+            }
+            /* divergence of the vector function of each atom */
+            int nat = static_cast<int>(rho_lm__.size());
+            std::vector<Flm> div_vsigma_grad_rho_lm(nat);
+            #pragma omp parallel for
+            for (int iat = 0; iat < nat; iat++) {
+                Spheric_vector_function<function_domain_t::spectral, double> f(sht__.lmmax(), rgrid__);
                 for (int x: {0, 1, 2}) {
-                    auto vsigma_grad_rho_tp = vsigma_tp * grad_rho_tp[x];
-                    transform(sht__, vsigma_grad_rho_tp, vsigma_grad_rho_lm[x]);
+                    f[x] = std::move(vsigma_grad_rho_lm[x].flm[iat]);
                 }
-                auto div_vsigma_grad_rho_tp = transform(sht__, divergence(vsigma_grad_rho_lm));
-                /* add remaining term to Vxc */
-                vxc_tp -= 2.0 * div_vsigma_grad_rho_tp;
+                div_vsigma_grad_rho_lm[iat] = divergence(f);
+            }
+            auto div_vsigma_grad_rho_tp = sht_backward_batch(sht__, div_vsigma_grad_rho_lm);
+            /* add remaining term to Vxc */
+            #pragma omp parallel for
+            for (int i = 0; i < num_points; i++) {
+                vxc_tp[i] -= 2 * div_vsigma_grad_rho_tp[i];
             }
         }
-        exc_lm__ += transform(sht__, exc_tp);
-        vxc_lm__ += transform(sht__, vxc_tp);
     } //ixc
+
+    /* forward transform from (theta, phi) to Rlm */
+    add_batch(sht_forward_batch(sht__, exc_tp), exc_lm__);
+    add_batch(sht_forward_batch(sht__, vxc_tp), vxc_lm__);
+
+    return xc_points.num_skipped();
 }
 
-void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int num_mag_dims__,
-                    std::vector<XC_functional> const& xc_func__, std::vector<Ftp> const& rho_tp__,
-                    std::vector<Flm*> vxc__, Flm& exc__)
+static int
+xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int num_mag_dims__,
+               std::vector<XC_functional> const& xc_func__, std::vector<mt_batch_t> const& rho_tp__,
+               std::vector<std::vector<Flm*>> const& vxc__, std::vector<Flm*> const& exc__)
 {
     bool is_gga{false};
     for (auto& ixc : xc_func__) {
@@ -134,183 +312,237 @@ void xc_mt_magnetic(Radial_grid<double> const& rgrid__, SHT const& sht__, int nu
         }
     }
 
-    Ftp exc_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_tp(sht__.num_points(), rgrid__);
+    int num_points = static_cast<int>(rho_tp__[0].size());
+    int ntp        = static_cast<int>(rho_tp__[0].size(0));
+    int ncol       = static_cast<int>(rho_tp__[0].size(1));
 
     /* convert to rho_up, rho_dn */
-    Ftp rho_dn_tp(sht__.num_points(), rgrid__);
-    Ftp rho_up_tp(sht__.num_points(), rgrid__);
-    /* loop over radial grid points */
-    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-        /* loop over points on the sphere */
-        for (int itp = 0; itp < sht__.num_points(); itp++) {
-            vector3d<double> m;
-            for (int j = 0; j < num_mag_dims__; j++) {
-                m[j] = rho_tp__[1 + j](itp, ir);
-            }
-            auto rud = get_rho_up_dn(num_mag_dims__, rho_tp__[0](itp, ir), m);
-
-            /* compute "up" and "dn" components */
-            rho_up_tp(itp, ir) = rud.first;
-            rho_dn_tp(itp, ir) = rud.second;
+    mt_batch_t rho_up_tp(ntp, ncol);
+    mt_batch_t rho_dn_tp(ntp, ncol);
+    #pragma omp parallel for
+    for (int i = 0; i < num_points; i++) {
+        vector3d<double> m;
+        for (int j = 0; j < num_mag_dims__; j++) {
+            m[j] = rho_tp__[1 + j][i];
         }
-    }
-    /* transform from (theta, phi) to Rlm */
-    auto rho_up_lm = transform(sht__, rho_up_tp);
-    auto rho_dn_lm = transform(sht__, rho_dn_tp);
+        auto rud = get_rho_up_dn(num_mag_dims__, rho_tp__[0][i], m);
 
-    std::vector<Ftp> bxc_tp(num_mag_dims__);
+        /* compute "up" and "dn" components */
+        rho_up_tp[i] = rud.first;
+        rho_dn_tp[i] = rud.second;
+    }
 
-    Ftp vxc_up_tp(sht__.num_points(), rgrid__);
-    Ftp vxc_dn_tp(sht__.num_points(), rgrid__);
+    mt_batch_t exc_tp(ntp, ncol);
+    mt_batch_t vxc_tp(ntp, ncol);
+    std::vector<mt_batch_t> bxc_tp(num_mag_dims__);
+    exc_tp.zero();
+    vxc_tp.zero();
     for (int j = 0; j < num_mag_dims__; j++) {
-        bxc_tp[j] = Ftp(sht__.num_points(), rgrid__);
+        bxc_tp[j] = mt_batch_t(ntp, ncol);
+        bxc_tp[j].zero();
     }
 
-    Ftp grad_rho_up_grad_rho_up_tp;
-    Ftp grad_rho_up_grad_rho_dn_tp;
-    Ftp grad_rho_dn_grad_rho_dn_tp;
-    Ftp vsigma_uu_tp;
-    Ftp vsigma_ud_tp;
-    Ftp vsigma_dd_tp;
-    Ftp lapl_rho_up_tp;
-    Ftp lapl_rho_dn_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_up_tp;
-    Spheric_vector_function<function_domain_t::spatial, double> grad_rho_dn_tp;
+    mt_batch_t vxc_up_tp(ntp, ncol);
+    mt_batch_t vxc_dn_tp(ntp, ncol);
+    mt_batch_t exc1_tp(ntp, ncol);
+
+    std::array<mt_batch_t, 3> grad_rho_up_tp;
+    std::array<mt_batch_t, 3> grad_rho_dn_tp;
+    /* grad_rho_up * grad_rho_up, grad_rho_up * grad_rho_dn, grad_rho_dn * grad_rho_dn */
+    std::array<mt_batch_t, 3> sigma_tp;
+    mt_batch_t lapl_rho_up_tp;
+    mt_batch_t lapl_rho_dn_tp;
 
     if (is_gga) {
+        /* transform from (theta, phi) to Rlm */
+        auto rho_up_lm = sht_forward_batch(sht__, rho_up_tp, rgrid__);
+        auto rho_dn_lm = sht_forward_batch(sht__, rho_dn_tp, rgrid__);
+
         /* compute gradient in Rlm spherical harmonics */
-        auto grad_rho_up_lm = gradient(rho_up_lm);
-        auto grad_rho_dn_lm = gradient(rho_dn_lm);
-        grad_rho_up_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
-        grad_rho_dn_tp = Spheric_vector_function<function_domain_t::spatial, double>(sht__.num_points(), rgrid__);
+        auto grad_rho_up_lm = gradient_batch(rho_up_lm.flm);
+        auto grad_rho_dn_lm = gradient_batch(rho_dn_lm.flm);
         /* backward transform gradient from Rlm to (theta, phi) */
-        for (int x = 0; x < 3; x++) {
-            transform(sht__, grad_rho_up_lm[x], grad_rho_up_tp[x]);
-            transform(sht__, grad_rho_dn_lm[x], grad_rho_dn_tp[x]);
+        for (int x: {0, 1, 2}) {
+            grad_rho_up_tp[x] = sht_backward_batch(sht__, grad_rho_up_lm, x);
+            grad_rho_dn_tp[x] = sht_backward_batch(sht__, grad_rho_dn_lm, x);
         }
         /* compute density gradient products */
-        grad_rho_up_grad_rho_up_tp = grad_rho_up_tp * grad_rho_up_tp;
-        grad_rho_up_grad_rho_dn_tp = grad_rho_up_tp * grad_rho_dn_tp;
-        grad_rho_dn_grad_rho_dn_tp = grad_rho_dn_tp * grad_rho_dn_tp;
-
-        vsigma_uu_tp = Ftp(sht__.num_points(), rgrid__);
-        vsigma_ud_tp = Ftp(sht__.num_points(), rgrid__);
-        vsigma_dd_tp = Ftp(sht__.num_points(), rgrid__);
+        for (int k = 0; k < 3; k++) {
+            sigma_tp[k] = mt_batch_t(ntp, ncol);
+        }
+        #pragma omp parallel for
+        for (int i = 0; i < num_points; i++) {
+            double uu{0}, ud{0}, dd{0};
+            for (int x: {0, 1, 2}) {
+                uu += grad_rho_up_tp[x][i] * grad_rho_up_tp[x][i];
+                ud += grad_rho_up_tp[x][i] * grad_rho_dn_tp[x][i];
+                dd += grad_rho_dn_tp[x][i] * grad_rho_dn_tp[x][i];
+            }
+            sigma_tp[0][i] = uu;
+            sigma_tp[1][i] = ud;
+            sigma_tp[2][i] = dd;
+        }
 
         /* backward transform Laplacians from Rlm to (theta, phi) */
-        lapl_rho_up_tp = transform(sht__, laplacian(rho_up_lm));
-        lapl_rho_dn_tp = transform(sht__, laplacian(rho_dn_lm));
+        int nat = static_cast<int>(rho_up_lm.flm.size());
+        std::vector<Flm> lapl_rho_up_lm(nat);
+        std::vector<Flm> lapl_rho_dn_lm(nat);
+        #pragma omp parallel for
+        for (int iat = 0; iat < nat; iat++) {
+            lapl_rho_up_lm[iat] = laplacian(rho_up_lm.flm[iat]);
+            lapl_rho_dn_lm[iat] = laplacian(rho_dn_lm.flm[iat]);
+        }
+        lapl_rho_up_tp = sht_backward_batch(sht__, lapl_rho_up_lm);
+        lapl_rho_dn_tp = sht_backward_batch(sht__, lapl_rho_dn_lm);
+    }
+
+    /* points with the total density below the threshold are not passed to the XC functionals */
+    XC_compaction xc_points(num_points, rho_up_tp.at(memory_t::host), rho_dn_tp.at(memory_t::host),
+                            xc_dens_threshold(xc_func__));
+    int num_active = xc_points.num_active();
+
+    std::vector<double> rho_up_c(num_active);
+    std::vector<double> rho_dn_c(num_active);
+    std::vector<double> exc_c(num_active);
+    std::vector<double> vxc_up_c(num_active);
+    std::vector<double> vxc_dn_c(num_active);
+    /* sigma_uu, sigma_ud, sigma_dd and vsigma_uu, vsigma_ud, vsigma_dd */
+    std::array<std::vector<double>, 3> sigma_c;
+    std::array<std::vector<double>, 3> vsigma_c;
+    xc_points.gather(rho_up_tp.at(memory_t::host), rho_up_c.data());
+    xc_points.gather(rho_dn_tp.at(memory_t::host), rho_dn_c.data());
+    if (is_gga) {
+        for (int k = 0; k < 3; k++) {
+            sigma_c[k].resize(num_active);
+            vsigma_c[k].resize(num_active);
+            xc_points.gather(sigma_tp[k].at(memory_t::host), sigma_c[k].data());
+        }
     }
 
     for (auto& ixc: xc_func__) {
         if (ixc.is_lda()) {
-            ixc.get_lda(sht__.num_points() * rgrid__.num_points(), rho_up_tp.at(memory_t::host),
-                rho_dn_tp.at(memory_t::host), vxc_up_tp.at(memory_t::host), vxc_dn_tp.at(memory_t::host),
-                exc_tp.at(memory_t::host));
+            xc_eval(num_active, [&](int n, int i0) {
+                ixc.get_lda(n, &rho_up_c[i0], &rho_dn_c[i0], &vxc_up_c[i0], &vxc_dn_c[i0], &exc_c[i0]);
+            });
         }
         if (ixc.is_gga()) {
             /* get the vrho and vsigma */
-            ixc.get_gga(sht__.num_points() * rgrid__.num_points(), rho_up_tp.at(memory_t::host),
-                    rho_dn_tp.at(memory_t::host), grad_rho_up_grad_rho_up_tp.at(memory_t::host),
-                    grad_rho_up_grad_rho_dn_tp.at(memory_t::host), grad_rho_dn_grad_rho_dn_tp.at(memory_t::host),
-                    vxc_up_tp.at(memory_t::host), vxc_dn_tp.at(memory_t::host), vsigma_uu_tp.at(memory_t::host),
-                    vsigma_ud_tp.at(memory_t::host), vsigma_dd_tp.at(memory_t::host), exc_tp.at(memory_t::host));
+            xc_eval(num_active, [&](int n, int i0) {
+                ixc.get_gga(n, &rho_up_c[i0], &rho_dn_c[i0], &sigma_c[0][i0], &sigma_c[1][i0], &sigma_c[2][i0],
+                            &vxc_up_c[i0], &vxc_dn_c[i0], &vsigma_c[0][i0], &vsigma_c[1][i0], &vsigma_c[2][i0],
+                            &exc_c[i0]);
+            });
+        }
+        xc_points.scatter(vxc_up_c.data(), vxc_up_tp.at(memory_t::host));
+        xc_points.scatter(vxc_dn_c.data(), vxc_dn_tp.at(memory_t::host));
+        xc_points.scatter(exc_c.data(), exc1_tp.at(memory_t::host));
 
-            /* directly add to Vxc available contributions */
-            vxc_up_tp -= (2.0 * vsigma_uu_tp * lapl_rho_up_tp + vsigma_ud_tp * lapl_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * vsigma_dd_tp * lapl_rho_dn_tp + vsigma_ud_tp * lapl_rho_up_tp);
-
-            /* forward transform vsigma to Rlm */
-            auto vsigma_uu_lm = transform(sht__, vsigma_uu_tp);
-            auto vsigma_ud_lm = transform(sht__, vsigma_ud_tp);
-            auto vsigma_dd_lm = transform(sht__, vsigma_dd_tp);
-
-            /* compute gradient of vsgima in spherical harmonics */
-            auto grad_vsigma_uu_lm = gradient(vsigma_uu_lm);
-            auto grad_vsigma_ud_lm = gradient(vsigma_ud_lm);
-            auto grad_vsigma_dd_lm = gradient(vsigma_dd_lm);
-
-            /* backward transform gradient from Rlm to (theta, phi) */
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_uu_tp(sht__.num_points(), rgrid__);
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_ud_tp(sht__.num_points(), rgrid__);
-            Spheric_vector_function<function_domain_t::spatial, double> grad_vsigma_dd_tp(sht__.num_points(), rgrid__);
-            for (int x = 0; x < 3; x++) {
-                grad_vsigma_uu_tp[x] = transform(sht__, grad_vsigma_uu_lm[x]);
-                grad_vsigma_ud_tp[x] = transform(sht__, grad_vsigma_ud_lm[x]);
-                grad_vsigma_dd_tp[x] = transform(sht__, grad_vsigma_dd_lm[x]);
+        if (ixc.is_gga()) {
+            /* vsigma_uu, vsigma_ud, vsigma_dd */
+            std::array<mt_batch_t, 3> vsigma_tp;
+            for (int k = 0; k < 3; k++) {
+                vsigma_tp[k] = mt_batch_t(ntp, ncol);
+                xc_points.scatter(vsigma_c[k].data(), vsigma_tp[k].at(memory_t::host));
             }
 
-            /* compute scalar product of two gradients */
-            auto grad_vsigma_uu_grad_rho_up_tp = grad_vsigma_uu_tp * grad_rho_up_tp;
-            auto grad_vsigma_dd_grad_rho_dn_tp = grad_vsigma_dd_tp * grad_rho_dn_tp;
-            auto grad_vsigma_ud_grad_rho_up_tp = grad_vsigma_ud_tp * grad_rho_up_tp;
-            auto grad_vsigma_ud_grad_rho_dn_tp = grad_vsigma_ud_tp * grad_rho_dn_tp;
+            /* directly add to Vxc available contributions */
+            #pragma omp parallel for
+            for (int i = 0; i < num_points; i++) {
+                vxc_up_tp[i] -= (2.0 * vsigma_tp[0][i] * lapl_rho_up_tp[i] + vsigma_tp[1][i] * lapl_rho_dn_tp[i]);
+                vxc_dn_tp[i] -= (2.0 * vsigma_tp[2][i] * lapl_rho_dn_tp[i] + vsigma_tp[1][i] * lapl_rho_up_tp[i]);
+            }
 
-            /* add remaining terms to Vxc */
-            vxc_up_tp -= (2.0 * grad_vsigma_uu_grad_rho_up_tp + grad_vsigma_ud_grad_rho_dn_tp);
-            vxc_dn_tp -= (2.0 * grad_vsigma_dd_grad_rho_dn_tp + grad_vsigma_ud_grad_rho_up_tp);
+            /* compute scalar product of the gradients of vsigma and density */
+            for (int k = 0; k < 3; k++) {
+                /* forward transform vsigma to Rlm and compute gradient */
+                auto grad_vsigma_lm = gradient_batch(sht_forward_batch(sht__, vsigma_tp[k], rgrid__).flm);
+                for (int x: {0, 1, 2}) {
+                    /* backward transform gradient from Rlm to (theta, phi) */
+                    auto grad_vsigma_tp = sht_backward_batch(sht__, grad_vsigma_lm, x);
+                    /* add remaining terms to Vxc */
+                    #pragma omp parallel for
+                    for (int i = 0; i < num_points; i++) {
+                        switch (k) {
+                            case 0: {
+                                vxc_up_tp[i] -= 2.0 * grad_vsigma_tp[i] * grad_rho_up_tp[x][i];
+                                break;
+                            }
+                            case 1: {
+                                vxc_up_tp[i] -= grad_vsigma_tp[i] * grad_rho_dn_tp[x][i];
+                                vxc_dn_tp[i] -= grad_vsigma_tp[i] * grad_rho_up_tp[x][i];
+                                break;
+                            }
+                            case 2: {
+                                vxc_dn_tp[i] -= 2.0 * grad_vsigma_tp[i] * grad_rho_dn_tp[x][i];
+                                break;
+                            }
+                        }
+                    }
+                }
+            }
         }
         /* genertate magnetic filed and effective potential inside MT sphere */
-        for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-            for (int itp = 0; itp < sht__.num_points(); itp++) {
-                /* Vxc = 0.5 * (V_up + V_dn) */
-                vxc_tp(itp, ir) = 0.5 * (vxc_up_tp(itp, ir) + vxc_dn_tp(itp, ir));
-                /* Bxc = 0.5 * (V_up - V_dn) */
-                double bxc = 0.5 * (vxc_up_tp(itp, ir) - vxc_dn_tp(itp, ir));
-                /* get the sign between mag and B */
-                auto s = utils::sign((rho_up_tp(itp, ir) - rho_dn_tp(itp, ir)) * bxc);
-
-                vector3d<double> m;
+        #pragma omp parallel for
+        for (int i = 0; i < num_points; i++) {
+            exc_tp[i] += exc1_tp[i];
+            /* Vxc = 0.5 * (V_up + V_dn) */
+            vxc_tp[i] += 0.5 * (vxc_up_tp[i] + vxc_dn_tp[i]);
+            /* Bxc = 0.5 * (V_up - V_dn) */
+            double bxc = 0.5 * (vxc_up_tp[i] - vxc_dn_tp[i]);
+            /* get the sign between mag and B */
+            auto s = utils::sign((rho_up_tp[i] - rho_dn_tp[i]) * bxc);
+
+            vector3d<double> m;
+            for (int j = 0; j < num_mag_dims__; j++) {
+                m[j] = rho_tp__[1 + j][i];
+            }
+            auto m_len = m.length();
+            if (m_len > 1e-8) {
                 for (int j = 0; j < num_mag_dims__; j++) {
-                    m[j] = rho_tp__[1 + j](itp, ir);
-                }
-                auto m_len = m.length();
-                if (m_len > 1e-8) {
-                    for (int j = 0; j < num_mag_dims__; j++) {
-                        bxc_tp[j](itp, ir) = std::abs(bxc) * s * m[j] / m_len;
-                    }
-                } else {
-                    for (int j = 0; j < num_mag_dims__; j++) {
-                        bxc_tp[j](itp, ir) = 0.0;
-                    }
+                    bxc_tp[j][i] += std::abs(bxc) * s * m[j] / m_len;
                 }
             }
         }
-        /* convert magnetic field back to Rlm */
-        for (int j = 0; j < num_mag_dims__; j++) {
-            *vxc__[j + 1] += transform(sht__, bxc_tp[j]);
-        }
-        /* forward transform from (theta, phi) to Rlm */
-        *vxc__[0] += transform(sht__, vxc_tp);
-        exc__ += transform(sht__, exc_tp);
     } // ixc
+
+    /* convert magnetic field back to Rlm */
+    for (int j = 0; j < num_mag_dims__; j++) {
+        add_batch(sht_forward_batch(sht__, bxc_tp[j]), vxc__[j + 1]);
+    }
+    /* forward transform from (theta, phi) to Rlm */
+    add_batch(sht_forward_batch(sht__, vxc_tp), vxc__[0]);
+    add_batch(sht_forward_batch(sht__, exc_tp), exc__);
+
+    return xc_points.num_skipped();
 }
 
-void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
-        int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__)
+int xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+          int num_mag_dims__, std::vector<std::vector<Flm const*>> const& rho__,
+          std::vector<std::vector<Flm*>> const& vxc__, std::vector<Flm*> const& exc__)
 {
+    int nat = static_cast<int>(exc__.size());
+
     /* zero the fields */
-    exc__->zero();
-    for (int j = 0; j < num_mag_dims__ + 1; j++) {
-        vxc__[j]->zero();
+    for (int iat = 0; iat < nat; iat++) {
+        exc__[iat]->zero();
+        for (int j = 0; j < num_mag_dims__ + 1; j++) {
+            vxc__[j][iat]->zero();
+        }
     }
 
-    std::vector<Ftp> rho_tp(num_mag_dims__ + 1);
+    std::vector<mt_batch_t> rho_tp(num_mag_dims__ + 1);
     for (int j = 0; j < num_mag_dims__ + 1; j++) {
         /* convert density and magnetization to theta, phi */
-        rho_tp[j] = transform(sht__, *rho__[j]);
+        rho_tp[j] = sht_backward_batch(sht__, rho__[j]);
     }
 
     /* check if density has negative values */
     double rhomin{0};
-    for (int ir = 0; ir < rgrid__.num_points(); ir++) {
-        for (int itp = 0; itp < sht__.num_points(); itp++) {
-            rhomin = std::min(rhomin, rho_tp[0](itp, ir));
-            /* fix negative density */
-            if (rho_tp[0](itp, ir) < 0.0) {
-                rho_tp[0](itp, ir) = 0.0;
-            }
+    for (size_t i = 0; i < rho_tp[0].size(); i++) {
+        rhomin = std::min(rhomin, rho_tp[0][i]);
+        /* fix negative density */
+        if (rho_tp[0][i] < 0.0) {
+            rho_tp[0][i] = 0.0;
         }
     }
 
@@ -322,40 +554,220 @@ void xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_
     }
 
     if (num_mag_dims__ == 0) {
-        xc_mt_nonmagnetic(rgrid__, sht__, xc_func__, *rho__[0], rho_tp[0], *vxc__[0], *exc__);
+        return xc_mt_nonmagnetic(rgrid__, sht__, xc_func__, rho__[0], rho_tp[0], vxc__[0], exc__);
     } else {
-        xc_mt_magnetic(rgrid__, sht__, num_mag_dims__, xc_func__, rho_tp, vxc__, *exc__);
+        return xc_mt_magnetic(rgrid__, sht__, num_mag_dims__, xc_func__, rho_tp, vxc__, exc__);
+    }
+}
+
+int xc_mt(Radial_grid<double> const& rgrid__, SHT const& sht__, std::vector<XC_functional> const& xc_func__,
+          int num_mag_dims__, std::vector<Flm const*> rho__, std::vector<Flm*> vxc__, Flm* exc__)
+{
+    std::vector<std::vector<Flm const*>> rho(num_mag_dims__ + 1);
+    std::vector<std::vector<Flm*>> vxc(num_mag_dims__ + 1);
+    for (int j = 0; j < num_mag_dims__ + 1; j++) {
+        rho[j].push_back(rho__[j]);
+        vxc[j].push_back(vxc__[j]);
     }
+    return xc_mt(rgrid__, sht__, xc_func__, num_mag_dims__, rho, vxc, {exc__});
 }
 
 void Potential::xc_mt(Density const& density__)
 {
     PROFILE("sirius::Potential::xc_mt");
 
-    #pragma omp parallel for
+    auto& comm = ctx_.comm();
+
+    int num_atoms = unit_cell_.num_atoms();
+    int nmag      = ctx_.num_mag_dims();
+
+    /* split atoms between ranks such that the number of radial points is balanced; the partitioning is
+     * contiguous in the atom index, as the default one */
+    std::vector<int> counts(comm.size(), 0);
+    double total{0};
+    for (int ia = 0; ia < num_atoms; ia++) {
+        total += unit_cell_.atom(ia).num_mt_points();
+    }
+    double acc{0};
+    for (int ia = 0; ia < num_atoms; ia++) {
+        int nr = unit_cell_.atom(ia).num_mt_points();
+        int r  = std::min(comm.size() - 1, static_cast<int>((acc + 0.5 * nr) * comm.size() / total));
+        counts[r]++;
+        acc += nr;
+    }
+    splindex<splindex_t::chunk> spl_atoms(num_atoms, comm.size(), comm.rank(), counts);
+
+    /* check if the new partitioning differs from the default one */
+    bool redistribute{false};
+    for (int r = 0; r < comm.size(); r++) {
+        if (counts[r] != unit_cell_.spl_num_atoms().local_size(r)) {
+            redistribute = true;
+        }
+    }
+
+    int nrmax     = unit_cell_.max_num_mt_points();
+    int lmmax_rho = density__.rho().angular_domain_size();
+    int lmmax_pot = xc_potential_->angular_domain_size();
+
+    /* input components: density and magnetisation */
+    auto rho_comp = [&](int j) -> Periodic_function<double> const& {
+        return (j == 0) ? density__.rho() : density__.magnetization(j - 1);
+    };
+    /* output components: XC potential, magnetic field and energy density */
+    auto vxc_comp = [&](int j) -> Periodic_function<double>& {
+        if (j == 0) {
+            return *xc_potential_;
+        } else if (j <= nmag) {
+            return effective_magnetic_field(j - 1);
+        } else {
+            return *xc_energy_density_;
+        }
+    };
+
+    auto& spl_default = unit_cell_.spl_num_atoms();
+
+    /* input and output functions of the atoms in the new partitioning; only the atoms that change the owner are
+     * sent point-to-point; messages between the same pair of ranks are matched in the order of atom index */
+    std::vector<sddk::mdarray<double, 3>> rho_loc;
+    std::vector<sddk::mdarray<double, 3>> vxc_loc;
+    if (redistribute) {
+        for (int j = 0; j < nmag + 1; j++) {
+            rho_loc.emplace_back(lmmax_rho, nrmax, spl_atoms.local_size(), memory_t::host, "rho_loc");
+        }
+        for (int j = 0; j < nmag + 2; j++) {
+            vxc_loc.emplace_back(lmmax_pot, nrmax, spl_atoms.local_size(), memory_t::host, "vxc_loc");
+        }
+        std::vector<Request> req;
+        for (int i = 0; i < spl_atoms.local_size(); i++) {
+            int ia = spl_atoms[i];
+            int r  = spl_default.local_rank(ia);
+            int n  = lmmax_rho * unit_cell_.atom(ia).num_mt_points();
+            for (int j = 0; j < nmag + 1; j++) {
+                if (r == comm.rank()) {
+                    auto& f = rho_comp(j).f_mt(spl_default.local_index(ia));
+                    std::copy(&f(0, 0), &f(0, 0) + n, &rho_loc[j](0, 0, i));
+                } else {
+                    req.push_back(comm.irecv(&rho_loc[j](0, 0, i), n, r, j));
+                }
+            }
+        }
+        for (int ialoc = 0; ialoc < spl_default.local_size(); ialoc++) {
+            int ia = spl_default[ialoc];
+            int r  = spl_atoms.local_rank(ia);
+            if (r != comm.rank()) {
+                int n = lmmax_rho * unit_cell_.atom(ia).num_mt_points();
+                for (int j = 0; j < nmag + 1; j++) {
+                    req.push_back(comm.isend(&rho_comp(j).f_mt(ialoc)(0, 0), n, r, j));
+                }
+            }
+        }
+        for (auto& e : req) {
+            e.wait();
+        }
+    }
+
+    /* group atoms of the same type into batches */
+    std::map<int, std::vector<int>> atoms_by_type;
+    for (int i = 0; i < spl_atoms.local_size(); i++) {
+        int ia = spl_atoms[i];
+        atoms_by_type[unit_cell_.atom(ia).type_id()].push_back(ia);
+    }
+
+    int num_points{0};
+    int num_skipped{0};
+    for (auto& e : atoms_by_type) {
+        auto& type  = unit_cell_.atom_type(e.first);
+        auto& rgrid = type.radial_grid();
+        /* limit the size of (theta, phi, r) arrays of the batch */
+        int max_batch_size = std::max(1, max_mt_batch_points / (sht_->num_points() * rgrid.num_points()));
+
+        for (int i0 = 0; i0 < static_cast<int>(e.second.size()); i0 += max_batch_size) {
+            int nat = std::min(max_batch_size, static_cast<int>(e.second.size()) - i0);
+
+            /* views to the data of atoms in the global arrays */
+            std::vector<Flm> views;
+            views.reserve(nat * (2 * nmag + 3));
+
+            std::vector<std::vector<Flm const*>> rho(nmag + 1);
+            std::vector<std::vector<Flm*>> vxc(nmag + 1);
+            std::vector<Flm*> exc;
+            for (int iat = 0; iat < nat; iat++) {
+                int ia = e.second[i0 + iat];
+                if (redistribute) {
+                    int i = spl_atoms.local_index(ia);
+                    for (int j = 0; j < nmag + 1; j++) {
+                        views.emplace_back(&rho_loc[j](0, 0, i), lmmax_rho, rgrid);
+                        rho[j].push_back(&views.back());
+                    }
+                    for (int j = 0; j < nmag + 1; j++) {
+                        views.emplace_back(&vxc_loc[j](0, 0, i), lmmax_pot, rgrid);
+                        vxc[j].push_back(&views.back());
+                    }
+                    views.emplace_back(&vxc_loc[nmag + 1](0, 0, i), lmmax_pot, rgrid);
+                    exc.push_back(&views.back());
+                } else {
+                    int ialoc = unit_cell_.spl_num_atoms().local_index(ia);
+                    rho[0].push_back(&density__.rho().f_mt(ialoc));
+                    vxc[0].push_back(&xc_potential_->f_mt(ialoc));
+                    for (int j = 0; j < nmag; j++) {
+                        rho[j + 1].push_back(&density__.magnetization(j).f_mt(ialoc));
+                        vxc[j + 1].push_back(&effective_magnetic_field(j).f_mt(ialoc));
+                    }
+                    exc.push_back(&xc_energy_density_->f_mt(ialoc));
+                }
+            }
+            num_skipped += sirius::xc_mt(rgrid, *sht_, xc_func_, nmag, rho, vxc, exc);
+            num_points += sht_->num_points() * rgrid.num_points() * nat;
+        }
+    }
+
+    if (redistribute) {
+        /* send the results back to the owners of the atoms in the default partitioning */
+        std::vector<Request> req;
+        for (int ialoc = 0; ialoc < spl_default.local_size(); ialoc++) {
+            int ia = spl_default[ialoc];
+            int r  = spl_atoms.local_rank(ia);
+            int n  = lmmax_pot * unit_cell_.atom(ia).num_mt_points();
+            for (int j = 0; j < nmag + 2; j++) {
+                auto& f = vxc_comp(j).f_mt(ialoc);
+                if (r == comm.rank()) {
+                    auto& g = vxc_loc[j];
+                    int i   = spl_atoms.local_index(ia);
+                    std::copy(&g(0, 0, i), &g(0, 0, i) + n, &f(0, 0));
+                } else {
+                    req.push_back(comm.irecv(&f(0, 0), n, r, j));
+                }
+            }
+        }
+        for (int i = 0; i < spl_atoms.local_size(); i++) {
+            int ia = spl_atoms[i];
+            int r  = spl_default.local_rank(ia);
+            if (r != comm.rank()) {
+                int n = lmmax_pot * unit_cell_.atom(ia).num_mt_points();
+                for (int j = 0; j < nmag + 2; j++) {
+                    req.push_back(comm.isend(&vxc_loc[j](0, 0, i), n, r, j));
+                }
+            }
+        }
+        for (auto& e : req) {
+            e.wait();
+        }
+    }
+
+    /* z, x, y order */
+    std::array<int, 3> comp_map = {2, 0, 1};
+    /* add auxiliary magnetic field antiparallel to starting magnetization */
     for (int ialoc = 0; ialoc < unit_cell_.spl_num_atoms().local_size(); ialoc++) {
         int ia = unit_cell_.spl_num_atoms(ialoc);
-        auto& rgrid = unit_cell_.atom(ia).radial_grid();
-        std::vector<Flm const*> rho(ctx_.num_mag_dims() + 1);
-        std::vector<Flm*> vxc(ctx_.num_mag_dims() + 1);
-        rho[0] = &density__.rho().f_mt(ialoc);
-        vxc[0] = &xc_potential_->f_mt(ialoc);
-        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-            rho[j + 1] = &density__.magnetization(j).f_mt(ialoc);
-            vxc[j + 1] = &effective_magnetic_field(j).f_mt(ialoc);
-        }
-        sirius::xc_mt(rgrid, *sht_, xc_func_, ctx_.num_mag_dims(), rho, vxc, &xc_energy_density_->f_mt(ialoc));
-
-        /* z, x, y order */
-        std::array<int, 3> comp_map = {2, 0, 1};
-        /* add auxiliary magnetic field antiparallel to starting magnetization */
-        for (int j = 0; j < ctx_.num_mag_dims(); j++) {
-            for (int ir = 0; ir < rgrid.num_points(); ir++) {
+        for (int j = 0; j < nmag; j++) {
+            for (int ir = 0; ir < unit_cell_.atom(ia).num_mt_points(); ir++) {
                 effective_magnetic_field(j).f_mt<index_domain_t::local>(0, ir, ialoc) -=
                     aux_bf_(j, ia) * ctx_.unit_cell().atom(ia).vector_field()[comp_map[j]];
             }
         }
-    } // ialoc
+    }
+
+    report_xc_compaction("xc_mt", num_points, num_skipped, comm);
 }
 
 } // namespace sirius
@@ -0,0 +1,545 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file xc_native.hpp
+ *
+ *  \brief Built-in implementation of the most common LDA and GGA functionals.
+ */
+
+#ifndef __XC_NATIVE_HPP__
+#define __XC_NATIVE_HPP__
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+#include "constants.hpp"
+
+namespace sirius {
+
+/// Built-in LDA and GGA functionals.
+/** The functionals follow the conventions of Libxc: the energy is returned per particle (\f$ \epsilon \f$),
+ *  potential is \f$ \partial (\rho \epsilon) / \partial \rho \f$ and the derivative with respect to the
+ *  contracted gradient is \f$ \partial (\rho \epsilon) / \partial \sigma \f$. The kernels are straight loops over
+ *  the points without branches in the hot path and without the per-point overhead of the generic Libxc
+ *  dispatch. Libxc is used as a reference implementation (see apps/unit_tests/test_xc_native.cpp). */
+namespace xc_native {
+
+/// List of functionals implemented natively.
+enum class functional_t
+{
+    none,
+    /// Slater exchange.
+    lda_x,
+    /// Perdew-Zunger correlation.
+    lda_c_pz,
+    /// Perdew-Wang 92 correlation.
+    lda_c_pw,
+    /// Perdew-Wang 92 correlation with the modified (more accurate) parameters.
+    lda_c_pw_mod,
+    /// PBE exchange.
+    gga_x_pbe,
+    /// PBE correlation.
+    gga_c_pbe
+};
+
+/// Get the native functional by its Libxc label.
+inline functional_t
+get_functional(std::string const& libxc_name__)
+{
+    if (libxc_name__ == "XC_LDA_X") {
+        return functional_t::lda_x;
+    }
+    if (libxc_name__ == "XC_LDA_C_PZ") {
+        return functional_t::lda_c_pz;
+    }
+    if (libxc_name__ == "XC_LDA_C_PW") {
+        return functional_t::lda_c_pw;
+    }
+    if (libxc_name__ == "XC_LDA_C_PW_MOD") {
+        return functional_t::lda_c_pw_mod;
+    }
+    if (libxc_name__ == "XC_GGA_X_PBE") {
+        return functional_t::gga_x_pbe;
+    }
+    if (libxc_name__ == "XC_GGA_C_PBE") {
+        return functional_t::gga_c_pbe;
+    }
+    return functional_t::none;
+}
+
+/// Return true if the functional is of the GGA type.
+inline bool
+is_gga(functional_t f__)
+{
+    return f__ == functional_t::gga_x_pbe || f__ == functional_t::gga_c_pbe;
+}
+
+/// Smallest allowed value of 1 +/- zeta.
+const double zeta_threshold = 2.220446049250313e-16;
+
+/// Smallest density at which the kernels are evaluated.
+/** The kernels evaluate every point and mask the points below the density threshold afterwards. The masked
+ *  points are evaluated at the threshold (and never below this value, if the threshold is zero), such that they
+ *  don't produce 0/0, rs(0) or log(0) which trap when the floating-point exceptions are enabled. Below this value
+ *  the PW92 correlation energy rounds to zero and the PBE correlation divides by zero. */
+const double dens_floor = 1e-20;
+
+/// Wigner-Seitz radius.
+inline double
+rs(double rho__)
+{
+    return std::cbrt(3.0 / (4 * pi * rho__));
+}
+
+/// Spin-interpolation function f(zeta) and its derivative.
+inline void
+fzeta(double zeta__, double& f__, double& df__)
+{
+    const double c = 1.0 / (2 * std::cbrt(2.0) - 2);
+
+    double opz = std::max(1 + zeta__, zeta_threshold);
+    double omz = std::max(1 - zeta__, zeta_threshold);
+    double a   = std::cbrt(opz);
+    double b   = std::cbrt(omz);
+
+    f__  = (opz * a + omz * b - 2) * c;
+    df__ = 4.0 * (a - b) * c / 3;
+}
+
+/// Parameters of the Perdew-Zunger correlation.
+struct pz_param
+{
+    double gamma, beta1, beta2, a, b, c, d;
+};
+
+/// Perdew-Zunger correlation energy per particle and its derivative with respect to rs.
+inline void
+pz(pz_param const& p__, double rs__, double& e__, double& de__)
+{
+    double srs = std::sqrt(rs__);
+    double lrs = std::log(rs__);
+    /* high-density limit */
+    double e1  = p__.a * lrs + p__.b + p__.c * rs__ * lrs + p__.d * rs__;
+    double de1 = p__.a / rs__ + p__.c * lrs + p__.c + p__.d;
+    /* low-density limit */
+    double x   = 1 + p__.beta1 * srs + p__.beta2 * rs__;
+    double e2  = p__.gamma / x;
+    double de2 = -p__.gamma * (0.5 * p__.beta1 / srs + p__.beta2) / (x * x);
+
+    bool low = (rs__ >= 1);
+    e__      = low ? e2 : e1;
+    de__     = low ? de2 : de1;
+}
+
+/// Parameters of the Perdew-Wang 92 G-function.
+struct pw_param
+{
+    double a, alpha1, beta1, beta2, beta3, beta4;
+};
+
+/// Perdew-Wang 92 G-function and its derivative with respect to rs.
+inline void
+pw_g(pw_param const& p__, double rs__, double& g__, double& dg__)
+{
+    double srs = std::sqrt(rs__);
+    double q0  = -2 * p__.a * (1 + p__.alpha1 * rs__);
+    double q1  = 2 * p__.a * (p__.beta1 * srs + p__.beta2 * rs__ + p__.beta3 * rs__ * srs + p__.beta4 * rs__ * rs__);
+    double dq1 = p__.a * (p__.beta1 / srs + 2 * p__.beta2 + 3 * p__.beta3 * srs + 4 * p__.beta4 * rs__);
+    double l   = std::log(1 + 1 / q1);
+
+    g__  = q0 * l;
+    dg__ = -2 * p__.a * p__.alpha1 * l - q0 * dq1 / (q1 * q1 + q1);
+}
+
+/// Set of PW92 parameters for paramagnetic, ferromagnetic and spin-stiffness parts.
+struct pw_params
+{
+    pw_param p[3];
+    /// Second derivative of f(zeta) at zeta = 0.
+    double fz20;
+};
+
+inline pw_params const&
+pw_params_orig()
+{
+    static const pw_params p = {{{0.031091, 0.21370, 7.5957, 3.5876, 1.6382, 0.49294},
+                                 {0.015545, 0.20548, 14.1189, 6.1977, 3.3662, 0.62517},
+                                 {0.016887, 0.11125, 10.357, 3.6231, 0.88026, 0.49671}},
+                                1.709921};
+    return p;
+}
+
+inline pw_params const&
+pw_params_mod()
+{
+    static const pw_params p = {{{0.0310907, 0.21370, 7.5957, 3.5876, 1.6382, 0.49294},
+                                 {0.01554535, 0.20548, 14.1189, 6.1977, 3.3662, 0.62517},
+                                 {0.0168869, 0.11125, 10.357, 3.6231, 0.88026, 0.49671}},
+                                1.709920934161365617563962776245};
+    return p;
+}
+
+/// Spin-polarized PW92 correlation energy per particle and its derivatives with respect to rs and zeta.
+inline void
+pw(pw_params const& p__, double rs__, double zeta__, double& e__, double& de_drs__, double& de_dz__)
+{
+    double g0, dg0, g1, dg1, ga, dga;
+    pw_g(p__.p[0], rs__, g0, dg0);
+    pw_g(p__.p[1], rs__, g1, dg1);
+    pw_g(p__.p[2], rs__, ga, dga);
+
+    double f, df;
+    fzeta(zeta__, f, df);
+
+    double z3 = zeta__ * zeta__ * zeta__;
+    double z4 = z3 * zeta__;
+    /* spin stiffness is -G(rs; alpha_c params) */
+    double ac  = -ga / p__.fz20;
+    double dac = -dga / p__.fz20;
+
+    e__      = g0 + ac * f * (1 - z4) + (g1 - g0) * f * z4;
+    de_drs__ = dg0 + dac * f * (1 - z4) + (dg1 - dg0) * f * z4;
+    de_dz__  = ac * (df * (1 - z4) - 4 * z3 * f) + (g1 - g0) * (df * z4 + 4 * z3 * f);
+}
+
+/// Slater exchange, unpolarized case.
+inline void
+lda_x(int n__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    /* -3/4 (3/pi)^{1/3} */
+    const double c = -0.75 * std::cbrt(3 / pi);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        double ex = c * std::cbrt(rho__[i]);
+        bool skip = (rho__[i] < thr__);
+        e__[i]    = skip ? 0 : ex;
+        v__[i]    = skip ? 0 : 4 * ex / 3;
+    }
+}
+
+/// Slater exchange, polarized case.
+inline void
+lda_x(int n__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__, double* e__,
+      double thr__)
+{
+    /* -(6/pi)^{1/3} */
+    const double c   = -std::cbrt(6 / pi);
+    const double thr = std::max(thr__, dens_floor);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip  = (rho_up__[i] + rho_dn__[i] < thr__);
+        double up  = std::max(rho_up__[i], 0.0);
+        double dn  = std::max(rho_dn__[i], 0.0);
+        double rho = std::max(up + dn, thr);
+        double vu  = c * std::cbrt(up);
+        double vd  = c * std::cbrt(dn);
+        e__[i]     = skip ? 0 : 0.75 * (vu * up + vd * dn) / rho;
+        v_up__[i]  = skip ? 0 : vu;
+        v_dn__[i]  = skip ? 0 : vd;
+    }
+}
+
+/// LDA correlation, unpolarized case.
+inline void
+lda_c(functional_t f__, int n__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    const pz_param pz_p = {-0.1423, 1.0529, 0.3334, 0.0311, -0.048, 0.0020, -0.0116};
+    auto const& pw_p    = (f__ == functional_t::lda_c_pw) ? pw_params_orig() : pw_params_mod();
+    const double thr    = std::max(thr__, dens_floor);
+
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip = (rho__[i] < thr__);
+        double r  = rs(std::max(rho__[i], thr));
+        double ec, dec;
+        if (f__ == functional_t::lda_c_pz) {
+            pz(pz_p, r, ec, dec);
+        } else {
+            pw_g(pw_p.p[0], r, ec, dec);
+        }
+        e__[i]    = skip ? 0 : ec;
+        v__[i]    = skip ? 0 : ec - r * dec / 3;
+    }
+}
+
+/// LDA correlation, polarized case.
+inline void
+lda_c(functional_t f__, int n__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__,
+      double* e__, double thr__)
+{
+    const pz_param pz_p[2] = {{-0.1423, 1.0529, 0.3334, 0.0311, -0.048, 0.0020, -0.0116},
+                              {-0.0843, 1.3981, 0.2611, 0.01555, -0.0269, 0.0007, -0.0048}};
+    auto const& pw_p = (f__ == functional_t::lda_c_pw) ? pw_params_orig() : pw_params_mod();
+    const double thr = std::max(thr__, dens_floor);
+
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip   = (rho_up__[i] + rho_dn__[i] < thr__);
+        double up   = std::max(rho_up__[i], 0.0);
+        double dn   = std::max(rho_dn__[i], 0.0);
+        double rho  = std::max(up + dn, thr);
+        double zeta = std::min(std::max((up - dn) / rho, -1.0), 1.0);
+        double r    = rs(rho);
+        double ec, de_drs, de_dz;
+        if (f__ == functional_t::lda_c_pz) {
+            double ep, dep, ef, def, f, df;
+            pz(pz_p[0], r, ep, dep);
+            pz(pz_p[1], r, ef, def);
+            fzeta(zeta, f, df);
+            ec     = ep + f * (ef - ep);
+            de_drs = dep + f * (def - dep);
+            de_dz  = df * (ef - ep);
+        } else {
+            pw(pw_p, r, zeta, ec, de_drs, de_dz);
+        }
+        double v  = ec - r * de_drs / 3;
+        e__[i]    = skip ? 0 : ec;
+        v_up__[i] = skip ? 0 : v + (1 - zeta) * de_dz;
+        v_dn__[i] = skip ? 0 : v - (1 + zeta) * de_dz;
+    }
+}
+
+const double pbe_kappa = 0.8040;
+const double pbe_mu    = 0.2195149727645171;
+const double pbe_beta  = 0.06672455060314922;
+const double pbe_gamma = (1 - 0.693147180559945309417232121458) / (pi * pi);
+
+/// Energy density, its derivatives with respect to rho and sigma of the unpolarized PBE exchange.
+inline void
+pbe_x(double rho__, double sigma__, double& f__, double& vrho__, double& vsigma__)
+{
+    const double cx = -0.75 * std::cbrt(3 / pi);
+    /* s^2 = cs * sigma / rho^{8/3} */
+    const double cs = 1.0 / (4 * std::pow(3 * pi * pi, 2.0 / 3));
+
+    double r13 = std::cbrt(rho__);
+    double ex  = cx * r13;
+    double r83 = rho__ * rho__ * r13 * r13;
+    double s2  = cs * sigma__ / r83;
+    double x   = pbe_kappa + pbe_mu * s2;
+    double fx  = 1 + pbe_kappa - pbe_kappa * pbe_kappa / x;
+    double dfx = pbe_kappa * pbe_kappa * pbe_mu / (x * x);
+
+    f__      = rho__ * ex * fx;
+    vrho__   = ex * (4 * fx - 8 * s2 * dfx) / 3;
+    vsigma__ = rho__ * ex * dfx * cs / r83;
+}
+
+/// PBE exchange, unpolarized case.
+inline void
+gga_x_pbe(int n__, double const* rho__, double const* sigma__, double* vrho__, double* vsigma__, double* e__,
+          double thr__)
+{
+    const double thr = std::max(thr__, dens_floor);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip    = (rho__[i] < thr__);
+        double rho   = std::max(rho__[i], thr);
+        double sigma = skip ? 0 : std::max(sigma__[i], 0.0);
+        double f, vr, vs;
+        pbe_x(rho, sigma, f, vr, vs);
+        e__[i]      = skip ? 0 : f / rho;
+        vrho__[i]   = skip ? 0 : vr;
+        vsigma__[i] = skip ? 0 : vs;
+    }
+}
+
+/// PBE exchange, polarized case.
+/** Spin-scaling relation \f$ E_x[\rho_{\uparrow}, \rho_{\downarrow}] = (E_x[2\rho_{\uparrow}] +
+ *  E_x[2\rho_{\downarrow}]) / 2 \f$ is used. */
+inline void
+gga_x_pbe(int n__, double const* rho_up__, double const* rho_dn__, double const* sigma_uu__,
+          double const* sigma_dd__, double* vrho_up__, double* vrho_dn__, double* vsigma_uu__, double* vsigma_ud__,
+          double* vsigma_dd__, double* e__, double thr__)
+{
+    const double thr = std::max(thr__, dens_floor);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip = (rho_up__[i] + rho_dn__[i] < thr__);
+        /* empty spin channels are evaluated at the threshold and don't contribute */
+        bool up = (rho_up__[i] >= thr__ / 2);
+        bool dn = (rho_dn__[i] >= thr__ / 2);
+        double fu, vru, vsu, fd, vrd, vsd;
+        pbe_x(std::max(2 * rho_up__[i], thr), up ? 4 * std::max(sigma_uu__[i], 0.0) : 0, fu, vru, vsu);
+        pbe_x(std::max(2 * rho_dn__[i], thr), dn ? 4 * std::max(sigma_dd__[i], 0.0) : 0, fd, vrd, vsd);
+        fu = up ? fu : 0;
+        fd = dn ? fd : 0;
+
+        double rho      = std::max(rho_up__[i] + rho_dn__[i], thr);
+        e__[i]          = skip ? 0 : 0.5 * (fu + fd) / rho;
+        vrho_up__[i]    = (skip || !up) ? 0 : vru;
+        vrho_dn__[i]    = (skip || !dn) ? 0 : vrd;
+        vsigma_uu__[i]  = (skip || !up) ? 0 : 2 * vsu;
+        vsigma_ud__[i]  = 0;
+        vsigma_dd__[i]  = (skip || !dn) ? 0 : 2 * vsd;
+    }
+}
+
+/// Energy density and its derivatives of the PBE correlation.
+/** The derivatives are taken with respect to the total density (at fixed zeta), zeta and the total contracted
+ *  gradient \f$ \sigma = |\nabla \rho|^2 \f$. */
+inline void
+pbe_c(double rho__, double zeta__, double sigma__, double& f__, double& df_drho__, double& df_dz__,
+      double& df_dsigma__)
+{
+    /* t^2 = ct * sigma / (phi^2 rho^{7/3}) */
+    const double ct = pi / (16 * std::cbrt(3 * pi * pi));
+    const double bg = pbe_beta / pbe_gamma;
+
+    double r = rs(rho__);
+    double ec, dec_drs, dec_dz;
+    pw(pw_params_mod(), r, zeta__, ec, dec_drs, dec_dz);
+    double dec_drho = -dec_drs * r / (3 * rho__);
+
+    double opz  = std::max(1 + zeta__, zeta_threshold);
+    double omz  = std::max(1 - zeta__, zeta_threshold);
+    double a    = std::cbrt(opz);
+    double b    = std::cbrt(omz);
+    double phi  = 0.5 * (a * a + b * b);
+    double dphi = (1 / a - 1 / b) / 3;
+    double phi3 = phi * phi * phi;
+
+    double r13 = std::cbrt(rho__);
+    double y   = ct * sigma__ / (phi * phi * rho__ * rho__ * r13);
+
+    double ex = std::exp(-ec / (pbe_gamma * phi3));
+    double A  = bg / (ex - 1);
+    /* derivatives of A with respect to ec and phi */
+    double dA_dec  = A * A * ex / (pbe_beta * phi3);
+    double dA_dphi = -3 * A * A * ex * ec / (pbe_beta * phi3 * phi);
+
+    double ay  = A * y;
+    double num = 1 + ay;
+    double den = 1 + ay + ay * ay;
+    double Q   = bg * y * num / den;
+    double H   = pbe_gamma * phi3 * std::log(1 + Q);
+
+    double dH_dQ = pbe_gamma * phi3 / (1 + Q);
+    double dH_dy = dH_dQ * bg * (1 + 2 * ay) / (den * den);
+    double dH_dA = -dH_dQ * bg * A * y * y * y * (2 + ay) / (den * den);
+
+    double dH_drho = dH_dA * dA_dec * dec_drho - 7 * dH_dy * y / (3 * rho__);
+    double dH_dz   = (3 * H / phi + dH_dA * dA_dphi - 2 * dH_dy * y / phi) * dphi + dH_dA * dA_dec * dec_dz;
+
+    f__         = rho__ * (ec + H);
+    df_drho__   = ec + H + rho__ * (dec_drho + dH_drho);
+    df_dz__     = rho__ * (dec_dz + dH_dz);
+    df_dsigma__ = rho__ * dH_dy * ct / (phi * phi * rho__ * rho__ * r13);
+}
+
+/// PBE correlation, unpolarized case.
+inline void
+gga_c_pbe(int n__, double const* rho__, double const* sigma__, double* vrho__, double* vsigma__, double* e__,
+          double thr__)
+{
+    const double thr = std::max(thr__, dens_floor);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip    = (rho__[i] < thr__);
+        double rho   = std::max(rho__[i], thr);
+        double sigma = skip ? 0 : std::max(sigma__[i], 0.0);
+        double f, vr, vz, vs;
+        pbe_c(rho, 0, sigma, f, vr, vz, vs);
+        e__[i]      = skip ? 0 : f / rho;
+        vrho__[i]   = skip ? 0 : vr;
+        vsigma__[i] = skip ? 0 : vs;
+    }
+}
+
+/// PBE correlation, polarized case.
+inline void
+gga_c_pbe(int n__, double const* rho_up__, double const* rho_dn__, double const* sigma_uu__,
+          double const* sigma_ud__, double const* sigma_dd__, double* vrho_up__, double* vrho_dn__,
+          double* vsigma_uu__, double* vsigma_ud__, double* vsigma_dd__, double* e__, double thr__)
+{
+    const double thr = std::max(thr__, dens_floor);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        bool skip    = (rho_up__[i] + rho_dn__[i] < thr__);
+        double up    = std::max(rho_up__[i], 0.0);
+        double dn    = std::max(rho_dn__[i], 0.0);
+        double rho   = std::max(up + dn, thr);
+        double zeta  = std::min(std::max((up - dn) / rho, -1.0), 1.0);
+        double sigma = skip ? 0 : std::max(sigma_uu__[i] + 2 * sigma_ud__[i] + sigma_dd__[i], 0.0);
+        double f, vr, vz, vs;
+        pbe_c(rho, zeta, sigma, f, vr, vz, vs);
+        e__[i]          = skip ? 0 : f / rho;
+        vrho_up__[i]    = skip ? 0 : vr + vz * (1 - zeta) / rho;
+        vrho_dn__[i]    = skip ? 0 : vr - vz * (1 + zeta) / rho;
+        vsigma_uu__[i]  = skip ? 0 : vs;
+        vsigma_ud__[i]  = skip ? 0 : 2 * vs;
+        vsigma_dd__[i]  = skip ? 0 : vs;
+    }
+}
+
+/// Evaluate LDA functional, unpolarized case.
+inline void
+get_lda(functional_t f__, int n__, double const* rho__, double* v__, double* e__, double thr__)
+{
+    if (f__ == functional_t::lda_x) {
+        lda_x(n__, rho__, v__, e__, thr__);
+    } else {
+        lda_c(f__, n__, rho__, v__, e__, thr__);
+    }
+}
+
+/// Evaluate LDA functional, polarized case.
+inline void
+get_lda(functional_t f__, int n__, double const* rho_up__, double const* rho_dn__, double* v_up__, double* v_dn__,
+        double* e__, double thr__)
+{
+    if (f__ == functional_t::lda_x) {
+        lda_x(n__, rho_up__, rho_dn__, v_up__, v_dn__, e__, thr__);
+    } else {
+        lda_c(f__, n__, rho_up__, rho_dn__, v_up__, v_dn__, e__, thr__);
+    }
+}
+
+/// Evaluate GGA functional, unpolarized case.
+inline void
+get_gga(functional_t f__, int n__, double const* rho__, double const* sigma__, double* vrho__, double* vsigma__,
+        double* e__, double thr__)
+{
+    if (f__ == functional_t::gga_x_pbe) {
+        gga_x_pbe(n__, rho__, sigma__, vrho__, vsigma__, e__, thr__);
+    } else {
+        gga_c_pbe(n__, rho__, sigma__, vrho__, vsigma__, e__, thr__);
+    }
+}
+
+/// Evaluate GGA functional, polarized case.
+inline void
+get_gga(functional_t f__, int n__, double const* rho_up__, double const* rho_dn__, double const* sigma_uu__,
+        double const* sigma_ud__, double const* sigma_dd__, double* vrho_up__, double* vrho_dn__,
+        double* vsigma_uu__, double* vsigma_ud__, double* vsigma_dd__, double* e__, double thr__)
+{
+    if (f__ == functional_t::gga_x_pbe) {
+        gga_x_pbe(n__, rho_up__, rho_dn__, sigma_uu__, sigma_dd__, vrho_up__, vrho_dn__, vsigma_uu__, vsigma_ud__,
+                  vsigma_dd__, e__, thr__);
+    } else {
+        gga_c_pbe(n__, rho_up__, rho_dn__, sigma_uu__, sigma_ud__, sigma_dd__, vrho_up__, vrho_dn__, vsigma_uu__,
+                  vsigma_ud__, vsigma_dd__, e__, thr__);
+    }
+}
+
+} // namespace xc_native
+
+} // namespace sirius
+
+#endif // __XC_NATIVE_HPP__
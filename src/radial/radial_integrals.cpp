@@ -80,7 +80,7 @@ void Radial_integrals_aug<jl_deriv>::generate()
     for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
         auto& atom_type = unit_cell_.atom_type(iat);
 
-        if (!atom_type.augment()) {
+        if (!atom_type.augment() || this->load_cache(jl_deriv ? "aug_djl" : "aug", iat)) {
             continue;
         }
 
@@ -89,6 +89,29 @@ void Radial_integrals_aug<jl_deriv>::generate()
         /* maximum l of beta-projectors */
         int lmax_beta = atom_type.indexr().lmax();
 
+        if (use_sbt_ && !jl_deriv) {
+            auto sbt = this->sbt(2 * lmax_beta, atom_type.radial_grid());
+            for (int l3 = 0; l3 <= 2 * lmax_beta; l3++) {
+                for (int idxrf2 = 0; idxrf2 < nbrf; idxrf2++) {
+                    int l2 = atom_type.indexr(idxrf2).l;
+                    for (int idxrf1 = 0; idxrf1 <= idxrf2; idxrf1++) {
+                        int l1  = atom_type.indexr(idxrf1).l;
+                        int idx = idxrf2 * (idxrf2 + 1) / 2 + idxrf1;
+                        if (l3 >= std::abs(l1 - l2) && l3 <= (l1 + l2) && (l1 + l2 + l3) % 2 == 0) {
+                            auto& f   = atom_type.q_radial_function(idxrf1, idxrf2, l3);
+                            auto g    = sbt.transform(l3, f, 0);
+                            double v0 = (l3 == 0) ? f.integrate(0) : 0;
+                            values_(idx, l3, iat) = this->sbt_spline(sbt, g, v0);
+                        } else {
+                            values_(idx, l3, iat) = Spline<double>(grid_q_);
+                        }
+                    }
+                }
+            }
+            this->save_cache("aug", iat);
+            continue;
+        }
+
         for (int l = 0; l <= 2 * lmax_beta; l++) {
             for (int idx = 0; idx < nbrf * (nbrf + 1) / 2; idx++) {
                 values_(idx, l, iat) = Spline<double>(grid_q_);
@@ -135,6 +158,7 @@ void Radial_integrals_aug<jl_deriv>::generate()
                 values_(idx, l, iat).interpolate();
             }
         }
+        this->save_cache(jl_deriv ? "aug_djl" : "aug", iat);
     }
 }
 
@@ -145,14 +169,26 @@ void Radial_integrals_rho_pseudo::generate()
     for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
         auto& atom_type = unit_cell_.atom_type(iat);
 
-        if (atom_type.ps_total_charge_density().empty()) {
+        if (atom_type.ps_total_charge_density().empty() || this->load_cache("rho_pseudo", iat)) {
             continue;
         }
 
-        values_(iat) = Spline<double>(grid_q_);
-
         Spline<double> rho(atom_type.radial_grid(), atom_type.ps_total_charge_density());
 
+        if (use_sbt_) {
+            auto sbt = this->sbt(0, atom_type.radial_grid());
+            double rc = atom_type.radial_grid(atom_type.num_mt_points() - 1);
+            auto g = sbt.transform(0, rho, 0, rc);
+            for (auto& e : g) {
+                e /= fourpi;
+            }
+            values_(iat) = this->sbt_spline(sbt, g, rho.integrate(0) / fourpi);
+            this->save_cache("rho_pseudo", iat);
+            continue;
+        }
+
+        values_(iat) = Spline<double>(grid_q_);
+
         #pragma omp parallel for
         for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
             int iq = spl_q_[iq_loc];
@@ -162,6 +198,7 @@ void Radial_integrals_rho_pseudo::generate()
         }
         unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.local_size(), spl_q_.global_offset());
         values_(iat).interpolate();
+        this->save_cache("rho_pseudo", iat);
     }
 }
 
@@ -207,7 +244,20 @@ void Radial_integrals_beta<jl_deriv>::generate()
         auto& atom_type = unit_cell_.atom_type(iat);
         int nrb = atom_type.num_beta_radial_functions();
 
-        if (!nrb) {
+        if (!nrb || this->load_cache(jl_deriv ? "beta_djl" : "beta", iat)) {
+            continue;
+        }
+
+        if (use_sbt_ && !jl_deriv) {
+            auto sbt = this->sbt(atom_type.indexr().lmax(), atom_type.radial_grid());
+            for (int idxrf = 0; idxrf < nrb; idxrf++) {
+                int l    = atom_type.indexr(idxrf).l;
+                auto& f  = atom_type.beta_radial_function(idxrf);
+                auto g   = sbt.transform(l, f, 1);
+                double v0 = (l == 0) ? f.integrate(1) : 0;
+                values_(idxrf, iat) = this->sbt_spline(sbt, g, v0);
+            }
+            this->save_cache("beta", iat);
             continue;
         }
 
@@ -236,6 +286,7 @@ void Radial_integrals_beta<jl_deriv>::generate()
             unit_cell_.comm().allgather(&values_(idxrf, iat)(0), spl_q_.local_size(), spl_q_.global_offset());
             values_(idxrf, iat).interpolate();
         }
+        this->save_cache(jl_deriv ? "beta_djl" : "beta", iat);
     }
 }
 
@@ -287,7 +338,7 @@ void Radial_integrals_vloc<jl_deriv>::generate()
     for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
         auto& atom_type = unit_cell_.atom_type(iat);
 
-        if (atom_type.local_potential().empty()) {
+        if (atom_type.local_potential().empty() || this->load_cache(jl_deriv ? "vloc_djl" : "vloc", iat)) {
             continue;
         }
 
@@ -312,6 +363,26 @@ void Radial_integrals_vloc<jl_deriv>::generate()
 
         auto rg = atom_type.radial_grid().segment(np);
 
+        if (use_sbt_ && !jl_deriv) {
+            /* q * \int j_0(q r) (r V(r) + Z erf(r)) r dr; the q = 0 value is \int (r V(r) + Z) r dr */
+            Spline<double> f(rg);
+            Spline<double> f0(rg);
+            for (int ir = 0; ir < rg.num_points(); ir++) {
+                double x = rg[ir];
+                f(ir)    = x * vloc[ir] + atom_type.zn() * std::erf(x);
+                f0(ir)   = (x * vloc[ir] + atom_type.zn()) * x;
+            }
+            f.interpolate();
+            auto sbt = this->sbt(0, rg);
+            auto g   = sbt.transform(0, f, 1);
+            for (int j = 0; j < sbt.num_points(); j++) {
+                g[j] *= sbt.k(j);
+            }
+            values_(iat) = this->sbt_spline(sbt, g, f0.interpolate().integrate(0));
+            this->save_cache("vloc", iat);
+            continue;
+        }
+
         #pragma omp parallel for
         for (int iq_loc = 0; iq_loc < spl_q_.local_size(); iq_loc++) {
             int iq = spl_q_[iq_loc];
@@ -342,6 +413,7 @@ void Radial_integrals_vloc<jl_deriv>::generate()
         }
         unit_cell_.comm().allgather(&values_(iat)(0), spl_q_.local_size(), spl_q_.global_offset());
         values_(iat).interpolate();
+        this->save_cache(jl_deriv ? "vloc_djl" : "vloc", iat);
     }
 }
 
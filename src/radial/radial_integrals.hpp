@@ -28,6 +28,9 @@
 #include "unit_cell/unit_cell.hpp"
 #include "specfunc/sbessel.hpp"
 #include "utils/rte.hpp"
+#include "utils/binary_cache.hpp"
+#include "radial/spherical_bessel_transform.hpp"
+#include "SDDK/memory_shared.hpp"
 
 namespace sirius {
 
@@ -51,10 +54,254 @@ class Radial_integrals_base
     /// Maximum length of the reciprocal wave-vector.
     double qmax_{0};
 
+    /// Cache of the interpolated radial integrals.
+    utils::binary_cache cache_;
+
+    /// Key of the cached radial integrals of a given kind for a given atom type.
+    /** The key depends on the input of the atom type and on the q-grid. Zero is returned if the input of the
+     *  atom type is not known, and the integrals are not cached. */
+    inline uint64_t cache_key(std::string const& label__, int iat__) const
+    {
+        auto h = unit_cell_.atom_type(iat__).input_hash();
+        if (!h) {
+            return 0;
+        }
+        int nq = grid_q_.num_points();
+        h = utils::hash(label__.data(), label__.size(), h);
+        h = utils::hash(&qmax_, sizeof(double), h);
+        h = utils::hash(&use_sbt_, sizeof(bool), h);
+        return utils::hash(&nq, sizeof(int), h);
+    }
+
+    /// Number of splines for a single atom type (the atom type is the last index of values_).
+    inline size_t cache_block_size() const
+    {
+        return values_.size() / values_.size(N - 1);
+    }
+
+    /// Load radial integrals of the atom type from the cache.
+    /** The record contains the number of splines and for each non-empty spline the N-1 leading indices and
+     *  the spline coefficients. This is a collective operation: the integrals are loaded only if the record is
+     *  valid on all ranks, otherwise all ranks compute them (the computation ends with a collective allgather). */
+    bool load_cache(std::string const& label__, int iat__)
+    {
+        auto key = cache_key(label__, iat__);
+        if (!key) {
+            return false;
+        }
+        auto r        = cache_.read("ri", key);
+        int nq        = grid_q_.num_points();
+        size_t rsize  = sizeof(int) * (N - 1) + sizeof(double) * 4 * nq;
+        auto ptr      = r.data();
+        int n{0};
+        /* check the record before anything is modified */
+        auto check = [&]() {
+            if (!r.valid()) {
+                return false;
+            }
+            std::memcpy(&n, ptr, sizeof(int));
+            if (r.size() != sizeof(int) + n * rsize) {
+                return false;
+            }
+            for (int i = 0; i < n; i++) {
+                std::array<int, N - 1> idx;
+                std::memcpy(idx.data(), ptr + sizeof(int) + i * rsize, sizeof(int) * (N - 1));
+                for (int d = 0; d < N - 1; d++) {
+                    if (idx[d] < 0 || idx[d] >= static_cast<int>(values_.size(d))) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        };
+        int valid = check() ? 1 : 0;
+        unit_cell_.comm().allreduce<int, sddk::mpi_op_t::min>(&valid, 1);
+        if (!valid) {
+            return false;
+        }
+        auto v = values_.at(sddk::memory_t::host) + cache_block_size() * iat__;
+        for (int i = 0; i < n; i++) {
+            auto p = ptr + sizeof(int) + i * rsize;
+            std::array<int, N - 1> idx;
+            std::memcpy(idx.data(), p, sizeof(int) * (N - 1));
+            size_t j{0};
+            for (int d = N - 2; d >= 0; d--) {
+                j = j * values_.size(d) + idx[d];
+            }
+            v[j] = Spline<double>(grid_q_);
+            std::memcpy(v[j].coeffs().at(sddk::memory_t::host), p + sizeof(int) * (N - 1),
+                        sizeof(double) * 4 * nq);
+        }
+        return true;
+    }
+
+    /// Store radial integrals of the atom type in the cache.
+    void save_cache(std::string const& label__, int iat__) const
+    {
+        auto key = cache_key(label__, iat__);
+        if (!key || unit_cell_.comm().rank() != 0) {
+            return;
+        }
+        int nq       = grid_q_.num_points();
+        size_t rsize = sizeof(int) * (N - 1) + sizeof(double) * 4 * nq;
+        auto v       = values_.at(sddk::memory_t::host) + cache_block_size() * iat__;
+
+        int n{0};
+        for (size_t j = 0; j < cache_block_size(); j++) {
+            n += (v[j].num_points() == nq) ? 1 : 0;
+        }
+        std::vector<char> buf(sizeof(int) + n * rsize);
+        std::memcpy(buf.data(), &n, sizeof(int));
+        auto p = buf.data() + sizeof(int);
+        for (size_t j = 0; j < cache_block_size(); j++) {
+            if (v[j].num_points() != nq) {
+                continue;
+            }
+            std::array<int, N - 1> idx;
+            size_t k = j;
+            for (int d = 0; d < N - 1; d++) {
+                idx[d] = static_cast<int>(k % values_.size(d));
+                k /= values_.size(d);
+            }
+            std::memcpy(p, idx.data(), sizeof(int) * (N - 1));
+            std::memcpy(p + sizeof(int) * (N - 1), v[j].coeffs().at(sddk::memory_t::host), sizeof(double) * 4 * nq);
+            p += rsize;
+        }
+        cache_.write("ri", key, buf.data(), buf.size());
+    }
+
+    /// True if the radial integrals are generated with the fast spherical Bessel transform.
+    bool use_sbt_{false};
+
+    /// Create the fast spherical Bessel transform for functions defined on a given radial grid.
+    inline Spherical_Bessel_transform sbt(int lmax__, Radial_grid<double> const& rgrid__) const
+    {
+        /* number of points of the logarithmic grids; the relative error of the transform is ~1e-9 */
+        int const n{4096};
+        return Spherical_Bessel_transform(lmax__, 1e-6, rgrid__.last(), grid_q_.last(), n);
+    }
+
+    /// Create the spline of radial integrals from the transform on the logarithmic k-grid.
+    /** The value at q = 0, which is not covered by the logarithmic k-grid, is given explicitly. */
+    inline Spline<double> sbt_spline(Spherical_Bessel_transform const& sbt__, std::vector<double> const& g__,
+                                     double v0__) const
+    {
+        auto gs = sbt__.interpolate(g__);
+        Spline<double> s(grid_q_);
+        s(0) = v0__;
+        for (int iq = 1; iq < grid_q_.num_points(); iq++) {
+            s(iq) = sbt__.value(gs, grid_q_[iq]);
+        }
+        s.interpolate();
+        return s;
+    }
+
+    /// Coefficients of the interpolating splines of one atom type in the structure-of-arrays layout.
+    /** For each point of the q-grid the coefficients of all non-empty splines are stored contiguously, so that
+     *  all radial integrals of the atom type at a given q are evaluated in a single vectorized loop. */
+    struct spline_soa
+    {
+        /// Flat index of each spline inside the block of the atom type in values_.
+        std::vector<int> idx;
+        /// Spline coefficients c(ispl, k, iq), k = 0..3.
+        sddk::mdarray<double, 3> c;
+    };
+
+    /// Structure-of-arrays copy of the spline coefficients for each atom type.
+    std::vector<spline_soa> soa_;
+
+    /// Create the structure-of-arrays copy of the spline coefficients.
+    /** Must be called by the derived class after the radial integrals are generated. If settings.shared_memory is
+     *  set, the coefficients are stored once per node in the shared memory and are filled by the first rank of
+     *  the node.
+     *
+     *  Only the augmentation integrals use it: their table holds O(nbeta^2 * lmax) splines per atom type. The beta,
+     *  atomic wave-function, local potential and core / pseudo density tables hold O(nbeta) or a single spline per
+     *  atom type; they are small compared with the augmentation table and stay per rank. */
+    void init_soa()
+    {
+        int nq      = grid_q_.num_points();
+        bool shared = unit_cell_.parameters().cfg().settings().shared_memory();
+        auto& comm  = unit_cell_.comm_node();
+        soa_.resize(unit_cell_.num_atom_types());
+        for (int iat = 0; iat < unit_cell_.num_atom_types(); iat++) {
+            auto v  = values_.at(sddk::memory_t::host) + cache_block_size() * iat;
+            auto& s = soa_[iat];
+            s.idx.clear();
+            for (size_t j = 0; j < cache_block_size(); j++) {
+                if (v[j].num_points() == nq) {
+                    s.idx.push_back(static_cast<int>(j));
+                }
+            }
+            int ns = static_cast<int>(s.idx.size());
+            if (ns == 0) {
+                continue;
+            }
+            if (shared) {
+                s.c = sddk::mdarray<double, 3>(ns, 4, nq, sddk::memory_t::none, "soa_.c");
+                s.c.allocate(comm);
+                if (comm.rank() != 0) {
+                    continue;
+                }
+            } else {
+                s.c = sddk::mdarray<double, 3>(ns, 4, nq);
+            }
+            for (int i = 0; i < ns; i++) {
+                auto& c = v[s.idx[i]].coeffs();
+                for (int iq = 0; iq < nq; iq++) {
+                    for (int k = 0; k < 4; k++) {
+                        s.c(i, k, iq) = c(iq, k);
+                    }
+                }
+            }
+        }
+        if (shared) {
+            for (auto& s : soa_) {
+                s.c.sync_shared(comm);
+            }
+        }
+    }
+
+    /// Release the spline objects; the radial integrals are evaluated only with the structure-of-arrays copy.
+    void release_splines()
+    {
+        auto v = values_.at(sddk::memory_t::host);
+        for (size_t j = 0; j < values_.size(); j++) {
+            v[j] = Spline<double>();
+        }
+    }
+
+    /// Evaluate all radial integrals of the atom type for a batch of q-points.
+    /** The values are stored as val[ispl + iq * ld] in the order of soa_[iat].idx. */
+    void values_batch(int iat__, int nq__, double const* q__, double* val__, int ld__) const
+    {
+        auto& s = soa_[iat__];
+        int ns  = static_cast<int>(s.idx.size());
+        if (ns == 0) {
+            return;
+        }
+        #pragma omp parallel for schedule(static)
+        for (int iq = 0; iq < nq__; iq++) {
+            auto idx   = iqdq(q__[iq]);
+            double dq  = idx.second;
+            auto c0    = s.c.at(sddk::memory_t::host, 0, 0, idx.first);
+            auto c1    = s.c.at(sddk::memory_t::host, 0, 1, idx.first);
+            auto c2    = s.c.at(sddk::memory_t::host, 0, 2, idx.first);
+            auto c3    = s.c.at(sddk::memory_t::host, 0, 3, idx.first);
+            double* v  = val__ + static_cast<size_t>(iq) * ld__;
+            #pragma omp simd
+            for (int i = 0; i < ns; i++) {
+                v[i] = c0[i] + dq * (c1[i] + dq * (c2[i] + dq * c3[i]));
+            }
+        }
+    }
+
   public:
     /// Constructor.
     Radial_integrals_base(Unit_cell const& unit_cell__, double const qmax__, int const np__)
         : unit_cell_(unit_cell__)
+        , cache_(unit_cell__.parameters().cfg().settings().cache_dir())
+        , use_sbt_(unit_cell__.parameters().cfg().settings().sbt_radial_integrals())
     {
         /* Add extra length to the cutoffs in order to interpolate radial integrals for q > cutoff.
            This is needed for the variable cell relaxation when lattice changes and the G-vectors in
@@ -175,6 +422,18 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
   private:
     std::function<void(int, double, double*, int, int)> ri_callback_{nullptr};
 
+    /// Radial integrals of an atom type computed for the last batch of q-points.
+    struct batch_values
+    {
+        /// Hash of the q-points of the batch.
+        uint64_t key{0};
+        /// Values of radial integrals (idxrf12, l, iq).
+        sddk::mdarray<double, 3> val;
+    };
+
+    /// Last computed batch of radial integrals for each atom type.
+    mutable std::vector<batch_values> batch_values_;
+
     void generate();
 
   public:
@@ -191,7 +450,10 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
                 sddk::mdarray<Spline<double>, 3>(nmax * (nmax + 1) / 2, 2 * lmax + 1, unit_cell_.num_atom_types());
 
             generate();
+            init_soa();
+            release_splines();
         }
+        batch_values_.resize(unit_cell_.num_atom_types());
     }
 
     inline sddk::mdarray<double, 2> values(int iat__, double q__) const
@@ -203,11 +465,17 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
         sddk::mdarray<double, 2> val(nbrf * (nbrf + 1) / 2, 2 * lmax + 1);
 
         if (ri_callback_ == nullptr) {
-            auto idx = iqdq(q__);
-
-            for (int l = 0; l <= 2 * lmax; l++) {
-                for (int i = 0; i < nbrf * (nbrf + 1) / 2; i++) {
-                    val(i, l) = values_(i, l, iat__)(idx.first, idx.second);
+            val.zero();
+            auto& s = soa_[iat__];
+            int ns  = static_cast<int>(s.idx.size());
+            std::vector<double> tmp(ns);
+            values_batch(iat__, 1, &q__, tmp.data(), ns);
+            int ld = static_cast<int>(values_.size(0));
+            for (int i = 0; i < ns; i++) {
+                int j = s.idx[i] % ld;
+                int l = s.idx[i] / ld;
+                if (j < nbrf * (nbrf + 1) / 2 && l <= 2 * lmax) {
+                    val(j, l) = tmp[i];
                 }
             }
         } else {
@@ -215,6 +483,56 @@ class Radial_integrals_aug : public Radial_integrals_base<3>
         }
         return val;
     }
+
+    /// Get all values for a given atom type and a batch of q-points (e.g. lengths of the G-vector shells).
+    /** Returns the array (idxrf12, l, iq). The result is kept for each atom type and the repeated call with the
+     *  same q-points (lattice is not changed) returns it without evaluation. This function is not thread-safe. */
+    inline sddk::mdarray<double, 3> const& values(int iat__, std::vector<double> const& q__) const
+    {
+        PROFILE("sirius::Radial_integrals_aug::values");
+
+        auto& atom_type = unit_cell_.atom_type(iat__);
+        int lmax        = atom_type.indexr().lmax();
+        int nbrf        = atom_type.mt_radial_basis_size();
+        int n12         = nbrf * (nbrf + 1) / 2;
+        int nq          = static_cast<int>(q__.size());
+
+        auto key = utils::hash(q__.data(), q__.size() * sizeof(double), static_cast<uint64_t>(nq) + 5381);
+
+        auto& bv = batch_values_[iat__];
+        if (bv.key == key && static_cast<int>(bv.val.size(2)) == nq) {
+            return bv.val;
+        }
+        bv.key = 0;
+        bv.val = sddk::mdarray<double, 3>(n12, 2 * lmax + 1, nq);
+
+        if (ri_callback_ == nullptr) {
+            bv.val.zero();
+            auto& s = soa_[iat__];
+            int ns  = static_cast<int>(s.idx.size());
+            if (ns) {
+                sddk::mdarray<double, 2> tmp(ns, nq);
+                values_batch(iat__, nq, q__.data(), tmp.at(sddk::memory_t::host), ns);
+                int ld = static_cast<int>(values_.size(0));
+                #pragma omp parallel for schedule(static)
+                for (int iq = 0; iq < nq; iq++) {
+                    for (int i = 0; i < ns; i++) {
+                        int j = s.idx[i] % ld;
+                        int l = s.idx[i] / ld;
+                        if (j < n12 && l <= 2 * lmax) {
+                            bv.val(j, l, iq) = tmp(i, iq);
+                        }
+                    }
+                }
+            }
+        } else {
+            for (int iq = 0; iq < nq; iq++) {
+                ri_callback_(iat__ + 1, q__[iq], bv.val.at(sddk::memory_t::host, 0, 0, iq), n12, 2 * lmax + 1);
+            }
+        }
+        bv.key = key;
+        return bv.val;
+    }
 };
 
 class Radial_integrals_rho_pseudo : public Radial_integrals_base<1>
@@ -0,0 +1,260 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file spherical_bessel_transform.hpp
+ *
+ *  \brief Contains declaration and implementation of sirius::Spherical_Bessel_transform class.
+ */
+
+#ifndef __SPHERICAL_BESSEL_TRANSFORM_HPP__
+#define __SPHERICAL_BESSEL_TRANSFORM_HPP__
+
+#include <complex>
+#include <vector>
+#include <cmath>
+#include "radial/spline.hpp"
+#include "utils/rte.hpp"
+
+namespace sirius {
+
+/// Fast spherical Bessel transform on the logarithmic grid.
+/** The transform
+ *  \f[
+ *    g_{\ell}(k) = \int_0^{\infty} j_{\ell}(kr) f(r) r^m dr
+ *  \f]
+ *  is computed for all points of the logarithmic k-grid at once, following J. D. Talman, Comput. Phys. Commun.
+ *  180, 332 (2009). With \f$ x = \ln r \f$, \f$ y = \ln k \f$ the transform is a correlation
+ *  \f[
+ *    k^{3/2} g_{\ell}(k) = \int K_{\ell}(x + y) F(x) dx, \quad K_{\ell}(t) = e^{3t/2} j_{\ell}(e^t),
+ *    \quad F(x) = r^{m - 1/2} f(r)
+ *  \f]
+ *  which is evaluated with two FFTs of the length \f$ 2N \f$ (the input is padded with zeros). The Fourier
+ *  transform of the kernel is known analytically:
+ *  \f[
+ *    M_{\ell}(\omega) = \int_0^{\infty} r^{s - 1} j_{\ell}(r) dr = 2^{s-2} \sqrt{\pi}
+ *      \frac{\Gamma(\frac{\ell + s}{2})}{\Gamma(\frac{\ell + 3 - s}{2})}, \quad s = \frac{3}{2} + i\omega
+ *  \f]
+ *  The cost is \f$ O(N \log N) \f$ per function instead of \f$ O(N_q N_r) \f$ of the direct integration.
+ *  The method requires \f$ F(x) \f$ to be smooth on the logarithmic grid; for \f$ k r_{max} \lesssim 1 \f$ the
+ *  accuracy drops and such k-points should be computed by direct integration. */
+class Spherical_Bessel_transform
+{
+  private:
+    /// Maximum orbital quantum number.
+    int lmax_;
+
+    /// Number of points of the r- and k-grids (power of two).
+    int n_;
+
+    /// Step of the logarithmic grids.
+    double dx_;
+
+    /// Logarithm of the first point of the r-grid.
+    double x0_;
+
+    /// Logarithm of the first point of the k-grid.
+    double y0_;
+
+    /// Fourier transform of the kernel for each l, multiplied by the phase factor and the FFT normalization.
+    std::vector<std::vector<std::complex<double>>> mk_;
+
+    /// Logarithm of the complex gamma function for Re(z) > 0 (Lanczos approximation, g = 7).
+    static std::complex<double> lgamma(std::complex<double> z__)
+    {
+        static const double c[] = {0.99999999999980993,  676.5203681218851,     -1259.1392167224028,
+                                   771.32342877765313,   -176.61502916214059,   12.507343278686905,
+                                   -0.13857109526572012, 9.9843695780195716e-6, 1.5056327351493116e-7};
+        z__ -= 1.0;
+        std::complex<double> a = c[0];
+        for (int i = 1; i < 9; i++) {
+            a += c[i] / (z__ + static_cast<double>(i));
+        }
+        auto t = z__ + 7.5;
+        return 0.5 * std::log(2 * M_PI) + (z__ + 0.5) * std::log(t) - t + std::log(a);
+    }
+
+    /// In-place radix-2 complex FFT with the kernel exp(-2 pi i k j / n).
+    static void fft(std::vector<std::complex<double>>& a__)
+    {
+        int n = static_cast<int>(a__.size());
+        for (int i = 1, j = 0; i < n; i++) {
+            int bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(a__[i], a__[j]);
+            }
+        }
+        for (int len = 2; len <= n; len <<= 1) {
+            double phi = -2 * M_PI / len;
+            std::complex<double> w1(std::cos(phi), std::sin(phi));
+            for (int i = 0; i < n; i += len) {
+                std::complex<double> w(1, 0);
+                for (int j = 0; j < len / 2; j++) {
+                    auto u                = a__[i + j];
+                    auto v                = a__[i + j + len / 2] * w;
+                    a__[i + j]            = u + v;
+                    a__[i + j + len / 2]  = u - v;
+                    w *= w1;
+                }
+            }
+        }
+    }
+
+  public:
+    /// Constructor.
+    /** \param [in] lmax  Maximum orbital quantum number.
+     *  \param [in] rmin  First point of the r-grid.
+     *  \param [in] rmax  Last point of the r-grid.
+     *  \param [in] kmax  Last point of the k-grid.
+     *  \param [in] n     Number of points (rounded up to the power of two).
+     */
+    Spherical_Bessel_transform(int lmax__, double rmin__, double rmax__, double kmax__, int n__)
+        : lmax_(lmax__)
+    {
+        if (rmin__ <= 0 || rmax__ <= rmin__ || kmax__ <= 0) {
+            RTE_THROW("wrong parameters of the logarithmic grid");
+        }
+        n_ = 2;
+        while (n_ < n__) {
+            n_ <<= 1;
+        }
+        dx_ = std::log(rmax__ / rmin__) / (n_ - 1);
+        x0_ = std::log(rmin__);
+        y0_ = std::log(kmax__) - (n_ - 1) * dx_;
+
+        int n2 = 2 * n_;
+        mk_.resize(lmax_ + 1);
+        for (int l = 0; l <= lmax_; l++) {
+            mk_[l].resize(n2);
+            for (int m = 0; m < n2; m++) {
+                /* frequency of the harmonic; the Nyquist one is taken as positive */
+                int mm       = (m <= n_) ? m : m - n2;
+                double omega = 2 * M_PI * mm / (n2 * dx_);
+                std::complex<double> s(1.5, omega);
+                auto lm = (s - 2.0) * std::log(2.0) + 0.5 * std::log(M_PI) + lgamma((static_cast<double>(l) + s) / 2.0) -
+                          lgamma((static_cast<double>(l) + 3.0 - s) / 2.0);
+                mk_[l][m] = std::exp(lm - std::complex<double>(0, omega * (x0_ + y0_))) / static_cast<double>(n2);
+                if (mm == n_) {
+                    /* keep the Nyquist harmonic real */
+                    mk_[l][m] = std::real(mk_[l][m]);
+                }
+            }
+        }
+    }
+
+    /// Number of points of the r- and k-grids.
+    inline int num_points() const
+    {
+        return n_;
+    }
+
+    /// Point of the r-grid.
+    inline double r(int i__) const
+    {
+        return std::exp(x0_ + i__ * dx_);
+    }
+
+    /// Point of the k-grid.
+    inline double k(int j__) const
+    {
+        return std::exp(y0_ + j__ * dx_);
+    }
+
+    /// Transform of the function given on the logarithmic r-grid.
+    /** \param [in] l  Orbital quantum number.
+     *  \param [in] f  Values \f$ f(r_i) \f$ on the r-grid.
+     *  \param [in] m  Power of r in the integrand.
+     *  \return Values \f$ g_{\ell}(k_j) \f$ on the k-grid.
+     */
+    std::vector<double> transform(int l__, std::vector<double> const& f__, int m__) const
+    {
+        if (l__ < 0 || l__ > lmax_) {
+            RTE_THROW("wrong l");
+        }
+        std::vector<std::complex<double>> a(2 * n_, 0);
+        for (int i = 0; i < n_; i++) {
+            a[i] = f__[i] * std::pow(r(i), m__ - 0.5);
+        }
+        fft(a);
+        for (int i = 0; i < 2 * n_; i++) {
+            a[i] *= mk_[l__][i];
+        }
+        fft(a);
+        std::vector<double> g(n_);
+        for (int j = 0; j < n_; j++) {
+            g[j] = std::real(a[j]) * std::pow(k(j), -1.5);
+        }
+        return g;
+    }
+
+    /// Transform of the spline function.
+    /** The function is set to zero outside of its radial grid or beyond the point rcut. */
+    std::vector<double> transform(int l__, Spline<double> const& f__, int m__, double rcut__ = -1) const
+    {
+        double rc = (rcut__ > 0) ? std::min(rcut__, f__.last()) : f__.last();
+        std::vector<double> fr(n_, 0);
+        int j{0};
+        for (int i = 0; i < n_; i++) {
+            double x = r(i);
+            if (x < f__.first()) {
+                continue;
+            }
+            if (x > rc) {
+                break;
+            }
+            /* points of the logarithmic grid are increasing */
+            while (j < f__.num_points() - 2 && x >= f__[j + 1]) {
+                j++;
+            }
+            fr[i] = f__(j, x - f__[j]);
+        }
+        return transform(l__, fr, m__);
+    }
+
+    /// Spline interpolation of the transform on the k-grid.
+    Spline<double> interpolate(std::vector<double> const& g__) const
+    {
+        std::vector<double> kp(n_);
+        for (int j = 0; j < n_; j++) {
+            kp[j] = k(j);
+        }
+        return Spline<double>(Radial_grid_ext<double>(n_, kp.data()), g__);
+    }
+
+    /// Value of the interpolated transform at a given point of the k-grid range.
+    inline double value(Spline<double> const& g__, double q__) const
+    {
+        int j = static_cast<int>((std::log(q__) - y0_) / dx_);
+        j     = std::max(0, std::min(n_ - 2, j));
+        return g__(j, q__ - g__[j]);
+    }
+
+    /// First point of the k-grid.
+    inline double kmin() const
+    {
+        return k(0);
+    }
+};
+
+} // namespace sirius
+
+#endif // __SPHERICAL_BESSEL_TRANSFORM_HPP__
@@ -0,0 +1,394 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file spline_set.hpp
+ *
+ *  \brief Contains definition and implementation of sirius::Spline_set class.
+ */
+
+#ifndef __SPLINE_SET_HPP__
+#define __SPLINE_SET_HPP__
+
+#include "radial/spline.hpp"
+#include "utils/rte.hpp"
+
+namespace sirius {
+
+/// Set of cubic splines with not-a-knot boundary conditions defined on the same radial grid.
+/** The coefficients are stored in the array \f$ c(i, k, s) \f$ where \f$ i \f$ is the index of the grid point,
+ *  \f$ k = 0..3 \f$ is the index of the coefficient and \f$ s \f$ is the index of the spline. This is the
+ *  structure-of-arrays layout: each coefficient of a spline is contiguous in memory, which allows the vectorized
+ *  evaluation of inner products and makes the coefficients directly usable by spline_inner_product_gpu_v3().
+ *
+ *  The matrix of the tridiagonal system for the second derivatives depends only on the radial grid (see
+ *  sirius::Spline for the derivation). It is factorized once and the factorization is applied to all splines of
+ *  the set. */
+template <typename T>
+class Spline_set
+{
+  private:
+    /// Number of grid points.
+    int num_points_{0};
+
+    /// Number of splines.
+    int num_splines_{0};
+
+    /// Grid points.
+    std::vector<double> x_;
+
+    /// Distances between grid points.
+    std::vector<double> dx_;
+
+    /// Spline coefficients.
+    sddk::mdarray<T, 3> coeffs_;
+
+    /// Lower diagonal of the factorized matrix (second upper diagonal after the row swaps).
+    std::vector<double> dl_;
+
+    /// Main diagonal of the factorized matrix.
+    std::vector<double> d_;
+
+    /// Upper diagonal of the factorized matrix.
+    std::vector<double> du_;
+
+    /// Multipliers of the Gaussian elimination.
+    std::vector<double> mult_;
+
+    /// True if the rows i and i+1 were swapped at the step i of the elimination.
+    std::vector<char> swap_;
+
+    /// Factorize the tridiagonal matrix of the not-a-knot spline.
+    /** This is the same elimination with partial pivoting as in Spline::solve(); the operations on the right
+     *  hand side are recorded in mult_ and swap_. */
+    void factorize()
+    {
+        int ns = num_points_;
+        dl_.resize(ns);
+        d_.resize(ns);
+        du_.resize(ns);
+        mult_.assign(ns, 0);
+        swap_.assign(ns, 0);
+
+        for (int i = 0; i < ns - 2; i++) {
+            d_[i + 1] = (x_[i + 2] - x_[i]) * 2.0;
+        }
+        for (int i = 0; i < ns - 1; i++) {
+            du_[i] = dx_[i];
+            dl_[i] = dx_[i];
+        }
+        double h0 = dx_[0];
+        double h1 = dx_[1];
+        d_[0]     = h0 - (h1 / h0) * h1;
+        du_[0]    = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+
+        h0          = dx_[ns - 2];
+        h1          = dx_[ns - 3];
+        d_[ns - 1]  = h0 - (h1 / h0) * h1;
+        dl_[ns - 2] = h1 * ((h1 / h0) + 1) + 2 * (h0 + h1);
+
+        for (int i = 0; i < ns - 1; i++) {
+            if (std::abs(dl_[i]) == 0) {
+                if (std::abs(d_[i]) == 0) {
+                    RTE_THROW("singular matrix of the spline");
+                }
+            } else if (std::abs(d_[i]) >= std::abs(dl_[i])) {
+                mult_[i] = dl_[i] / d_[i];
+                d_[i + 1] -= mult_[i] * du_[i];
+                if (i < ns - 2) {
+                    dl_[i] = 0;
+                }
+            } else {
+                swap_[i]   = 1;
+                mult_[i]   = d_[i] / dl_[i];
+                d_[i]      = dl_[i];
+                double tmp = d_[i + 1];
+                d_[i + 1]  = du_[i] - mult_[i] * tmp;
+                if (i < ns - 2) {
+                    dl_[i]     = du_[i + 1];
+                    du_[i + 1] = -mult_[i] * dl_[i];
+                }
+                du_[i] = tmp;
+            }
+        }
+        if (std::abs(d_[ns - 1]) == 0) {
+            RTE_THROW("singular matrix of the spline");
+        }
+    }
+
+  public:
+    /// Default constructor.
+    Spline_set()
+    {
+    }
+
+    /// Constructor of a set of empty splines.
+    Spline_set(Radial_grid<double> const& radial_grid__, int num_splines__)
+        : num_points_(radial_grid__.num_points())
+        , num_splines_(num_splines__)
+    {
+        if (num_points_ < 4) {
+            RTE_THROW("number of grid points is too small");
+        }
+        x_.resize(num_points_);
+        dx_.resize(num_points_ - 1);
+        for (int i = 0; i < num_points_; i++) {
+            x_[i] = radial_grid__[i];
+        }
+        for (int i = 0; i < num_points_ - 1; i++) {
+            dx_[i] = radial_grid__.dx(i);
+        }
+        coeffs_ = sddk::mdarray<T, 3>(num_points_, 4, num_splines_);
+        coeffs_.zero();
+        factorize();
+    }
+
+    inline int num_points() const
+    {
+        return num_points_;
+    }
+
+    inline int num_splines() const
+    {
+        return num_splines_;
+    }
+
+    /// Value of the spline at the grid point.
+    inline T& operator()(int i__, int ispl__)
+    {
+        return coeffs_(i__, 0, ispl__);
+    }
+
+    inline T const& operator()(int i__, int ispl__) const
+    {
+        return coeffs_(i__, 0, ispl__);
+    }
+
+    /// Value of the spline at the point x = x_i + dx.
+    inline T operator()(int i__, double dx__, int ispl__) const
+    {
+        return coeffs_(i__, 0, ispl__) +
+               dx__ * (coeffs_(i__, 1, ispl__) + dx__ * (coeffs_(i__, 2, ispl__) + dx__ * coeffs_(i__, 3, ispl__)));
+    }
+
+    inline sddk::mdarray<T, 3> const& coeffs() const
+    {
+        return coeffs_;
+    }
+
+    inline sddk::mdarray<T, 3>& coeffs()
+    {
+        return coeffs_;
+    }
+
+    /// Compute the spline coefficients of a single spline from its values.
+    void interpolate(int ispl__)
+    {
+        int ns  = num_points_;
+        T* a    = coeffs_.at(sddk::memory_t::host, 0, 0, ispl__);
+        T* b    = coeffs_.at(sddk::memory_t::host, 0, 1, ispl__);
+        T* c    = coeffs_.at(sddk::memory_t::host, 0, 2, ispl__);
+        T* d    = coeffs_.at(sddk::memory_t::host, 0, 3, ispl__);
+        /* the last two arrays are used as temporary storage for y_i' and m_i */
+        T* dy   = b;
+        T* m    = d;
+
+        #pragma omp simd
+        for (int i = 0; i < ns - 1; i++) {
+            dy[i] = (a[i + 1] - a[i]) / dx_[i];
+        }
+        for (int i = 0; i < ns - 2; i++) {
+            c[i + 1] = (dy[i + 1] - dy[i]) * 6.0;
+        }
+        c[0]      = c[1];
+        c[ns - 1] = c[ns - 2];
+
+        /* forward elimination with the recorded operations */
+        for (int i = 0; i < ns - 1; i++) {
+            if (swap_[i]) {
+                T tmp    = c[i];
+                c[i]     = c[i + 1];
+                c[i + 1] = tmp - mult_[i] * c[i + 1];
+            } else {
+                c[i + 1] -= mult_[i] * c[i];
+            }
+        }
+        /* back substitution */
+        m[ns - 1] = c[ns - 1] / d_[ns - 1];
+        m[ns - 2] = (c[ns - 2] - du_[ns - 2] * m[ns - 1]) / d_[ns - 2];
+        for (int i = ns - 3; i >= 0; i--) {
+            m[i] = (c[i] - du_[i] * m[i + 1] - dl_[i] * m[i + 2]) / d_[i];
+        }
+
+        /* iteration i overwrites m_i with d_i and reads m_{i+1}, which is not yet overwritten */
+        #pragma omp simd
+        for (int i = 0; i < ns - 1; i++) {
+            T t  = (m[i + 1] - m[i]) / 6.0;
+            c[i] = m[i] / 2.0;
+            b[i] = dy[i] - (c[i] + t) * dx_[i];
+            d[i] = t / dx_[i];
+        }
+        b[ns - 1] = 0;
+        c[ns - 1] = 0;
+        d[ns - 1] = 0;
+    }
+
+    /// Compute the spline coefficients of all splines.
+    void interpolate()
+    {
+        #pragma omp parallel for schedule(static)
+        for (int s = 0; s < num_splines_; s++) {
+            interpolate(s);
+        }
+    }
+
+    /// Set spline k of this set to the product of spline i of the set a and spline j of the set b.
+    /** Only the terms up to the third order in dx are kept, as in the operator* of two splines. */
+    void product(int k__, Spline_set<T> const& a__, int i__, Spline_set<T> const& b__, int j__)
+    {
+        T const* fa = a__.coeffs_.at(sddk::memory_t::host, 0, 0, i__);
+        T const* fb = a__.coeffs_.at(sddk::memory_t::host, 0, 1, i__);
+        T const* fc = a__.coeffs_.at(sddk::memory_t::host, 0, 2, i__);
+        T const* fd = a__.coeffs_.at(sddk::memory_t::host, 0, 3, i__);
+        T const* ga = b__.coeffs_.at(sddk::memory_t::host, 0, 0, j__);
+        T const* gb = b__.coeffs_.at(sddk::memory_t::host, 0, 1, j__);
+        T const* gc = b__.coeffs_.at(sddk::memory_t::host, 0, 2, j__);
+        T const* gd = b__.coeffs_.at(sddk::memory_t::host, 0, 3, j__);
+        T* ha       = coeffs_.at(sddk::memory_t::host, 0, 0, k__);
+        T* hb       = coeffs_.at(sddk::memory_t::host, 0, 1, k__);
+        T* hc       = coeffs_.at(sddk::memory_t::host, 0, 2, k__);
+        T* hd       = coeffs_.at(sddk::memory_t::host, 0, 3, k__);
+        #pragma omp simd
+        for (int i = 0; i < num_points_; i++) {
+            ha[i] = fa[i] * ga[i];
+            hb[i] = fb[i] * ga[i] + fa[i] * gb[i];
+            hc[i] = fc[i] * ga[i] + fb[i] * gb[i] + fa[i] * gc[i];
+            hd[i] = fd[i] * ga[i] + fc[i] * gb[i] + fb[i] * gc[i] + fa[i] * gd[i];
+        }
+    }
+
+    /// Inner product of spline i of this set and spline j of the set g with the r^m prefactor (m = 0, 1, 2).
+    T inner(int i__, Spline_set<T> const& g__, int j__, int m__) const
+    {
+        T const* fa = coeffs_.at(sddk::memory_t::host, 0, 0, i__);
+        T const* fb = coeffs_.at(sddk::memory_t::host, 0, 1, i__);
+        T const* fc = coeffs_.at(sddk::memory_t::host, 0, 2, i__);
+        T const* fd = coeffs_.at(sddk::memory_t::host, 0, 3, i__);
+        T const* ga = g__.coeffs_.at(sddk::memory_t::host, 0, 0, j__);
+        T const* gb = g__.coeffs_.at(sddk::memory_t::host, 0, 1, j__);
+        T const* gc = g__.coeffs_.at(sddk::memory_t::host, 0, 2, j__);
+        T const* gd = g__.coeffs_.at(sddk::memory_t::host, 0, 3, j__);
+        double const* xp  = x_.data();
+        double const* dxp = dx_.data();
+        int n             = num_points_ - 1;
+
+        T result{0};
+        switch (m__) {
+            case 0: {
+                #pragma omp simd reduction(+:result)
+                for (int i = 0; i < n; i++) {
+                    double dx = dxp[i];
+                    T faga    = fa[i] * ga[i];
+                    T fdgd    = fd[i] * gd[i];
+                    T k1      = fa[i] * gb[i] + fb[i] * ga[i];
+                    T k2      = fc[i] * ga[i] + fb[i] * gb[i] + fa[i] * gc[i];
+                    T k3      = fa[i] * gd[i] + fb[i] * gc[i] + fc[i] * gb[i] + fd[i] * ga[i];
+                    T k4      = fb[i] * gd[i] + fc[i] * gc[i] + fd[i] * gb[i];
+                    T k5      = fc[i] * gd[i] + fd[i] * gc[i];
+
+                    result += dx * (faga + dx * (k1 / 2.0 + dx * (k2 / 3.0 + dx * (k3 / 4.0 + dx * (k4 / 5.0 +
+                              dx * (k5 / 6.0 + dx * fdgd / 7.0))))));
+                }
+                break;
+            }
+            case 1: {
+                #pragma omp simd reduction(+:result)
+                for (int i = 0; i < n; i++) {
+                    double x0 = xp[i];
+                    double dx = dxp[i];
+                    T faga    = fa[i] * ga[i];
+                    T fdgd    = fd[i] * gd[i];
+                    T k1      = fa[i] * gb[i] + fb[i] * ga[i];
+                    T k2      = fc[i] * ga[i] + fb[i] * gb[i] + fa[i] * gc[i];
+                    T k3      = fa[i] * gd[i] + fb[i] * gc[i] + fc[i] * gb[i] + fd[i] * ga[i];
+                    T k4      = fb[i] * gd[i] + fc[i] * gc[i] + fd[i] * gb[i];
+                    T k5      = fc[i] * gd[i] + fd[i] * gc[i];
+
+                    result += dx * ((faga * x0) + dx * ((faga + k1 * x0) / 2.0 + dx * ((k1 + k2 * x0) / 3.0 +
+                              dx * ((k2 + k3 * x0) / 4.0 + dx * ((k3 + k4 * x0) / 5.0 + dx * ((k4 + k5 * x0) / 6.0 +
+                              dx * ((k5 + fdgd * x0) / 7.0 + dx * fdgd / 8.0)))))));
+                }
+                break;
+            }
+            case 2: {
+                #pragma omp simd reduction(+:result)
+                for (int i = 0; i < n; i++) {
+                    double x0 = xp[i];
+                    double dx = dxp[i];
+                    T k0      = fa[i] * ga[i];
+                    T k1      = fd[i] * gb[i] + fc[i] * gc[i] + fb[i] * gd[i];
+                    T k2      = fd[i] * ga[i] + fc[i] * gb[i] + fb[i] * gc[i] + fa[i] * gd[i];
+                    T k3      = fc[i] * ga[i] + fb[i] * gb[i] + fa[i] * gc[i];
+                    T k4      = fd[i] * gc[i] + fc[i] * gd[i];
+                    T k5      = fb[i] * ga[i] + fa[i] * gb[i];
+                    T k6      = fd[i] * gd[i];
+
+                    T r1 = k4 * 0.125 + k6 * x0 * 0.25;
+                    T r2 = (k1 + x0 * (2.0 * k4 + k6 * x0)) * 0.14285714285714285714;
+                    T r3 = (k2 + x0 * (2.0 * k1 + k4 * x0)) * 0.16666666666666666667;
+                    T r4 = (k3 + x0 * (2.0 * k2 + k1 * x0)) * 0.2;
+                    T r5 = (k5 + x0 * (2.0 * k3 + k2 * x0)) * 0.25;
+                    T r6 = (k0 + x0 * (2.0 * k5 + k3 * x0)) * 0.33333333333333333333;
+                    T r7 = (x0 * (2.0 * k0 + x0 * k5)) * 0.5;
+
+                    T v = dx * k6 * 0.11111111111111111111;
+                    v   = dx * (r1 + v);
+                    v   = dx * (r2 + v);
+                    v   = dx * (r3 + v);
+                    v   = dx * (r4 + v);
+                    v   = dx * (r5 + v);
+                    v   = dx * (r6 + v);
+                    v   = dx * (r7 + v);
+
+                    result += dx * (k0 * x0 * x0 + v);
+                }
+                break;
+            }
+            default: {
+                RTE_THROW("wrong r^m prefactor");
+            }
+        }
+        return result;
+    }
+
+    /// Batched inner products with the r^m prefactor.
+    /** For each pair j the inner product of spline idx(0, j) of this set and spline idx(1, j) of the set g is
+     *  stored in result[j]. This is the CPU counterpart of spline_inner_product_gpu_v3(). */
+    void inner(Spline_set<T> const& g__, sddk::mdarray<int, 2> const& idx__, int m__, T* result__) const
+    {
+        int n = static_cast<int>(idx__.size(1));
+        #pragma omp parallel for schedule(static)
+        for (int j = 0; j < n; j++) {
+            result__[j] = inner(idx__(0, j), g__, idx__(1, j), m__);
+        }
+    }
+};
+
+} // namespace sirius
+
+#endif // __SPLINE_SET_HPP__
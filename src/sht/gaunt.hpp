@@ -51,9 +51,26 @@ struct gaunt_L1_L2
     T   coef;
 };
 
+/// View of the non-zero Gaunt coefficients {lm3, coefficient} of a given combination of lm1 and lm2.
+template <typename T>
+struct gaunt_L3_row
+{
+    /// Number of non-zero coefficients.
+    int size;
+    /// Pointer to the lm3 indices.
+    int const* lm3;
+    /// Pointer to the coefficients.
+    T const* coef;
+};
+
 /// Compact storage of non-zero Gaunt coefficients \f$ \langle \ell_1 m_1 | \ell_3 m_3 | \ell_2 m_2 \rangle \f$.
 /** Very important! The following notation is adopted and used everywhere: lm1 and lm2 represent 'bra' and 'ket' 
  *  spherical harmonics of the Gaunt integral and lm3 represent the inner spherical harmonic. 
+ *
+ *  Both groupings of the coefficients are stored in the compressed sparse row format: the non-zero coefficients
+ *  of all rows are packed in the contiguous arrays and the row pointer gives the position of the first coefficient
+ *  of each row. For lmax = 10 and above this avoids the allocation of a separate vector for each of the
+ *  lmmax1 * lmmax2 combinations and keeps the coefficients of the inner loops in a single stream of memory.
  */
 template <typename T>
 class Gaunt_coefficients
@@ -74,11 +91,25 @@ class Gaunt_coefficients
     /// lmmax of |lm2>
     int lmmax2_;
 
-    /// List of non-zero Gaunt coefficients for each lm3.
-    mdarray<std::vector<gaunt_L1_L2<T>>, 1> gaunt_packed_L1_L2_;
+    /// Position of the first non-zero coefficient of each lm3 in the {lm1, lm2, coefficient} arrays.
+    std::vector<int> row_ptr_L1_L2_;
+    std::vector<int> lm1_;
+    std::vector<int> lm2_;
+    std::vector<T> coef_L1_L2_;
 
-    /// List of non-zero Gaunt coefficients for each combination of lm1, lm2.
-    mdarray<std::vector<gaunt_L3<T>>, 2> gaunt_packed_L3_;
+    /// Position of the first non-zero coefficient of each (lm1, lm2) pair in the {lm3, coefficient} arrays.
+    /** The pair is indexed as lm1 + lm2 * lmmax1. */
+    std::vector<int> row_ptr_L3_;
+    std::vector<int> lm3_;
+    std::vector<int> l3_;
+    std::vector<T> coef_L3_;
+
+    inline int row_L3(int lm1__, int lm2__) const
+    {
+        assert(lm1__ >= 0 && lm1__ < lmmax1_);
+        assert(lm2__ >= 0 && lm2__ < lmmax2_);
+        return lm1__ + lm2__ * lmmax1_;
+    }
 
   public:
     /// Class constructor.
@@ -91,44 +122,59 @@ class Gaunt_coefficients
         lmmax3_ = utils::lmmax(lmax3_);
         lmmax2_ = utils::lmmax(lmax2_);
 
-        gaunt_packed_L1_L2_ = mdarray<std::vector<gaunt_L1_L2<T>>, 1>(lmmax3_);
-        gaunt_L1_L2<T> g12;
-
-        gaunt_packed_L3_ = mdarray<std::vector<gaunt_L3<T>>, 2>(lmmax1_, lmmax2_);
-        gaunt_L3<T> g3;
+        row_ptr_L3_ = std::vector<int>(lmmax1_ * lmmax2_ + 1, 0);
+        std::vector<int> num_L1_L2(lmmax3_, 0);
 
-        for (int l1 = 0, lm1 = 0; l1 <= lmax1_; l1++) {
-            for (int m1 = -l1; m1 <= l1; m1++, lm1++) {
-                for (int l2 = 0, lm2 = 0; l2 <= lmax2_; l2++) {
-                    for (int m2 = -l2; m2 <= l2; m2++, lm2++) {
+        /* rows of the {lm3, coefficient} grouping are filled in the order of lm1 + lm2 * lmmax1 */
+        for (int l2 = 0, lm2 = 0; l2 <= lmax2_; l2++) {
+            for (int m2 = -l2; m2 <= l2; m2++, lm2++) {
+                for (int l1 = 0, lm1 = 0; l1 <= lmax1_; l1++) {
+                    for (int m1 = -l1; m1 <= l1; m1++, lm1++) {
                         for (int l3 = 0, lm3 = 0; l3 <= lmax3_; l3++) {
                             for (int m3 = -l3; m3 <= l3; m3++, lm3++) {
 
                                 T gc = get__(l1, l3, l2, m1, m3, m2);
                                 if (std::abs(gc) > 1e-12) {
-                                    g12.lm1  = lm1;
-                                    g12.lm2  = lm2;
-                                    g12.coef = gc;
-                                    gaunt_packed_L1_L2_[lm3].push_back(g12);
-
-                                    g3.lm3  = lm3;
-                                    g3.l3   = l3;
-                                    g3.coef = gc;
-                                    gaunt_packed_L3_(lm1, lm2).push_back(g3);
+                                    lm3_.push_back(lm3);
+                                    l3_.push_back(l3);
+                                    coef_L3_.push_back(gc);
+                                    num_L1_L2[lm3]++;
                                 }
                             }
                         }
+                        row_ptr_L3_[row_L3(lm1, lm2) + 1] = static_cast<int>(lm3_.size());
                     }
                 }
             }
         }
+
+        /* the {lm1, lm2, coefficient} grouping is obtained by transposition of the first one */
+        row_ptr_L1_L2_ = std::vector<int>(lmmax3_ + 1, 0);
+        for (int lm3 = 0; lm3 < lmmax3_; lm3++) {
+            row_ptr_L1_L2_[lm3 + 1] = row_ptr_L1_L2_[lm3] + num_L1_L2[lm3];
+        }
+        lm1_        = std::vector<int>(lm3_.size());
+        lm2_        = std::vector<int>(lm3_.size());
+        coef_L1_L2_ = std::vector<T>(lm3_.size());
+        std::vector<int> pos(row_ptr_L1_L2_.begin(), row_ptr_L1_L2_.end() - 1);
+        /* keep the lm1-major order of the coefficients inside each lm3 row */
+        for (int lm1 = 0; lm1 < lmmax1_; lm1++) {
+            for (int lm2 = 0; lm2 < lmmax2_; lm2++) {
+                for (int k = row_ptr_L3_[row_L3(lm1, lm2)]; k < row_ptr_L3_[row_L3(lm1, lm2) + 1]; k++) {
+                    int i          = pos[lm3_[k]]++;
+                    lm1_[i]        = lm1;
+                    lm2_[i]        = lm2;
+                    coef_L1_L2_[i] = coef_L3_[k];
+                }
+            }
+        }
     }
 
     /// Return number of non-zero Gaunt coefficients for a given lm3.
     inline int num_gaunt(int lm3) const
     {
         assert(lm3 >= 0 && lm3 < lmmax3_);
-        return static_cast<int>(gaunt_packed_L1_L2_[lm3].size());
+        return row_ptr_L1_L2_[lm3 + 1] - row_ptr_L1_L2_[lm3];
     }
 
     /// Return a structure containing {lm1, lm2, coef} for a given lm3 and index.
@@ -146,23 +192,35 @@ class Gaunt_coefficients
      *  }
      *  \endcode
      */
-    inline gaunt_L1_L2<T> const& gaunt(int lm3, int idx) const
+    inline gaunt_L1_L2<T> gaunt(int lm3, int idx) const
     {
         assert(lm3 >= 0 && lm3 < lmmax3_);
-        assert(idx >= 0 && idx < (int)gaunt_packed_L1_L2_[lm3].size());
-        return gaunt_packed_L1_L2_[lm3][idx];
+        assert(idx >= 0 && idx < num_gaunt(lm3));
+        int i = row_ptr_L1_L2_[lm3] + idx;
+        return gaunt_L1_L2<T>{lm1_[i], lm2_[i], coef_L1_L2_[i]};
     }
 
     /// Return number of non-zero Gaunt coefficients for a combination of lm1 and lm2.
     inline int num_gaunt(int lm1, int lm2) const
     {
-        return static_cast<int>(gaunt_packed_L3_(lm1, lm2).size());
+        int r = row_L3(lm1, lm2);
+        return row_ptr_L3_[r + 1] - row_ptr_L3_[r];
     }
 
     /// Return a structure containing {lm3, coef} for a given lm1, lm2 and index
-    inline gaunt_L3<T> const& gaunt(int lm1, int lm2, int idx) const
+    inline gaunt_L3<T> gaunt(int lm1, int lm2, int idx) const
+    {
+        assert(idx >= 0 && idx < num_gaunt(lm1, lm2));
+        int i = row_ptr_L3_[row_L3(lm1, lm2)] + idx;
+        return gaunt_L3<T>{lm3_[i], l3_[i], coef_L3_[i]};
+    }
+
+    /// Return the view of non-zero Gaunt coefficients for a given combination of lm1 and lm2.
+    inline gaunt_L3_row<T> gaunt_row(int lm1, int lm2) const
     {
-        return gaunt_packed_L3_(lm1, lm2)[idx];
+        int r = row_L3(lm1, lm2);
+        int i = row_ptr_L3_[r];
+        return gaunt_L3_row<T>{row_ptr_L3_[r + 1] - i, lm3_.data() + i, coef_L3_.data() + i};
     }
 
     /// Return a sum over L3 (lm3) index of Gaunt coefficients and a complex vector.
@@ -174,9 +232,10 @@ class Gaunt_coefficients
      */
     inline double_complex sum_L3_gaunt(int lm1, int lm2, double_complex const* v) const
     {
+        auto g = gaunt_row(lm1, lm2);
         double_complex zsum(0, 0);
-        for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-            zsum += gaunt_packed_L3_(lm1, lm2)[k].coef * v[gaunt_packed_L3_(lm1, lm2)[k].lm3];
+        for (int k = 0; k < g.size; k++) {
+            zsum += g.coef[k] * v[g.lm3[k]];
         }
         return zsum;
     }
@@ -190,17 +249,42 @@ class Gaunt_coefficients
      */
     inline T sum_L3_gaunt(int lm1, int lm2, double const* v) const
     {
-        T sum = 0;
-        for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-            sum += gaunt_packed_L3_(lm1, lm2)[k].coef * v[gaunt_packed_L3_(lm1, lm2)[k].lm3];
+        auto g = gaunt_row(lm1, lm2);
+        T sum  = 0;
+        for (int k = 0; k < g.size; k++) {
+            sum += g.coef[k] * v[g.lm3[k]];
         }
         return sum;
     }
 
-    /// Return vector of non-zero Gaunt coefficients for a given combination of lm1 and lm2
-    inline std::vector<gaunt_L3<T>> const& gaunt_vector(int lm1, int lm2) const
+    /// Contract Gaunt coefficients of (lm1, lm2) with a block of real vectors.
+    /** The following operation is performed:
+     *  \f[
+     *      r_i = \sum_{\ell_3 m_3} \langle \ell_1 m_1 | \ell_3 m_3 | \ell_2 m_2 \rangle v_{\ell_3 m_3, idx_i}
+     *  \f]
+     *  for i = 0..n-1, where the vector with the index j starts at v + j * ld. If idx is nullptr, idx_i = i.
+     *  The coefficients are loaded once for the whole block, which is used in the setup of the muffin-tin
+     *  Hamiltonian where the same (lm1, lm2) pair is contracted with the radial integrals of all radial functions.
+     */
+    inline void sum_L3_gaunt(int lm1, int lm2, double const* v, int ld, int n, int const* idx, T* result) const
     {
-        return gaunt_packed_L3_(lm1, lm2);
+        auto g = gaunt_row(lm1, lm2);
+        for (int i = 0; i < n; i++) {
+            result[i] = 0;
+        }
+        for (int k = 0; k < g.size; k++) {
+            double const* vk = v + g.lm3[k];
+            T c              = g.coef[k];
+            if (idx) {
+                for (int i = 0; i < n; i++) {
+                    result[i] += c * vk[static_cast<size_t>(idx[i]) * ld];
+                }
+            } else {
+                for (int i = 0; i < n; i++) {
+                    result[i] += c * vk[static_cast<size_t>(i) * ld];
+                }
+            }
+        }
     }
 
     inline sddk::mdarray<T, 3> get_full_set_L3() const
@@ -209,9 +293,9 @@ class Gaunt_coefficients
         gc.zero();
         for (int lm2 = 0; lm2 < lmmax2_; lm2++) {
             for (int lm1 = 0; lm1 < lmmax1_; lm1++) {
-                for (int k = 0; k < (int)gaunt_packed_L3_(lm1, lm2).size(); k++) {
-                    int lm3 = gaunt_packed_L3_(lm1, lm2)[k].lm3;
-                    gc(lm3, lm1, lm2) = gaunt_packed_L3_(lm1, lm2)[k].coef;
+                auto g = gaunt_row(lm1, lm2);
+                for (int k = 0; k < g.size; k++) {
+                    gc(g.lm3[k], lm1, lm2) = g.coef[k];
                 }
             }
         }
@@ -279,6 +279,69 @@ void SHT::forward_transform<double_complex>(double_complex const *ftp, int nr, i
         &ylm_forward_(0, 0), num_points_, ftp, num_points_, &sddk::linalg_const<double_complex>::zero(), flm, ld);
 }
 
+/* true if the functions of the batch follow each other in memory */
+template <typename T>
+static bool
+is_contiguous(std::vector<T> const& ptr__, size_t size__)
+{
+    for (size_t i = 1; i < ptr__.size(); i++) {
+        if (ptr__[i] != ptr__[0] + i * size__) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void SHT::backward_transform(int ld, std::vector<T const*> const& flm, int nr, int lmmax, T* ftp) const
+{
+    int n = static_cast<int>(flm.size());
+    if (n == 0) {
+        return;
+    }
+    if (is_contiguous(flm, static_cast<size_t>(ld) * nr)) {
+        backward_transform(ld, flm[0], nr * n, lmmax, ftp);
+        return;
+    }
+    /* transform each function in place; packing the batch costs more than it saves for the typical
+       number of radial points */
+    for (int i = 0; i < n; i++) {
+        backward_transform(ld, flm[i], nr, lmmax, ftp + static_cast<size_t>(i) * nr * num_points_);
+    }
+}
+
+template <typename T>
+void SHT::forward_transform(T const* ftp, int nr, int lmmax, int ld, std::vector<T*> const& flm) const
+{
+    int n = static_cast<int>(flm.size());
+    if (n == 0) {
+        return;
+    }
+    if (is_contiguous(flm, static_cast<size_t>(ld) * nr)) {
+        forward_transform(ftp, nr * n, lmmax, ld, flm[0]);
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        forward_transform(ftp + static_cast<size_t>(i) * nr * num_points_, nr, lmmax, ld, flm[i]);
+    }
+}
+
+template
+void SHT::backward_transform<double>(int ld, std::vector<double const*> const& flm, int nr, int lmmax,
+                                     double* ftp) const;
+
+template
+void SHT::backward_transform<double_complex>(int ld, std::vector<double_complex const*> const& flm, int nr,
+                                             int lmmax, double_complex* ftp) const;
+
+template
+void SHT::forward_transform<double>(double const* ftp, int nr, int lmmax, int ld,
+                                    std::vector<double*> const& flm) const;
+
+template
+void SHT::forward_transform<double_complex>(double_complex const* ftp, int nr, int lmmax, int ld,
+                                            std::vector<double_complex*> const& flm) const;
+
 void SHT::check() const
 {
     double dr = 0;
@@ -260,6 +260,27 @@ class SHT // TODO: better name
     template <typename T>
     void forward_transform(T const* ftp, int nr, int lmmax, int ld, T* flm) const;
 
+    /// Perform a backward transformation of a batch of functions.
+    /** All functions have the same number of radial points and the same leading dimension. Radial points of the
+     *  batch are stacked as columns of a single matrix; if the functions follow each other in memory the whole
+     *  batch is transformed with one GEMM, otherwise each function is transformed in place.
+     *
+     *  \param [in] ld Size of leading dimension of each flm.
+     *  \param [in] flm Raw pointers to \f$ f_{\ell m}(r) \f$ of each function.
+     *  \param [in] nr Number of radial points of each function.
+     *  \param [in] lmmax Maximum number of lm- harmonics to take into sum.
+     *  \param [out] ftp Raw pointer to \f$ f(\theta, \phi, r) \f$ of the batch; the column ir + i * nr holds
+     *                   the radial point ir of the function i.
+     */
+    template <typename T>
+    void backward_transform(int ld, std::vector<T const*> const& flm, int nr, int lmmax, T* ftp) const;
+
+    /// Perform a forward transformation of a batch of functions.
+    /** This is the inverse of the batched backward transformation: the input is stored as in the output of
+     *  the backward transformation and the result is written to each flm with the leading dimension ld. */
+    template <typename T>
+    void forward_transform(T const* ftp, int nr, int lmmax, int ld, std::vector<T*> const& flm) const;
+
     /// Convert form Rlm to Ylm representation.
     static void convert(int lmax__, double const* f_rlm__, double_complex* f_ylm__)
     {
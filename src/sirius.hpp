@@ -93,6 +93,8 @@ inline static double& energy_acc()
 /// Initialize the library.
 inline void initialize(bool call_mpi_init__ = true)
 {
+    /* MPI statistics is attributed to the enclosing profiler regions */
+    utils::profiler_regions::enabled() = (sddk::mpi_stat::level() > 0);
     PROFILE_START("sirius");
     PROFILE("sirius::initialize");
     if (is_initialized()) {
@@ -105,6 +107,10 @@ inline void initialize(bool call_mpi_init__ = true)
     if (call_mpi_init__) {
         Communicator::initialize(MPI_THREAD_MULTIPLE);
     }
+    /* start the timeline trace of the profiler regions */
+    utils::profiler_trace::init(Communicator::world().mpi_comm());
+    /* open the hardware performance counters */
+    utils::profiler_counters::init();
 #if defined(__APEX)
     apex::init("sirius", Communicator::world().rank(), Communicator::world().size());
 #endif
@@ -208,6 +214,10 @@ inline void finalize(bool call_mpi_fin__ = true, bool reset_device__ = true, boo
         printf("energy_acc : %9.2f Joules\n", e_acc * nn / Communicator::world().size());
     }
 #endif
+    if (!Communicator::is_finalized()) {
+        sddk::mpi_stat::collect(Communicator::world());
+        utils::profiler_trace::save(Communicator::world().mpi_comm());
+    }
     if (call_mpi_fin__) {
         Communicator::finalize();
     }
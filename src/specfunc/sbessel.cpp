@@ -1,6 +1,8 @@
 #include <gsl/gsl_sf_bessel.h>
 #include <cmath>
 #include <cassert>
+#include <vector>
+#include <algorithm>
 
 #include "sbessel.hpp"
 
@@ -75,6 +77,138 @@ Spherical_Bessel_functions::sbessel(int lmax__, double t__, double* jl__)
     gsl_sf_bessel_jl_array(lmax__, t__, jl__);
 }
 
+void
+Spherical_Bessel_functions::sbessel(int lmax__, int n__, double const* x__, double* jl__, int ld__)
+{
+    int const nb{64};
+    /* starting order of the downward recurrence; the error decays fast with L - lmax for x <= lmax */
+    int const lmax_dn = lmax__ + 40;
+
+    /* split arguments between the two methods */
+    std::vector<int> idx_up;
+    std::vector<int> idx_dn;
+    for (int i = 0; i < n__; i++) {
+        if (x__[i] > lmax__) {
+            idx_up.push_back(i);
+        } else {
+            idx_dn.push_back(i);
+        }
+    }
+
+    std::vector<double> jl((lmax__ + 1) * nb);
+    double x[nb];
+    double r[nb];
+
+    auto scatter = [&](std::vector<int> const& idx, int i0, int n) {
+        for (int i = 0; i < n; i++) {
+            auto out = jl__ + static_cast<size_t>(idx[i0 + i]) * ld__;
+            for (int l = 0; l <= lmax__; l++) {
+                out[l] = jl[l * nb + i];
+            }
+        }
+    };
+
+    /* upward recurrence j_{l+1}(x) = (2l+1)/x j_l(x) - j_{l-1}(x) is stable for l < x */
+    for (int i0 = 0; i0 < static_cast<int>(idx_up.size()); i0 += nb) {
+        int n = std::min(nb, static_cast<int>(idx_up.size()) - i0);
+        for (int i = 0; i < n; i++) {
+            x[i] = x__[idx_up[i0 + i]];
+        }
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            r[i]  = 1.0 / x[i];
+            jl[i] = std::sin(x[i]) * r[i];
+        }
+        if (lmax__ > 0) {
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                jl[nb + i] = (jl[i] - std::cos(x[i])) * r[i];
+            }
+        }
+        for (int l = 2; l <= lmax__; l++) {
+            double* j0       = &jl[l * nb];
+            double const* j1 = &jl[(l - 1) * nb];
+            double const* j2 = &jl[(l - 2) * nb];
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                j0[i] = (2 * l - 1) * r[i] * j1[i] - j2[i];
+            }
+        }
+        scatter(idx_up, i0, n);
+    }
+
+    /* Miller's algorithm: downward recurrence j_{l-1}(x) = (2l+1)/x j_l(x) - j_{l+1}(x) for the unnormalized
+       functions f_l starting from f_{L+1} = 0, f_L = 1, followed by the normalization with the sum rule
+       sum_l (2l+1) j_l^2(x) = 1; the sign is fixed by the larger of j_0 and j_1. The recurrence is stable in the
+       downward direction and the normalization doesn't depend on the zeros of j_0. The lanes are rescaled when
+       the values grow too large. */
+    double const big{1e100};
+    double const big_inv{1e-100};
+    double fp[nb];
+    double fc[nb];
+    double sum[nb];
+    for (int i0 = 0; i0 < static_cast<int>(idx_dn.size()); i0 += nb) {
+        int n = std::min(nb, static_cast<int>(idx_dn.size()) - i0);
+        for (int i = 0; i < n; i++) {
+            x[i]   = x__[idx_dn[i0 + i]];
+            /* the small arguments are treated separately below */
+            r[i]   = 1.0 / std::max(x[i], 1e-8);
+            fp[i]  = 0;
+            fc[i]  = 1;
+            sum[i] = 2 * lmax_dn + 1;
+        }
+        for (int l = lmax_dn; l >= 1; l--) {
+            /* fc becomes f_{l-1} */
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                double f = (2 * l + 1) * r[i] * fc[i] - fp[i];
+                fp[i]    = fc[i];
+                fc[i]    = f;
+                sum[i] += (2 * l - 1) * f * f;
+            }
+            if (l - 1 <= lmax__) {
+                std::copy(fc, fc + n, &jl[(l - 1) * nb]);
+            }
+            for (int i = 0; i < n; i++) {
+                if (std::abs(fc[i]) > big) {
+                    fc[i] *= big_inv;
+                    fp[i] *= big_inv;
+                    sum[i] *= big_inv * big_inv;
+                    for (int k = l - 1; k <= lmax__; k++) {
+                        jl[k * nb + i] *= big_inv;
+                    }
+                }
+            }
+        }
+        /* normalization */
+        #pragma omp simd
+        for (int i = 0; i < n; i++) {
+            double j0 = std::sin(x[i]) * r[i];
+            double j1 = (j0 - std::cos(x[i])) * r[i];
+            double f  = (std::abs(j0) >= std::abs(j1) || lmax__ == 0) ? j0 * jl[i] : j1 * jl[nb + i];
+            r[i]      = (f >= 0 ? 1 : -1) / std::sqrt(sum[i]);
+        }
+        for (int l = 0; l <= lmax__; l++) {
+            double* j0 = &jl[l * nb];
+            #pragma omp simd
+            for (int i = 0; i < n; i++) {
+                j0[i] *= r[i];
+            }
+        }
+        /* leading terms of the series for small arguments: j_l(x) = x^l / (2l+1)!! (1 - x^2 / (2(2l+3))) */
+        for (int i = 0; i < n; i++) {
+            if (x[i] < 1e-8) {
+                double t{1};
+                for (int l = 0; l <= lmax__; l++) {
+                    jl[l * nb + i] = t * (1 - x[i] * x[i] / (2 * (2 * l + 3)));
+                    t *= x[i] / (2 * l + 3);
+                }
+            }
+        }
+        scatter(idx_dn, i0, n);
+    }
+}
+
 void
 Spherical_Bessel_functions::sbessel_deriv_q(int lmax__, double q__, double x__, double* jl_dq__)
 {
@@ -48,6 +48,13 @@ class Spherical_Bessel_functions
 
     static void sbessel(int lmax__, double t__, double* jl__);
 
+    /// Spherical Bessel functions for a batch of arguments.
+    /** Functions \f$ j_{\ell}(x_i) \f$ are stored in jl__[l + i * ld__]. The recurrences are vectorized over the
+        arguments: upward recurrence is used for \f$ x_i > \ell_{max} \f$ and Miller's algorithm (downward recurrence
+        normalized with the sum rule \f$ \sum_{\ell} (2\ell+1) j_{\ell}^2(x) = 1 \f$) is used for the remaining
+        arguments. */
+    static void sbessel(int lmax__, int n__, double const* x__, double* jl__, int ld__);
+
     static void sbessel_deriv_q(int lmax__, double q__, double x__, double* jl_dq__);
 
     Spline<double> const& operator[](int l__) const;
@@ -385,6 +385,192 @@ inline void spherical_harmonics(int lmax, double theta, double phi, double* rlm)
     }
 }
 
+/// Normalised associated Legendre polynomials for a batch of arguments.
+/** The same recursive relations as in sirius::legendre_plm() are used, but the inner loops run over the arguments
+    and are vectorized. The polynomial \f$ P_{\ell}^{m}(x_i) \f$ is stored in plm__[utils::lm(l, m) * ld__ + i].
+    Arguments are given as \f$ x_i = \cos \theta_i \f$ and \f$ y_i = \sin \theta_i \f$.
+ */
+inline void legendre_plm(int lmax__, int n__, double const* x__, double const* y__, double* plm__, int ld__)
+{
+    auto p = [plm__, ld__](int l, int m) { return plm__ + utils::lm(l, m) * ld__; };
+
+    double* p00 = p(0, 0);
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        p00[i] = 0.28209479177387814347; // 1.0 / std::sqrt(fourpi)
+    }
+    /* compute P_{l,l} (diagonal) */
+    for (int l = 1; l <= lmax__; l++) {
+        double a         = -std::sqrt(1 + 0.5 / l);
+        double const* p0 = p(l - 1, l - 1);
+        double* p1       = p(l, l);
+        #pragma omp simd
+        for (int i = 0; i < n__; i++) {
+            p1[i] = a * y__[i] * p0[i];
+        }
+    }
+    /* compute P_{l+1,l} (upper diagonal) */
+    for (int l = 0; l < lmax__; l++) {
+        double a         = std::sqrt(2.0 * l + 3);
+        double const* p0 = p(l, l);
+        double* p1       = p(l + 1, l);
+        #pragma omp simd
+        for (int i = 0; i < n__; i++) {
+            p1[i] = a * x__[i] * p0[i];
+        }
+    }
+    for (int m = 0; m <= lmax__ - 2; m++) {
+        for (int l = m + 2; l <= lmax__; l++) {
+            double alm = std::sqrt(static_cast<double>((2 * l - 1) * (2 * l + 1)) / (l * l - m * m));
+            double blm = std::sqrt(static_cast<double>((l - 1 - m) * (l - 1 + m)) / ((2 * l - 3) * (2 * l - 1)));
+            double const* p1 = p(l - 1, m);
+            double const* p2 = p(l - 2, m);
+            double* p0       = p(l, m);
+            #pragma omp simd
+            for (int i = 0; i < n__; i++) {
+                p0[i] = alm * (x__[i] * p1[i] - blm * p2[i]);
+            }
+        }
+    }
+}
+
+namespace detail {
+
+/// Block size of the batched generation of spherical harmonics.
+const int ylm_block_size = 32;
+
+/// Generate the Legendre polynomials and \f$ \cos m\phi \f$, \f$ \sin m\phi \f$ for a block of directions.
+/** On output plm__[lm * nb + i] contains \f$ P_{\ell}^{m}(\cos \theta_i) \f$ for \f$ m \ge 0 \f$, cosmp__[m * nb + i]
+    and sinmp__[m * nb + i] contain \f$ \cos m\phi_i \f$ and \f$ \sin m\phi_i \f$ for \f$ m \ge 1 \f$. */
+inline void spherical_harmonics_block(int lmax__, int n__, double const* theta__, double const* phi__, double* plm__,
+                                      double* cosmp__, double* sinmp__)
+{
+    int const nb = ylm_block_size;
+    double x[nb], y[nb];
+
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        x[i] = std::cos(theta__[i]);
+        y[i] = std::sqrt(1 - x[i] * x[i]);
+    }
+    legendre_plm(lmax__, n__, x, y, plm__, nb);
+
+    if (lmax__ == 0) {
+        return;
+    }
+    #pragma omp simd
+    for (int i = 0; i < n__; i++) {
+        cosmp__[nb + i] = std::cos(phi__[i]);
+        sinmp__[nb + i] = std::sin(phi__[i]);
+        cosmp__[i]      = 1;
+        sinmp__[i]      = 0;
+    }
+    for (int m = 2; m <= lmax__; m++) {
+        double* c  = cosmp__ + m * nb;
+        double* s  = sinmp__ + m * nb;
+        double* c1 = cosmp__ + (m - 1) * nb;
+        double* s1 = sinmp__ + (m - 1) * nb;
+        double* c0 = cosmp__ + (m - 2) * nb;
+        double* s0 = sinmp__ + (m - 2) * nb;
+        double* cp = cosmp__ + nb;
+        #pragma omp simd
+        for (int i = 0; i < n__; i++) {
+            c[i] = 2 * cp[i] * c1[i] - c0[i];
+            s[i] = 2 * cp[i] * s1[i] - s0[i];
+        }
+    }
+}
+
+} // namespace detail
+
+/// Complex spherical harmonics for a batch of directions.
+/** Harmonics of the direction i are stored in ylm__[lm + i * ld__]; the result is the same as for the
+    single-direction function, but the recurrences are vectorized over the directions. */
+inline void spherical_harmonics(int lmax__, int n__, double const* theta__, double const* phi__, double_complex* ylm__,
+                                int ld__)
+{
+    int const nb = detail::ylm_block_size;
+    int lmmax    = utils::lmmax(lmax__);
+    std::vector<double> re(lmmax * nb);
+    std::vector<double> im(lmmax * nb);
+    std::vector<double> cosmp((lmax__ + 1) * nb);
+    std::vector<double> sinmp((lmax__ + 1) * nb);
+
+    for (int i0 = 0; i0 < n__; i0 += nb) {
+        int n = std::min(nb, n__ - i0);
+        detail::spherical_harmonics_block(lmax__, n, theta__ + i0, phi__ + i0, re.data(), cosmp.data(), sinmp.data());
+        for (int l = 0; l <= lmax__; l++) {
+            std::fill(&im[utils::lm(l, 0) * nb], &im[utils::lm(l, 0) * nb] + nb, 0);
+        }
+        for (int m = 1; m <= lmax__; m++) {
+            double const* c = &cosmp[m * nb];
+            double const* s = &sinmp[m * nb];
+            double phase    = (m % 2) ? -1 : 1;
+            for (int l = m; l <= lmax__; l++) {
+                double* re1 = &re[utils::lm(l, m) * nb];
+                double* im1 = &im[utils::lm(l, m) * nb];
+                double* re2 = &re[utils::lm(l, -m) * nb];
+                double* im2 = &im[utils::lm(l, -m) * nb];
+                #pragma omp simd
+                for (int i = 0; i < n; i++) {
+                    double p = re1[i];
+                    re1[i]   = p * c[i];
+                    im1[i]   = p * s[i];
+                    re2[i]   = phase * p * c[i];
+                    im2[i]   = -phase * p * s[i];
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            auto out = ylm__ + static_cast<size_t>(i0 + i) * ld__;
+            for (int lm = 0; lm < lmmax; lm++) {
+                out[lm] = double_complex(re[lm * nb + i], im[lm * nb + i]);
+            }
+        }
+    }
+}
+
+/// Real spherical harmonics for a batch of directions.
+/** Harmonics of the direction i are stored in rlm__[lm + i * ld__]; the result is the same as for the
+    single-direction function, but the recurrences are vectorized over the directions. */
+inline void spherical_harmonics(int lmax__, int n__, double const* theta__, double const* phi__, double* rlm__,
+                                int ld__)
+{
+    int const nb = detail::ylm_block_size;
+    int lmmax    = utils::lmmax(lmax__);
+    std::vector<double> r(lmmax * nb);
+    std::vector<double> cosmp((lmax__ + 1) * nb);
+    std::vector<double> sinmp((lmax__ + 1) * nb);
+
+    double const t = std::sqrt(2.0);
+
+    for (int i0 = 0; i0 < n__; i0 += nb) {
+        int n = std::min(nb, n__ - i0);
+        detail::spherical_harmonics_block(lmax__, n, theta__ + i0, phi__ + i0, r.data(), cosmp.data(), sinmp.data());
+        for (int m = 1; m <= lmax__; m++) {
+            double const* c = &cosmp[m * nb];
+            double const* s = &sinmp[m * nb];
+            double phase    = (m % 2) ? t : -t;
+            for (int l = m; l <= lmax__; l++) {
+                double* r1 = &r[utils::lm(l, m) * nb];
+                double* r2 = &r[utils::lm(l, -m) * nb];
+                #pragma omp simd
+                for (int i = 0; i < n; i++) {
+                    double p = r1[i];
+                    r1[i]    = t * p * c[i];
+                    r2[i]    = phase * p * s[i];
+                }
+            }
+        }
+        for (int i = 0; i < n; i++) {
+            auto out = rlm__ + static_cast<size_t>(i0 + i) * ld__;
+            for (int lm = 0; lm < lmmax; lm++) {
+                out[lm] = r[lm * nb + i];
+            }
+        }
+    }
+}
+
 /// Generate \f$ \cos(m x) \f$ for m in [1, n] using recursion.
 inline sddk::mdarray<double, 1> cosxn(int n__, double x__)
 {
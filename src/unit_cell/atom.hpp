@@ -28,6 +28,7 @@
 #include "sht/gaunt.hpp"
 #include "atom_symmetry_class.hpp"
 #include "function3d/spheric_function.hpp"
+#include "radial/spline_set.hpp"
 #include "utils/profiler.hpp"
 
 namespace sirius {
@@ -174,42 +175,42 @@ class Atom
             b_radial_integrals_.zero();
         }
 
-        /* copy radial functions to spline objects */
-        std::vector<Spline<double>> rf_spline(nrf);
-        #pragma omp parallel for
-        for (int i = 0; i < nrf; i++) {
-            rf_spline[i] = Spline<double>(type().radial_grid());
-            for (int ir = 0; ir < nmtp; ir++) {
-                rf_spline[i](ir) = symmetry_class().radial_function(ir, i);
-            }
-        }
+        auto& idx_ri = type().idx_radial_integrals();
 
-        /* copy effective potential components to spline objects */
-        std::vector<Spline<double>> v_spline(lmmax * (1 + num_mag_dims));
-        #pragma omp parallel for
-        for (int lm = 0; lm < lmmax; lm++) {
-            v_spline[lm] = Spline<double>(type().radial_grid());
-            for (int ir = 0; ir < nmtp; ir++) {
-                v_spline[lm](ir) = veff_(lm, ir);
-            }
+        mdarray<double, 1> result(idx_ri.size(1));
 
-            for (int j = 0; j < num_mag_dims; j++) {
-                v_spline[lm + (j + 1) * lmmax] = Spline<double>(type().radial_grid());
+        if (pu__ == device_t::GPU) {
+#ifdef SIRIUS_GPU
+            /* copy radial functions to spline objects */
+            std::vector<Spline<double>> rf_spline(nrf);
+            #pragma omp parallel for
+            for (int i = 0; i < nrf; i++) {
+                rf_spline[i] = Spline<double>(type().radial_grid());
                 for (int ir = 0; ir < nmtp; ir++) {
-                    v_spline[lm + (j + 1) * lmmax](ir) = beff_[j](lm, ir);
+                    rf_spline[i](ir) = symmetry_class().radial_function(ir, i);
                 }
             }
-        }
 
-        /* interpolate potential multiplied by a radial function */
-        std::vector<Spline<double>> vrf_spline(lmmax * nrf * (1 + num_mag_dims));
+            /* copy effective potential components to spline objects */
+            std::vector<Spline<double>> v_spline(lmmax * (1 + num_mag_dims));
+            #pragma omp parallel for
+            for (int lm = 0; lm < lmmax; lm++) {
+                v_spline[lm] = Spline<double>(type().radial_grid());
+                for (int ir = 0; ir < nmtp; ir++) {
+                    v_spline[lm](ir) = veff_(lm, ir);
+                }
 
-        auto& idx_ri = type().idx_radial_integrals();
+                for (int j = 0; j < num_mag_dims; j++) {
+                    v_spline[lm + (j + 1) * lmmax] = Spline<double>(type().radial_grid());
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        v_spline[lm + (j + 1) * lmmax](ir) = beff_[j](lm, ir);
+                    }
+                }
+            }
 
-        mdarray<double, 1> result(idx_ri.size(1));
+            /* interpolate potential multiplied by a radial function */
+            std::vector<Spline<double>> vrf_spline(lmmax * nrf * (1 + num_mag_dims));
 
-        if (pu__ == device_t::GPU) {
-#ifdef SIRIUS_GPU
             auto& rgrid    = type().radial_grid();
             auto& rf_coef  = type().rf_coef();
             auto& vrf_coef = type().vrf_coef();
@@ -265,23 +266,40 @@ class Atom
 #endif
         }
         if (pu__ == device_t::CPU) {
+            /* radial functions, potential components and their products are stored in the sets of splines */
+            Spline_set<double> rf_set(type().radial_grid(), nrf);
+            Spline_set<double> v_set(type().radial_grid(), lmmax * (1 + num_mag_dims));
+            Spline_set<double> vrf_set(type().radial_grid(), lmmax * nrf * (1 + num_mag_dims));
+
             PROFILE_START("sirius::Atom::generate_radial_integrals|interp");
             #pragma omp parallel
             {
                 #pragma omp for
                 for (int i = 0; i < nrf; i++) {
-                    rf_spline[i].interpolate();
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        rf_set(ir, i) = symmetry_class().radial_function(ir, i);
+                    }
+                    rf_set.interpolate(i);
                 }
                 #pragma omp for
-                for (int i = 0; i < lmmax * (1 + num_mag_dims); i++) {
-                    v_spline[i].interpolate();
+                for (int lm = 0; lm < lmmax; lm++) {
+                    for (int ir = 0; ir < nmtp; ir++) {
+                        v_set(ir, lm) = veff_(lm, ir);
+                    }
+                    v_set.interpolate(lm);
+                    for (int j = 0; j < num_mag_dims; j++) {
+                        for (int ir = 0; ir < nmtp; ir++) {
+                            v_set(ir, lm + (j + 1) * lmmax) = beff_[j](lm, ir);
+                        }
+                        v_set.interpolate(lm + (j + 1) * lmmax);
+                    }
                 }
 
                 #pragma omp for
                 for (int lm = 0; lm < lmmax; lm++) {
                     for (int i = 0; i < nrf; i++) {
                         for (int j = 0; j < num_mag_dims + 1; j++) {
-                            vrf_spline[lm + lmmax * i + lmmax * nrf * j] = rf_spline[i] * v_spline[lm + j * lmmax];
+                            vrf_set.product(lm + lmmax * i + lmmax * nrf * j, rf_set, i, v_set, lm + j * lmmax);
                         }
                     }
                 }
@@ -289,10 +307,7 @@ class Atom
             PROFILE_STOP("sirius::Atom::generate_radial_integrals|interp");
 
             PROFILE("sirius::Atom::generate_radial_integrals|inner");
-            #pragma omp parallel for
-            for (int j = 0; j < (int)idx_ri.size(1); j++) {
-                result(j) = inner(rf_spline[idx_ri(0, j)], vrf_spline[idx_ri(1, j)], 2);
-            }
+            rf_set.inner(vrf_set, idx_ri, 2, result.at(memory_t::host));
             //if (type().parameters().control().print_performance_) {
             //    double tval = t2.stop();
             //    DUMP("spline CPU integration performance: %12.6f GFlops",
@@ -437,39 +452,40 @@ class Atom
      */
     template <spin_block_t sblock>
     inline double_complex
-    radial_integrals_sum_L3(int idxrf1__, int idxrf2__, std::vector<gaunt_L3<double_complex>> const& gnt__) const
+    radial_integrals_sum_L3(int idxrf1__, int idxrf2__, gaunt_L3_row<double_complex> const& gnt__) const
     {
         double_complex zsum(0, 0);
 
-        for (size_t i = 0; i < gnt__.size(); i++) {
+        for (int i = 0; i < gnt__.size; i++) {
+            int lm3 = gnt__.lm3[i];
             switch (sblock) {
                 case spin_block_t::nm: {
                     /* just the Hamiltonian */
-                    zsum += gnt__[i].coef * h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__);
+                    zsum += gnt__.coef[i] * h_radial_integrals_(lm3, idxrf1__, idxrf2__);
                     break;
                 }
                 case spin_block_t::uu: {
                     /* h + Bz */
-                    zsum += gnt__[i].coef * (h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__) +
-                                             b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 0));
+                    zsum += gnt__.coef[i] * (h_radial_integrals_(lm3, idxrf1__, idxrf2__) +
+                                             b_radial_integrals_(lm3, idxrf1__, idxrf2__, 0));
                     break;
                 }
                 case spin_block_t::dd: {
                     /* h - Bz */
-                    zsum += gnt__[i].coef * (h_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__) -
-                                             b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 0));
+                    zsum += gnt__.coef[i] * (h_radial_integrals_(lm3, idxrf1__, idxrf2__) -
+                                             b_radial_integrals_(lm3, idxrf1__, idxrf2__, 0));
                     break;
                 }
                 case spin_block_t::ud: {
                     /* Bx - i By */
-                    zsum += gnt__[i].coef * double_complex(b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 1),
-                                                           -b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 2));
+                    zsum += gnt__.coef[i] * double_complex(b_radial_integrals_(lm3, idxrf1__, idxrf2__, 1),
+                                                           -b_radial_integrals_(lm3, idxrf1__, idxrf2__, 2));
                     break;
                 }
                 case spin_block_t::du: {
                     /* Bx + i By */
-                    zsum += gnt__[i].coef * double_complex(b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 1),
-                                                           b_radial_integrals_(gnt__[i].lm3, idxrf1__, idxrf2__, 2));
+                    zsum += gnt__.coef[i] * double_complex(b_radial_integrals_(lm3, idxrf1__, idxrf2__, 1),
+                                                           b_radial_integrals_(lm3, idxrf1__, idxrf2__, 2));
                     break;
                 }
             }
@@ -477,6 +493,124 @@ class Atom
         return zsum;
     }
 
+    /// Compute the sums over L3 for a fixed bra function and a list of ket radial functions.
+    /** For each idxrf2 = idxrf2__[i] the same value as radial_integrals_sum_L3(idxrf1__, idxrf2, gaunt_row(lm1, lm2))
+     *  is computed. The Gaunt coefficients of the (lm1, lm2) pair are loaded once for the whole list. */
+    template <spin_block_t sblock>
+    inline void
+    radial_integrals_sum_L3(int idxrf1__, int lm1__, int lm2__, int n__, int const* idxrf2__, double_complex* zsum__,
+                            double_complex* ztmp__) const
+    {
+        auto& gc = type_.gaunt_coefs();
+        /* stride between the radial integrals of two consecutive idxrf2 */
+        int ld = static_cast<int>(h_radial_integrals_.size(0) * h_radial_integrals_.size(1));
+        switch (sblock) {
+            case spin_block_t::nm: {
+                gc.sum_L3_gaunt(lm1__, lm2__, &h_radial_integrals_(0, idxrf1__, 0), ld, n__, idxrf2__, zsum__);
+                break;
+            }
+            case spin_block_t::uu:
+            case spin_block_t::dd: {
+                gc.sum_L3_gaunt(lm1__, lm2__, &h_radial_integrals_(0, idxrf1__, 0), ld, n__, idxrf2__, zsum__);
+                gc.sum_L3_gaunt(lm1__, lm2__, &b_radial_integrals_(0, idxrf1__, 0, 0), ld, n__, idxrf2__, ztmp__);
+                double s = (sblock == spin_block_t::uu) ? 1 : -1;
+                for (int i = 0; i < n__; i++) {
+                    zsum__[i] += s * ztmp__[i];
+                }
+                break;
+            }
+            case spin_block_t::ud:
+            case spin_block_t::du: {
+                gc.sum_L3_gaunt(lm1__, lm2__, &b_radial_integrals_(0, idxrf1__, 0, 1), ld, n__, idxrf2__, zsum__);
+                gc.sum_L3_gaunt(lm1__, lm2__, &b_radial_integrals_(0, idxrf1__, 0, 2), ld, n__, idxrf2__, ztmp__);
+                double_complex s = (sblock == spin_block_t::ud) ? double_complex(0, -1) : double_complex(0, 1);
+                for (int i = 0; i < n__; i++) {
+                    zsum__[i] += s * ztmp__[i];
+                }
+                break;
+            }
+        }
+    }
+
+    /// Compute the muffin-tin Hamiltonian of a given spin block for the first nbf basis functions.
+    /** The matrix elements
+     *  \f[
+     *      h_{\xi_1 \xi_2} = \sum_{L_3} \langle u_{\ell_1 \nu_1} | h_{L_3} | u_{\ell_2 \nu_2} \rangle
+     *                 \langle Y_{L_1} | R_{L_3} | Y_{L_2} \rangle
+     *  \f]
+     *  are computed for \f$ \xi_1, \xi_2 < n_{bf} \f$. For each bra function and each \f$ L_2 \f$ the sum is
+     *  done for all ket radial functions of the orbital quantum number \f$ \ell_2 \f$ at once.
+     *
+     *  The spherical part of the radial integrals is not symmetric in the radial functions, so the full matrix
+     *  is not Hermitian. If hermitian__ is true, only the upper triangle \f$ \xi_1 \le \xi_2 \f$ is computed
+     *  and the lower triangle is set to its complex conjugate.
+     */
+    template <spin_block_t sblock, typename T>
+    inline void generate_hmt(int nbf__, mdarray<std::complex<T>, 2>& hmt__, bool hermitian__) const
+    {
+        auto& indexr = type_.indexr();
+        auto& indexb = type_.indexb();
+
+        /* radial functions of each l with at least one basis function inside the block */
+        std::vector<std::vector<int>> rf_by_l(indexr.lmax() + 1);
+        for (int idxrf = 0; idxrf < indexr.size(); idxrf++) {
+            if (indexb.index_by_idxrf(idxrf) < nbf__) {
+                rf_by_l[indexr[idxrf].l].push_back(idxrf);
+            }
+        }
+        std::vector<double_complex> zsum(indexr.size());
+        std::vector<double_complex> ztmp(indexr.size());
+
+        for (int idxrf1 = 0; idxrf1 < indexr.size(); idxrf1++) {
+            int l1 = indexr[idxrf1].l;
+            int j0 = indexb.index_by_idxrf(idxrf1);
+            if (j0 >= nbf__) {
+                continue;
+            }
+            for (int m1 = -l1; m1 <= l1; m1++) {
+                int lm1 = utils::lm(l1, m1);
+                int j1  = j0 + l1 + m1;
+                for (int l2 = 0; l2 <= indexr.lmax(); l2++) {
+                    int n = static_cast<int>(rf_by_l[l2].size());
+                    if (n == 0) {
+                        continue;
+                    }
+                    /* largest index of the ket basis functions with m2 = -l2 */
+                    int jmax{0};
+                    for (int i = 0; i < n; i++) {
+                        jmax = std::max(jmax, indexb.index_by_idxrf(rf_by_l[l2][i]));
+                    }
+                    for (int m2 = -l2; m2 <= l2; m2++) {
+                        int lm2 = utils::lm(l2, m2);
+                        /* the whole group is in the lower triangle */
+                        if (hermitian__ && jmax + l2 + m2 < j1) {
+                            continue;
+                        }
+                        if (type_.gaunt_coefs().num_gaunt(lm1, lm2) == 0) {
+                            std::fill(zsum.begin(), zsum.begin() + n, 0);
+                        } else {
+                            radial_integrals_sum_L3<sblock>(idxrf1, lm1, lm2, n, rf_by_l[l2].data(), zsum.data(),
+                                                            ztmp.data());
+                        }
+                        for (int i = 0; i < n; i++) {
+                            int j2 = indexb.index_by_idxrf(rf_by_l[l2][i]) + l2 + m2;
+                            if (!hermitian__ || j1 <= j2) {
+                                hmt__(j1, j2) = static_cast<std::complex<T>>(zsum[i]);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        if (hermitian__) {
+            for (int j2 = 0; j2 < nbf__; j2++) {
+                for (int j1 = 0; j1 < j2; j1++) {
+                    hmt__(j2, j1) = std::conj(hmt__(j1, j2));
+                }
+            }
+        }
+    }
+
     inline int num_mt_points() const
     {
         return type_.num_mt_points();
@@ -72,226 +72,235 @@ Atom_symmetry_class::Atom_symmetry_class(int id__, Atom_type const& atom_type__)
 
 void
 Atom_symmetry_class::generate_aw_radial_functions(relativity_t rel__)
+{
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int l = 0; l < num_aw_descriptors(); l++) {
+        generate_aw_radial_functions(rel__, l);
+    }
+}
+
+void
+Atom_symmetry_class::generate_aw_radial_functions(relativity_t rel__, int l__)
 {
     int nmtp = atom_type_.num_mt_points();
 
     Radial_solver solver(atom_type_.zn(), spherical_potential_, atom_type_.radial_grid());
 
-    #pragma omp parallel default(shared)
-    {
-        Spline<double> s(atom_type_.radial_grid());
+    Spline<double> s(atom_type_.radial_grid());
 
-        std::vector<double>   p;
-        std::vector<double>   rdudr;
-        std::array<double, 2> uderiv;
+    std::vector<double>   p;
+    std::vector<double>   rdudr;
+    std::array<double, 2> uderiv;
 
-        #pragma omp for schedule(dynamic, 1)
-        for (int l = 0; l < num_aw_descriptors(); l++) {
-            for (int order = 0; order < (int)aw_descriptor(l).size(); order++) {
-                auto rsd = aw_descriptor(l)[order];
+    for (int order = 0; order < (int)aw_descriptor(l__).size(); order++) {
+        auto rsd = aw_descriptor(l__)[order];
 
-                int idxrf = atom_type_.indexr().index_by_l_order(l, order);
+        int idxrf = atom_type_.indexr().index_by_l_order(l__, order);
 
-                solver.solve(rel__, rsd.dme, rsd.l, rsd.enu, p, rdudr, uderiv);
+        solver.solve(rel__, rsd.dme, rsd.l, rsd.enu, p, rdudr, uderiv);
 
-                /* normalize */
-                for (int ir = 0; ir < nmtp; ir++) {
-                    s(ir) = std::pow(p[ir], 2);
-                }
-                double norm = 1.0 / std::sqrt(s.interpolate().integrate(0));
+        /* normalize */
+        for (int ir = 0; ir < nmtp; ir++) {
+            s(ir) = std::pow(p[ir], 2);
+        }
+        double norm = 1.0 / std::sqrt(s.interpolate().integrate(0));
 
-                for (int ir = 0; ir < nmtp; ir++) {
-                    radial_functions_(ir, idxrf, 0) = p[ir] * norm;
-                    radial_functions_(ir, idxrf, 1) = rdudr[ir] * norm;
-                }
-                surface_derivatives_(0, idxrf) = norm * p.back() / atom_type_.mt_radius();
-                for (int i : {0, 1}) {
-                    surface_derivatives_(i + 1, idxrf) = uderiv[i] * norm;
-                }
+        for (int ir = 0; ir < nmtp; ir++) {
+            radial_functions_(ir, idxrf, 0) = p[ir] * norm;
+            radial_functions_(ir, idxrf, 1) = rdudr[ir] * norm;
+        }
+        surface_derivatives_(0, idxrf) = norm * p.back() / atom_type_.mt_radius();
+        for (int i : {0, 1}) {
+            surface_derivatives_(i + 1, idxrf) = uderiv[i] * norm;
+        }
 
-                /* orthogonalize to previous radial functions */
-                for (int order1 = 0; order1 < order; order1++) {
-                    int idxrf1 = atom_type_.indexr().index_by_l_order(l, order1);
+        /* orthogonalize to previous radial functions */
+        for (int order1 = 0; order1 < order; order1++) {
+            int idxrf1 = atom_type_.indexr().index_by_l_order(l__, order1);
 
-                    for (int ir = 0; ir < nmtp; ir++) {
-                        s(ir) = radial_functions_(ir, idxrf, 0) * radial_functions_(ir, idxrf1, 0);
-                    }
+            for (int ir = 0; ir < nmtp; ir++) {
+                s(ir) = radial_functions_(ir, idxrf, 0) * radial_functions_(ir, idxrf1, 0);
+            }
 
-                    /* <u_{\nu'}|u_{\nu}> */
-                    double ovlp = s.interpolate().integrate(0);
+            /* <u_{\nu'}|u_{\nu}> */
+            double ovlp = s.interpolate().integrate(0);
 
-                    for (int ir = 0; ir < nmtp; ir++) {
-                        radial_functions_(ir, idxrf, 0) -= radial_functions_(ir, idxrf1, 0) * ovlp;
-                        radial_functions_(ir, idxrf, 1) -= radial_functions_(ir, idxrf1, 1) * ovlp;
-                    }
-                    for (int i : {0, 1, 2}) {
-                        surface_derivatives_(i, idxrf) -= surface_derivatives_(i, idxrf1) * ovlp;
-                    }
-                }
+            for (int ir = 0; ir < nmtp; ir++) {
+                radial_functions_(ir, idxrf, 0) -= radial_functions_(ir, idxrf1, 0) * ovlp;
+                radial_functions_(ir, idxrf, 1) -= radial_functions_(ir, idxrf1, 1) * ovlp;
+            }
+            for (int i : {0, 1, 2}) {
+                surface_derivatives_(i, idxrf) -= surface_derivatives_(i, idxrf1) * ovlp;
+            }
+        }
 
-                /* normalize again */
-                for (int ir = 0; ir < nmtp; ir++) {
-                    s(ir) = std::pow(radial_functions_(ir, idxrf, 0), 2);
-                }
-                norm = s.interpolate().integrate(0);
-
-                if (std::abs(norm) < 1e-10) {
-                    std::stringstream s;
-                    s << "AW radial function for atom " << atom_type_.label() << " is linearly dependent" << std::endl
-                      << "  order: " << order << std::endl
-                      << "      l: " << l << std::endl
-                      << "    dme: " << rsd.dme << std::endl
-                      << "    enu: " << rsd.enu;
-                    RTE_THROW(s);
-                }
+        /* normalize again */
+        for (int ir = 0; ir < nmtp; ir++) {
+            s(ir) = std::pow(radial_functions_(ir, idxrf, 0), 2);
+        }
+        norm = s.interpolate().integrate(0);
 
-                norm = 1.0 / std::sqrt(norm);
+        if (std::abs(norm) < 1e-10) {
+            std::stringstream s;
+            s << "AW radial function for atom " << atom_type_.label() << " is linearly dependent" << std::endl
+              << "  order: " << order << std::endl
+              << "      l: " << l__ << std::endl
+              << "    dme: " << rsd.dme << std::endl
+              << "    enu: " << rsd.enu;
+            RTE_THROW(s);
+        }
 
-                for (int ir = 0; ir < nmtp; ir++) {
-                    radial_functions_(ir, idxrf, 0) *= norm;
-                    radial_functions_(ir, idxrf, 1) *= norm;
-                }
-                for (int i : {0, 1, 2}) {
-                    surface_derivatives_(i, idxrf) *= norm;
-                }
-            } // order
-            /* divide by r */
-            for (int order = 0; order < (int)aw_descriptor(l).size(); order++) {
-                int idxrf = atom_type_.indexr().index_by_l_order(l, order);
-                for (int ir = 0; ir < nmtp; ir++) {
-                    radial_functions_(ir, idxrf, 0) *= atom_type_.radial_grid().x_inv(ir);
-                }
-            }
-        } // l
+        norm = 1.0 / std::sqrt(norm);
+
+        for (int ir = 0; ir < nmtp; ir++) {
+            radial_functions_(ir, idxrf, 0) *= norm;
+            radial_functions_(ir, idxrf, 1) *= norm;
+        }
+        for (int i : {0, 1, 2}) {
+            surface_derivatives_(i, idxrf) *= norm;
+        }
+    } // order
+    /* divide by r */
+    for (int order = 0; order < (int)aw_descriptor(l__).size(); order++) {
+        int idxrf = atom_type_.indexr().index_by_l_order(l__, order);
+        for (int ir = 0; ir < nmtp; ir++) {
+            radial_functions_(ir, idxrf, 0) *= atom_type_.radial_grid().x_inv(ir);
+        }
     }
 }
 
 void
 Atom_symmetry_class::generate_lo_radial_functions(relativity_t rel__)
 {
-    int nmtp = atom_type_.num_mt_points();
-
-    Radial_solver solver(atom_type_.zn(), spherical_potential_, atom_type_.radial_grid());
-
     #pragma omp parallel for schedule(dynamic, 1)
     for (int idxlo = 0; idxlo < num_lo_descriptors(); idxlo++) {
-        Spline<double> s(atom_type_.radial_grid());
-        double a[3][3];
-        double rderiv[3][3];
+        generate_lo_radial_function(rel__, idxlo);
+    }
 
-        /* number of radial solutions */
-        int num_rs = static_cast<int>(lo_descriptor(idxlo).rsd_set.size());
-        RTE_ASSERT(num_rs <= 3);
+    if (atom_type_.parameters().cfg().control().verification() > 0 && num_lo_descriptors() > 0) {
+        check_lo_linear_independence(0.0001);
+    }
+}
 
-        std::vector<std::vector<double>> p(num_rs);
-        std::vector<std::vector<double>> rdudr(num_rs);
-        std::array<double, 2>            uderiv;
+void
+Atom_symmetry_class::generate_lo_radial_function(relativity_t rel__, int idxlo__)
+{
+    int nmtp = atom_type_.num_mt_points();
 
-        for (int order = 0; order < num_rs; order++) {
-            auto rsd = lo_descriptor(idxlo).rsd_set[order];
+    Radial_solver solver(atom_type_.zn(), spherical_potential_, atom_type_.radial_grid());
 
-            solver.solve(rel__, rsd.dme, rsd.l, rsd.enu, p[order], rdudr[order], uderiv);
+    Spline<double> s(atom_type_.radial_grid());
+    double a[3][3];
+    double rderiv[3][3];
 
-            /* find norm of the radial solution */
-            for (int ir = 0; ir < nmtp; ir++) {
-                s(ir) = std::pow(p[order][ir], 2);
-            }
-            double norm = 1.0 / std::sqrt(s.interpolate().integrate(0));
+    /* number of radial solutions */
+    int num_rs = static_cast<int>(lo_descriptor(idxlo__).rsd_set.size());
+    RTE_ASSERT(num_rs <= 3);
 
-            /* normalize radial solution and divide by r */
-            for (int ir = 0; ir < nmtp; ir++) {
-                /* store u(r) = p(r)/r */
-                p[order][ir] *= (norm * atom_type_.radial_grid().x_inv(ir));
-                /* don't divide rdudr by r */
-                rdudr[order][ir] *= norm;
-            }
-            uderiv[0] *= norm;
-            uderiv[1] *= norm;
+    std::vector<std::vector<double>> p(num_rs);
+    std::vector<std::vector<double>> rdudr(num_rs);
+    std::array<double, 2>            uderiv;
 
-            /* matrix of derivatives */
-            a[order][0] = p[order].back();
-            a[order][1] = uderiv[0];
-            a[order][2] = uderiv[1];
+    for (int order = 0; order < num_rs; order++) {
+        auto rsd = lo_descriptor(idxlo__).rsd_set[order];
 
-            for (int i: {0, 1, 2}) {
-                rderiv[order][i] = a[order][i];
-            }
+        solver.solve(rel__, rsd.dme, rsd.l, rsd.enu, p[order], rdudr[order], uderiv);
+
+        /* find norm of the radial solution */
+        for (int ir = 0; ir < nmtp; ir++) {
+            s(ir) = std::pow(p[order][ir], 2);
         }
+        double norm = 1.0 / std::sqrt(s.interpolate().integrate(0));
 
-        double b[]    = {0, 0, 0};
-        b[num_rs - 1] = 1.0;
+        /* normalize radial solution and divide by r */
+        for (int ir = 0; ir < nmtp; ir++) {
+            /* store u(r) = p(r)/r */
+            p[order][ir] *= (norm * atom_type_.radial_grid().x_inv(ir));
+            /* don't divide rdudr by r */
+            rdudr[order][ir] *= norm;
+        }
+        uderiv[0] *= norm;
+        uderiv[1] *= norm;
 
-        int info = linalg(linalg_t::lapack).gesv(num_rs, 1, &a[0][0], 3, b, 3);
+        /* matrix of derivatives */
+        a[order][0] = p[order].back();
+        a[order][1] = uderiv[0];
+        a[order][2] = uderiv[1];
 
-        if (info) {
-            std::stringstream s;
-            s << "a[i][j] = ";
-            for (int i = 0; i < num_rs; i++) {
-                for (int j = 0; j < num_rs; j++) {
-                    s << rderiv[i][j] << " ";
-                }
-            }
-            s << std::endl;
-            s << "atom: " << atom_type_.label() << std::endl
-              << "zn: " << atom_type_.zn() << std::endl
-              << "l: " << lo_descriptor(idxlo).l << std::endl;
-            s << "gesv returned " << info;
-            RTE_THROW(s);
+        for (int i: {0, 1, 2}) {
+            rderiv[order][i] = a[order][i];
         }
+    }
 
-        /* index of local orbital radial function */
-        int idxrf = atom_type_.indexr().index_by_idxlo(idxlo);
-        /* zero surface derivatives */
-        for (int i : {0, 1, 2}) {
-            surface_derivatives_(i, idxrf) = 0;
-        }
-        /* take linear combination of radial solutions */
-        for (int order = 0; order < num_rs; order++) {
-            for (int ir = 0; ir < nmtp; ir++) {
-                /* u(r) function */
-                radial_functions_(ir, idxrf, 0) += b[order] * p[order][ir];
-                /* r(du/dr) function */
-                radial_functions_(ir, idxrf, 1) += b[order] * rdudr[order][ir];
-            }
-            for (int i : {0, 1, 2}) {
-                surface_derivatives_(i, idxrf) += b[order] * rderiv[order][i];
-            }
-        }
+    double b[]    = {0, 0, 0};
+    b[num_rs - 1] = 1.0;
 
-        /* find norm of constructed local orbital */
-        for (int ir = 0; ir < nmtp; ir++) {
-            s(ir) = std::pow(radial_functions_(ir, idxrf, 0), 2);
-        }
-        double norm = 1.0 / std::sqrt(s.interpolate().integrate(2));
+    int info = linalg(linalg_t::lapack).gesv(num_rs, 1, &a[0][0], 3, b, 3);
 
-        /* normalize */
+    if (info) {
+        std::stringstream s;
+        s << "a[i][j] = ";
+        for (int i = 0; i < num_rs; i++) {
+            for (int j = 0; j < num_rs; j++) {
+                s << rderiv[i][j] << " ";
+            }
+        }
+        s << std::endl;
+        s << "atom: " << atom_type_.label() << std::endl
+          << "zn: " << atom_type_.zn() << std::endl
+          << "l: " << lo_descriptor(idxlo__).l << std::endl;
+        s << "gesv returned " << info;
+        RTE_THROW(s);
+    }
+
+    /* index of local orbital radial function */
+    int idxrf = atom_type_.indexr().index_by_idxlo(idxlo__);
+    /* zero surface derivatives */
+    for (int i : {0, 1, 2}) {
+        surface_derivatives_(i, idxrf) = 0;
+    }
+    /* take linear combination of radial solutions */
+    for (int order = 0; order < num_rs; order++) {
         for (int ir = 0; ir < nmtp; ir++) {
-            radial_functions_(ir, idxrf, 0) *= norm;
-            radial_functions_(ir, idxrf, 1) *= norm;
+            /* u(r) function */
+            radial_functions_(ir, idxrf, 0) += b[order] * p[order][ir];
+            /* r(du/dr) function */
+            radial_functions_(ir, idxrf, 1) += b[order] * rdudr[order][ir];
         }
         for (int i : {0, 1, 2}) {
-            surface_derivatives_(i, idxrf) *= norm;
+            surface_derivatives_(i, idxrf) += b[order] * rderiv[order][i];
         }
+    }
 
-        if (std::abs(radial_functions_(nmtp - 1, idxrf, 0)) > 1e-10 || surface_derivatives_(0, idxrf) > 1e-10) {
-            std::stringstream s;
-            s << "local orbital " << idxlo << " is not zero at MT boundary" << std::endl
-              << "  atom symmetry class id : " << id() << " (" << atom_type().symbol() << ")" << std::endl
-              << "  value : " << radial_functions_(nmtp - 1, idxrf, 0) << std::endl
-              << "  number of MT points: " << nmtp << std::endl
-              << "  MT radius: " << atom_type_.radial_grid().last() << std::endl
-              << "  b_coeffs: ";
-            for (int j = 0; j < num_rs; j++) {
-                s << b[j] << " ";
-            }
-            s << std::endl;
-            s << "surface derivative : " << surface_derivatives_(0, idxrf);
-            WARNING(s);
-        }
+    /* find norm of constructed local orbital */
+    for (int ir = 0; ir < nmtp; ir++) {
+        s(ir) = std::pow(radial_functions_(ir, idxrf, 0), 2);
     }
+    double norm = 1.0 / std::sqrt(s.interpolate().integrate(2));
 
-    if (atom_type_.parameters().cfg().control().verification() > 0 && num_lo_descriptors() > 0) {
-        check_lo_linear_independence(0.0001);
+    /* normalize */
+    for (int ir = 0; ir < nmtp; ir++) {
+        radial_functions_(ir, idxrf, 0) *= norm;
+        radial_functions_(ir, idxrf, 1) *= norm;
+    }
+    for (int i : {0, 1, 2}) {
+        surface_derivatives_(i, idxrf) *= norm;
+    }
+
+    if (std::abs(radial_functions_(nmtp - 1, idxrf, 0)) > 1e-10 || surface_derivatives_(0, idxrf) > 1e-10) {
+        std::stringstream s;
+        s << "local orbital " << idxlo__ << " is not zero at MT boundary" << std::endl
+          << "  atom symmetry class id : " << id() << " (" << atom_type().symbol() << ")" << std::endl
+          << "  value : " << radial_functions_(nmtp - 1, idxrf, 0) << std::endl
+          << "  number of MT points: " << nmtp << std::endl
+          << "  MT radius: " << atom_type_.radial_grid().last() << std::endl
+          << "  b_coeffs: ";
+        for (int j = 0; j < num_rs; j++) {
+            s << b[j] << " ";
+        }
+        s << std::endl;
+        s << "surface derivative : " << surface_derivatives_(0, idxrf);
+        WARNING(s);
     }
 }
 
@@ -521,15 +530,24 @@ Atom_symmetry_class::find_enu(relativity_t rel__)
 
     #pragma omp parallel for
     for (size_t i = 0; i < rs_with_auto_enu.size(); i++) {
-        auto   rsd     = rs_with_auto_enu[i];
-        double new_enu = Enu_finder(rel__, atom_type_.zn(), rsd->n, rsd->l, atom_type_.radial_grid(), spherical_potential_, rsd->enu).enu();
-        /* update linearization energy only if its change is above a threshold */
-        if (std::abs(new_enu - rsd->enu) > atom_type_.parameters().cfg().settings().auto_enu_tol()) {
-            rsd->enu           = new_enu;
-            rsd->new_enu_found = true;
-        } else {
-            rsd->new_enu_found = false;
-        }
+        find_enu(rel__, *rs_with_auto_enu[i]);
+    }
+}
+
+void
+Atom_symmetry_class::find_enu(relativity_t rel__, radial_solution_descriptor& rsd__) const
+{
+    if (!rsd__.auto_enu) {
+        return;
+    }
+    double new_enu = Enu_finder(rel__, atom_type_.zn(), rsd__.n, rsd__.l, atom_type_.radial_grid(),
+                                spherical_potential_, rsd__.enu).enu();
+    /* update linearization energy only if its change is above a threshold */
+    if (std::abs(new_enu - rsd__.enu) > atom_type_.parameters().cfg().settings().auto_enu_tol()) {
+        rsd__.enu           = new_enu;
+        rsd__.new_enu_found = true;
+    } else {
+        rsd__.new_enu_found = false;
     }
 }
 
@@ -611,81 +629,80 @@ Atom_symmetry_class::generate_radial_integrals(relativity_t rel__)
 {
     PROFILE("sirius::Atom_symmetry_class::generate_radial_integrals");
 
+    h_spherical_integrals_.zero();
+    o_radial_integrals_.zero();
+    so_radial_integrals_.zero();
+    if (atom_type_.parameters().valence_relativity() == relativity_t::iora) {
+        o1_radial_integrals_.zero();
+    }
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (int l = 0; l <= atom_type_.indexr().lmax(); l++) {
+        generate_radial_integrals(rel__, l);
+    }
+}
+
+void
+Atom_symmetry_class::generate_radial_integrals(relativity_t rel__, int l__)
+{
     int nmtp = atom_type_.num_mt_points();
+    int nrf  = atom_type_.indexr().num_rf(l__);
+    int ll   = l__ * (l__ + 1);
 
     double sq_alpha_half = 0.5 * std::pow(speed_of_light, -2);
     if (rel__ == relativity_t::none) {
         sq_alpha_half = 0;
     }
 
-    h_spherical_integrals_.zero();
-    #pragma omp parallel default(shared)
-    {
-        Spline<double> s(atom_type_.radial_grid());
-        #pragma omp for
-        for (int i1 = 0; i1 < atom_type_.mt_radial_basis_size(); i1++) {
-            for (int i2 = 0; i2 < atom_type_.mt_radial_basis_size(); i2++) {
-                /* for spherical part of potential integrals are diagonal in l */
-                if (atom_type_.indexr(i1).l == atom_type_.indexr(i2).l) {
-                    int ll = atom_type_.indexr(i1).l * (atom_type_.indexr(i1).l + 1);
-                    for (int ir = 0; ir < nmtp; ir++) {
-                        double Minv = 1.0 / (1 - spherical_potential_[ir] * sq_alpha_half);
-                        /* u_1(r) * u_2(r) */
-                        double t0 = radial_functions_(ir, i1, 0) * radial_functions_(ir, i2, 0);
-                        /* r*u'_1(r) * r*u'_2(r) */
-                        double t1 = radial_functions_(ir, i1, 1) * radial_functions_(ir, i2, 1);
-                        s(ir)     = 0.5 * t1 * Minv + t0 * (0.5 * ll * Minv + spherical_potential_[ir] *
-                            std::pow(atom_type_.radial_grid(ir), 2));
-                    }
-                    h_spherical_integrals_(i1, i2) = s.interpolate().integrate(0) / y00;
-                }
+    Spline<double> s(atom_type_.radial_grid());
+
+    /* for spherical part of potential integrals are diagonal in l */
+    for (int order1 = 0; order1 < nrf; order1++) {
+        int i1 = atom_type_.indexr().index_by_l_order(l__, order1);
+        for (int order2 = 0; order2 < nrf; order2++) {
+            int i2 = atom_type_.indexr().index_by_l_order(l__, order2);
+            for (int ir = 0; ir < nmtp; ir++) {
+                double Minv = 1.0 / (1 - spherical_potential_[ir] * sq_alpha_half);
+                /* u_1(r) * u_2(r) */
+                double t0 = radial_functions_(ir, i1, 0) * radial_functions_(ir, i2, 0);
+                /* r*u'_1(r) * r*u'_2(r) */
+                double t1 = radial_functions_(ir, i1, 1) * radial_functions_(ir, i2, 1);
+                s(ir)     = 0.5 * t1 * Minv + t0 * (0.5 * ll * Minv + spherical_potential_[ir] *
+                    std::pow(atom_type_.radial_grid(ir), 2));
             }
+            h_spherical_integrals_(i1, i2) = s.interpolate().integrate(0) / y00;
         }
     }
 
-    o_radial_integrals_.zero();
-    #pragma omp parallel default(shared)
-    {
-        Spline<double> s(atom_type_.radial_grid());
-        #pragma omp for
-        for (int l = 0; l <= atom_type_.indexr().lmax(); l++) {
-            int nrf = atom_type_.indexr().num_rf(l);
-
-            for (int order1 = 0; order1 < nrf; order1++) {
-                int idxrf1 = atom_type_.indexr().index_by_l_order(l, order1);
-                for (int order2 = 0; order2 < nrf; order2++) {
-                    int idxrf2 = atom_type_.indexr().index_by_l_order(l, order2);
-                    if (order1 == order2) {
-                        o_radial_integrals_(l, order1, order2) = 1.0;
-                    } else {
-                        for (int ir = 0; ir < nmtp; ir++) {
-                            s(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0);
-                        }
-                        o_radial_integrals_(l, order1, order2) = s.interpolate().integrate(2);
-                    }
+    for (int order1 = 0; order1 < nrf; order1++) {
+        int idxrf1 = atom_type_.indexr().index_by_l_order(l__, order1);
+        for (int order2 = 0; order2 < nrf; order2++) {
+            int idxrf2 = atom_type_.indexr().index_by_l_order(l__, order2);
+            if (order1 == order2) {
+                o_radial_integrals_(l__, order1, order2) = 1.0;
+            } else {
+                for (int ir = 0; ir < nmtp; ir++) {
+                    s(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0);
                 }
+                o_radial_integrals_(l__, order1, order2) = s.interpolate().integrate(2);
             }
         }
     }
+
     if (atom_type_.parameters().valence_relativity() == relativity_t::iora) {
-        o1_radial_integrals_.zero();
-        #pragma omp parallel for
-        for (int i1 = 0; i1 < atom_type_.mt_radial_basis_size(); i1++) {
-            Spline<double> s(atom_type_.radial_grid());
-            for (int i2 = 0; i2 < atom_type_.mt_radial_basis_size(); i2++) {
-                /* for spherical part of potential integrals are diagonal in l */
-                if (atom_type_.indexr(i1).l == atom_type_.indexr(i2).l) {
-                    int ll = atom_type_.indexr(i1).l * (atom_type_.indexr(i1).l + 1);
-                    for (int ir = 0; ir < nmtp; ir++) {
-                        double Minv = std::pow(1 - spherical_potential_[ir] * sq_alpha_half, -2);
-                        /* u_1(r) * u_2(r) */
-                        double t0 = radial_functions_(ir, i1, 0) * radial_functions_(ir, i2, 0);
-                        /* r*u'_1(r) * r*u'_2(r) */
-                        double t1 = radial_functions_(ir, i1, 1) * radial_functions_(ir, i2, 1);
-                        s(ir)     = sq_alpha_half * 0.5 * Minv * (t1 + t0 * 0.5 * ll);
-                    }
-                    o1_radial_integrals_(i1, i2) = s.interpolate().integrate(0);
+        for (int order1 = 0; order1 < nrf; order1++) {
+            int i1 = atom_type_.indexr().index_by_l_order(l__, order1);
+            for (int order2 = 0; order2 < nrf; order2++) {
+                int i2 = atom_type_.indexr().index_by_l_order(l__, order2);
+                for (int ir = 0; ir < nmtp; ir++) {
+                    double Minv = std::pow(1 - spherical_potential_[ir] * sq_alpha_half, -2);
+                    /* u_1(r) * u_2(r) */
+                    double t0 = radial_functions_(ir, i1, 0) * radial_functions_(ir, i2, 0);
+                    /* r*u'_1(r) * r*u'_2(r) */
+                    double t1 = radial_functions_(ir, i1, 1) * radial_functions_(ir, i2, 1);
+                    s(ir)     = sq_alpha_half * 0.5 * Minv * (t1 + t0 * 0.5 * ll);
                 }
+                o1_radial_integrals_(i1, i2) = s.interpolate().integrate(0);
             }
         }
     }
@@ -693,7 +710,6 @@ Atom_symmetry_class::generate_radial_integrals(relativity_t rel__)
     if (atom_type_.parameters().so_correction()) {
         double soc = std::pow(2 * speed_of_light, -2);
 
-        Spline<double> s(atom_type_.radial_grid());
         Spline<double> s1(atom_type_.radial_grid());
         Spline<double> ve(atom_type_.radial_grid());
 
@@ -702,30 +718,25 @@ Atom_symmetry_class::generate_radial_integrals(relativity_t rel__)
         }
         ve.interpolate();
 
-        so_radial_integrals_.zero();
-        for (int l = 0; l <= atom_type_.indexr().lmax(); l++) {
-            int nrf = atom_type_.indexr().num_rf(l);
-
-            for (int order1 = 0; order1 < nrf; order1++) {
-                int idxrf1 = atom_type_.indexr().index_by_l_order(l, order1);
-                for (int order2 = 0; order2 < nrf; order2++) {
-                    int idxrf2 = atom_type_.indexr().index_by_l_order(l, order2);
-
-                    for (int ir = 0; ir < nmtp; ir++) {
-                        double M = 1.0 - 2 * soc * spherical_potential_[ir];
-                        /* first part <f| dVe / dr |f'> */
-                        s(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0) *
-                                soc * ve.deriv(1, ir) / pow(M, 2);
-
-                        /* second part <f| d(z/r) / dr |f'> */
-                        s1(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0) *
-                                 soc * atom_type_.zn() / pow(M, 2);
-                    }
-                    s.interpolate();
-                    s1.interpolate();
-
-                    so_radial_integrals_(l, order1, order2) = s.integrate(1) + s1.integrate(-1);
+        for (int order1 = 0; order1 < nrf; order1++) {
+            int idxrf1 = atom_type_.indexr().index_by_l_order(l__, order1);
+            for (int order2 = 0; order2 < nrf; order2++) {
+                int idxrf2 = atom_type_.indexr().index_by_l_order(l__, order2);
+
+                for (int ir = 0; ir < nmtp; ir++) {
+                    double M = 1.0 - 2 * soc * spherical_potential_[ir];
+                    /* first part <f| dVe / dr |f'> */
+                    s(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0) *
+                            soc * ve.deriv(1, ir) / pow(M, 2);
+
+                    /* second part <f| d(z/r) / dr |f'> */
+                    s1(ir) = radial_functions_(ir, idxrf1, 0) * radial_functions_(ir, idxrf2, 0) *
+                             soc * atom_type_.zn() / pow(M, 2);
                 }
+                s.interpolate();
+                s1.interpolate();
+
+                so_radial_integrals_(l__, order1, order2) = s.integrate(1) + s1.integrate(-1);
             }
         }
     }
@@ -96,9 +96,6 @@ class Atom_symmetry_class
     /// Generate local orbital raidal functions
     void generate_lo_radial_functions(relativity_t rel__);
 
-    /// Orthogonalize the radial functions.
-    void orthogonalize_radial_functions();
-
   public:
     /// Constructor
     Atom_symmetry_class(int id_, Atom_type const& atom_type_);
@@ -110,6 +107,42 @@ class Atom_symmetry_class
     /// Generate APW and LO radial functions.
     void generate_radial_functions(relativity_t rel__);
 
+    /// Generate augmented wave radial functions of a given orbital quantum number.
+    /** The radial functions of different l are independent; this function is not thread-parallel and can be
+     *  called concurrently for different l. */
+    void generate_aw_radial_functions(relativity_t rel__, int l__);
+
+    /// Generate radial function of a given local orbital.
+    /** Radial functions of different local orbitals are independent; this function is not thread-parallel and
+     *  can be called concurrently for different local orbitals. The radial function is accumulated and must be
+     *  zeroed beforehand. */
+    void generate_lo_radial_function(relativity_t rel__, int idxlo__);
+
+    /// Orthogonalize the radial functions.
+    void orthogonalize_radial_functions();
+
+    /// Pointers to the arrays of radial functions and surface derivatives together with their sizes.
+    /** Used to pack the radial functions of all symmetry classes into a single buffer for the exchange between
+     *  MPI ranks. */
+    inline std::vector<std::pair<double*, size_t>> radial_functions_data()
+    {
+        return {{radial_functions_.at(memory_t::host), radial_functions_.size()},
+                {surface_derivatives_.at(memory_t::host), surface_derivatives_.size()}};
+    }
+
+    /// Pointers to the arrays of radial integrals together with their sizes.
+    inline std::vector<std::pair<double*, size_t>> radial_integrals_data()
+    {
+        std::vector<std::pair<double*, size_t>> data(
+            {{h_spherical_integrals_.at(memory_t::host), h_spherical_integrals_.size()},
+             {o_radial_integrals_.at(memory_t::host), o_radial_integrals_.size()},
+             {so_radial_integrals_.at(memory_t::host), so_radial_integrals_.size()}});
+        if (atom_type_.parameters().valence_relativity() == relativity_t::iora) {
+            data.push_back({o1_radial_integrals_.at(memory_t::host), o1_radial_integrals_.size()});
+        }
+        return data;
+    }
+
     void sync_radial_functions(Communicator const& comm__, int const rank__);
 
     void sync_radial_integrals(Communicator const& comm__, int const rank__);
@@ -128,6 +161,9 @@ class Atom_symmetry_class
     /// Find linearization energy.
     void find_enu(relativity_t rel__);
 
+    /// Find linearization energy of a single radial solution if it is marked for the automatic search.
+    void find_enu(relativity_t rel__, radial_solution_descriptor& rsd__) const;
+
     void write_enu(pstdout& pout) const;
 
     /// Generate radial overlap and SO integrals
@@ -143,6 +179,11 @@ class Atom_symmetry_class
      */
     void generate_radial_integrals(relativity_t rel__);
 
+    /// Generate radial integrals between the radial functions of a given orbital quantum number.
+    /** The spherical Hamiltonian, overlap and SO integrals are diagonal in l. This function is not thread-parallel
+     *  and can be called concurrently for different l; the arrays of integrals must be zeroed beforehand. */
+    void generate_radial_integrals(relativity_t rel__, int l__);
+
     /// Get m-th order radial derivative of AW functions at the MT surface.
     inline double aw_surface_deriv(int l__, int order__, int dm__) const
     {
@@ -23,11 +23,12 @@
  */
 
 #include "atom_type.hpp"
+#include "utils/binary_cache.hpp"
 
 namespace sirius {
 
 void
-Atom_type::init(int offset_lo__)
+Atom_type::init(int offset_lo__, Communicator const& comm__)
 {
     PROFILE("sirius::Atom_type::init");
 
@@ -39,7 +40,7 @@ Atom_type::init(int offset_lo__)
     offset_lo_ = offset_lo__;
 
     /* read data from file if it exists */
-    read_input(file_name_);
+    read_input(file_name_, comm__);
 
     /* check the nuclear charge */
     if (zn_ == 0) {
@@ -669,9 +670,41 @@ Atom_type::read_pseudo_paw(nlohmann::json const& parser)
 }
 
 void
-Atom_type::read_input(std::string const& str__)
+Atom_type::read_input(std::string const& str__, Communicator const& comm__)
 {
-    auto parser = utils::read_json_from_file_or_string(str__);
+    nlohmann::json parser;
+
+    utils::binary_cache cache(parameters_.cfg().settings().cache_dir());
+    if (cache.enabled() && !str__.empty()) {
+        /* input is either a file name or a JSON string */
+        std::string raw = str__;
+        if (str__.find("{") == std::string::npos) {
+            std::ifstream ifs(str__);
+            if (!ifs.is_open()) {
+                RTE_THROW("file " + str__ + " can't be opened");
+            }
+            std::stringstream ss;
+            ss << ifs.rdbuf();
+            raw = ss.str();
+        }
+        input_hash_ = utils::hash(raw.data(), raw.size());
+        /* parsed input is stored in the binary CBOR format */
+        auto r = cache.read("atom_type", input_hash_);
+        /* either all ranks decode the cached input or all ranks parse the text */
+        int valid = r.valid() ? 1 : 0;
+        comm__.allreduce<int, mpi_op_t::min>(&valid, 1);
+        if (valid) {
+            parser = nlohmann::json::from_cbor(r.data(), r.data() + r.size());
+        } else {
+            parser = utils::read_json_from_string(raw);
+            if (comm__.rank() == 0) {
+                auto buf = nlohmann::json::to_cbor(parser);
+                cache.write("atom_type", input_hash_, buf.data(), buf.size());
+            }
+        }
+    } else {
+        parser = utils::read_json_from_file_or_string(str__);
+    }
 
     if (parser.empty()) {
         return;
@@ -238,6 +238,9 @@ class Atom_type
     /// Name of the input file for this atom type.
     std::string file_name_;
 
+    /// Hash of the input file or string; zero if the atom type is not read from the input.
+    uint64_t input_hash_{0};
+
     sddk::mdarray<int, 2> idx_radial_integrals_;
 
     mutable sddk::mdarray<double, 3> rf_coef_;
@@ -270,7 +273,8 @@ class Atom_type
     inline void read_pseudo_paw(nlohmann::json const& parser);
 
     /// Read atomic parameters from json file or string.
-    inline void read_input(std::string const& str__);
+    /** The ranks of comm__ take the same decision about the use of the cached input. */
+    inline void read_input(std::string const& str__, Communicator const& comm__);
 
     /// Initialize descriptors of the augmented-wave radial functions.
     inline void init_aw_descriptors()
@@ -347,8 +351,9 @@ class Atom_type
     Atom_type(Atom_type&& src) = default;
 
     /// Initialize the atom type.
-    /** Once the unit cell is populated with all atom types and atoms, each atom type can be initialized. */
-    void init(int offset_lo__);
+    /** Once the unit cell is populated with all atom types and atoms, each atom type can be initialized.
+     *  This is a collective operation over comm__ if the cache of the input is enabled. */
+    void init(int offset_lo__, Communicator const& comm__ = Communicator::self());
 
     /// Initialize the free atom density (smooth or true).
     void init_free_atom_density(bool smooth);
@@ -963,6 +968,12 @@ class Atom_type
         return file_name_;
     }
 
+    /// Hash of the input; used as a key of the cached data of this atom type.
+    inline uint64_t input_hash() const
+    {
+        return input_hash_;
+    }
+
     inline int offset_lo() const
     {
         RTE_ASSERT(offset_lo_ >= 0);
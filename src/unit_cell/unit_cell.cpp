@@ -23,6 +23,7 @@
  */
 
 #include <iomanip>
+#include <numeric>
 #include "unit_cell.hpp"
 #include "symmetry/crystal_symmetry.hpp"
 
@@ -31,6 +32,7 @@ namespace sirius {
 Unit_cell::Unit_cell(Simulation_parameters const& parameters__, Communicator const& comm__)
     : parameters_(parameters__)
     , comm_(comm__)
+    , comm_node_(comm__.split_shared())
 {
 }
 
@@ -466,19 +468,161 @@ Unit_cell::is_point_in_mt(vector3d<double> vc, int& ja, int& jr, double& dr, dou
     return false;
 }
 
+/// Distribute independent tasks between MPI ranks and execute the local tasks in the OpenMP task pool.
+/** Tasks are assigned with the longest-processing-time rule: in the order of decreasing cost each task goes to
+ *  the least loaded rank. The assignment depends only on the costs and is the same on all ranks. Local tasks are
+ *  spawned in the same order, so the most expensive ones start first. Return the list of local tasks. */
+template <typename F>
+static std::vector<int>
+run_tasks(Communicator const& comm__, std::vector<double> const& cost__, F&& f__)
+{
+    std::vector<int> order(cost__.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&cost__](int i1, int i2) { return cost__[i1] > cost__[i2]; });
+
+    std::vector<double> load(comm__.size(), 0);
+    std::vector<int> local;
+    for (int i : order) {
+        int rank = static_cast<int>(std::min_element(load.begin(), load.end()) - load.begin());
+        load[rank] += cost__[i];
+        if (rank == comm__.rank()) {
+            local.push_back(i);
+        }
+    }
+
+    #pragma omp parallel
+    {
+        #pragma omp single
+        {
+            for (int i : local) {
+                #pragma omp task firstprivate(i)
+                f__(i);
+            }
+        }
+    }
+    return local;
+}
+
+/// Sum the arrays over all MPI ranks with a single collective operation.
+static void
+allreduce(Communicator const& comm__, std::vector<std::pair<double*, size_t>> const& data__)
+{
+    size_t size{0};
+    for (auto& e : data__) {
+        size += e.second;
+    }
+    std::vector<double> buf(size);
+    size_t offset{0};
+    for (auto& e : data__) {
+        std::copy(e.first, e.first + e.second, buf.begin() + offset);
+        offset += e.second;
+    }
+    comm__.allreduce(buf.data(), static_cast<int>(size));
+    offset = 0;
+    for (auto& e : data__) {
+        std::copy(buf.begin() + offset, buf.begin() + offset + e.second, e.first);
+        offset += e.second;
+    }
+}
+
 void
 Unit_cell::generate_radial_functions()
 {
     PROFILE("sirius::Unit_cell::generate_radial_functions");
 
-    for (int icloc = 0; icloc < (int)spl_num_atom_symmetry_classes().local_size(); icloc++) {
-        int ic = spl_num_atom_symmetry_classes(icloc);
-        atom_symmetry_class(ic).generate_radial_functions(parameters_.valence_relativity());
+    auto rel = parameters_.valence_relativity();
+
+    /* The work is split into independent radial solves: one task for the augmented waves of each (class, l) pair,
+       as the orders of the same l are orthogonalized to each other, and one task for each local orbital.
+       The automatic search of the linearization energies is done inside the task which uses them. */
+    struct task
+    {
+        int ic;
+        /* l for the augmented waves or -1 - idxlo for the local orbitals */
+        int i;
+    };
+    std::vector<task> tasks;
+    std::vector<double> cost;
+    auto rsd_set = [this, &tasks](int i) -> radial_solution_descriptor_set& {
+        auto& asc = atom_symmetry_class(tasks[i].ic);
+        return (tasks[i].i >= 0) ? asc.aw_descriptor(tasks[i].i) : asc.lo_descriptor(-1 - tasks[i].i).rsd_set;
+    };
+    for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+        auto& asc = atom_symmetry_class(ic);
+        for (int l = 0; l < asc.num_aw_descriptors(); l++) {
+            tasks.push_back({ic, l});
+        }
+        for (int idxlo = 0; idxlo < asc.num_lo_descriptors(); idxlo++) {
+            tasks.push_back({ic, -1 - idxlo});
+        }
+        /* radial functions are summed over ranks at the end */
+        for (auto& e : asc.radial_functions_data()) {
+            std::fill(e.first, e.first + e.second, 0);
+        }
+    }
+    /* cost is measured in radial solves times the number of radial points; the search of the linearization
+       energy takes roughly ten radial solves */
+    std::vector<int> enu_offset(tasks.size() + 1, 0);
+    for (int i = 0; i < static_cast<int>(tasks.size()); i++) {
+        double c{0};
+        for (auto& rsd : rsd_set(i)) {
+            c += rsd.auto_enu ? 11 : 1;
+        }
+        cost.push_back(c * atom_symmetry_class(tasks[i].ic).atom_type().num_mt_points());
+        enu_offset[i + 1] = enu_offset[i] + static_cast<int>(rsd_set(i).size());
     }
 
+    auto local = run_tasks(comm_, cost, [&](int i) {
+        auto& asc = atom_symmetry_class(tasks[i].ic);
+        for (auto& rsd : rsd_set(i)) {
+            asc.find_enu(rel, rsd);
+        }
+        if (tasks[i].i >= 0) {
+            asc.generate_aw_radial_functions(rel, tasks[i].i);
+        } else {
+            asc.generate_lo_radial_function(rel, -1 - tasks[i].i);
+        }
+    });
+
+    /* linearization energies and the flags of their update are exchanged together with the radial functions */
+    std::vector<double> enu(2 * enu_offset.back(), 0);
+    for (int i : local) {
+        int j{enu_offset[i]};
+        for (auto& rsd : rsd_set(i)) {
+            enu[2 * j]     = rsd.enu;
+            enu[2 * j + 1] = rsd.new_enu_found;
+            j++;
+        }
+    }
+    std::vector<std::pair<double*, size_t>> data({{enu.data(), enu.size()}});
     for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-        int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-        atom_symmetry_class(ic).sync_radial_functions(comm_, rank);
+        for (auto& e : atom_symmetry_class(ic).radial_functions_data()) {
+            data.push_back(e);
+        }
+    }
+    allreduce(comm_, data);
+
+    for (int i = 0; i < static_cast<int>(tasks.size()); i++) {
+        int j{enu_offset[i]};
+        for (auto& rsd : rsd_set(i)) {
+            rsd.enu           = enu[2 * j];
+            rsd.new_enu_found = enu[2 * j + 1] != 0;
+            j++;
+        }
+    }
+
+    for (int icloc = 0; icloc < (int)spl_num_atom_symmetry_classes().local_size(); icloc++) {
+        int ic = spl_num_atom_symmetry_classes(icloc);
+        auto& asc = atom_symmetry_class(ic);
+        if (parameters_.cfg().control().verification() > 0 && asc.num_lo_descriptors() > 0) {
+            asc.check_lo_linear_independence(0.0001);
+        }
+    }
+    if (parameters_.cfg().control().ortho_rf()) {
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
+            atom_symmetry_class(ic).orthogonalize_radial_functions();
+        }
     }
 
     if (parameters_.verbosity() >= 1) {
@@ -507,15 +651,30 @@ Unit_cell::generate_radial_integrals()
     PROFILE("sirius::Unit_cell::generate_radial_integrals");
 
     try {
-        for (int icloc = 0; icloc < spl_num_atom_symmetry_classes().local_size(); icloc++) {
-            int ic = spl_num_atom_symmetry_classes(icloc);
-            atom_symmetry_class(ic).generate_radial_integrals(parameters_.valence_relativity());
-        }
+        auto rel = parameters_.valence_relativity();
 
+        /* integrals are diagonal in l: one task for each (class, l) pair */
+        std::vector<std::pair<int, int>> tasks;
+        std::vector<double> cost;
+        std::vector<std::pair<double*, size_t>> data;
         for (int ic = 0; ic < num_atom_symmetry_classes(); ic++) {
-            int rank = spl_num_atom_symmetry_classes().local_rank(ic);
-            atom_symmetry_class(ic).sync_radial_integrals(comm_, rank);
+            auto& asc = atom_symmetry_class(ic);
+            for (int l = 0; l <= asc.atom_type().indexr().lmax(); l++) {
+                int nrf = asc.atom_type().indexr().num_rf(l);
+                tasks.push_back({ic, l});
+                cost.push_back(static_cast<double>(nrf * nrf) * asc.atom_type().num_mt_points());
+            }
+            for (auto& e : asc.radial_integrals_data()) {
+                std::fill(e.first, e.first + e.second, 0);
+                data.push_back(e);
+            }
         }
+
+        run_tasks(comm_, cost, [&](int i) {
+            atom_symmetry_class(tasks[i].first).generate_radial_integrals(rel, tasks[i].second);
+        });
+
+        allreduce(comm_, data);
     } catch(std::exception const& e) {
         std::stringstream s;
         s << "Error in generating atom_symmetry_class radial integrals";
@@ -611,7 +770,7 @@ Unit_cell::initialize()
     /* initialize atom types */
     int offs_lo{0};
     for (int iat = 0; iat < num_atom_types(); iat++) {
-        atom_type(iat).init(offs_lo);
+        atom_type(iat).init(offs_lo, comm_);
         max_num_mt_points_        = std::max(max_num_mt_points_, atom_type(iat).num_mt_points());
         max_mt_basis_size_        = std::max(max_mt_basis_size_, atom_type(iat).mt_basis_size());
         max_mt_radial_basis_size_ = std::max(max_mt_radial_basis_size_, atom_type(iat).mt_radial_basis_size());
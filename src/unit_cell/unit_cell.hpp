@@ -163,6 +163,9 @@ class Unit_cell
 
     Communicator const& comm_;
 
+    /// Ranks of comm_ which share the memory of a node.
+    Communicator comm_node_;
+
     std::pair<int, std::vector<int>> num_hubbard_wf_;
 
     /// Check if MT spheres overlap
@@ -256,8 +259,12 @@ class Unit_cell
 
     bool is_point_in_mt(vector3d<double> vc, int& ja, int& jr, double& dr, double tp[2]) const;
 
+    /// Generate radial functions of all atom symmetry classes.
+    /** Individual radial solves of all classes are distributed between MPI ranks and executed as OpenMP tasks;
+     *  the result is exchanged with a single collective operation. */
     void generate_radial_functions();
 
+    /// Generate radial integrals of all atom symmetry classes and atoms.
     void generate_radial_integrals();
 
     /// Get a simple simple chemical formula bases on the total unit cell.
@@ -564,6 +571,12 @@ class Unit_cell
         return comm_;
     }
 
+    /// Communicator of the ranks sharing the memory of a node.
+    auto const& comm_node() const
+    {
+        return comm_node_;
+    }
+
     inline auto const& atom_coord(int iat__) const
     {
         return atom_coord_[iat__];
@@ -0,0 +1,223 @@
+// Copyright (c) 2013-2021 Anton Kozhevnikov, Thomas Schulthess
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+// the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this list of conditions and the
+//    following disclaimer.
+// 2. Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+//    and the following disclaimer in the documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+// WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+// ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+/** \file binary_cache.hpp
+ *
+ *  \brief Simple file-based cache of binary data.
+ */
+
+#ifndef __BINARY_CACHE_HPP__
+#define __BINARY_CACHE_HPP__
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace utils {
+
+/// Cache of binary records stored in separate files of a directory.
+/** Each record is identified by a 64-bit key, which is a hash of all the input data the record depends on.
+ *  The record is written to a temporary file which is then renamed, so a concurrent reader sees either the
+ *  complete record or no record at all. Records are read through a read-only memory mapping; on a node all
+ *  processes share the same pages of the file system cache. */
+class binary_cache
+{
+  private:
+    /// Increase the version when the layout of any record is changed.
+    static const uint32_t version_ = 1;
+
+    struct header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t key;
+        uint64_t size;
+    };
+
+    /// Cache directory; empty if the cache is disabled.
+    std::string dir_;
+
+    std::string file_name(std::string const& prefix__, uint64_t key__) const
+    {
+        std::stringstream s;
+        s << dir_ << "/" << prefix__ << "_" << std::hex << std::setw(16) << std::setfill('0') << key__ << ".bin";
+        return s.str();
+    }
+
+  public:
+    /// Memory-mapped record.
+    class record
+    {
+      private:
+        void* ptr_{nullptr};
+        size_t size_{0};
+        /// Size of the header in front of the data.
+        size_t offset_{0};
+
+        record(record const& src__) = delete;
+        record& operator=(record const& src__) = delete;
+
+      public:
+        record()
+        {
+        }
+
+        record(void* ptr__, size_t size__, size_t offset__)
+            : ptr_(ptr__)
+            , size_(size__)
+            , offset_(offset__)
+        {
+        }
+
+        record(record&& src__)
+        {
+            *this = std::move(src__);
+        }
+
+        record& operator=(record&& src__)
+        {
+            if (this != &src__) {
+                if (ptr_) {
+                    munmap(ptr_, size_);
+                }
+                ptr_        = src__.ptr_;
+                size_       = src__.size_;
+                offset_     = src__.offset_;
+                src__.ptr_  = nullptr;
+                src__.size_ = 0;
+            }
+            return *this;
+        }
+
+        ~record()
+        {
+            if (ptr_) {
+                munmap(ptr_, size_);
+            }
+        }
+
+        /// True if the record was found.
+        inline bool valid() const
+        {
+            return ptr_ != nullptr;
+        }
+
+        /// Pointer to the data.
+        inline char const* data() const
+        {
+            return static_cast<char const*>(ptr_) + offset_;
+        }
+
+        /// Size of the data in bytes.
+        inline size_t size() const
+        {
+            return size_ - offset_;
+        }
+    };
+
+    binary_cache()
+    {
+    }
+
+    explicit binary_cache(std::string const& dir__)
+        : dir_(dir__)
+    {
+    }
+
+    /// True if the cache is enabled.
+    inline bool enabled() const
+    {
+        return !dir_.empty();
+    }
+
+    /// Map the record into memory; an invalid record is returned if it doesn't exist or doesn't match the key.
+    record read(std::string const& prefix__, uint64_t key__) const
+    {
+        if (!enabled()) {
+            return record();
+        }
+        int fd = open(file_name(prefix__, key__).c_str(), O_RDONLY);
+        if (fd < 0) {
+            return record();
+        }
+        struct stat st;
+        if (fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(header)) {
+            close(fd);
+            return record();
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* ptr   = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (ptr == MAP_FAILED) {
+            return record();
+        }
+        record r(ptr, size, sizeof(header));
+        header h;
+        std::memcpy(&h, ptr, sizeof(header));
+        if (std::memcmp(h.magic, "SIRIUSBC", 8) || h.version != version_ || h.key != key__ ||
+            h.size != r.size()) {
+            return record();
+        }
+        return r;
+    }
+
+    /// Write the record.
+    void write(std::string const& prefix__, uint64_t key__, void const* data__, size_t size__) const
+    {
+        if (!enabled()) {
+            return;
+        }
+        header h;
+        std::memcpy(h.magic, "SIRIUSBC", 8);
+        h.version  = version_;
+        h.reserved = 0;
+        h.key      = key__;
+        h.size     = size__;
+
+        auto name = file_name(prefix__, key__);
+        std::stringstream s;
+        s << name << "." << getpid() << ".tmp";
+        auto tmp_name = s.str();
+
+        FILE* fout = std::fopen(tmp_name.c_str(), "wb");
+        if (!fout) {
+            return;
+        }
+        bool ok = std::fwrite(&h, sizeof(header), 1, fout) == 1;
+        ok      = ok && (size__ == 0 || std::fwrite(data__, size__, 1, fout) == 1);
+        ok      = (std::fclose(fout) == 0) && ok;
+        if (!ok || std::rename(tmp_name.c_str(), name.c_str())) {
+            std::remove(tmp_name.c_str());
+        }
+    }
+};
+
+} // namespace utils
+
+#endif
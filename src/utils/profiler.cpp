@@ -22,7 +22,26 @@
  *  \brief A time-based profiler.
  */
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "profiler.hpp"
+#include "SDDK/omp.hpp"
 
 namespace utils {
 ::rt_graph::Timer global_rtgraph_timer;
@@ -30,4 +49,407 @@ namespace utils {
 #if defined(SIRIUS_CUDA_NVTX)
 ::nvtxprofiler::Timer global_nvtx_timer;
 #endif
+
+namespace {
+
+/// Origin of the trace time.
+std::chrono::steady_clock::time_point trace_t0;
+
+/// Buffers of all threads which recorded events.
+std::vector<std::unique_ptr<profiler_trace::thread_buffer>> trace_buffers;
+
+std::mutex trace_mutex;
+
+inline double trace_time()
+{
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - trace_t0).count();
+}
+
+inline size_t trace_buffer_size()
+{
+    char const* str = std::getenv("SIRIUS_TRACE_BUFFER");
+    long n = str ? std::atol(str) : 0;
+    return (n > 0) ? static_cast<size_t>(n) : 100000;
+}
+
+inline std::string json_quote(std::string const& str__)
+{
+    std::string r("\"");
+    for (char c : str__) {
+        if (c == '"' || c == '\\') {
+            r += '\\';
+        }
+        r += c;
+    }
+    return r + "\"";
+}
+
+/// Perf event group of one OpenMP thread.
+struct counter_group
+{
+    /// File descriptor of the group leader.
+    int leader{-1};
+    /// Position of the event in the group data or -1 if the event is not counted.
+    std::array<int, profiler_counters::num_events> slot;
+    int num_slots{0};
+};
+
+/// Accumulated counters of a node of the region tree.
+struct counter_node
+{
+    std::string name;
+    int depth{0};
+    long calls{0};
+    double wall{0};
+    std::array<double, profiler_counters::num_events> value;
+};
+
+/// Open region.
+struct counter_frame
+{
+    /// Index of the node or -1 for the region called inside a parallel section.
+    int node{-1};
+    std::string path;
+    std::chrono::steady_clock::time_point t0;
+    std::array<double, profiler_counters::num_events> value;
+};
+
+std::vector<counter_group> counter_groups;
+
+/// Events which are counted by all threads.
+std::array<bool, profiler_counters::num_events> counter_available;
+
+/// Nodes of the region tree in the order of the first appearance.
+std::vector<counter_node> counter_nodes;
+
+std::map<std::string, int> counter_index;
+
+/// Open regions of the calling thread.
+inline std::vector<counter_frame>& counter_stack()
+{
+    static thread_local std::vector<counter_frame> stack_;
+    return stack_;
+}
+
+#if defined(__linux__)
+inline int perf_event_open(uint32_t type__, uint64_t config__, int group_fd__)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(perf_event_attr));
+    attr.size           = sizeof(perf_event_attr);
+    attr.type           = type__;
+    attr.config         = config__;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    /* count the calling thread on any CPU */
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd__, 0));
+}
+#endif
+
+/// Open the counter group for the calling thread.
+inline counter_group open_counter_group()
+{
+    counter_group g;
+    g.slot.fill(-1);
+#if defined(__linux__)
+    g.leader = perf_event_open(PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK, -1);
+    if (g.leader < 0) {
+        return g;
+    }
+    g.slot[profiler_counters::task_clock] = g.num_slots++;
+
+    auto add = [&](profiler_counters::event_t e__, uint32_t type__, uint64_t config__) {
+        if (perf_event_open(type__, config__, g.leader) >= 0) {
+            g.slot[e__] = g.num_slots++;
+        }
+    };
+    add(profiler_counters::cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    add(profiler_counters::instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    add(profiler_counters::cache_misses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+    /* floating point operations are counted by a model specific raw event, e.g. 0x01c7 for
+       FP_ARITH_INST_RETIRED.SCALAR_DOUBLE on Intel */
+    if (char const* str = std::getenv("SIRIUS_PERF_FLOPS_EVENT")) {
+        add(profiler_counters::flops, PERF_TYPE_RAW, std::strtoull(str, nullptr, 16));
+    }
+#endif
+    return g;
+}
+
+/// Read the counters of all threads and sum them up.
+inline std::array<double, profiler_counters::num_events> read_counters()
+{
+    std::array<double, profiler_counters::num_events> v;
+    v.fill(0);
+#if defined(__linux__)
+    /* number of events, time enabled, time running and the values */
+    std::array<uint64_t, 3 + profiler_counters::num_events> buf;
+    for (auto& g : counter_groups) {
+        if (g.leader < 0) {
+            continue;
+        }
+        size_t sz = (3 + g.num_slots) * sizeof(uint64_t);
+        if (read(g.leader, buf.data(), sz) != static_cast<ssize_t>(sz)) {
+            continue;
+        }
+        /* scale the values if the group was multiplexed */
+        double scale = (buf[2] > 0) ? static_cast<double>(buf[1]) / buf[2] : 0;
+        for (int e = 0; e < profiler_counters::num_events; e++) {
+            if (g.slot[e] >= 0) {
+                v[e] += scale * buf[3 + g.slot[e]];
+            }
+        }
+    }
+#endif
+    return v;
+}
+
+} // namespace
+
+int profiler_trace::level()
+{
+    static int level_ = []() {
+        char const* str = std::getenv("SIRIUS_TRACE");
+        return str ? std::atoi(str) : 0;
+    }();
+    return level_;
+}
+
+profiler_trace::thread_buffer& profiler_trace::buffer()
+{
+    static thread_local thread_buffer* buf{nullptr};
+    if (!buf) {
+        std::lock_guard<std::mutex> lock(trace_mutex);
+        trace_buffers.emplace_back(new thread_buffer);
+        buf      = trace_buffers.back().get();
+        buf->tid = static_cast<int>(trace_buffers.size()) - 1;
+        buf->events.resize(trace_buffer_size());
+    }
+    return *buf;
+}
+
+void profiler_trace::init(MPI_Comm comm__)
+{
+    if (level() == 0) {
+        return;
+    }
+    MPI_Barrier(comm__);
+    trace_t0  = std::chrono::steady_clock::now();
+    enabled() = true;
+}
+
+void profiler_trace::begin(std::string const& name__)
+{
+    auto& buf = buffer();
+    event e;
+    e.name  = name__;
+    e.start = trace_time();
+    buf.open.push_back(std::move(e));
+}
+
+void profiler_trace::end()
+{
+    auto& buf = buffer();
+    if (buf.open.empty()) {
+        return;
+    }
+    auto& e    = buf.open.back();
+    e.duration = trace_time() - e.start;
+    buf.events[buf.count % buf.events.size()] = std::move(e);
+    buf.count++;
+    buf.open.pop_back();
+}
+
+std::string profiler_trace::events(int rank__)
+{
+    std::stringstream s;
+    s.precision(3);
+    s << std::fixed;
+    s << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << rank__ << ",\"args\":{\"name\":\"rank " << rank__
+      << "\"}}";
+
+    std::lock_guard<std::mutex> lock(trace_mutex);
+    for (auto& buf : trace_buffers) {
+        size_t n      = std::min(buf->count, buf->events.size());
+        size_t offset = buf->count - n;
+        s << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << rank__ << ",\"tid\":" << buf->tid
+          << ",\"args\":{\"name\":\"thread " << buf->tid << "\",\"dropped_events\":" << offset << "}}";
+        for (size_t i = offset; i < buf->count; i++) {
+            auto& e = buf->events[i % buf->events.size()];
+            s << ",\n{\"name\":" << json_quote(e.name) << ",\"cat\":\"sirius\",\"ph\":\"X\",\"ts\":" << e.start
+              << ",\"dur\":" << e.duration << ",\"pid\":" << rank__ << ",\"tid\":" << buf->tid << "}";
+        }
+    }
+    return s.str();
+}
+
+void profiler_trace::save(MPI_Comm comm__)
+{
+    if (!enabled()) {
+        return;
+    }
+    int rank, size;
+    MPI_Comm_rank(comm__, &rank);
+    MPI_Comm_size(comm__, &size);
+
+    auto str = events(rank);
+
+    if (level() == 1) {
+        std::stringstream fname;
+        fname << "trace_rank" << rank << ".json";
+        std::ofstream ofs(fname.str(), std::ofstream::out | std::ofstream::trunc);
+        ofs << "{\"traceEvents\":[\n" << str << "\n],\"displayTimeUnit\":\"ms\"}\n";
+        return;
+    }
+
+    /* merge the events of all ranks on rank 0; the events of the ranks are streamed to rank 0 one by one in
+       chunks, so neither the total size nor the size of one rank is limited by the int counts of MPI */
+    size_t const chunk_size = size_t(1) << 30;
+    if (rank == 0) {
+        std::ofstream ofs("trace.json", std::ofstream::out | std::ofstream::trunc);
+        ofs << "{\"traceEvents\":[\n" << str;
+        std::vector<char> buf;
+        for (int r = 1; r < size; r++) {
+            uint64_t len;
+            MPI_Recv(&len, 1, MPI_UINT64_T, r, 0, comm__, MPI_STATUS_IGNORE);
+            ofs << ",\n";
+            for (uint64_t offs = 0; offs < len; offs += chunk_size) {
+                int n = static_cast<int>(std::min<uint64_t>(chunk_size, len - offs));
+                buf.resize(n);
+                MPI_Recv(buf.data(), n, MPI_CHAR, r, 1, comm__, MPI_STATUS_IGNORE);
+                ofs.write(buf.data(), n);
+            }
+        }
+        ofs << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    } else {
+        uint64_t len = str.size();
+        MPI_Send(&len, 1, MPI_UINT64_T, 0, 0, comm__);
+        for (uint64_t offs = 0; offs < len; offs += chunk_size) {
+            int n = static_cast<int>(std::min<uint64_t>(chunk_size, len - offs));
+            MPI_Send(str.data() + offs, n, MPI_CHAR, 0, 1, comm__);
+        }
+    }
+}
+
+int profiler_counters::level()
+{
+    static int level_ = []() {
+        char const* str = std::getenv("SIRIUS_PERF_COUNTERS");
+        return str ? std::atoi(str) : 0;
+    }();
+    return level_;
+}
+
+void profiler_counters::init()
+{
+    if (level() == 0 || enabled()) {
+        return;
+    }
+    counter_groups.resize(omp_get_max_threads());
+    #pragma omp parallel
+    {
+        counter_groups[omp_get_thread_num()] = open_counter_group();
+    }
+    counter_available.fill(true);
+    for (auto& g : counter_groups) {
+        for (int e = 0; e < num_events; e++) {
+            counter_available[e] = counter_available[e] && (g.slot[e] >= 0);
+        }
+    }
+    enabled() = counter_available[task_clock];
+    if (!enabled()) {
+        int rank{0};
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        if (rank == 0) {
+            std::printf("[profiler_counters] perf_event_open() failed, performance counters are not available\n");
+        }
+    }
+}
+
+void profiler_counters::begin(std::string const& name__)
+{
+    auto& stack = counter_stack();
+    counter_frame f;
+    if (omp_in_parallel()) {
+        stack.push_back(f);
+        return;
+    }
+    f.path = (stack.empty() ? std::string() : stack.back().path + "/") + name__;
+    auto it = counter_index.find(f.path);
+    if (it == counter_index.end()) {
+        counter_node n;
+        n.name  = name__;
+        n.depth = 0;
+        for (auto& e : stack) {
+            n.depth += (e.node >= 0);
+        }
+        n.value.fill(0);
+        counter_nodes.push_back(n);
+        it = counter_index.emplace(f.path, static_cast<int>(counter_nodes.size()) - 1).first;
+    }
+    f.node  = it->second;
+    f.value = read_counters();
+    f.t0    = std::chrono::steady_clock::now();
+    stack.push_back(std::move(f));
+}
+
+void profiler_counters::end()
+{
+    auto& stack = counter_stack();
+    if (stack.empty()) {
+        return;
+    }
+    auto& f = stack.back();
+    if (f.node >= 0) {
+        auto t1 = std::chrono::steady_clock::now();
+        auto v  = read_counters();
+        auto& n = counter_nodes[f.node];
+        n.calls++;
+        n.wall += std::chrono::duration<double>(t1 - f.t0).count();
+        for (int e = 0; e < num_events; e++) {
+            n.value[e] += v[e] - f.value[e];
+        }
+    }
+    stack.pop_back();
+}
+
+std::string profiler_counters::print()
+{
+    std::stringstream s;
+    if (!enabled()) {
+        return s.str();
+    }
+    auto metric = [&](bool available__, double val__) {
+        char str[32];
+        if (available__) {
+            std::snprintf(str, sizeof(str), " %10.3f", val__);
+        } else {
+            std::snprintf(str, sizeof(str), " %10s", "-");
+        }
+        s << str;
+    };
+
+    char str[256];
+    std::snprintf(str, sizeof(str), "%-50s %8s %12s %10s %10s %10s %10s\n", "performance counters", "calls",
+                  "time (s)", "threads", "IPC", "GFLOP/s", "est. GB/s");
+    s << str << std::string(116, '-') << "\n";
+    for (auto& n : counter_nodes) {
+        auto name = std::string(2 * n.depth, ' ') + n.name;
+        if (name.size() > 50) {
+            name = name.substr(0, 47) + "...";
+        }
+        double t = (n.wall > 0) ? n.wall : 1;
+        std::snprintf(str, sizeof(str), "%-50s %8li %12.6f", name.c_str(), n.calls, n.wall);
+        s << str;
+        /* task clock is measured in nanoseconds */
+        metric(true, n.value[task_clock] * 1e-9 / t);
+        metric(counter_available[cycles] && counter_available[instructions] && n.value[cycles] > 0,
+               n.value[instructions] / std::max(n.value[cycles], 1.0));
+        metric(counter_available[flops], n.value[flops] * 1e-9 / t);
+        /* each last level cache miss moves one cache line from memory */
+        metric(counter_available[cache_misses], n.value[cache_misses] * 64 * 1e-9 / t);
+        s << "\n";
+    }
+    return s.str();
+}
 }
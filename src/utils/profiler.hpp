@@ -27,6 +27,7 @@
 
 #include <mpi.h>
 #include <string>
+#include <vector>
 #if defined(__APEX)
 #include <apex_api.hpp>
 #endif
@@ -45,6 +46,189 @@ extern ::nvtxprofiler::Timer global_nvtx_timer;
 
 // TODO: add calls to apex and cudaNvtx
 
+/// Timeline of the PROFILE regions in the Chrome trace event format.
+/** The trace is switched on by the environment variable SIRIUS_TRACE. With SIRIUS_TRACE=1 each rank writes its
+ *  events to trace_rank<N>.json, with SIRIUS_TRACE=2 the events of all ranks are merged into trace.json on
+ *  rank 0. The files can be opened with chrome://tracing or https://ui.perfetto.dev. Each thread records
+ *  its events into a ring buffer of SIRIUS_TRACE_BUFFER events (100000 by default); when the buffer is full
+ *  the oldest events are overwritten. The time origin is synchronized between the ranks with a barrier. */
+class profiler_trace
+{
+  public:
+    /// Complete event (region with the start time and duration in microseconds).
+    struct event
+    {
+        std::string name;
+        double start{0};
+        double duration{0};
+    };
+
+    /// Events of a single thread.
+    struct thread_buffer
+    {
+        /// Index of the thread in the order of the first recorded event.
+        int tid{0};
+        /// Ring buffer of the events.
+        std::vector<event> events;
+        /// Total number of recorded events.
+        size_t count{0};
+        /// Regions which are not finished yet.
+        std::vector<event> open;
+    };
+
+  private:
+    static thread_buffer& buffer();
+
+  public:
+    /// Tracing level taken from the environment variable SIRIUS_TRACE.
+    static int level();
+
+    static bool& enabled()
+    {
+        static bool enabled_{false};
+        return enabled_;
+    }
+
+    /// Start tracing; this is a collective operation.
+    static void init(MPI_Comm comm__);
+
+    /// Open the region on the calling thread.
+    static void begin(std::string const& name__);
+
+    /// Close the innermost open region of the calling thread and record the event.
+    static void end();
+
+    /// Events of the calling rank in the Chrome trace event format (without the enclosing braces).
+    static std::string events(int rank__);
+
+    /// Write the trace files; this is a collective operation.
+    static void save(MPI_Comm comm__);
+};
+
+/// Hardware performance counters of the PROFILE regions.
+/** The counters are switched on by the environment variable SIRIUS_PERF_COUNTERS and are read with the Linux
+ *  perf_event_open() system call; no external library is needed. A group of counters (task clock, cycles,
+ *  instructions, last level cache misses and, optionally, a raw floating point event given by
+ *  SIRIUS_PERF_FLOPS_EVENT) is opened for each OpenMP thread and the values are summed over the threads at the
+ *  start and the end of each region called outside of a parallel section. The values are accumulated for each
+ *  node of the region tree. Counters which can't be opened (e.g. no hardware counters in a virtual machine or
+ *  restrictive perf_event_paranoid setting) are skipped and the corresponding metrics are not reported. */
+class profiler_counters
+{
+  public:
+    /// Counted events.
+    enum event_t
+    {
+        task_clock,
+        cycles,
+        instructions,
+        cache_misses,
+        flops,
+        num_events
+    };
+
+    /// Counter level taken from the environment variable SIRIUS_PERF_COUNTERS.
+    static int level();
+
+    static bool& enabled()
+    {
+        static bool enabled_{false};
+        return enabled_;
+    }
+
+    /// Open the counters for all OpenMP threads.
+    static void init();
+
+    /// Take the snapshot of the counters at the start of the region.
+    static void begin(std::string const& name__);
+
+    /// Accumulate the counters of the innermost region.
+    static void end();
+
+    /// Table of the accumulated counters and derived metrics.
+    static std::string print();
+};
+
+/// Stack of the currently open PROFILE regions of the calling thread.
+/** The stack is maintained only when it is enabled (e.g. when the MPI statistics is collected) and is used to
+ *  attribute measurements to the innermost region. The regions are also passed to the timeline trace. */
+struct profiler_regions
+{
+    static bool& enabled()
+    {
+        static bool enabled_{false};
+        return enabled_;
+    }
+
+    /// True if the regions are recorded by any of the consumers.
+    static bool active()
+    {
+        return enabled() || profiler_trace::enabled() || profiler_counters::enabled();
+    }
+
+    static std::vector<std::string>& stack()
+    {
+        static thread_local std::vector<std::string> stack_;
+        return stack_;
+    }
+
+    template <typename T>
+    static void push(T const& name__)
+    {
+        if (enabled()) {
+            stack().push_back(name__);
+        }
+        if (profiler_trace::enabled()) {
+            profiler_trace::begin(name__);
+        }
+        if (profiler_counters::enabled()) {
+            profiler_counters::begin(name__);
+        }
+    }
+
+    static void pop()
+    {
+        if (enabled() && !stack().empty()) {
+            stack().pop_back();
+        }
+        if (profiler_counters::enabled()) {
+            profiler_counters::end();
+        }
+        if (profiler_trace::enabled()) {
+            profiler_trace::end();
+        }
+    }
+
+    /// Name of the innermost region.
+    static std::string current()
+    {
+        return stack().empty() ? std::string("(none)") : stack().back();
+    }
+};
+
+/// Keep the region on the stack for the lifetime of the object.
+class scoped_region
+{
+  private:
+    bool pushed_{false};
+
+  public:
+    template <typename T>
+    scoped_region(T const& name__)
+    {
+        if (profiler_regions::active()) {
+            profiler_regions::push(name__);
+            pushed_ = true;
+        }
+    }
+    ~scoped_region()
+    {
+        if (pushed_) {
+            profiler_regions::pop();
+        }
+    }
+};
+
 #if defined(SIRIUS_PROFILE)
 #define PROFILER_CONCAT_IMPL(x, y) x##y
 #define PROFILER_CONCAT(x, y) PROFILER_CONCAT_IMPL(x, y)
@@ -52,19 +236,25 @@ extern ::nvtxprofiler::Timer global_nvtx_timer;
 #if defined(SIRIUS_CUDA_NVTX)
     #define PROFILE(identifier) \
         ::nvtxprofiler::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_nvtx_timer); \
-        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer);
+        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer); \
+        ::utils::scoped_region PROFILER_CONCAT(GeneratedScopedRegion, __COUNTER__)(identifier);
     #define PROFILE_START(identifier) \
         ::utils::global_nvtx_timer.start(identifier); \
-        ::utils::global_rtgraph_timer.start(identifier);
+        ::utils::global_rtgraph_timer.start(identifier); \
+        ::utils::profiler_regions::push(identifier);
     #define PROFILE_STOP(identifier) \
+        ::utils::profiler_regions::pop(); \
         ::utils::global_rtgraph_timer.stop(identifier); \
         ::utils::global_nvtx_timer.stop(identifier);
 #else
     #define PROFILE(identifier) \
-        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer);
+        ::rt_graph::ScopedTiming PROFILER_CONCAT(GeneratedScopedTimer, __COUNTER__)(identifier, ::utils::global_rtgraph_timer); \
+        ::utils::scoped_region PROFILER_CONCAT(GeneratedScopedRegion, __COUNTER__)(identifier);
     #define PROFILE_START(identifier) \
-        ::utils::global_rtgraph_timer.start(identifier);
+        ::utils::global_rtgraph_timer.start(identifier); \
+        ::utils::profiler_regions::push(identifier);
     #define PROFILE_STOP(identifier) \
+        ::utils::profiler_regions::pop(); \
         ::utils::global_rtgraph_timer.stop(identifier);
 #endif
 